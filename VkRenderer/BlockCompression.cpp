@@ -0,0 +1,695 @@
+#include "BlockCompression.h"
+
+#include <JobSystem.h>
+#include <MipGenerator.h>
+#include <Simd.h>
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+    constexpr uint32_t BLOCK_TEXELS = 16;
+
+    // the 16 texels of a block split into one float array per channel, so projections run a lane per texel
+    struct BlockSoA {
+        alignas(simd::ALIGNMENT) float channel[4][BLOCK_TEXELS];
+    };
+
+    BlockSoA to_soa(const uint8_t *rgba) {
+        BlockSoA block;
+        for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+            for (uint32_t c = 0; c < 4; c++) {
+                block.channel[c][i] = static_cast<float>(rgba[i * 4 + c]);
+            }
+        }
+        return block;
+    }
+
+    // t[i] = dot(texel[i] - origin, axis) over the first `channels` channels
+    void project(const BlockSoA &block, uint32_t channels, const float *origin, const float *axis, float *t) {
+        alignas(simd::ALIGNMENT) float out[BLOCK_TEXELS];
+        for (uint32_t i = 0; i < BLOCK_TEXELS; i += simd::LANES) {
+            simd::vfloat sum = simd::set1(0.f);
+            for (uint32_t c = 0; c < channels; c++) {
+                const simd::vfloat d = simd::sub(simd::load(block.channel[c] + i), simd::set1(origin[c]));
+                sum = simd::add(sum, simd::mul(d, simd::set1(axis[c])));
+            }
+            simd::store(out + i, sum);
+        }
+        memcpy(t, out, sizeof(out));
+    }
+
+    // endpoints at the extremes of the block along its principal axis, found by power iteration on the covariance
+    void principal_endpoints(const BlockSoA &block, uint32_t channels, float *e0, float *e1) {
+        float mean[4] = {};
+        float lo[4], hi[4];
+        for (uint32_t c = 0; c < channels; c++) {
+            lo[c] = hi[c] = block.channel[c][0];
+            for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+                mean[c] += block.channel[c][i];
+                lo[c] = std::min(lo[c], block.channel[c][i]);
+                hi[c] = std::max(hi[c], block.channel[c][i]);
+            }
+            mean[c] /= static_cast<float>(BLOCK_TEXELS);
+        }
+
+        float cov[4][4] = {};
+        for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+            for (uint32_t a = 0; a < channels; a++) {
+                const float da = block.channel[a][i] - mean[a];
+                for (uint32_t b = a; b < channels; b++) {
+                    cov[a][b] += da * (block.channel[b][i] - mean[b]);
+                }
+            }
+        }
+        for (uint32_t a = 0; a < channels; a++) {
+            for (uint32_t b = 0; b < a; b++) {
+                cov[a][b] = cov[b][a];
+            }
+        }
+
+        // the bounding box diagonal is a good first guess and converges in a handful of steps
+        float axis[4] = {};
+        for (uint32_t c = 0; c < channels; c++) {
+            axis[c] = hi[c] - lo[c];
+        }
+        for (int iteration = 0; iteration < 8; iteration++) {
+            float next[4] = {};
+            float length = 0.f;
+            for (uint32_t a = 0; a < channels; a++) {
+                for (uint32_t b = 0; b < channels; b++) {
+                    next[a] += cov[a][b] * axis[b];
+                }
+                length = std::max(length, std::abs(next[a]));
+            }
+            if (length < 1e-6f) {
+                break;
+            }
+            for (uint32_t c = 0; c < channels; c++) {
+                axis[c] = next[c] / length;
+            }
+        }
+
+        float length2 = 0.f;
+        for (uint32_t c = 0; c < channels; c++) {
+            length2 += axis[c] * axis[c];
+        }
+        if (length2 < 1e-12f) {
+            // flat block, both endpoints sit on the mean
+            for (uint32_t c = 0; c < channels; c++) {
+                e0[c] = e1[c] = mean[c];
+            }
+            return;
+        }
+        const float inverse = 1.f / std::sqrt(length2);
+        for (uint32_t c = 0; c < channels; c++) {
+            axis[c] *= inverse;
+        }
+
+        float t[BLOCK_TEXELS];
+        project(block, channels, mean, axis, t);
+        const float tMin = *std::min_element(t, t + BLOCK_TEXELS);
+        const float tMax = *std::max_element(t, t + BLOCK_TEXELS);
+        for (uint32_t c = 0; c < channels; c++) {
+            e0[c] = std::clamp(mean[c] + axis[c] * tMin, 0.f, 255.f);
+            e1[c] = std::clamp(mean[c] + axis[c] * tMax, 0.f, 255.f);
+        }
+    }
+
+    // parameter of every texel along e0 -> e1, 0 at e0 and 1 at e1
+    void interpolation_parameters(const BlockSoA &block, uint32_t channels, const float *e0, const float *e1,
+                                  float *t) {
+        float axis[4] = {};
+        float length2 = 0.f;
+        for (uint32_t c = 0; c < channels; c++) {
+            axis[c] = e1[c] - e0[c];
+            length2 += axis[c] * axis[c];
+        }
+        if (length2 < 1e-6f) {
+            std::fill(t, t + BLOCK_TEXELS, 0.f);
+            return;
+        }
+        for (uint32_t c = 0; c < channels; c++) {
+            axis[c] /= length2;
+        }
+        project(block, channels, e0, axis, t);
+    }
+
+    // endpoints minimizing the squared error of the block for fixed interpolation weights (weight of e1 per
+    // texel). false when all texels use the same weight and the system is singular
+    bool least_squares_endpoints(const BlockSoA &block, uint32_t channels, const float *weights, float *e0,
+                                 float *e1) {
+        float a = 0.f, b = 0.f, c = 0.f;
+        float x[4] = {}, y[4] = {};
+        for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+            const float w = weights[i];
+            a += (1.f - w) * (1.f - w);
+            b += (1.f - w) * w;
+            c += w * w;
+            for (uint32_t ch = 0; ch < channels; ch++) {
+                x[ch] += (1.f - w) * block.channel[ch][i];
+                y[ch] += w * block.channel[ch][i];
+            }
+        }
+        const float det = a * c - b * b;
+        if (std::abs(det) < 1e-6f) {
+            return false;
+        }
+        for (uint32_t ch = 0; ch < channels; ch++) {
+            e0[ch] = std::clamp((c * x[ch] - b * y[ch]) / det, 0.f, 255.f);
+            e1[ch] = std::clamp((a * y[ch] - b * x[ch]) / det, 0.f, 255.f);
+        }
+        return true;
+    }
+
+    uint16_t pack_565(const float *rgb) {
+        const auto r = static_cast<uint16_t>(std::lround(rgb[0] * 31.f / 255.f));
+        const auto g = static_cast<uint16_t>(std::lround(rgb[1] * 63.f / 255.f));
+        const auto b = static_cast<uint16_t>(std::lround(rgb[2] * 31.f / 255.f));
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    void unpack_565(uint16_t color, int *rgb) {
+        const int r = (color >> 11) & 31;
+        const int g = (color >> 5) & 63;
+        const int b = color & 31;
+        rgb[0] = (r << 3) | (r >> 2);
+        rgb[1] = (g << 2) | (g >> 4);
+        rgb[2] = (b << 3) | (b >> 2);
+    }
+
+    // the four colors of a 4 color mode block
+    void bc1_palette(uint16_t c0, uint16_t c1, int palette[4][3]) {
+        unpack_565(c0, palette[0]);
+        unpack_565(c1, palette[1]);
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+    }
+
+    struct Bc1Candidate {
+        uint16_t c0;
+        uint16_t c1;
+        uint32_t indices;
+        float error;
+    };
+
+    // picks the closest of the four colors per texel by its position along c0 -> c1
+    Bc1Candidate bc1_fit(const BlockSoA &block, uint16_t c0, uint16_t c1) {
+        static constexpr uint32_t STEP_TO_CODE[4] = {0, 2, 3, 1};
+
+        int palette[4][3];
+        bc1_palette(c0, c1, palette);
+        const float e0[3] = {float(palette[0][0]), float(palette[0][1]), float(palette[0][2])};
+        const float e1[3] = {float(palette[1][0]), float(palette[1][1]), float(palette[1][2])};
+
+        float t[BLOCK_TEXELS];
+        interpolation_parameters(block, 3, e0, e1, t);
+
+        Bc1Candidate candidate{c0, c1, 0, 0.f};
+        for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+            const int step = std::clamp(static_cast<int>(std::lround(t[i] * 3.f)), 0, 3);
+            const uint32_t code = STEP_TO_CODE[step];
+            candidate.indices |= code << (2 * i);
+            for (int c = 0; c < 3; c++) {
+                const float d = block.channel[c][i] - static_cast<float>(palette[code][c]);
+                candidate.error += d * d;
+            }
+        }
+        return candidate;
+    }
+
+    void encode_bc1(const uint8_t *rgba, uint8_t *out) {
+        const BlockSoA block = to_soa(rgba);
+
+        float e0[4], e1[4];
+        principal_endpoints(block, 3, e0, e1);
+        Bc1Candidate best = bc1_fit(block, pack_565(e1), pack_565(e0));
+
+        // one refinement with the endpoints that fit the chosen indices best
+        static constexpr float CODE_WEIGHT[4] = {0.f, 1.f, 1.f / 3.f, 2.f / 3.f};
+        float weights[BLOCK_TEXELS];
+        for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+            weights[i] = CODE_WEIGHT[(best.indices >> (2 * i)) & 3];
+        }
+        if (least_squares_endpoints(block, 3, weights, e0, e1)) {
+            const Bc1Candidate refined = bc1_fit(block, pack_565(e0), pack_565(e1));
+            if (refined.error < best.error) {
+                best = refined;
+            }
+        }
+
+        // c0 > c1 selects the 4 color mode, swapping the endpoints swaps codes 0/1 and 2/3
+        if (best.c0 < best.c1) {
+            std::swap(best.c0, best.c1);
+            best.indices ^= 0x55555555u;
+        } else if (best.c0 == best.c1) {
+            best.indices = 0;
+        }
+
+        memcpy(out, &best.c0, 2);
+        memcpy(out + 2, &best.c1, 2);
+        memcpy(out + 4, &best.indices, 4);
+    }
+
+    void decode_bc1(const uint8_t *block, uint8_t *rgba) {
+        uint16_t c0, c1;
+        uint32_t indices;
+        memcpy(&c0, block, 2);
+        memcpy(&c1, block + 2, 2);
+        memcpy(&indices, block + 4, 4);
+
+        int palette[4][3];
+        unpack_565(c0, palette[0]);
+        unpack_565(c1, palette[1]);
+        uint8_t alpha[4] = {255, 255, 255, 255};
+        for (int c = 0; c < 3; c++) {
+            if (c0 > c1) {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            } else {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+        }
+        if (c0 <= c1) {
+            alpha[3] = 0;
+        }
+
+        for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+            const uint32_t code = (indices >> (2 * i)) & 3;
+            for (int c = 0; c < 3; c++) {
+                rgba[i * 4 + c] = static_cast<uint8_t>(palette[code][c]);
+            }
+            rgba[i * 4 + 3] = alpha[code];
+        }
+    }
+
+    // single channel block, 8 value mode between the channel's min and max
+    void encode_bc4(const uint8_t *rgba, uint32_t channel, uint8_t *out) {
+        uint8_t lo = 255, hi = 0;
+        for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+            lo = std::min(lo, rgba[i * 4 + channel]);
+            hi = std::max(hi, rgba[i * 4 + channel]);
+        }
+
+        uint64_t bits = uint64_t(hi) | (uint64_t(lo) << 8);
+        if (hi > lo) {
+            const float scale = 7.f / static_cast<float>(hi - lo);
+            for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+                // step 0 is hi (code 0), step 7 is lo (code 1), the interpolants in between are codes 2..7
+                const int step = std::clamp(
+                    static_cast<int>(std::lround(static_cast<float>(hi - rgba[i * 4 + channel]) * scale)), 0, 7);
+                const uint64_t code = step == 0 ? 0 : step == 7 ? 1 : uint64_t(step + 1);
+                bits |= code << (16 + 3 * i);
+            }
+        }
+        memcpy(out, &bits, 8);
+    }
+
+    void decode_bc4(const uint8_t *block, uint8_t *rgba, uint32_t channel) {
+        uint64_t bits;
+        memcpy(&bits, block, 8);
+        const int r0 = static_cast<int>(bits & 0xff);
+        const int r1 = static_cast<int>((bits >> 8) & 0xff);
+
+        int palette[8] = {r0, r1};
+        if (r0 > r1) {
+            for (int k = 1; k < 7; k++) {
+                palette[k + 1] = ((7 - k) * r0 + k * r1) / 7;
+            }
+        } else {
+            for (int k = 1; k < 5; k++) {
+                palette[k + 1] = ((5 - k) * r0 + k * r1) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+            rgba[i * 4 + channel] = static_cast<uint8_t>(palette[(bits >> (16 + 3 * i)) & 7]);
+        }
+    }
+
+    // BC7 mode 6: one subset, RGBA endpoints of 7 bits plus a shared lsb (p-bit) each and 4 bit indices. the
+    // single subset mode is the cheapest to search and still beats BC1/BC3 clearly on color and alpha
+    constexpr int BC7_WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    struct Bc7Endpoint {
+        uint8_t q[4]; // 7 bit per channel
+        uint8_t p;
+        [[nodiscard]] int value(int c) const { return (q[c] << 1) | p; }
+    };
+
+    // rounds to the 7 bit + p-bit grid, trying both p-bits
+    Bc7Endpoint quantize_bc7(const float *e) {
+        Bc7Endpoint best{};
+        float bestError = std::numeric_limits<float>::max();
+        for (uint8_t p = 0; p < 2; p++) {
+            Bc7Endpoint candidate{};
+            candidate.p = p;
+            float error = 0.f;
+            for (int c = 0; c < 4; c++) {
+                const int q = static_cast<int>(std::lround((e[c] - static_cast<float>(p)) / 2.f));
+                candidate.q[c] = static_cast<uint8_t>(std::clamp(q, 0, 127));
+                const float d = static_cast<float>(candidate.value(c)) - e[c];
+                error += d * d;
+            }
+            if (error < bestError) {
+                bestError = error;
+                best = candidate;
+            }
+        }
+        return best;
+    }
+
+    int bc7_interpolate(int e0, int e1, int index) {
+        return ((64 - BC7_WEIGHTS[index]) * e0 + BC7_WEIGHTS[index] * e1 + 32) >> 6;
+    }
+
+    struct Bc7Candidate {
+        Bc7Endpoint e0;
+        Bc7Endpoint e1;
+        uint8_t indices[BLOCK_TEXELS];
+        float error;
+    };
+
+    Bc7Candidate bc7_fit(const BlockSoA &block, const Bc7Endpoint &q0, const Bc7Endpoint &q1) {
+        const float e0[4] = {float(q0.value(0)), float(q0.value(1)), float(q0.value(2)), float(q0.value(3))};
+        const float e1[4] = {float(q1.value(0)), float(q1.value(1)), float(q1.value(2)), float(q1.value(3))};
+
+        float t[BLOCK_TEXELS];
+        interpolation_parameters(block, 4, e0, e1, t);
+
+        Bc7Candidate candidate{q0, q1, {}, 0.f};
+        for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+            // the weights are only nearly uniform, check the neighbours of the rounded guess
+            const int guess = std::clamp(static_cast<int>(std::lround(t[i] * 15.f)), 0, 15);
+            int bestIndex = guess;
+            float bestError = std::numeric_limits<float>::max();
+            for (int index = std::max(guess - 1, 0); index <= std::min(guess + 1, 15); index++) {
+                float error = 0.f;
+                for (int c = 0; c < 4; c++) {
+                    const float d = static_cast<float>(bc7_interpolate(q0.value(c), q1.value(c), index)) -
+                                    block.channel[c][i];
+                    error += d * d;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    bestIndex = index;
+                }
+            }
+            candidate.indices[i] = static_cast<uint8_t>(bestIndex);
+            candidate.error += bestError;
+        }
+        return candidate;
+    }
+
+    // LSB first bit stream over the 128 bits of a block
+    struct BlockBits {
+        uint8_t bytes[16]{};
+        uint32_t position{0};
+
+        void write(uint32_t value, uint32_t count) {
+            for (uint32_t i = 0; i < count; i++, position++) {
+                bytes[position >> 3] |= static_cast<uint8_t>(((value >> i) & 1) << (position & 7));
+            }
+        }
+
+        uint32_t read(uint32_t count) {
+            uint32_t value = 0;
+            for (uint32_t i = 0; i < count; i++, position++) {
+                value |= ((bytes[position >> 3] >> (position & 7)) & 1u) << i;
+            }
+            return value;
+        }
+    };
+
+    void encode_bc7(const uint8_t *rgba, uint8_t *out) {
+        const BlockSoA block = to_soa(rgba);
+
+        float e0[4], e1[4];
+        principal_endpoints(block, 4, e0, e1);
+        Bc7Candidate best = bc7_fit(block, quantize_bc7(e0), quantize_bc7(e1));
+
+        float weights[BLOCK_TEXELS];
+        for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+            weights[i] = static_cast<float>(BC7_WEIGHTS[best.indices[i]]) / 64.f;
+        }
+        if (least_squares_endpoints(block, 4, weights, e0, e1)) {
+            const Bc7Candidate refined = bc7_fit(block, quantize_bc7(e0), quantize_bc7(e1));
+            if (refined.error < best.error) {
+                best = refined;
+            }
+        }
+
+        // the msb of the first index is implied zero, flip the block around when it is set
+        if (best.indices[0] & 8) {
+            std::swap(best.e0, best.e1);
+            for (uint8_t &index: best.indices) {
+                index = static_cast<uint8_t>(15 - index);
+            }
+        }
+
+        BlockBits bits;
+        bits.write(1u << 6, 7);
+        for (int c = 0; c < 4; c++) {
+            bits.write(best.e0.q[c], 7);
+            bits.write(best.e1.q[c], 7);
+        }
+        bits.write(best.e0.p, 1);
+        bits.write(best.e1.p, 1);
+        bits.write(best.indices[0], 3);
+        for (uint32_t i = 1; i < BLOCK_TEXELS; i++) {
+            bits.write(best.indices[i], 4);
+        }
+        assert(bits.position == 128);
+        memcpy(out, bits.bytes, 16);
+    }
+
+    void decode_bc7(const uint8_t *block, uint8_t *rgba) {
+        BlockBits bits;
+        memcpy(bits.bytes, block, 16);
+        if (bits.read(7) != (1u << 6)) {
+            // not mode 6, we never write anything else
+            memset(rgba, 0, BLOCK_TEXELS * 4);
+            return;
+        }
+
+        Bc7Endpoint e0{}, e1{};
+        for (int c = 0; c < 4; c++) {
+            e0.q[c] = static_cast<uint8_t>(bits.read(7));
+            e1.q[c] = static_cast<uint8_t>(bits.read(7));
+        }
+        e0.p = static_cast<uint8_t>(bits.read(1));
+        e1.p = static_cast<uint8_t>(bits.read(1));
+
+        for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+            const int index = static_cast<int>(bits.read(i == 0 ? 3 : 4));
+            for (int c = 0; c < 4; c++) {
+                rgba[i * 4 + c] = static_cast<uint8_t>(bc7_interpolate(e0.value(c), e1.value(c), index));
+            }
+        }
+    }
+
+    // 4x4 texels starting at (x, y), the image edge repeats for blocks that hang over it
+    void gather_block(const uint8_t *rgba, uint32_t width, uint32_t height, uint32_t x, uint32_t y, uint8_t *block) {
+        for (uint32_t row = 0; row < 4; row++) {
+            const uint32_t sy = std::min(y + row, height - 1);
+            for (uint32_t column = 0; column < 4; column++) {
+                const uint32_t sx = std::min(x + column, width - 1);
+                memcpy(block + (row * 4 + column) * 4, rgba + (size_t(sy) * width + sx) * 4, 4);
+            }
+        }
+    }
+
+    void encode_level(const uint8_t *rgba, uint32_t width, uint32_t height, VkFormat format, uint8_t *out,
+                      JobSystem *jobs) {
+        const uint32_t blocksX = (width + 3) / 4;
+        const uint32_t blocksY = (height + 3) / 4;
+        const uint32_t blockSize = blockcompress::block_bytes(format);
+
+        auto encode_rows = [&](size_t begin, size_t end) {
+            uint8_t texels[BLOCK_TEXELS * 4];
+            for (size_t by = begin; by < end; by++) {
+                for (uint32_t bx = 0; bx < blocksX; bx++) {
+                    gather_block(rgba, width, height, bx * 4, static_cast<uint32_t>(by) * 4, texels);
+                    blockcompress::encode_block(format, texels, out + (by * blocksX + bx) * blockSize);
+                }
+            }
+        };
+
+        // a row of a 1k texture is 256 blocks, enough work per job to keep the pool overhead small
+        constexpr size_t ROWS_PER_JOB = 4;
+        if (jobs && blocksY > ROWS_PER_JOB) {
+            jobs->parallel_for(blocksY, ROWS_PER_JOB, encode_rows);
+        } else {
+            encode_rows(0, blocksY);
+        }
+    }
+} // namespace
+
+VkFormat blockcompress::format_for(TextureUsage usage) {
+    switch (usage) {
+        case TextureUsage::Normal:
+            return VK_FORMAT_BC5_UNORM_BLOCK;
+        case TextureUsage::MetalRough:
+            return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+        case TextureUsage::Color:
+        default:
+            return VK_FORMAT_BC7_UNORM_BLOCK;
+    }
+}
+
+bool blockcompress::is_block_compressed(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+            return true;
+        default:
+            return false;
+    }
+}
+
+uint32_t blockcompress::block_bytes(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+            return 8;
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+            return 16;
+        default:
+            return 4;
+    }
+}
+
+uint32_t blockcompress::mip_count(uint32_t width, uint32_t height) {
+    return static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+}
+
+uint64_t blockcompress::level_bytes(VkFormat format, uint32_t width, uint32_t height) {
+    if (!is_block_compressed(format)) {
+        return uint64_t(width) * height * block_bytes(format);
+    }
+    return uint64_t((width + 3) / 4) * ((height + 3) / 4) * block_bytes(format);
+}
+
+uint64_t blockcompress::image_bytes(VkFormat format, uint32_t width, uint32_t height, bool mipmapped) {
+    const uint32_t levels = mipmapped ? mip_count(width, height) : 1;
+    uint64_t bytes = 0;
+    for (uint32_t level = 0; level < levels; level++) {
+        bytes += level_bytes(format, std::max(width >> level, 1u), std::max(height >> level, 1u));
+    }
+    return bytes;
+}
+
+void blockcompress::encode_block(VkFormat format, const uint8_t *rgba, uint8_t *block) {
+    switch (format) {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            encode_bc1(rgba, block);
+            break;
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+            encode_bc4(rgba, 0, block);
+            break;
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+            encode_bc4(rgba, 0, block);
+            encode_bc4(rgba, 1, block + 8);
+            break;
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+            encode_bc7(rgba, block);
+            break;
+        default:
+            assert(false && "not a block compressed format");
+            break;
+    }
+}
+
+void blockcompress::decode_block(VkFormat format, const uint8_t *block, uint8_t *rgba) {
+    switch (format) {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            decode_bc1(block, rgba);
+            // the RGB variant ignores the transparent code
+            for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+                rgba[i * 4 + 3] = 255;
+            }
+            break;
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+            decode_bc4(block, rgba, 0);
+            for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+                rgba[i * 4 + 1] = rgba[i * 4 + 2] = 0;
+                rgba[i * 4 + 3] = 255;
+            }
+            break;
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+            decode_bc4(block, rgba, 0);
+            decode_bc4(block + 8, rgba, 1);
+            for (uint32_t i = 0; i < BLOCK_TEXELS; i++) {
+                rgba[i * 4 + 2] = 0;
+                rgba[i * 4 + 3] = 255;
+            }
+            break;
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+            decode_bc7(block, rgba);
+            break;
+        default:
+            assert(false && "not a block compressed format");
+            break;
+    }
+}
+
+MipChain blockcompress::allocate(VkFormat format, uint32_t width, uint32_t height, bool mipmapped) {
+    MipChain chain;
+    chain.format = format;
+
+    const uint32_t levels = mipmapped ? mip_count(width, height) : 1;
+    uint64_t offset = 0;
+    for (uint32_t level = 0; level < levels; level++) {
+        MipLevel mip{};
+        mip.width = std::max(width >> level, 1u);
+        mip.height = std::max(height >> level, 1u);
+        mip.offset = offset;
+        mip.size = level_bytes(format, mip.width, mip.height);
+        offset += mip.size;
+        chain.levels.push_back(mip);
+    }
+    chain.data.resize(offset);
+    return chain;
+}
+
+MipChain blockcompress::compress(const MipChainView &rgba, VkFormat format, JobSystem *jobs) {
+    assert(rgba.format == VK_FORMAT_R8G8B8A8_UNORM);
+    const MipLevel &base = rgba.levels[0];
+    MipChain chain = allocate(format, base.width, base.height, rgba.levels.size() > 1);
+
+    for (size_t level = 0; level < chain.levels.size(); level++) {
+        const MipLevel &mip = chain.levels[level];
+        const uint8_t *texels = rgba.data.data() + rgba.levels[level].offset;
+        uint8_t *out = chain.data.data() + mip.offset;
+        if (is_block_compressed(format)) {
+            encode_level(texels, mip.width, mip.height, format, out, jobs);
+        } else {
+            memcpy(out, texels, mip.size);
+        }
+    }
+    return chain;
+}
+
+MipChain blockcompress::compress(const uint8_t *rgba, uint32_t width, uint32_t height, VkFormat format,
+                                 bool mipmapped, JobSystem *jobs) {
+    if (mipmapped) {
+        mipgen::MipSettings settings;
+        settings.filter = mipgen::MipFilter::Box;
+        const MipChain levels = mipgen::generate(rgba, width, height, settings, jobs);
+        return compress(levels.view(), format, jobs);
+    }
+
+    const MipLevel base{width, height, 0, level_bytes(VK_FORMAT_R8G8B8A8_UNORM, width, height)};
+    const MipChainView level{VK_FORMAT_R8G8B8A8_UNORM, {&base, 1}, {rgba, base.size}};
+    return compress(level, format, jobs);
+}
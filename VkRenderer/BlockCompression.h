@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+class JobSystem;
+
+// one level of a mip chain, `offset` and `size` locate its blocks inside the chain's data
+struct MipLevel {
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;
+    uint64_t size;
+};
+static_assert(sizeof(MipLevel) == 24);
+
+// non-owning view of a full mip chain, level 0 first, every level tightly packed in `format`
+struct MipChainView {
+    VkFormat format;
+    std::span<const MipLevel> levels;
+    std::span<const uint8_t> data;
+};
+
+struct MipChain {
+    VkFormat format{VK_FORMAT_UNDEFINED};
+    std::vector<MipLevel> levels;
+    std::vector<uint8_t> data;
+
+    [[nodiscard]] MipChainView view() const { return {format, levels, data}; }
+};
+
+// CPU block compression of glTF textures into the BC formats every desktop GPU samples natively.
+// Blocks are 4x4 texels, levels whose size is not a multiple of 4 are padded by repeating the edge texels.
+namespace blockcompress {
+
+    // what the material samples the texture as, picks the format it is compressed to
+    enum class TextureUsage : uint32_t {
+        Color, // base color, emissive and anything sampled as plain RGBA: BC7
+        Normal, // tangent space normal map, only xy are kept and the shader rebuilds z: BC5
+        MetalRough, // glTF metallic (b) and roughness (g): BC1
+    };
+
+    VkFormat format_for(TextureUsage usage);
+
+    // true for the BC formats below, false for R8G8B8A8 and everything else
+    bool is_block_compressed(VkFormat format);
+
+    // bytes of one 4x4 block, or of one texel for uncompressed RGBA8
+    uint32_t block_bytes(VkFormat format);
+
+    // levels of a full chain down to 1x1, the same count vkutil::create_image allocates
+    uint32_t mip_count(uint32_t width, uint32_t height);
+
+    uint64_t level_bytes(VkFormat format, uint32_t width, uint32_t height);
+
+    // GPU footprint of the image, with or without its full mip chain. also valid for R8G8B8A8
+    uint64_t image_bytes(VkFormat format, uint32_t width, uint32_t height, bool mipmapped);
+
+    // encodes one block of 16 RGBA8 texels in row order into block_bytes(format) bytes
+    void encode_block(VkFormat format, const uint8_t *rgba, uint8_t *block);
+
+    // decodes what encode_block produces back into 16 RGBA8 texels. BC7 only understands mode 6, the only
+    // mode the encoder writes. used by the tests and the quality numbers of the benchmark
+    void decode_block(VkFormat format, const uint8_t *block, uint8_t *rgba);
+
+    // chain with every level laid out back to back and its data sized, but not filled
+    MipChain allocate(VkFormat format, uint32_t width, uint32_t height, bool mipmapped);
+
+    // compresses every level of an R8G8B8A8 chain, e.g. one built by mipgen::generate. rows of blocks are
+    // spread over `jobs` when given, which is safe from inside a job
+    MipChain compress(const MipChainView &rgba, VkFormat format, JobSystem *jobs = nullptr);
+
+    // box filters `rgba` down to 1x1 with mipgen and compresses every level
+    MipChain compress(const uint8_t *rgba, uint32_t width, uint32_t height, VkFormat format, bool mipmapped,
+                      JobSystem *jobs = nullptr);
+
+} // namespace blockcompress
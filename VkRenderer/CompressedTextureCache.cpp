@@ -0,0 +1,140 @@
+#include "CompressedTextureCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <utility>
+#include <vk_utils.h>
+
+namespace {
+    constexpr char TEXTURE_CACHE_MAGIC[4] = {'E', 'R', 'T', 'C'};
+    constexpr uint64_t DATA_ALIGNMENT = 16;
+} // namespace
+
+CompressedTextureCache::CompressedTextureCache(CompressedTextureCache &&other) noexcept :
+    _file(std::move(other._file)), _header(std::exchange(other._header, nullptr)) {}
+
+CompressedTextureCache &CompressedTextureCache::operator=(CompressedTextureCache &&other) noexcept {
+    if (this != &other) {
+        _file = std::move(other._file);
+        _header = std::exchange(other._header, nullptr);
+    }
+    return *this;
+}
+
+std::filesystem::path CompressedTextureCache::path_for(const std::filesystem::path &cacheDirectory, uint64_t key) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.texcache", static_cast<unsigned long long>(key));
+    return cacheDirectory / name;
+}
+
+bool CompressedTextureCache::write(const std::filesystem::path &path, uint64_t key, const MipChainView &chain) {
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    // several decode jobs may write the same texture at once, each gets a temporary file of its own
+    std::filesystem::path tmpPath = path;
+    tmpPath += std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".tmp";
+
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            spdlog::warn("Texture cache: could not create {}", tmpPath.string());
+            return false;
+        }
+
+        CompressedTextureHeader header{};
+        memcpy(header.magic, TEXTURE_CACHE_MAGIC, sizeof(header.magic));
+        header.version = COMPRESSED_TEXTURE_CACHE_VERSION;
+        header.key = key;
+        header.format = static_cast<uint32_t>(chain.format);
+        header.levelCount = static_cast<uint32_t>(chain.levels.size());
+        header.dataOffset = align_up(sizeof(CompressedTextureHeader) + chain.levels.size_bytes(), DATA_ALIGNMENT);
+        header.dataSize = chain.data.size();
+
+        static constexpr char zeros[DATA_ALIGNMENT] = {};
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(chain.levels.data()),
+                  static_cast<std::streamsize>(chain.levels.size_bytes()));
+        out.write(zeros, static_cast<std::streamsize>(header.dataOffset - sizeof(header) - chain.levels.size_bytes()));
+        out.write(reinterpret_cast<const char *>(chain.data.data()), static_cast<std::streamsize>(chain.data.size()));
+
+        if (!out) {
+            spdlog::warn("Texture cache: failed writing {}", tmpPath.string());
+            out.close();
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        spdlog::warn("Texture cache: could not move {} into place: {}", path.string(), ec.message());
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+
+bool CompressedTextureCache::open(const std::filesystem::path &path, uint64_t key, VkFormat format) {
+    close();
+
+    if (!_file.open(path)) {
+        return false;
+    }
+
+    const size_t fileSize = _file.size();
+    if (fileSize < sizeof(CompressedTextureHeader)) {
+        close();
+        return false;
+    }
+
+    const auto *header = reinterpret_cast<const CompressedTextureHeader *>(_file.data());
+    if (memcmp(header->magic, TEXTURE_CACHE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != COMPRESSED_TEXTURE_CACHE_VERSION || header->key != key ||
+        header->format != static_cast<uint32_t>(format)) {
+        spdlog::info("Texture cache: {} is stale, ignoring it", path.string());
+        close();
+        return false;
+    }
+
+    const uint64_t tableEnd = sizeof(CompressedTextureHeader) + uint64_t(header->levelCount) * sizeof(MipLevel);
+    if (header->levelCount == 0 || tableEnd > header->dataOffset || header->dataOffset % DATA_ALIGNMENT != 0 ||
+        header->dataOffset > fileSize || header->dataSize > fileSize - header->dataOffset) {
+        spdlog::warn("Texture cache: {} is truncated or corrupt", path.string());
+        close();
+        return false;
+    }
+
+    const auto *levels = reinterpret_cast<const MipLevel *>(_file.data() + sizeof(CompressedTextureHeader));
+    for (uint32_t i = 0; i < header->levelCount; i++) {
+        const MipLevel &level = levels[i];
+        if (level.offset > header->dataSize || level.size > header->dataSize - level.offset ||
+            level.size != blockcompress::level_bytes(format, level.width, level.height)) {
+            spdlog::warn("Texture cache: {} is truncated or corrupt", path.string());
+            close();
+            return false;
+        }
+    }
+
+    _header = header;
+    return true;
+}
+
+void CompressedTextureCache::close() {
+    _header = nullptr;
+    _file.close();
+}
+
+MipChainView CompressedTextureCache::view() const {
+    const uint8_t *base = _file.data();
+
+    MipChainView view;
+    view.format = static_cast<VkFormat>(_header->format);
+    view.levels = {reinterpret_cast<const MipLevel *>(base + sizeof(CompressedTextureHeader)), _header->levelCount};
+    view.data = {base + _header->dataOffset, _header->dataSize};
+    return view;
+}
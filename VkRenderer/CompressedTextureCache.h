@@ -0,0 +1,52 @@
+#pragma once
+
+#include <BlockCompression.h>
+#include <MappedFile.h>
+#include <filesystem>
+
+// On-disk cache of block compressed mip chains, one file per texture keyed by its TextureCache key, so only
+// the first load of a texture pays for the encoder.
+//
+// Layout (all offsets from the start of the file, the data 16 byte aligned):
+//   CompressedTextureHeader
+//   MipLevel[levelCount], offsets relative to the start of the data
+//   blocks of every level, level 0 first
+//
+// Warm loads map the file and copy the levels straight into staging memory. Changes to the encoder output
+// must bump COMPRESSED_TEXTURE_CACHE_VERSION.
+constexpr uint32_t COMPRESSED_TEXTURE_CACHE_VERSION = 2;
+
+struct CompressedTextureHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t format; // VkFormat
+    uint32_t levelCount;
+    uint64_t dataOffset;
+    uint64_t dataSize;
+};
+
+class CompressedTextureCache {
+public:
+    CompressedTextureCache() = default;
+    // movable so decode jobs can hand an open cache over to the upload stage
+    CompressedTextureCache(CompressedTextureCache &&other) noexcept;
+    CompressedTextureCache &operator=(CompressedTextureCache &&other) noexcept;
+
+    static std::filesystem::path path_for(const std::filesystem::path &cacheDirectory, uint64_t key);
+
+    // writes to a temporary file first and renames it, so a crash never leaves a half written cache behind
+    static bool write(const std::filesystem::path &path, uint64_t key, const MipChainView &chain);
+
+    // maps the file and validates magic, version, key, format and the bounds of every level
+    bool open(const std::filesystem::path &path, uint64_t key, VkFormat format);
+    void close();
+
+    [[nodiscard]] bool is_open() const { return _header != nullptr; }
+    // valid while the cache stays open
+    [[nodiscard]] MipChainView view() const;
+
+private:
+    MappedFile _file;
+    const CompressedTextureHeader *_header = nullptr;
+};
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 64 bit content hash (XXH64) used to key on-disk caches by the bytes of the source asset.
+// hash_combine chains several hashes, e.g. a glTF file followed by its external buffers.
+uint64_t hash_bytes(const void *data, size_t size, uint64_t seed = 0);
+
+inline uint64_t hash_combine(uint64_t seed, uint64_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
@@ -0,0 +1,87 @@
+#include "DrawSort.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+namespace drawsort {
+
+    namespace {
+
+        uint64_t field(uint32_t value, uint32_t bits, uint32_t shift) {
+            const uint32_t max = (1u << bits) - 1;
+            return static_cast<uint64_t>(std::min(value, max)) << shift;
+        }
+
+    } // namespace
+
+    uint64_t state_key(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t indexBinding) {
+        uint32_t shift = 64;
+        uint64_t key = field(pass, PASS_BITS, shift -= PASS_BITS);
+        key |= field(pipeline, PIPELINE_BITS, shift -= PIPELINE_BITS);
+        key |= field(material, MATERIAL_BITS, shift -= MATERIAL_BITS);
+        key |= field(indexBinding, INDEX_BINDING_BITS, shift -= INDEX_BINDING_BITS);
+        return key;
+    }
+
+    uint64_t depth_key(float depth) {
+        constexpr float max = static_cast<float>((1u << DEPTH_BITS) - 1);
+        // NaN fails both comparisons and lands at the far end
+        const float clamped = depth >= 0.f ? std::min(depth, 1.f) : (depth < 0.f ? 0.f : 1.f);
+        return static_cast<uint64_t>(clamped * max);
+    }
+
+    void radix_sort(std::span<uint64_t> keys, std::span<uint32_t> values, std::vector<uint64_t> &keyScratch,
+                    std::vector<uint32_t> &valueScratch) {
+        assert(keys.size() == values.size());
+        const size_t count = keys.size();
+        if (count < 2) {
+            return;
+        }
+
+        // one read of the keys counts all 8 digits
+        std::array<std::array<uint32_t, 256>, 8> histograms{};
+        for (const uint64_t key: keys) {
+            for (uint32_t digit = 0; digit < 8; digit++) {
+                histograms[digit][(key >> (digit * 8)) & 0xff]++;
+            }
+        }
+
+        keyScratch.resize(count);
+        valueScratch.resize(count);
+        std::span<uint64_t> srcKeys = keys;
+        std::span<uint32_t> srcValues = values;
+        std::span<uint64_t> dstKeys = keyScratch;
+        std::span<uint32_t> dstValues = valueScratch;
+
+        for (uint32_t digit = 0; digit < 8; digit++) {
+            std::array<uint32_t, 256> &histogram = histograms[digit];
+            // the high bytes of the pass and pipeline fields are mostly the same in every key
+            const uint32_t shift = digit * 8;
+            if (histogram[(srcKeys[0] >> shift) & 0xff] == count) {
+                continue;
+            }
+
+            uint32_t offset = 0;
+            for (uint32_t &bucket: histogram) {
+                const uint32_t size = bucket;
+                bucket = offset;
+                offset += size;
+            }
+            for (size_t i = 0; i < count; i++) {
+                const uint32_t slot = histogram[(srcKeys[i] >> shift) & 0xff]++;
+                dstKeys[slot] = srcKeys[i];
+                dstValues[slot] = srcValues[i];
+            }
+            std::swap(srcKeys, dstKeys);
+            std::swap(srcValues, dstValues);
+        }
+
+        // an odd number of scatters left the result in the scratch
+        if (srcKeys.data() != keys.data()) {
+            std::copy(srcKeys.begin(), srcKeys.end(), keys.begin());
+            std::copy(srcValues.begin(), srcValues.end(), values.begin());
+        }
+    }
+
+} // namespace drawsort
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Ordering of the draws of a pass by one packed 64 bit key per draw. From the most significant bits down the key
+// holds the material pass, the pipeline, the material, the index buffer binding and the quantized depth, so
+// sorting the keys groups the state changes the passes care about most and draws front to back within a group.
+// Meshes share arena blocks, the binding is the block together with the index type a surface was packed as.
+namespace drawsort {
+
+    constexpr uint32_t PASS_BITS = 4;
+    constexpr uint32_t PIPELINE_BITS = 8;
+    constexpr uint32_t MATERIAL_BITS = 16;
+    constexpr uint32_t INDEX_BINDING_BITS = 16;
+    constexpr uint32_t DEPTH_BITS = 20;
+    static_assert(PASS_BITS + PIPELINE_BITS + MATERIAL_BITS + INDEX_BINDING_BITS + DEPTH_BITS == 64);
+
+    // everything but the depth, built once per surface when the draw lists are built. ids past what their field
+    // holds are clamped, those draws then only lose their grouping, not their place in the list
+    uint64_t state_key(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t indexBinding);
+
+    // `depth` in [0, 1], 0 nearest, clamped
+    uint64_t depth_key(float depth);
+
+    // sorts `keys` and moves `values` along, equal keys keep their order. LSD radix sort over the 8 bytes of the
+    // key, bytes all keys share are skipped. The scratch vectors are grown as needed and can be reused across calls
+    void radix_sort(std::span<uint64_t> keys, std::span<uint32_t> values, std::vector<uint64_t> &keyScratch,
+                    std::vector<uint32_t> &valueScratch);
+
+} // namespace drawsort
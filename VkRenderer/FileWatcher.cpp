@@ -0,0 +1,51 @@
+#include "FileWatcher.h"
+
+#include <algorithm>
+
+void FileWatcher::watch(std::vector<std::filesystem::path> files) {
+    _files = std::move(files);
+    _stamps = stamps();
+    _pending.clear();
+}
+
+void FileWatcher::clear() {
+    _files.clear();
+    _stamps.clear();
+    _pending.clear();
+}
+
+bool FileWatcher::poll(Clock::time_point now) {
+    if (_files.empty() || now - _lastPoll < _interval) {
+        return false;
+    }
+    _lastPoll = now;
+
+    std::vector<Stamp> current = stamps();
+    if (current == _stamps) {
+        // nothing changed, or a change was undone before it settled
+        _pending.clear();
+        return false;
+    }
+    if (current != _pending || !std::ranges::all_of(current, &Stamp::exists)) {
+        // still being written, or replaced through a delete and rename
+        _pending = std::move(current);
+        return false;
+    }
+    _stamps = std::move(current);
+    _pending.clear();
+    return true;
+}
+
+std::vector<FileWatcher::Stamp> FileWatcher::stamps() const {
+    std::vector<Stamp> result(_files.size());
+    for (size_t i = 0; i < _files.size(); i++) {
+        std::error_code error;
+        const std::filesystem::file_time_type time = std::filesystem::last_write_time(_files[i], error);
+        if (error) {
+            continue;
+        }
+        const uintmax_t size = std::filesystem::file_size(_files[i], error);
+        result[i] = error ? Stamp{} : Stamp{time, size, true};
+    }
+    return result;
+}
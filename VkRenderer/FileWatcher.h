@@ -0,0 +1,44 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// Polls the modification time and size of a set of files, e.g. a glTF and the buffers and images it references.
+// A change is only reported once every file exists and has kept its new stamp for a whole poll interval, so an
+// exporter that writes the .gltf and its .bin one after the other is picked up once, after it is done.
+class FileWatcher {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FileWatcher(Clock::duration interval = std::chrono::milliseconds(250)) : _interval(interval) {}
+
+    // replaces the watched files, their current stamps are the baseline
+    void watch(std::vector<std::filesystem::path> files);
+    void clear();
+
+    [[nodiscard]] const std::vector<std::filesystem::path> &files() const { return _files; }
+
+    // stats the files at most once per interval, true once for every change that settled
+    bool poll(Clock::time_point now);
+
+private:
+    struct Stamp {
+        std::filesystem::file_time_type time{};
+        uintmax_t size{0};
+        bool exists{false};
+
+        bool operator==(const Stamp &) const = default;
+    };
+
+    [[nodiscard]] std::vector<Stamp> stamps() const;
+
+    Clock::duration _interval;
+    Clock::time_point _lastPoll{};
+    std::vector<std::filesystem::path> _files;
+    // what the last reported change, or watch(), left the files at
+    std::vector<Stamp> _stamps;
+    // a change seen on the previous poll, waiting to settle
+    std::vector<Stamp> _pending;
+};
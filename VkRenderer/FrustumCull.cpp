@@ -0,0 +1,163 @@
+#include "FrustumCull.h"
+
+#include <Simd.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace frustumcull {
+
+    namespace {
+
+        glm::vec4 matrix_row(const glm::mat4 &m, int row) { return {m[0][row], m[1][row], m[2][row], m[3][row]}; }
+
+        glm::vec4 normalize_plane(const glm::vec4 &plane) {
+            const float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+            if (length < 1e-20f) {
+                // no normal left, the plane sits at infinity
+                return {0.f, 0.f, 0.f, 1.f};
+            }
+            return {plane.x / length, plane.y / length, plane.z / length, plane.w / length};
+        }
+
+        size_t padded(size_t count) { return (count + simd::LANES - 1) / simd::LANES * simd::LANES; }
+
+    } // namespace
+
+    Frustum extract_frustum(const glm::mat4 &viewproj) {
+        const glm::vec4 x = matrix_row(viewproj, 0);
+        const glm::vec4 y = matrix_row(viewproj, 1);
+        const glm::vec4 z = matrix_row(viewproj, 2);
+        const glm::vec4 w = matrix_row(viewproj, 3);
+
+        Frustum frustum{};
+        frustum.planes[0] = normalize_plane(w + x); // -w <= x
+        frustum.planes[1] = normalize_plane(w - x); // x <= w
+        frustum.planes[2] = normalize_plane(w + y); // -w <= y
+        frustum.planes[3] = normalize_plane(w - y); // y <= w
+        frustum.planes[4] = normalize_plane(z); // 0 <= z
+        frustum.planes[5] = normalize_plane(w - z); // z <= w
+        return frustum;
+    }
+
+    void BoundsSoA::resize(size_t surfaceCount) {
+        count = surfaceCount;
+        const size_t size = padded(surfaceCount);
+        for (std::vector<float> *array: {&centerX, &centerY, &centerZ, &radius, &extentX, &extentY, &extentZ}) {
+            array->resize(size);
+        }
+    }
+
+    void BoundsSoA::set(size_t index, const Bounds &local, const glm::mat4 &transform) {
+        const glm::vec4 center = transform * glm::vec4(local.origin, 1.f);
+        centerX[index] = center.x;
+        centerY[index] = center.y;
+        centerZ[index] = center.z;
+
+        float scale = 0.f;
+        glm::vec3 extents(0.f);
+        for (int column = 0; column < 3; column++) {
+            const glm::vec3 axis(transform[column]);
+            scale = std::max(scale, glm::length(axis));
+            // the box around the rotated box spans |axis| * extent along each world axis
+            extents = extents + glm::abs(axis) * local.extents[column];
+        }
+        radius[index] = local.sphereRadius * scale;
+        extentX[index] = extents.x;
+        extentY[index] = extents.y;
+        extentZ[index] = extents.z;
+    }
+
+    void cull(const BoundsSoA &bounds, const Frustum &frustum, std::span<uint64_t> visible) {
+        static_assert(64 % simd::LANES == 0, "a batch of lanes must not straddle two mask words");
+
+        std::fill_n(visible.begin(), mask_words(bounds.count), uint64_t{0});
+
+        struct PlaneLanes {
+            simd::vfloat nx, ny, nz, w;
+            simd::vfloat ax, ay, az;
+        };
+        std::array<PlaneLanes, 6> planes{};
+        for (size_t p = 0; p < planes.size(); p++) {
+            const glm::vec4 &plane = frustum.planes[p];
+            planes[p].nx = simd::set1(plane.x);
+            planes[p].ny = simd::set1(plane.y);
+            planes[p].nz = simd::set1(plane.z);
+            planes[p].w = simd::set1(plane.w);
+            planes[p].ax = simd::set1(std::fabs(plane.x));
+            planes[p].ay = simd::set1(std::fabs(plane.y));
+            planes[p].az = simd::set1(std::fabs(plane.z));
+        }
+        const simd::vfloat zero = simd::set1(0.f);
+        constexpr uint64_t allLanes = (uint64_t{1} << simd::LANES) - 1;
+
+        for (size_t i = 0; i < bounds.count; i += simd::LANES) {
+            const simd::vfloat cx = simd::loadu(&bounds.centerX[i]);
+            const simd::vfloat cy = simd::loadu(&bounds.centerY[i]);
+            const simd::vfloat cz = simd::loadu(&bounds.centerZ[i]);
+            const simd::vfloat r = simd::loadu(&bounds.radius[i]);
+            const simd::vfloat ex = simd::loadu(&bounds.extentX[i]);
+            const simd::vfloat ey = simd::loadu(&bounds.extentY[i]);
+            const simd::vfloat ez = simd::loadu(&bounds.extentZ[i]);
+
+            int outside = 0;
+            for (const PlaneLanes &plane: planes) {
+                const simd::vfloat distance = simd::add(
+                    simd::add(simd::mul(plane.nx, cx), simd::mul(plane.ny, cy)),
+                    simd::add(simd::mul(plane.nz, cz), plane.w));
+                // how far the box reaches towards the plane, the tighter of box and sphere decides
+                const simd::vfloat boxReach = simd::add(simd::add(simd::mul(plane.ax, ex), simd::mul(plane.ay, ey)),
+                                                        simd::mul(plane.az, ez));
+                outside |= simd::mask_lt(simd::add(distance, simd::min(r, boxReach)), zero);
+            }
+
+            uint64_t lanes = ~static_cast<uint64_t>(outside) & allLanes;
+            if (bounds.count - i < simd::LANES) {
+                lanes &= (uint64_t{1} << (bounds.count - i)) - 1;
+            }
+            visible[i / 64] |= lanes << (i % 64);
+        }
+    }
+
+    void cull_scalar(const BoundsSoA &bounds, const Frustum &frustum, std::span<uint64_t> visible) {
+        std::fill_n(visible.begin(), mask_words(bounds.count), uint64_t{0});
+
+        for (size_t i = 0; i < bounds.count; i++) {
+            bool inside = true;
+            for (const glm::vec4 &plane: frustum.planes) {
+                const float distance = plane.x * bounds.centerX[i] + plane.y * bounds.centerY[i] +
+                                       (plane.z * bounds.centerZ[i] + plane.w);
+                const float boxReach = std::fabs(plane.x) * bounds.extentX[i] +
+                                       std::fabs(plane.y) * bounds.extentY[i] + std::fabs(plane.z) * bounds.extentZ[i];
+                if (distance + std::min(bounds.radius[i], boxReach) < 0.f) {
+                    inside = false;
+                    break;
+                }
+            }
+            if (inside) {
+                visible[i / 64] |= uint64_t{1} << (i % 64);
+            }
+        }
+    }
+
+    void append_visible(std::span<const uint64_t> visible, size_t first, size_t count,
+                        std::vector<uint32_t> &indices) {
+        const size_t end = first + count;
+        for (size_t word = first / 64; word < mask_words(end); word++) {
+            uint64_t bits = visible[word];
+            // drop the bits before first and from end on
+            if (word == first / 64) {
+                bits &= ~uint64_t{0} << (first % 64);
+            }
+            if (word == end / 64) {
+                bits &= (uint64_t{1} << (end % 64)) - 1;
+            }
+            while (bits != 0) {
+                const size_t i = word * 64 + static_cast<size_t>(std::countr_zero(bits));
+                indices.push_back(static_cast<uint32_t>(i - first));
+                bits &= bits - 1;
+            }
+        }
+    }
+
+} // namespace frustumcull
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <MeshGeometry.h>
+#include <array>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include <span>
+#include <vector>
+
+// CPU frustum culling of whole surfaces. The world space bounds live in structure of arrays form so the kernel
+// tests simd::LANES surfaces per iteration against the 6 planes, the result is one visibility bit per surface.
+namespace frustumcull {
+
+    // inward facing planes, xyz the unit normal and w the offset: p is inside when dot(xyz, p) + w >= 0
+    struct Frustum {
+        std::array<glm::vec4, 6> planes;
+    };
+
+    // Gribb-Hartmann extraction for Vulkan clip space (0 <= z <= w), reversed Z and orthographic matrices
+    // included. A plane at infinity, the far plane of an infinite projection, never rejects anything.
+    Frustum extract_frustum(const glm::mat4 &viewproj);
+
+    // world space bounding spheres and boxes, both centered on the surface's Bounds::origin.
+    // The arrays are padded to a whole number of simd lanes, the padding is never reported visible.
+    struct BoundsSoA {
+        std::vector<float> centerX, centerY, centerZ;
+        std::vector<float> radius;
+        std::vector<float> extentX, extentY, extentZ;
+        size_t count{0};
+
+        void resize(size_t surfaceCount);
+        // moves the local space bounds of a surface to world space, the box stays axis aligned around the
+        // transformed one and the sphere grows with the largest axis scale
+        void set(size_t index, const Bounds &local, const glm::mat4 &transform);
+    };
+
+    // 64 bit words of a visibility mask covering `count` surfaces
+    constexpr size_t mask_words(size_t count) { return (count + 63) / 64; }
+
+    // bit i of `visible` is set when neither the sphere nor the box of surface i lies fully behind a plane.
+    // `visible` holds at least mask_words(bounds.count) words, bits past bounds.count are cleared.
+    void cull(const BoundsSoA &bounds, const Frustum &frustum, std::span<uint64_t> visible);
+
+    // one surface at a time reference of cull, for tests and benchmarks
+    void cull_scalar(const BoundsSoA &bounds, const Frustum &frustum, std::span<uint64_t> visible);
+
+    // appends i - first for every set bit i in [first, first + count), the index lists the passes draw from
+    void append_visible(std::span<const uint64_t> visible, size_t first, size_t count,
+                        std::vector<uint32_t> &indices);
+
+} // namespace frustumcull
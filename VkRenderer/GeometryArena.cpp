@@ -0,0 +1,151 @@
+#include "GeometryArena.h"
+
+#include <algorithm>
+#include <spdlog/spdlog.h>
+#include <vk_buffers.h>
+#include "vk_engine.h"
+
+void GeometryArena::init(VulkanEngine *engine) {
+    _engine = engine;
+
+    constexpr VkBufferUsageFlags sharedUsage = VK_BUFFER_USAGE_TRANSFER_DST_BIT |
+                                               VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
+                                               VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+
+    _vertices = Pool{.blocks = {},
+                     .blockSize = VERTEX_BLOCK_SIZE,
+                     .alignment = VERTEX_ALIGNMENT,
+                     .usage = sharedUsage | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                     .name = "Geometry Arena Vertices"};
+    _indices = Pool{.blocks = {},
+                    .blockSize = INDEX_BLOCK_SIZE,
+                    .alignment = INDEX_ALIGNMENT,
+                    .usage = sharedUsage | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                    .name = "Geometry Arena Indices"};
+    _meshlets = Pool{.blocks = {},
+                     .blockSize = MESHLET_BLOCK_SIZE,
+                     .alignment = MESHLET_ALIGNMENT,
+                     .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                              VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                     .name = "Geometry Arena Meshlets"};
+
+    // first block of each pool up front, most scenes never need another
+    add_block(_vertices, _vertices.blockSize);
+    add_block(_indices, _indices.blockSize);
+    add_block(_meshlets, _meshlets.blockSize);
+}
+
+void GeometryArena::cleanup() {
+    for (Pool *pool: {&_vertices, &_indices, &_meshlets}) {
+        for (Block &block: pool->blocks) {
+            vkutil::destroy_buffer(_engine, block.buffer);
+        }
+        pool->blocks.clear();
+    }
+}
+
+GPUMeshBuffers GeometryArena::allocate(VkDeviceSize vertexBytes, VkDeviceSize indexBytes,
+                                       VkDeviceSize meshletBytes) {
+    GPUMeshBuffers mesh{};
+    mesh.vertices = allocate_range(_vertices, vertexBytes);
+    mesh.indices = allocate_range(_indices, indexBytes);
+
+    const Block &vertexBlock = _vertices.blocks[mesh.vertices.block];
+    mesh.vertexBuffer = vertexBlock.buffer.buffer;
+    mesh.vertexBufferAddress = vertexBlock.address + mesh.vertices.offset;
+
+    const Block &indexBlock = _indices.blocks[mesh.indices.block];
+    mesh.indexBuffer = indexBlock.buffer.buffer;
+    mesh.indexBufferAddress = indexBlock.address;
+
+    if (meshletBytes > 0) {
+        mesh.meshlets = allocate_range(_meshlets, meshletBytes);
+        const Block &meshletBlock = _meshlets.blocks[mesh.meshlets.block];
+        mesh.meshletBuffer = meshletBlock.buffer.buffer;
+        mesh.meshletBufferAddress = meshletBlock.address + mesh.meshlets.offset;
+    }
+    return mesh;
+}
+
+void GeometryArena::free(GPUMeshBuffers &mesh) {
+    free_range(_vertices, mesh.vertices);
+    free_range(_indices, mesh.indices);
+    free_range(_meshlets, mesh.meshlets);
+    mesh = GPUMeshBuffers{};
+}
+
+GeometryArena::Stats GeometryArena::stats() const {
+    Stats stats{};
+    for (const Pool *pool: {&_vertices, &_indices, &_meshlets}) {
+        for (const Block &block: pool->blocks) {
+            if (block.buffer.buffer == VK_NULL_HANDLE) {
+                continue;
+            }
+            stats.blockCount++;
+            stats.allocationCount += static_cast<uint32_t>(block.allocator.allocation_count());
+            stats.capacity += block.allocator.capacity();
+            stats.used += block.allocator.used();
+        }
+    }
+    return stats;
+}
+
+ArenaRange GeometryArena::allocate_range(Pool &pool, VkDeviceSize size) {
+    for (uint32_t i = 0; i < pool.blocks.size(); i++) {
+        Block &block = pool.blocks[i];
+        if (block.buffer.buffer == VK_NULL_HANDLE) {
+            continue;
+        }
+        const uint64_t offset = block.allocator.allocate(size);
+        if (offset != RangeAllocator::INVALID_OFFSET) {
+            return ArenaRange{i, offset, size};
+        }
+    }
+
+    // nothing fits, grow the pool. meshes larger than a block get a block of their own
+    const VkDeviceSize alignedSize = (size + pool.alignment - 1) / pool.alignment * pool.alignment;
+    const uint32_t index = add_block(pool, std::max({pool.blockSize, alignedSize, pool.alignment}));
+    const uint64_t offset = pool.blocks[index].allocator.allocate(size);
+    return ArenaRange{index, offset, size};
+}
+
+void GeometryArena::free_range(Pool &pool, const ArenaRange &range) {
+    if (range.block >= pool.blocks.size()) {
+        return;
+    }
+
+    Block &block = pool.blocks[range.block];
+    block.allocator.free(range.offset);
+
+    if (range.block != 0 && block.allocator.empty()) {
+        spdlog::info("{}: releasing empty block {} ({:.1f} MB)", pool.name, range.block,
+                     static_cast<double>(block.allocator.capacity()) / (1024.0 * 1024.0));
+        vkutil::destroy_buffer(_engine, block.buffer);
+        block = Block{};
+    }
+}
+
+uint32_t GeometryArena::add_block(Pool &pool, VkDeviceSize size) {
+    Block block;
+    block.buffer = vkutil::create_buffer(_engine, size, pool.usage, VMA_MEMORY_USAGE_GPU_ONLY, pool.name);
+
+    const VkBufferDeviceAddressInfo addressInfo{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+                                                .buffer = block.buffer.buffer};
+    block.address = vkGetBufferDeviceAddress(_engine->_device, &addressInfo);
+    block.allocator = RangeAllocator(size, pool.alignment);
+
+    // reuse a released slot before growing the list
+    const auto slot = std::find_if(pool.blocks.begin(), pool.blocks.end(),
+                                   [](const Block &b) { return b.buffer.buffer == VK_NULL_HANDLE; });
+    uint32_t index;
+    if (slot != pool.blocks.end()) {
+        index = static_cast<uint32_t>(slot - pool.blocks.begin());
+        *slot = std::move(block);
+    } else {
+        index = static_cast<uint32_t>(pool.blocks.size());
+        pool.blocks.push_back(std::move(block));
+    }
+
+    spdlog::info("{}: added block {} ({:.1f} MB)", pool.name, index, static_cast<double>(size) / (1024.0 * 1024.0));
+    return index;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <RangeAllocator.h>
+#include <vector>
+#include <vk_types.h>
+
+class VulkanEngine;
+
+// Device local megabuffers every mesh is suballocated from, one pool each for vertices, indices and meshlets.
+// A pool grows by a whole block when no existing block has room, so a scene ends up with a handful of
+// buffers instead of two per mesh and draws rarely need to rebind the index buffer.
+class GeometryArena {
+public:
+    static constexpr VkDeviceSize VERTEX_BLOCK_SIZE = 128ull * 1024 * 1024;
+    static constexpr VkDeviceSize INDEX_BLOCK_SIZE = 64ull * 1024 * 1024;
+    static constexpr VkDeviceSize MESHLET_BLOCK_SIZE = 16ull * 1024 * 1024;
+    // buffer references in the shaders assume 16 byte aligned vertex addresses
+    static constexpr VkDeviceSize VERTEX_ALIGNMENT = 16;
+    // meshes mix 16 and 32 bit surfaces, 4 bytes keeps the offset a whole index of either type
+    static constexpr VkDeviceSize INDEX_ALIGNMENT = sizeof(uint32_t);
+    static constexpr VkDeviceSize MESHLET_ALIGNMENT = 16;
+
+    void init(VulkanEngine *engine);
+    void cleanup();
+
+    // reserves room for one mesh, the caller copies its data to the returned ranges. meshes without meshlets
+    // get no meshlet range
+    GPUMeshBuffers allocate(VkDeviceSize vertexBytes, VkDeviceSize indexBytes, VkDeviceSize meshletBytes = 0);
+    // returns the mesh's ranges, blocks that end up empty are released (except the first of each pool)
+    void free(GPUMeshBuffers &mesh);
+
+    struct Stats {
+        uint32_t blockCount;
+        uint32_t allocationCount;
+        VkDeviceSize capacity;
+        VkDeviceSize used;
+    };
+    [[nodiscard]] Stats stats() const;
+
+private:
+    struct Block {
+        AllocatedBuffer buffer;
+        VkDeviceAddress address{0};
+        RangeAllocator allocator;
+    };
+
+    struct Pool {
+        std::vector<Block> blocks; // released blocks stay as empty slots so block indices remain valid
+        VkDeviceSize blockSize;
+        VkDeviceSize alignment;
+        VkBufferUsageFlags usage;
+        const char *name;
+    };
+
+    ArenaRange allocate_range(Pool &pool, VkDeviceSize size);
+    void free_range(Pool &pool, const ArenaRange &range);
+    uint32_t add_block(Pool &pool, VkDeviceSize size);
+
+    VulkanEngine *_engine{nullptr};
+    Pool _vertices{};
+    Pool _indices{};
+    Pool _meshlets{};
+};
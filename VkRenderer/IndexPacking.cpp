@@ -0,0 +1,60 @@
+#include "IndexPacking.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+namespace indexpacking {
+
+    SurfaceLayout layout_surface(std::span<const uint32_t> indices, std::span<const Range> ranges,
+                                 uint64_t byteOffset, bool allowNarrow) {
+        assert(byteOffset % 4 == 0);
+        uint32_t lowest = std::numeric_limits<uint32_t>::max();
+        uint32_t highest = 0;
+        uint64_t count = 0;
+        for (const Range &range: ranges) {
+            for (const uint32_t index: indices.subspan(range.first, range.count)) {
+                lowest = std::min(lowest, index);
+                highest = std::max(highest, index);
+            }
+            count += range.count;
+        }
+
+        SurfaceLayout layout{};
+        layout.baseVertex = count > 0 ? lowest : 0;
+        layout.indexSize = allowNarrow && highest - layout.baseVertex <= std::numeric_limits<uint16_t>::max() ? 2 : 4;
+        layout.byteOffset = byteOffset;
+        layout.byteSize = (count * layout.indexSize + 3) & ~uint64_t(3);
+        return layout;
+    }
+
+    uint32_t first_index(const SurfaceLayout &layout, std::span<const Range> ranges, size_t range) {
+        uint64_t first = layout.byteOffset / layout.indexSize;
+        for (size_t r = 0; r < range; r++) {
+            first += ranges[r].count;
+        }
+        return static_cast<uint32_t>(first);
+    }
+
+    void pack_surface(std::span<const uint32_t> indices, std::span<const Range> ranges, const SurfaceLayout &layout,
+                      std::span<std::byte> out) {
+        assert(layout.byteOffset + layout.byteSize <= out.size());
+        std::byte *dst = out.data() + layout.byteOffset;
+        for (const Range &range: ranges) {
+            for (const uint32_t index: indices.subspan(range.first, range.count)) {
+                const uint32_t local = index - layout.baseVertex;
+                if (layout.indexSize == 2) {
+                    const auto narrow = static_cast<uint16_t>(local);
+                    memcpy(dst, &narrow, sizeof(narrow));
+                } else {
+                    memcpy(dst, &local, sizeof(local));
+                }
+                dst += layout.indexSize;
+            }
+        }
+        // the padding of an odd 16 bit block is never read, but staging memory is not zeroed
+        std::fill(dst, out.data() + layout.byteOffset + layout.byteSize, std::byte{0});
+    }
+
+} // namespace indexpacking
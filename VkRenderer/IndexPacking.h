@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Upload layout of a mesh's indices. The loader and the mesh cache keep 32 bit indices into the whole mesh;
+// on the GPU every surface gets a block of its own, rebased on the smallest vertex it references so most fit
+// in 16 bits, and its draws add that vertex back as their vertexOffset.
+namespace indexpacking {
+
+    // index ranges of one surface, its full detail range followed by its LODs, in mesh indices
+    struct Range {
+        uint32_t first;
+        uint32_t count;
+    };
+
+    struct SurfaceLayout {
+        uint32_t indexSize; // 2 or 4 bytes
+        uint32_t baseVertex; // subtracted from every index of the surface
+        uint64_t byteOffset; // start of the block, 4 byte aligned so both index types can bind it
+        uint64_t byteSize; // the ranges back to back, padded to 4 bytes
+    };
+
+    // the layout of a surface whose block starts at `byteOffset`, 16 bit unless `allowNarrow` is off or its
+    // vertices span more than 65536
+    [[nodiscard]] SurfaceLayout layout_surface(std::span<const uint32_t> indices, std::span<const Range> ranges,
+                                               uint64_t byteOffset, bool allowNarrow = true);
+
+    // first index of ranges[range] inside the block, in units of layout.indexSize and relative to the mesh
+    [[nodiscard]] uint32_t first_index(const SurfaceLayout &layout, std::span<const Range> ranges, size_t range);
+
+    // writes the surface's rebased block to `out`, which starts at the mesh's first index byte
+    void pack_surface(std::span<const uint32_t> indices, std::span<const Range> ranges, const SurfaceLayout &layout,
+                      std::span<std::byte> out);
+
+} // namespace indexpacking
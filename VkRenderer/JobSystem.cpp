@@ -0,0 +1,160 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+JobSystem::JobSystem(uint32_t threadCount) {
+    if (threadCount == 0) {
+        const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    _queues.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++) {
+        _queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    _workers.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++) {
+        _workers.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard lock(_sleepMutex);
+        _stop = true;
+    }
+    _sleepCv.notify_all();
+
+    for (auto &worker: _workers) {
+        worker.join();
+    }
+}
+
+void JobSystem::submit(std::function<void()> job) {
+    _pending.fetch_add(1);
+
+    // round robin the initial placement, stealing balances the rest
+    const uint32_t index = _nextQueue.fetch_add(1) % static_cast<uint32_t>(_queues.size());
+    {
+        std::lock_guard lock(_queues[index]->mutex);
+        _queues[index]->jobs.push_back(std::move(job));
+    }
+    _queued.fetch_add(1);
+
+    // take the sleep lock so a worker between its predicate check and wait can't miss the wakeup
+    { std::lock_guard lock(_sleepMutex); }
+    _sleepCv.notify_one();
+}
+
+void JobSystem::wait_idle() {
+    const auto thief = static_cast<uint32_t>(_queues.size());
+
+    while (_pending.load() > 0) {
+        std::function<void()> job;
+        if (try_steal(thief, job)) {
+            job();
+            finish_job();
+            continue;
+        }
+
+        // nothing left to help with, wait for the workers to drain their current jobs
+        std::unique_lock lock(_sleepMutex);
+        _idleCv.wait(lock, [this] { return _pending.load() == 0 || _queued.load() > 0; });
+    }
+}
+
+void JobSystem::parallel_for(size_t count, size_t grainSize,
+                             const std::function<void(size_t begin, size_t end)> &fn) {
+    if (count == 0) {
+        return;
+    }
+
+    grainSize = std::max<size_t>(grainSize, 1);
+    const size_t batches = (count + grainSize - 1) / grainSize;
+    if (batches == 1) {
+        fn(0, count);
+        return;
+    }
+
+    std::atomic<size_t> remaining{batches};
+    for (size_t b = 1; b < batches; b++) {
+        submit([&fn, &remaining, b, grainSize, count] {
+            fn(b * grainSize, std::min(count, (b + 1) * grainSize));
+            remaining.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    // the calling thread takes the first range and then helps with whatever is still queued,
+    // this keeps nested parallel_for calls from a worker deadlock free
+    fn(0, std::min(count, grainSize));
+    remaining.fetch_sub(1, std::memory_order_release);
+
+    const auto thief = static_cast<uint32_t>(_queues.size());
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        std::function<void()> job;
+        if (try_steal(thief, job)) {
+            job();
+            finish_job();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool JobSystem::try_pop(uint32_t queueIndex, std::function<void()> &job) {
+    WorkQueue &queue = *_queues[queueIndex];
+    std::lock_guard lock(queue.mutex);
+    if (queue.jobs.empty()) {
+        return false;
+    }
+    job = std::move(queue.jobs.back());
+    queue.jobs.pop_back();
+    _queued.fetch_sub(1);
+    return true;
+}
+
+bool JobSystem::try_steal(uint32_t thiefIndex, std::function<void()> &job) {
+    const auto queueCount = static_cast<uint32_t>(_queues.size());
+    for (uint32_t i = 1; i <= queueCount; i++) {
+        const uint32_t victim = (thiefIndex + i) % queueCount;
+        if (victim == thiefIndex) {
+            continue;
+        }
+
+        WorkQueue &queue = *_queues[victim];
+        std::lock_guard lock(queue.mutex);
+        if (queue.jobs.empty()) {
+            continue;
+        }
+        job = std::move(queue.jobs.front());
+        queue.jobs.pop_front();
+        _queued.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+void JobSystem::finish_job() {
+    if (_pending.fetch_sub(1) == 1) {
+        { std::lock_guard lock(_sleepMutex); }
+        _idleCv.notify_all();
+    }
+}
+
+void JobSystem::worker_loop(uint32_t index) {
+    while (true) {
+        std::function<void()> job;
+        if (try_pop(index, job) || try_steal(index, job)) {
+            job();
+            finish_job();
+            continue;
+        }
+
+        std::unique_lock lock(_sleepMutex);
+        _sleepCv.wait(lock, [this] { return _stop || _queued.load() > 0; });
+        if (_stop && _queued.load() == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small work-stealing thread pool for the CPU heavy parts of asset loading.
+// Every worker owns a deque: it pops its own jobs from the back and steals from
+// the front of the other workers' deques once it runs dry.
+class JobSystem {
+public:
+    // 0 picks hardware_concurrency - 1 workers, the submitting thread helps while waiting
+    explicit JobSystem(uint32_t threadCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    void submit(std::function<void()> job);
+
+    // blocks until every submitted job has run, the caller executes queued jobs meanwhile
+    void wait_idle();
+
+    // splits [0, count) into ranges of grainSize and runs fn(begin, end) on the pool,
+    // returns once all ranges are done. safe to call from inside a job
+    void parallel_for(size_t count, size_t grainSize, const std::function<void(size_t begin, size_t end)> &fn);
+
+    [[nodiscard]] uint32_t thread_count() const { return static_cast<uint32_t>(_workers.size()); }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> jobs;
+    };
+
+    bool try_pop(uint32_t queueIndex, std::function<void()> &job);
+    bool try_steal(uint32_t thiefIndex, std::function<void()> &job);
+    void finish_job();
+    void worker_loop(uint32_t index);
+
+    std::vector<std::unique_ptr<WorkQueue>> _queues;
+    std::vector<std::thread> _workers;
+
+    std::mutex _sleepMutex;
+    std::condition_variable _sleepCv;
+    std::condition_variable _idleCv;
+
+    std::atomic<uint32_t> _nextQueue{0};
+    std::atomic<size_t> _queued{0};
+    std::atomic<size_t> _pending{0};
+    bool _stop{false};
+};
+
+// Thread safe FIFO used to hand results from pool jobs back to a single consumer
+// (e.g. the upload stage) in the order they complete.
+template<typename T>
+class CompletionQueue {
+public:
+    void push(T &&value) {
+        // notify under the lock, the consumer may destroy the queue as soon as it has the last item
+        std::lock_guard lock(_mutex);
+        _items.push_back(std::move(value));
+        _cv.notify_one();
+    }
+
+    T pop() {
+        std::unique_lock lock(_mutex);
+        _cv.wait(lock, [this] { return !_items.empty(); });
+        T value = std::move(_items.front());
+        _items.pop_front();
+        return value;
+    }
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::deque<T> _items;
+};
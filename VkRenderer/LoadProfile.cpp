@@ -0,0 +1,149 @@
+#include "LoadProfile.h"
+
+#include <algorithm>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+LoadProfile::Phase &LoadProfile::phase(std::string_view name) {
+    const auto it = std::ranges::find(_phases, name, &Phase::name);
+    if (it != _phases.end()) {
+        return *it;
+    }
+    Phase &added = _phases.emplace_back();
+    added.name = name;
+    return added;
+}
+
+void LoadProfile::add_time(std::string_view name, double timeMs, uint64_t peakRssBytes) {
+    std::lock_guard lock(_mutex);
+    Phase &p = phase(name);
+    p.timeMs += timeMs;
+    p.calls++;
+    p.peakRssBytes = std::max(p.peakRssBytes, peakRssBytes);
+}
+
+void LoadProfile::add_bytes(std::string_view name, uint64_t bytes) {
+    std::lock_guard lock(_mutex);
+    phase(name).bytes += bytes;
+}
+
+void LoadProfile::set_counter(std::string_view name, std::string_view counter, uint64_t value) {
+    std::lock_guard lock(_mutex);
+    std::vector<std::pair<std::string, uint64_t>> &counters = phase(name).counters;
+    const auto it = std::ranges::find(counters, counter, &std::pair<std::string, uint64_t>::first);
+    if (it != counters.end()) {
+        it->second = value;
+    } else {
+        counters.emplace_back(counter, value);
+    }
+}
+
+void LoadProfile::add_item(std::string_view name, std::string_view item, double timeMs, uint64_t bytes) {
+    std::lock_guard lock(_mutex);
+    phase(name).items.push_back(Item{std::string(item), timeMs, bytes});
+}
+
+std::vector<LoadProfile::Phase> LoadProfile::phases() const {
+    std::lock_guard lock(_mutex);
+    return _phases;
+}
+
+std::string LoadProfile::to_json(std::string_view scene, double totalMs) const {
+    // ordered, so the report lists phases and their fields in load order and diffs cleanly between runs
+    nlohmann::ordered_json report;
+    report["scene"] = scene;
+    report["totalMs"] = totalMs;
+    report["peakRssBytes"] = peak_rss();
+
+    nlohmann::ordered_json phases = nlohmann::ordered_json::array();
+    for (const Phase &p: this->phases()) {
+        nlohmann::ordered_json entry;
+        entry["name"] = p.name;
+        entry["timeMs"] = p.timeMs;
+        entry["calls"] = p.calls;
+        entry["bytes"] = p.bytes;
+        entry["peakRssBytes"] = p.peakRssBytes;
+        nlohmann::ordered_json counters = nlohmann::ordered_json::object();
+        for (const auto &[counter, value]: p.counters) {
+            counters[counter] = value;
+        }
+        entry["counters"] = std::move(counters);
+        nlohmann::ordered_json items = nlohmann::ordered_json::array();
+        for (const Item &item: p.items) {
+            items.push_back({{"name", item.name}, {"timeMs", item.timeMs}, {"bytes", item.bytes}});
+        }
+        entry["items"] = std::move(items);
+        phases.push_back(std::move(entry));
+    }
+    report["phases"] = std::move(phases);
+    return report.dump(2);
+}
+
+bool LoadProfile::write_json(const std::filesystem::path &path, std::string_view scene, double totalMs) const {
+    std::error_code error;
+    if (path.has_parent_path()) {
+        std::filesystem::create_directories(path.parent_path(), error);
+    }
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << to_json(scene, totalMs) << '\n';
+    return file.good();
+}
+
+std::filesystem::path LoadProfile::report_path(const std::filesystem::path &scene,
+                                               const std::filesystem::path &directory) {
+    const std::filesystem::path name = scene.stem().string() + ".load.json";
+    return directory.empty() ? scene.parent_path() / name : directory / name;
+}
+
+uint64_t LoadProfile::peak_rss() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize;
+#elif defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            return std::stoull(line.substr(6)) * 1024;
+        }
+    }
+    return 0;
+#else
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+bool LoadProfile::reset_peak_rss() {
+#if defined(__linux__)
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+    return clearRefs.good();
+#else
+    return false;
+#endif
+}
+
+ScopedLoadPhase::ScopedLoadPhase(LoadProfile &profile, std::string_view phase) :
+    _profile(profile), _phase(phase) {
+    if (_profile.tracks_memory()) {
+        LoadProfile::reset_peak_rss();
+    }
+    _start = std::chrono::high_resolution_clock::now();
+}
+
+ScopedLoadPhase::~ScopedLoadPhase() {
+    const double timeMs =
+        std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - _start).count();
+    _profile.add_time(_phase, timeMs, _profile.tracks_memory() ? LoadProfile::peak_rss() : 0);
+}
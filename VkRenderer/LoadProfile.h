@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Per phase timers and counters of one scene load, written out as a JSON report so the load times of an asset
+// corpus can be tracked across runs. Phases are keyed by name and accumulate, so one that runs once per texture
+// or mesh, spread over frames or job threads, sums up. Every member is safe to call from any thread.
+class LoadProfile {
+public:
+    // one unit of work inside a phase, e.g. a single image decode
+    struct Item {
+        std::string name;
+        double timeMs{0.0};
+        uint64_t bytes{0};
+    };
+
+    struct Phase {
+        std::string name;
+        double timeMs{0.0}; // summed over every call
+        uint32_t calls{0};
+        uint64_t bytes{0};
+        // highest peak resident set seen as a call ended, 0 where the platform has no counter
+        uint64_t peakRssBytes{0};
+        std::vector<std::pair<std::string, uint64_t>> counters;
+        std::vector<Item> items;
+    };
+
+    // scoped phases read and reset the peak resident set only when this is on, both are a file access on Linux
+    void track_memory(bool enabled) { _trackMemory.store(enabled); }
+    [[nodiscard]] bool tracks_memory() const { return _trackMemory.load(); }
+
+    void add_time(std::string_view phase, double timeMs, uint64_t peakRssBytes = 0);
+    void add_bytes(std::string_view phase, uint64_t bytes);
+    void set_counter(std::string_view phase, std::string_view counter, uint64_t value);
+    void add_item(std::string_view phase, std::string_view item, double timeMs, uint64_t bytes = 0);
+
+    // phases in the order they were first reported
+    [[nodiscard]] std::vector<Phase> phases() const;
+
+    [[nodiscard]] std::string to_json(std::string_view scene, double totalMs) const;
+    bool write_json(const std::filesystem::path &path, std::string_view scene, double totalMs) const;
+    // <scene stem>.load.json in `directory`, next to the scene when it is empty
+    static std::filesystem::path report_path(const std::filesystem::path &scene,
+                                             const std::filesystem::path &directory = {});
+
+    // peak resident set of the process in bytes, 0 where the platform has no counter
+    static uint64_t peak_rss();
+    // lowers it to the current resident set, only Linux can. returns whether it did
+    static bool reset_peak_rss();
+
+private:
+    Phase &phase(std::string_view name);
+
+    std::atomic<bool> _trackMemory{false};
+    mutable std::mutex _mutex;
+    std::vector<Phase> _phases;
+};
+
+// times its scope into a phase of the profile and, when the profile tracks memory, samples the peak resident set
+// as it ends. the peak is reset when the scope starts, so on Linux it is the scope's own peak, elsewhere the
+// process's so far. scopes that run in parallel would reset each other's peak, those report items instead
+class ScopedLoadPhase {
+public:
+    ScopedLoadPhase(LoadProfile &profile, std::string_view phase);
+    ~ScopedLoadPhase();
+
+    ScopedLoadPhase(const ScopedLoadPhase &) = delete;
+    ScopedLoadPhase &operator=(const ScopedLoadPhase &) = delete;
+
+private:
+    LoadProfile &_profile;
+    std::string _phase;
+    std::chrono::high_resolution_clock::time_point _start;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+// Read-only memory mapping of a whole file. Move-only, unmaps on destruction.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    bool open(const std::filesystem::path &path);
+    void close();
+
+    [[nodiscard]] bool is_open() const { return _data != nullptr; }
+    [[nodiscard]] const uint8_t *data() const { return _data; }
+    [[nodiscard]] size_t size() const { return _size; }
+    [[nodiscard]] std::span<const uint8_t> bytes() const { return {_data, _size}; }
+
+private:
+    const uint8_t *_data = nullptr;
+    size_t _size = 0;
+#ifdef _WIN32
+    void *_fileHandle = nullptr;
+    void *_mappingHandle = nullptr;
+#endif
+};
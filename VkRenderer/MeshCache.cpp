@@ -0,0 +1,180 @@
+#include "MeshCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <spdlog/spdlog.h>
+#include <vk_utils.h>
+
+namespace {
+    constexpr char MESH_CACHE_MAGIC[4] = {'E', 'R', 'M', 'C'};
+    constexpr uint64_t STREAM_ALIGNMENT = 16;
+
+    void write_padding(std::ofstream &out, uint64_t &offset) {
+        static constexpr char zeros[STREAM_ALIGNMENT] = {};
+        const uint64_t aligned = align_up(offset, STREAM_ALIGNMENT);
+        out.write(zeros, static_cast<std::streamsize>(aligned - offset));
+        offset = aligned;
+    }
+
+    void write_stream(std::ofstream &out, uint64_t &offset, const void *data, size_t size) {
+        out.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+        offset += size;
+        write_padding(out, offset);
+    }
+
+    bool in_file(uint64_t offset, uint64_t size, size_t fileSize) {
+        return offset <= fileSize && size <= fileSize - offset && offset % STREAM_ALIGNMENT == 0;
+    }
+} // namespace
+
+std::filesystem::path MeshCache::path_for(const std::filesystem::path &cacheDirectory, uint64_t contentHash) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.meshcache", static_cast<unsigned long long>(contentHash));
+    return cacheDirectory / name;
+}
+
+bool MeshCache::write(const std::filesystem::path &path, uint64_t contentHash, std::span<const MeshGeometry> meshes) {
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    std::filesystem::path tmpPath = path;
+    tmpPath += ".tmp";
+
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            spdlog::warn("Mesh cache: could not create {}", tmpPath.string());
+            return false;
+        }
+
+        MeshCacheHeader header{};
+        memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(header.magic));
+        header.version = MESH_CACHE_VERSION;
+        header.contentHash = contentHash;
+        header.vertexStride = sizeof(Vertex);
+        header.surfaceStride = sizeof(SurfaceGeometry);
+        header.meshletStride = sizeof(Meshlet);
+        header.meshCount = static_cast<uint32_t>(meshes.size());
+
+        // lay out every stream up front so the table can be written before the data
+        std::vector<MeshCacheEntry> entries(meshes.size());
+        uint64_t offset = align_up(sizeof(MeshCacheHeader) + sizeof(MeshCacheEntry) * meshes.size(), STREAM_ALIGNMENT);
+        for (size_t i = 0; i < meshes.size(); i++) {
+            const MeshGeometry &mesh = meshes[i];
+            MeshCacheEntry &entry = entries[i];
+
+            entry.nameLength = static_cast<uint32_t>(mesh.name.size());
+            entry.surfaceCount = static_cast<uint32_t>(mesh.surfaces.size());
+            entry.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+            entry.indexCount = static_cast<uint32_t>(mesh.indices.size());
+            entry.meshletCount = static_cast<uint32_t>(mesh.meshlets.size());
+
+            entry.nameOffset = offset;
+            offset = align_up(offset + mesh.name.size(), STREAM_ALIGNMENT);
+            entry.surfaceOffset = offset;
+            offset = align_up(offset + mesh.surfaces.size() * sizeof(SurfaceGeometry), STREAM_ALIGNMENT);
+            entry.vertexOffset = offset;
+            offset = align_up(offset + mesh.vertices.size() * sizeof(Vertex), STREAM_ALIGNMENT);
+            entry.indexOffset = offset;
+            offset = align_up(offset + mesh.indices.size() * sizeof(uint32_t), STREAM_ALIGNMENT);
+            entry.meshletOffset = offset;
+            offset = align_up(offset + mesh.meshlets.size() * sizeof(Meshlet), STREAM_ALIGNMENT);
+        }
+
+        uint64_t written = 0;
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        written += sizeof(header);
+        write_stream(out, written, entries.data(), entries.size() * sizeof(MeshCacheEntry));
+
+        for (const MeshGeometry &mesh: meshes) {
+            write_stream(out, written, mesh.name.data(), mesh.name.size());
+            write_stream(out, written, mesh.surfaces.data(), mesh.surfaces.size() * sizeof(SurfaceGeometry));
+            write_stream(out, written, mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex));
+            write_stream(out, written, mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+            write_stream(out, written, mesh.meshlets.data(), mesh.meshlets.size() * sizeof(Meshlet));
+        }
+
+        if (!out) {
+            spdlog::warn("Mesh cache: failed writing {}", tmpPath.string());
+            out.close();
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        spdlog::warn("Mesh cache: could not move {} into place: {}", path.string(), ec.message());
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+
+bool MeshCache::open(const std::filesystem::path &path, uint64_t contentHash) {
+    close();
+
+    if (!_file.open(path)) {
+        return false;
+    }
+
+    const size_t fileSize = _file.size();
+    if (fileSize < sizeof(MeshCacheHeader)) {
+        close();
+        return false;
+    }
+
+    const auto *header = reinterpret_cast<const MeshCacheHeader *>(_file.data());
+    if (memcmp(header->magic, MESH_CACHE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != MESH_CACHE_VERSION || header->contentHash != contentHash ||
+        header->vertexStride != sizeof(Vertex) || header->surfaceStride != sizeof(SurfaceGeometry) ||
+        header->meshletStride != sizeof(Meshlet)) {
+        spdlog::info("Mesh cache: {} is stale, ignoring it", path.string());
+        close();
+        return false;
+    }
+
+    const uint64_t tableSize = uint64_t(header->meshCount) * sizeof(MeshCacheEntry);
+    if (!in_file(sizeof(MeshCacheHeader), tableSize, fileSize)) {
+        close();
+        return false;
+    }
+
+    const auto *entries = reinterpret_cast<const MeshCacheEntry *>(_file.data() + sizeof(MeshCacheHeader));
+    for (uint32_t i = 0; i < header->meshCount; i++) {
+        const MeshCacheEntry &e = entries[i];
+        if (!in_file(e.nameOffset, e.nameLength, fileSize) ||
+            !in_file(e.surfaceOffset, uint64_t(e.surfaceCount) * sizeof(SurfaceGeometry), fileSize) ||
+            !in_file(e.vertexOffset, uint64_t(e.vertexCount) * sizeof(Vertex), fileSize) ||
+            !in_file(e.indexOffset, uint64_t(e.indexCount) * sizeof(uint32_t), fileSize) ||
+            !in_file(e.meshletOffset, uint64_t(e.meshletCount) * sizeof(Meshlet), fileSize)) {
+            spdlog::warn("Mesh cache: {} is truncated or corrupt", path.string());
+            close();
+            return false;
+        }
+    }
+
+    _header = header;
+    _entries = entries;
+    return true;
+}
+
+void MeshCache::close() {
+    _header = nullptr;
+    _entries = nullptr;
+    _file.close();
+}
+
+MeshCacheView MeshCache::mesh(size_t index) const {
+    const MeshCacheEntry &e = _entries[index];
+    const uint8_t *base = _file.data();
+
+    MeshCacheView view;
+    view.name = std::string_view(reinterpret_cast<const char *>(base + e.nameOffset), e.nameLength);
+    view.surfaces = {reinterpret_cast<const SurfaceGeometry *>(base + e.surfaceOffset), e.surfaceCount};
+    view.vertices = {reinterpret_cast<const Vertex *>(base + e.vertexOffset), e.vertexCount};
+    view.indices = {reinterpret_cast<const uint32_t *>(base + e.indexOffset), e.indexCount};
+    view.meshlets = {reinterpret_cast<const Meshlet *>(base + e.meshletOffset), e.meshletCount};
+    return view;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <MappedFile.h>
+#include <MeshGeometry.h>
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+// Versioned on-disk cache of processed glTF geometry, keyed by the content hash of the source asset.
+//
+// Layout (all offsets from the start of the file, every stream 16 byte aligned):
+//   MeshCacheHeader
+//   MeshCacheEntry[meshCount]
+//   per mesh: name bytes, SurfaceGeometry[] (with their LOD ranges), Vertex[], uint32_t indices[], Meshlet[]
+//
+// Warm loads map the file and hand the streams straight to the upload path, the layout of Vertex,
+// SurfaceGeometry and Meshlet is stored as-is, so any change to them must bump MESH_CACHE_VERSION.
+constexpr uint32_t MESH_CACHE_VERSION = 4;
+
+struct MeshCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t contentHash;
+    uint32_t vertexStride;
+    uint32_t surfaceStride;
+    uint32_t meshletStride;
+    uint32_t meshCount;
+};
+
+struct MeshCacheEntry {
+    uint64_t nameOffset;
+    uint64_t surfaceOffset;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint64_t meshletOffset;
+    uint32_t nameLength;
+    uint32_t surfaceCount;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t meshletCount;
+    uint32_t padding;
+};
+
+// non-owning view of one cached mesh, valid while the MeshCache stays open
+struct MeshCacheView {
+    std::string_view name;
+    std::span<const SurfaceGeometry> surfaces;
+    std::span<const Vertex> vertices;
+    std::span<const uint32_t> indices;
+    std::span<const Meshlet> meshlets;
+};
+
+class MeshCache {
+public:
+    static std::filesystem::path path_for(const std::filesystem::path &cacheDirectory, uint64_t contentHash);
+
+    // writes to a temporary file first and renames it, so a crash never leaves a half written cache behind
+    static bool write(const std::filesystem::path &path, uint64_t contentHash, std::span<const MeshGeometry> meshes);
+
+    // maps the file and validates magic, version, strides, hash and bounds of every stream
+    bool open(const std::filesystem::path &path, uint64_t contentHash);
+    void close();
+
+    [[nodiscard]] bool is_open() const { return _header != nullptr; }
+    [[nodiscard]] size_t mesh_count() const { return _header ? _header->meshCount : 0; }
+    [[nodiscard]] size_t size_bytes() const { return _file.size(); }
+    [[nodiscard]] MeshCacheView mesh(size_t index) const;
+
+private:
+    MappedFile _file;
+    const MeshCacheHeader *_header = nullptr;
+    const MeshCacheEntry *_entries = nullptr;
+};
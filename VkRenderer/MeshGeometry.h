@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Meshlets.h>
+#include <Simplify.h>
+#include <Vertex.h>
+#include <array>
+#include <cstdint>
+#include <glm/vec3.hpp>
+#include <string>
+#include <vector>
+
+struct Bounds {
+    glm::vec3 origin;
+    float sphereRadius;
+    glm::vec3 extents;
+};
+
+// cpu side description of a GeoSurface, the material is referenced by its glTF index
+struct SurfaceGeometry {
+    uint32_t startIndex;
+    uint32_t count;
+    uint32_t materialIndex;
+    Bounds bounds;
+    // range of MeshGeometry::meshlets covering this surface
+    uint32_t firstMeshlet;
+    uint32_t meshletCount;
+    // coarser levels, finest first, their indices follow every full detail range in MeshGeometry::indices
+    uint32_t lodCount;
+    std::array<SurfaceLod, simplify::MAX_LODS> lods;
+};
+
+// processed geometry of one glTF mesh, ready to be uploaded or written to the mesh cache
+struct MeshGeometry {
+    std::string name;
+    std::vector<uint32_t> indices;
+    std::vector<Vertex> vertices;
+    std::vector<SurfaceGeometry> surfaces;
+    std::vector<Meshlet> meshlets;
+    uint32_t sourceVertexCount{0}; // vertices before welding, not stored in the mesh cache
+};
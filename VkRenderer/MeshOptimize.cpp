@@ -0,0 +1,261 @@
+#include "MeshOptimize.h"
+
+#include <algorithm>
+#include <glm/glm.hpp>
+#include <numeric>
+
+namespace {
+    constexpr uint32_t NO_VERTEX = ~0u;
+
+    // triangles around every vertex in CSR form
+    struct Adjacency {
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> triangles;
+
+        Adjacency(std::span<const uint32_t> indices, size_t vertexCount, uint32_t baseVertex) :
+            offsets(vertexCount + 1, 0), triangles(indices.size()) {
+            for (const uint32_t index: indices) {
+                offsets[index - baseVertex + 1]++;
+            }
+            std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+            std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < indices.size(); i++) {
+                triangles[cursor[indices[i] - baseVertex]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        [[nodiscard]] std::span<const uint32_t> of(uint32_t vertex) const {
+            return std::span(triangles).subspan(offsets[vertex], offsets[vertex + 1] - offsets[vertex]);
+        }
+    };
+} // namespace
+
+namespace meshoptimize {
+
+    VertexCacheStats analyze_vertex_cache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t baseVertex,
+                                          uint32_t cacheSize) {
+        if (indices.size() < 3 || vertexCount == 0) {
+            return VertexCacheStats{0.f, 0.f};
+        }
+
+        // a vertex is in the cache while fewer than cacheSize misses happened since it was inserted
+        std::vector<uint64_t> insertedAt(vertexCount, 0);
+        std::vector<bool> referenced(vertexCount, false);
+        uint64_t misses = 0;
+        size_t uniqueVertices = 0;
+
+        for (const uint32_t index: indices) {
+            const uint32_t v = index - baseVertex;
+            if (!referenced[v]) {
+                referenced[v] = true;
+                uniqueVertices++;
+            }
+            if (insertedAt[v] == 0 || misses - insertedAt[v] + 1 > cacheSize) {
+                misses++;
+                insertedAt[v] = misses;
+            }
+        }
+
+        const auto triangleCount = static_cast<float>(indices.size() / 3);
+        return VertexCacheStats{static_cast<float>(misses) / triangleCount,
+                                static_cast<float>(misses) / static_cast<float>(uniqueVertices)};
+    }
+
+    void optimize_vertex_cache(std::span<uint32_t> indices, size_t vertexCount, uint32_t baseVertex,
+                               uint32_t cacheSize, std::vector<uint32_t> *clusterStarts) {
+        const size_t triangleCount = indices.size() / 3;
+        if (triangleCount < 2 || vertexCount == 0) {
+            return;
+        }
+
+        const Adjacency adjacency(indices, vertexCount, baseVertex);
+
+        // live triangles per vertex and the time stamp it entered the cache at
+        std::vector<uint32_t> live(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++) {
+            live[v] = static_cast<uint32_t>(adjacency.of(v).size());
+        }
+        std::vector<uint32_t> cacheTime(vertexCount, 0);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> deadEnd;
+        std::vector<uint32_t> candidates;
+
+        std::vector<uint32_t> output;
+        output.reserve(indices.size());
+
+        uint32_t time = cacheSize + 1;
+        uint32_t scan = 0;
+        uint32_t fan = 0;
+        bool jumped = true;
+
+        // fallback when the fan has no live neighbours: recently used dead ends first, then input order
+        auto skip_dead_end = [&]() -> uint32_t {
+            while (!deadEnd.empty()) {
+                const uint32_t v = deadEnd.back();
+                deadEnd.pop_back();
+                if (live[v] > 0) {
+                    return v;
+                }
+            }
+            for (; scan < vertexCount; scan++) {
+                if (live[scan] > 0) {
+                    return scan;
+                }
+            }
+            return NO_VERTEX;
+        };
+
+        while (fan != NO_VERTEX) {
+            if (jumped && clusterStarts) {
+                clusterStarts->push_back(static_cast<uint32_t>(output.size() / 3));
+            }
+
+            candidates.clear();
+            for (const uint32_t t: adjacency.of(fan)) {
+                if (emitted[t]) {
+                    continue;
+                }
+                emitted[t] = true;
+
+                for (uint32_t corner = 0; corner < 3; corner++) {
+                    const uint32_t v = indices[t * 3 + corner] - baseVertex;
+                    output.push_back(v + baseVertex);
+                    deadEnd.push_back(v);
+                    candidates.push_back(v);
+                    live[v]--;
+                    if (time - cacheTime[v] > cacheSize) {
+                        cacheTime[v] = time++;
+                    }
+                }
+            }
+
+            // next fan: the candidate that stays in the cache the longest while its remaining triangles are emitted
+            uint32_t best = NO_VERTEX;
+            int64_t bestPriority = -1;
+            for (const uint32_t v: candidates) {
+                if (live[v] == 0) {
+                    continue;
+                }
+                int64_t priority = 0;
+                if (static_cast<int64_t>(time) - cacheTime[v] + 2 * static_cast<int64_t>(live[v]) <= cacheSize) {
+                    priority = static_cast<int64_t>(time) - cacheTime[v];
+                }
+                if (priority > bestPriority) {
+                    bestPriority = priority;
+                    best = v;
+                }
+            }
+
+            jumped = best == NO_VERTEX;
+            fan = jumped ? skip_dead_end() : best;
+        }
+
+        std::copy(output.begin(), output.end(), indices.begin());
+    }
+
+    void optimize_overdraw(std::span<uint32_t> indices, std::span<const Vertex> vertices, uint32_t baseVertex,
+                           std::span<const uint32_t> clusterStarts, float threshold) {
+        const size_t triangleCount = indices.size() / 3;
+        if (clusterStarts.size() < 2 || triangleCount == 0) {
+            return;
+        }
+
+        struct Cluster {
+            uint32_t first;
+            uint32_t count;
+            float key;
+        };
+
+        // area weighted centroid and normal of every cluster, and of the whole surface
+        glm::vec3 surfaceCentroid(0.f);
+        float surfaceArea = 0.f;
+        std::vector<glm::vec3> clusterCentroids(clusterStarts.size(), glm::vec3(0.f));
+        std::vector<glm::vec3> clusterNormals(clusterStarts.size(), glm::vec3(0.f));
+        std::vector<float> clusterAreas(clusterStarts.size(), 0.f);
+
+        std::vector<Cluster> clusters(clusterStarts.size());
+        for (size_t c = 0; c < clusterStarts.size(); c++) {
+            const uint32_t first = clusterStarts[c];
+            const uint32_t end =
+                c + 1 < clusterStarts.size() ? clusterStarts[c + 1] : static_cast<uint32_t>(triangleCount);
+            clusters[c] = Cluster{first, end - first, 0.f};
+
+            for (uint32_t t = first; t < end; t++) {
+                const glm::vec3 &p0 = vertices[indices[t * 3 + 0] - baseVertex].position;
+                const glm::vec3 &p1 = vertices[indices[t * 3 + 1] - baseVertex].position;
+                const glm::vec3 &p2 = vertices[indices[t * 3 + 2] - baseVertex].position;
+
+                const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+                const float area = glm::length(normal);
+                const glm::vec3 centroid = (p0 + p1 + p2) / 3.f;
+
+                clusterCentroids[c] += centroid * area;
+                clusterNormals[c] += normal;
+                clusterAreas[c] += area;
+                surfaceCentroid += centroid * area;
+                surfaceArea += area;
+            }
+        }
+        if (surfaceArea <= 0.f) {
+            return;
+        }
+        surfaceCentroid /= surfaceArea;
+
+        for (size_t c = 0; c < clusters.size(); c++) {
+            const float normalLength = glm::length(clusterNormals[c]);
+            if (clusterAreas[c] > 0.f && normalLength > 0.f) {
+                const glm::vec3 centroid = clusterCentroids[c] / clusterAreas[c];
+                clusters[c].key = glm::dot(centroid - surfaceCentroid, clusterNormals[c] / normalLength);
+            }
+        }
+
+        std::stable_sort(clusters.begin(), clusters.end(),
+                         [](const Cluster &a, const Cluster &b) { return a.key > b.key; });
+
+        std::vector<uint32_t> sorted;
+        sorted.reserve(indices.size());
+        for (const Cluster &cluster: clusters) {
+            const auto begin = indices.begin() + cluster.first * 3;
+            sorted.insert(sorted.end(), begin, begin + cluster.count * 3);
+        }
+
+        // clusters already start with a cache miss, but keep the input when sorting costs too much anyway
+        const float before = analyze_vertex_cache(indices, vertices.size(), baseVertex).acmr;
+        const float after = analyze_vertex_cache(sorted, vertices.size(), baseVertex).acmr;
+        if (after <= before * threshold) {
+            std::copy(sorted.begin(), sorted.end(), indices.begin());
+        }
+    }
+
+    void optimize_vertex_fetch(std::span<uint32_t> indices, std::span<Vertex> vertices, uint32_t baseVertex) {
+        std::vector<uint32_t> remap(vertices.size(), NO_VERTEX);
+        std::vector<Vertex> reordered;
+        reordered.reserve(vertices.size());
+
+        for (uint32_t &index: indices) {
+            const uint32_t v = index - baseVertex;
+            if (remap[v] == NO_VERTEX) {
+                remap[v] = static_cast<uint32_t>(reordered.size());
+                reordered.push_back(vertices[v]);
+            }
+            index = remap[v] + baseVertex;
+        }
+
+        for (size_t v = 0; v < vertices.size(); v++) {
+            if (remap[v] == NO_VERTEX) {
+                reordered.push_back(vertices[v]);
+            }
+        }
+
+        std::copy(reordered.begin(), reordered.end(), vertices.begin());
+    }
+
+    void optimize_surface(std::span<uint32_t> indices, std::span<Vertex> vertices, uint32_t baseVertex) {
+        std::vector<uint32_t> clusterStarts;
+        optimize_vertex_cache(indices, vertices.size(), baseVertex, CACHE_SIZE, &clusterStarts);
+        optimize_overdraw(indices, vertices, baseVertex, clusterStarts);
+        optimize_vertex_fetch(indices, vertices, baseVertex);
+    }
+
+} // namespace meshoptimize
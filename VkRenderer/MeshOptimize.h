@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Vertex.h>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Index and vertex reordering pass of the glTF loader, run once per primitive on that primitive's index and
+// vertex range. `indices` index the mesh, `baseVertex` is the mesh index of vertices[0] (or of the first vertex
+// of the range when only a vertex count is given).
+namespace meshoptimize {
+
+    // FIFO post-transform cache size we optimize for, small enough to suit every GPU we target
+    constexpr uint32_t CACHE_SIZE = 16;
+    // ACMR the overdraw pass may give up relative to the cache optimized order
+    constexpr float OVERDRAW_THRESHOLD = 1.05f;
+
+    struct VertexCacheStats {
+        float acmr; // transformed vertices per triangle, 0.5 is the limit for large regular meshes
+        float atvr; // transformed vertices per referenced vertex, 1.0 is ideal
+    };
+
+    // simulates a FIFO post-transform cache of `cacheSize` entries
+    VertexCacheStats analyze_vertex_cache(std::span<const uint32_t> indices, size_t vertexCount, uint32_t baseVertex,
+                                          uint32_t cacheSize = CACHE_SIZE);
+
+    // Tipsify (Sander et al. 2007): fans around the most recently used vertices and jumps to a dead end or the
+    // next unprocessed vertex when the fan runs out. Triangles keep their winding. When clusterStarts is given it
+    // receives the first triangle of every run that started with such a jump.
+    void optimize_vertex_cache(std::span<uint32_t> indices, size_t vertexCount, uint32_t baseVertex,
+                               uint32_t cacheSize = CACHE_SIZE, std::vector<uint32_t> *clusterStarts = nullptr);
+
+    // Sorts the clusters of a cache optimized index buffer so outward facing ones come first, which lets early z
+    // reject more of the rest from most viewpoints. Kept only if the ACMR stays within threshold times the input's.
+    void optimize_overdraw(std::span<uint32_t> indices, std::span<const Vertex> vertices, uint32_t baseVertex,
+                           std::span<const uint32_t> clusterStarts, float threshold = OVERDRAW_THRESHOLD);
+
+    // renumbers vertices in the order the index buffer first uses them so vertex fetch walks memory forward,
+    // unreferenced vertices move to the end
+    void optimize_vertex_fetch(std::span<uint32_t> indices, std::span<Vertex> vertices, uint32_t baseVertex);
+
+    // all three passes in order
+    void optimize_surface(std::span<uint32_t> indices, std::span<Vertex> vertices, uint32_t baseVertex);
+
+} // namespace meshoptimize
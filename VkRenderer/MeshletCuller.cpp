@@ -0,0 +1,176 @@
+#include "MeshletCuller.h"
+
+#include <Meshlets.h>
+#include <algorithm>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <spdlog/spdlog.h>
+#include <vk_buffers.h>
+#include <vk_pipelines.h>
+#include "vk_engine.h"
+
+namespace {
+    VkDeviceAddress buffer_address(VkDevice device, VkBuffer buffer) {
+        const VkBufferDeviceAddressInfo addressInfo{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+                                                    .buffer = buffer};
+        return vkGetBufferDeviceAddress(device, &addressInfo);
+    }
+
+    void memory_barrier(VkCommandBuffer cmd, VkPipelineStageFlags2 srcStage, VkAccessFlags2 srcAccess,
+                        VkPipelineStageFlags2 dstStage, VkAccessFlags2 dstAccess) {
+        VkMemoryBarrier2 barrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2};
+        barrier.srcStageMask = srcStage;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstStageMask = dstStage;
+        barrier.dstAccessMask = dstAccess;
+
+        VkDependencyInfo depInfo{.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+        depInfo.memoryBarrierCount = 1;
+        depInfo.pMemoryBarriers = &barrier;
+        vkCmdPipelineBarrier2(cmd, &depInfo);
+    }
+} // namespace
+
+void MeshletCuller::init(VulkanEngine *engine) {
+    VkPushConstantRange pushConstant{};
+    pushConstant.offset = 0;
+    pushConstant.size = sizeof(GPUMeshletCullPushConstants);
+    pushConstant.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+    VkPipelineLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = nullptr;
+    layoutInfo.pPushConstantRanges = &pushConstant;
+    layoutInfo.pushConstantRangeCount = 1;
+
+    VK_CHECK(vkCreatePipelineLayout(engine->_device, &layoutInfo, nullptr, &_pipelineLayout));
+
+    VkShaderModule cullShader;
+    if (!vkutil::load_shader_module("MeshletCull.comp.spv", engine->_device, &cullShader)) {
+        spdlog::error("Error when building the meshlet cull compute shader");
+    }
+
+    VkPipelineShaderStageCreateInfo stageInfo{};
+    stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stageInfo.pNext = nullptr;
+    stageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    stageInfo.module = cullShader;
+    stageInfo.pName = "main";
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.pNext = nullptr;
+    pipelineInfo.layout = _pipelineLayout;
+    pipelineInfo.stage = stageInfo;
+
+    VK_CHECK(vkCreateComputePipelines(engine->_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &_pipeline));
+
+    vkDestroyShaderModule(engine->_device, cullShader, nullptr);
+    engine->_mainDeletionQueue.push_function([=, this] {
+        vkDestroyPipelineLayout(engine->_device, _pipelineLayout, nullptr);
+        vkDestroyPipeline(engine->_device, _pipeline, nullptr);
+    });
+}
+
+void MeshletCuller::cull(VulkanEngine *engine, VkCommandBuffer cmd, std::span<const RenderObject> surfaces,
+                         std::span<const uint32_t> visible) {
+    _slots.assign(surfaces.size(), Slot{});
+    _drawBuffer = VK_NULL_HANDLE;
+    _countBuffer = VK_NULL_HANDLE;
+    _stats = Stats{};
+    if (!enabled) {
+        return;
+    }
+
+    const glm::vec3 camera = engine->sceneData.cameraPosition;
+    std::vector<GPUMeshletCullJob> jobs;
+    uint32_t drawCount = 0;
+    // culled surfaces are never drawn, the jobs and the dispatch follow the visible set
+    for (const uint32_t i: visible) {
+        const RenderObject &r = surfaces[i];
+        if (r.meshletCount == 0) {
+            continue;
+        }
+
+        GPUMeshletCullJob job{};
+        job.transform = r.transform;
+        const float scale = std::max({glm::length(glm::vec3(r.transform[0])), glm::length(glm::vec3(r.transform[1])),
+                                      glm::length(glm::vec3(r.transform[2]))});
+        job.cameraLocal = glm::vec4(glm::vec3(glm::inverse(r.transform) * glm::vec4(camera, 1.f)), scale);
+        job.meshlets = r.meshletBufferAddress;
+        job.meshletCount = r.meshletCount;
+        job.drawOffset = drawCount;
+        job.firstIndex = r.firstIndex;
+        job.vertexOffset = r.vertexOffset;
+        job.flags = r.meshletCullFlags;
+
+        _slots[i] = Slot{drawCount, static_cast<uint32_t>(jobs.size()), r.meshletCount};
+        drawCount += r.meshletCount;
+        jobs.push_back(job);
+    }
+    if (jobs.empty()) {
+        return;
+    }
+    _stats = Stats{static_cast<uint32_t>(jobs.size()), drawCount};
+
+    // frustum and jobs are written straight into the mapped upload buffer, draws and counts stay on the GPU
+    const size_t frameSize = sizeof(GPUMeshletCullFrame) + jobs.size() * sizeof(GPUMeshletCullJob);
+    const AllocatedBuffer frameBuffer =
+        vkutil::create_buffer(engine, frameSize, VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                              VMA_MEMORY_USAGE_CPU_TO_GPU, "MeshletCullFrame");
+    const AllocatedBuffer drawBuffer = vkutil::create_buffer(
+        engine, drawCount * sizeof(VkDrawIndexedIndirectCommand),
+        VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+            VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY, "MeshletCullDraws");
+    const AllocatedBuffer countBuffer = vkutil::create_buffer(
+        engine, jobs.size() * sizeof(uint32_t),
+        VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+        VMA_MEMORY_USAGE_GPU_ONLY, "MeshletCullCounts");
+    engine->get_current_frame()._deletionQueue.push_function([=] {
+        vkutil::destroy_buffer(engine, frameBuffer);
+        vkutil::destroy_buffer(engine, drawBuffer);
+        vkutil::destroy_buffer(engine, countBuffer);
+    });
+
+    GPUMeshletCullFrame header{};
+    const std::array<glm::vec4, 6> planes = meshlets::frustum_planes(engine->sceneData.viewproj);
+    std::ranges::copy(planes, header.frustum);
+    auto *mapped = static_cast<std::byte *>(frameBuffer.info.pMappedData);
+    memcpy(mapped, &header, sizeof(header));
+    memcpy(mapped + sizeof(header), jobs.data(), jobs.size() * sizeof(GPUMeshletCullJob));
+    vmaFlushAllocation(engine->_allocator, frameBuffer.allocation, 0, VK_WHOLE_SIZE);
+
+    vkCmdFillBuffer(cmd, countBuffer.buffer, 0, VK_WHOLE_SIZE, 0);
+    memory_barrier(cmd, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+                   VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                   VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT);
+
+    GPUMeshletCullPushConstants pushConstants{};
+    pushConstants.frame = buffer_address(engine->_device, frameBuffer.buffer);
+    pushConstants.drawBuffer = buffer_address(engine->_device, drawBuffer.buffer);
+    pushConstants.countBuffer = buffer_address(engine->_device, countBuffer.buffer);
+
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline);
+    vkCmdPushConstants(cmd, _pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+    vkCmdDispatch(cmd, static_cast<uint32_t>(jobs.size()), 1, 1);
+
+    memory_barrier(cmd, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT,
+                   VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT);
+
+    _drawBuffer = drawBuffer.buffer;
+    _countBuffer = countBuffer.buffer;
+}
+
+bool MeshletCuller::draw(VkCommandBuffer cmd, size_t surfaceIndex) const {
+    if (surfaceIndex >= _slots.size() || _slots[surfaceIndex].maxDraws == 0) {
+        return false;
+    }
+
+    const Slot &slot = _slots[surfaceIndex];
+    vkCmdDrawIndexedIndirectCount(cmd, _drawBuffer, slot.drawOffset * sizeof(VkDrawIndexedIndirectCommand),
+                                  _countBuffer, slot.job * sizeof(uint32_t), slot.maxDraws,
+                                  sizeof(VkDrawIndexedIndirectCommand));
+    return true;
+}
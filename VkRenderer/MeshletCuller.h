@@ -0,0 +1,50 @@
+#pragma once
+
+#include <RenderObject.h>
+#include <span>
+#include <vk_types.h>
+
+class VulkanEngine;
+
+// GPU meshlet culling for the main opaque pass. cull() dispatches MeshletCull.comp, one workgroup per surface,
+// which tests the surface's meshlets against the view frustum and, where back faces are culled anyway, their
+// normal cones (RenderObject::meshletCullFlags) and compacts the survivors
+// into indirect draw commands. draw() then replaces the surface's vkCmdDrawIndexed with a
+// vkCmdDrawIndexedIndirectCount over them. Only core Vulkan 1.2 features are used (drawIndirectCount and buffer
+// device addresses), so the pass runs on software devices like lavapipe too.
+class MeshletCuller {
+public:
+    void init(VulkanEngine *engine);
+
+    // records the cull dispatch for surfaces[i] of every i in `visible`, must be called outside a render pass.
+    // surfaces without meshlets keep their regular draw, as do all of them while disabled
+    void cull(VulkanEngine *engine, VkCommandBuffer cmd, std::span<const RenderObject> surfaces,
+              std::span<const uint32_t> visible);
+
+    // draws what cull() kept of surfaces[surfaceIndex], false when that surface was not culled
+    bool draw(VkCommandBuffer cmd, size_t surfaceIndex) const;
+
+    struct Stats {
+        uint32_t surfaces;
+        uint32_t meshlets; // of the visible surfaces tested in the last frame, the GPU alone knows what it kept
+    };
+    [[nodiscard]] Stats stats() const { return _stats; }
+
+    bool enabled{true};
+
+private:
+    struct Slot {
+        uint32_t drawOffset;
+        uint32_t job;
+        uint32_t maxDraws; // 0 for surfaces drawn the regular way
+    };
+
+    VkPipelineLayout _pipelineLayout{};
+    VkPipeline _pipeline{};
+
+    // one per surface of the last cull(), the buffers belong to the current frame
+    std::vector<Slot> _slots;
+    VkBuffer _drawBuffer{VK_NULL_HANDLE};
+    VkBuffer _countBuffer{VK_NULL_HANDLE};
+    Stats _stats{};
+};
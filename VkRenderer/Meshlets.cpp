@@ -0,0 +1,147 @@
+#include "Meshlets.h"
+
+#include <algorithm>
+#include <glm/glm.hpp>
+
+namespace {
+    constexpr uint32_t NOT_SEEN = ~0u;
+
+    // below this the cone spans more than ~84 degrees and culls too rarely to be worth testing
+    constexpr float MIN_CONE_DOT = 0.1f;
+
+    Meshlet meshlet_bounds(std::span<const uint32_t> indices, std::span<const Vertex> vertices, uint32_t baseVertex) {
+        Meshlet meshlet{};
+
+        glm::vec3 minpos = vertices[indices[0] - baseVertex].position;
+        glm::vec3 maxpos = minpos;
+        for (const uint32_t index: indices) {
+            minpos = glm::min(minpos, vertices[index - baseVertex].position);
+            maxpos = glm::max(maxpos, vertices[index - baseVertex].position);
+        }
+        meshlet.center = (minpos + maxpos) * 0.5f;
+        for (const uint32_t index: indices) {
+            const float distance = glm::length(vertices[index - baseVertex].position - meshlet.center);
+            meshlet.radius = std::max(meshlet.radius, distance);
+        }
+
+        // the cone has to contain the face normal of every triangle, degenerate ones face nowhere
+        std::vector<glm::vec3> normals;
+        normals.reserve(indices.size() / 3);
+        glm::vec3 axis(0.f);
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            const glm::vec3 &p0 = vertices[indices[i] - baseVertex].position;
+            const glm::vec3 &p1 = vertices[indices[i + 1] - baseVertex].position;
+            const glm::vec3 &p2 = vertices[indices[i + 2] - baseVertex].position;
+            const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+            const float length = glm::length(normal);
+            if (length > 0.f) {
+                normals.push_back(normal / length);
+                axis += normal / length;
+            }
+        }
+
+        meshlet.coneCutoff = 1.f;
+        const float axisLength = glm::length(axis);
+        if (normals.empty() || axisLength == 0.f) {
+            meshlet.coneAxis = glm::vec3(0.f, 0.f, 1.f);
+            return meshlet;
+        }
+        meshlet.coneAxis = axis / axisLength;
+
+        float minDot = 1.f;
+        for (const glm::vec3 &normal: normals) {
+            minDot = std::min(minDot, glm::dot(normal, meshlet.coneAxis));
+        }
+        if (minDot >= MIN_CONE_DOT) {
+            meshlet.coneCutoff = std::sqrt(1.f - minDot * minDot);
+        }
+        return meshlet;
+    }
+} // namespace
+
+namespace meshlets {
+
+    uint32_t build_meshlets(std::span<const uint32_t> indices, std::span<const Vertex> vertices, uint32_t baseVertex,
+                            std::vector<Meshlet> &out, uint32_t maxVertices, uint32_t maxTriangles) {
+        // meshlet that last referenced every vertex, so unique vertices are counted without clearing a set
+        std::vector<uint32_t> seenBy(vertices.size(), NOT_SEEN);
+        const size_t firstMeshlet = out.size();
+
+        size_t begin = 0;
+        uint32_t vertexCount = 0;
+        auto close = [&](size_t end) {
+            Meshlet meshlet = meshlet_bounds(indices.subspan(begin, end - begin), vertices, baseVertex);
+            meshlet.firstIndex = static_cast<uint32_t>(begin);
+            meshlet.indexCount = static_cast<uint32_t>(end - begin);
+            meshlet.vertexCount = vertexCount;
+            out.push_back(meshlet);
+            begin = end;
+            vertexCount = 0;
+        };
+
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            auto id = static_cast<uint32_t>(out.size());
+
+            uint32_t newVertices = 0;
+            for (size_t c = 0; c < 3; c++) {
+                newVertices += seenBy[indices[i + c] - baseVertex] != id ? 1 : 0;
+            }
+            // a triangle repeating a vertex counts it twice above, which only closes a meshlet a little early
+            if (i > begin && (vertexCount + newVertices > maxVertices || (i - begin) / 3 >= maxTriangles)) {
+                close(i);
+                id = static_cast<uint32_t>(out.size());
+            }
+
+            for (size_t c = 0; c < 3; c++) {
+                uint32_t &seen = seenBy[indices[i + c] - baseVertex];
+                if (seen != id) {
+                    seen = id;
+                    vertexCount++;
+                }
+            }
+        }
+        if (indices.size() - indices.size() % 3 > begin) {
+            close(indices.size() - indices.size() % 3);
+        }
+        return static_cast<uint32_t>(out.size() - firstMeshlet);
+    }
+
+    bool cone_culled(const Meshlet &meshlet, const glm::vec3 &cameraPosition) {
+        // the sphere around the meshlet stays behind every triangle plane when seen from inside the
+        // cone's backward extension, widened by the radius
+        const glm::vec3 toCenter = meshlet.center - cameraPosition;
+        return glm::dot(toCenter, meshlet.coneAxis) >= meshlet.coneCutoff * glm::length(toCenter) + meshlet.radius;
+    }
+
+    uint32_t cull_flags(bool doubleSided, bool pipelineCullsBackFaces) {
+        return !doubleSided && pipelineCullsBackFaces ? CULL_CONE : 0u;
+    }
+
+    std::array<glm::vec4, 6> frustum_planes(const glm::mat4 &viewproj) {
+        const glm::mat4 m = glm::transpose(viewproj);
+        std::array<glm::vec4, 6> planes = {
+            m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[2], m[3] - m[2],
+        };
+        for (glm::vec4 &plane: planes) {
+            const float length = glm::length(glm::vec3(plane));
+            plane = length > 0.f ? plane / length : glm::vec4(0.f, 0.f, 0.f, 1.f);
+        }
+        return planes;
+    }
+
+    bool sphere_outside(std::span<const glm::vec4, 6> planes, const glm::vec3 &center, float radius) {
+        return std::ranges::any_of(planes, [&](const glm::vec4 &plane) {
+            return glm::dot(glm::vec3(plane), center) + plane.w < -radius;
+        });
+    }
+
+    bool visible(const Meshlet &meshlet, uint32_t flags, std::span<const glm::vec4, 6> planes,
+                 const glm::mat4 &transform, const glm::vec3 &cameraLocal, float scale) {
+        if ((flags & CULL_CONE) != 0 && cone_culled(meshlet, cameraLocal)) {
+            return false;
+        }
+        const glm::vec3 center = glm::vec3(transform * glm::vec4(meshlet.center, 1.f));
+        return !sphere_outside(planes, center, meshlet.radius * scale);
+    }
+
+} // namespace meshlets
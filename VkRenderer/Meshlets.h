@@ -0,0 +1,59 @@
+#pragma once
+
+#include <Vertex.h>
+#include <array>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <span>
+#include <vector>
+
+// Small cluster of consecutive triangles of one surface, the unit the GPU culls (MeshletCull.comp).
+// Layout matches the shader's std430 struct, 48 bytes.
+struct Meshlet {
+    glm::vec3 center; // bounding sphere in mesh space
+    float radius;
+    glm::vec3 coneAxis; // average facing of the triangles
+    float coneCutoff; // sine of the normal cone's half angle, 1 when the cone is too wide to ever cull
+    uint32_t firstIndex; // relative to the first index of the surface
+    uint32_t indexCount;
+    uint32_t vertexCount;
+    uint32_t padding;
+};
+static_assert(sizeof(Meshlet) == 48);
+
+// Builds the meshlets of a surface and the conservative tests the cull shader runs on them. Like meshoptimize,
+// `indices` index the mesh and `baseVertex` is the mesh index of vertices[0].
+namespace meshlets {
+
+    // sized for a 64 wide workgroup per meshlet should mesh shaders ever consume them directly
+    constexpr uint32_t MAX_VERTICES = 64;
+    constexpr uint32_t MAX_TRIANGLES = 124;
+
+    // splits the index range into runs of consecutive triangles that stay within both limits, so every meshlet
+    // is a contiguous index range an indirect draw can reference. the vertex cache order of the loader keeps
+    // those runs spatially tight. appends to `out` and returns the number of meshlets added
+    uint32_t build_meshlets(std::span<const uint32_t> indices, std::span<const Vertex> vertices, uint32_t baseVertex,
+                            std::vector<Meshlet> &out, uint32_t maxVertices = MAX_VERTICES,
+                            uint32_t maxTriangles = MAX_TRIANGLES);
+
+    // true when every triangle of the meshlet faces away from a camera at `cameraPosition` (mesh space)
+    bool cone_culled(const Meshlet &meshlet, const glm::vec3 &cameraPosition);
+
+    // GPUMeshletCullJob::flags, CULL_CONE enables the normal cone test
+    constexpr uint32_t CULL_CONE = 1;
+
+    // the cone test only drops what the rasterizer would drop anyway, so it needs a single sided material on a
+    // pipeline culling back faces. every other surface is only frustum tested
+    uint32_t cull_flags(bool doubleSided, bool pipelineCullsBackFaces);
+
+    // inward facing planes of the Vulkan clip volume (-w <= x, y <= w, 0 <= z <= w), xyz normalized
+    std::array<glm::vec4, 6> frustum_planes(const glm::mat4 &viewproj);
+
+    bool sphere_outside(std::span<const glm::vec4, 6> planes, const glm::vec3 &center, float radius);
+
+    // what MeshletCull.comp keeps of one meshlet of a surface. cameraLocal is the camera in mesh space and scale
+    // the largest axis scale of transform, like GPUMeshletCullJob::cameraLocal
+    bool visible(const Meshlet &meshlet, uint32_t flags, std::span<const glm::vec4, 6> planes,
+                 const glm::mat4 &transform, const glm::vec3 &cameraLocal, float scale);
+
+} // namespace meshlets
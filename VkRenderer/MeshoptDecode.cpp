@@ -0,0 +1,438 @@
+#include "MeshoptDecode.h"
+
+#include <Simd.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    constexpr uint8_t VERTEX_HEADER = 0xa0;
+    constexpr uint8_t INDEX_HEADER = 0xe0;
+    constexpr uint8_t SEQUENCE_HEADER = 0xd0;
+
+    constexpr size_t BYTE_GROUP = 16;
+    constexpr size_t VERTEX_BLOCK_BYTES = 8192;
+    constexpr size_t VERTEX_BLOCK_MAX = 256;
+    constexpr size_t TAIL_MIN = 32;
+
+    using Cursor = const uint8_t *;
+
+    size_t vertex_block_size(size_t stride) {
+        const size_t size = (VERTEX_BLOCK_BYTES / stride) & ~(BYTE_GROUP - 1);
+        return std::min(size, VERTEX_BLOCK_MAX);
+    }
+
+    // one group of 16 byte deltas at 0, 2, 4 or 8 bits each. packed values that are all ones are escapes whose
+    // byte follows the packed bits, returns the end of the group or nullptr when it runs past `end`
+    Cursor decode_group(Cursor data, Cursor end, uint8_t *out, int bitsLog2) {
+        if (bitsLog2 == 0) {
+            std::memset(out, 0, BYTE_GROUP);
+            return data;
+        }
+        if (bitsLog2 == 3) {
+            if (static_cast<size_t>(end - data) < BYTE_GROUP) {
+                return nullptr;
+            }
+            std::memcpy(out, data, BYTE_GROUP);
+            return data + BYTE_GROUP;
+        }
+
+        const int bits = bitsLog2 == 1 ? 2 : 4;
+        const size_t packedBytes = BYTE_GROUP * bits / 8;
+        if (static_cast<size_t>(end - data) < packedBytes) {
+            return nullptr;
+        }
+        const uint8_t escape = static_cast<uint8_t>((1 << bits) - 1);
+        Cursor escapes = data + packedBytes;
+        for (size_t i = 0; i < BYTE_GROUP; i++) {
+            // most significant bits first
+            const size_t bit = i * bits;
+            const uint8_t value = static_cast<uint8_t>((data[bit / 8] >> (8 - bits - bit % 8)) & escape);
+            if (value == escape) {
+                if (escapes == end) {
+                    return nullptr;
+                }
+                out[i] = *escapes++;
+            } else {
+                out[i] = value;
+            }
+        }
+        return escapes;
+    }
+
+    // the zigzag deltas of one byte lane for `count` elements, rounded up to whole groups
+    Cursor decode_lane(Cursor data, Cursor end, uint8_t *out, size_t count) {
+        const size_t groups = count / BYTE_GROUP;
+        const size_t headerSize = (groups + 3) / 4;
+        if (static_cast<size_t>(end - data) < headerSize) {
+            return nullptr;
+        }
+        Cursor header = data;
+        data += headerSize;
+        for (size_t g = 0; g < groups && data; g++) {
+            const int bitsLog2 = (header[g / 4] >> ((g % 4) * 2)) & 3;
+            data = decode_group(data, end, out + g * BYTE_GROUP, bitsLog2);
+        }
+        return data;
+    }
+
+    uint8_t unzigzag8(uint8_t v) { return static_cast<uint8_t>(-(v & 1) ^ (v >> 1)); }
+
+    // turns the deltas of one lane into values starting from `previous` and writes them `stride` apart. the
+    // prefix sum is the serial part of the decoder, so SSE2 does it 16 elements at a time
+    uint8_t accumulate_lane(const uint8_t *deltas, size_t count, uint8_t previous, uint8_t *out, size_t stride) {
+        size_t i = 0;
+#if defined(EXPERIRENDER_SIMD_AVX2) || defined(EXPERIRENDER_SIMD_SSE2)
+        const __m128i one = _mm_set1_epi8(1);
+        const __m128i low7 = _mm_set1_epi8(127);
+        alignas(16) uint8_t values[BYTE_GROUP];
+        for (; i + BYTE_GROUP <= count; i += BYTE_GROUP) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(deltas + i));
+            const __m128i sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(v, one));
+            v = _mm_xor_si128(sign, _mm_and_si128(_mm_srli_epi16(v, 1), low7));
+            v = _mm_add_epi8(v, _mm_slli_si128(v, 1));
+            v = _mm_add_epi8(v, _mm_slli_si128(v, 2));
+            v = _mm_add_epi8(v, _mm_slli_si128(v, 4));
+            v = _mm_add_epi8(v, _mm_slli_si128(v, 8));
+            v = _mm_add_epi8(v, _mm_set1_epi8(static_cast<char>(previous)));
+            _mm_store_si128(reinterpret_cast<__m128i *>(values), v);
+            for (size_t k = 0; k < BYTE_GROUP; k++) {
+                out[(i + k) * stride] = values[k];
+            }
+            previous = values[BYTE_GROUP - 1];
+        }
+#endif
+        for (; i < count; i++) {
+            previous = static_cast<uint8_t>(previous + unzigzag8(deltas[i]));
+            out[i * stride] = previous;
+        }
+        return previous;
+    }
+
+    uint32_t decode_vbyte(Cursor &data) {
+        uint8_t lead = *data++;
+        if (lead < 128) {
+            return lead;
+        }
+        // little endian groups of 7 bits, at most 5 bytes
+        uint32_t result = lead & 127;
+        int shift = 7;
+        for (int i = 0; i < 4; i++) {
+            const uint8_t group = *data++;
+            result |= static_cast<uint32_t>(group & 127) << shift;
+            shift += 7;
+            if (group < 128) {
+                break;
+            }
+        }
+        return result;
+    }
+
+    uint32_t unzigzag32(uint32_t v) { return (v >> 1) ^ (0u - (v & 1)); }
+
+    uint32_t decode_index(Cursor &data, uint32_t last) { return last + unzigzag32(decode_vbyte(data)); }
+
+    void write_index(std::span<std::byte> out, size_t i, size_t indexSize, uint32_t value) {
+        if (indexSize == 2) {
+            const uint16_t narrow = static_cast<uint16_t>(value);
+            std::memcpy(out.data() + i * 2, &narrow, 2);
+        } else {
+            std::memcpy(out.data() + i * 4, &value, 4);
+        }
+    }
+
+    Cursor bytes_of(std::span<const std::byte> in) { return reinterpret_cast<Cursor>(in.data()); }
+
+    template<typename T>
+    void unfilter_octahedral(std::span<std::byte> data, size_t count) {
+        const float one = static_cast<float>((1 << (sizeof(T) * 8 - 1)) - 1);
+        for (size_t i = 0; i < count; i++) {
+            T c[4];
+            std::memcpy(c, data.data() + i * sizeof(c), sizeof(c));
+            // the third component stores 1.0 at the same precision, the octahedron folds back where z < 0
+            float x = static_cast<float>(c[0]);
+            float y = static_cast<float>(c[1]);
+            const float z = static_cast<float>(c[2]) - std::fabs(x) - std::fabs(y);
+            const float t = std::min(z, 0.f);
+            x += x >= 0.f ? t : -t;
+            y += y >= 0.f ? t : -t;
+            const float s = one / std::sqrt(x * x + y * y + z * z);
+            c[0] = static_cast<T>(std::lround(x * s));
+            c[1] = static_cast<T>(std::lround(y * s));
+            c[2] = static_cast<T>(std::lround(z * s));
+            std::memcpy(data.data() + i * sizeof(c), c, sizeof(c));
+        }
+    }
+
+    void unfilter_quaternion(std::span<std::byte> data, size_t count) {
+        const float scale = 1.f / std::sqrt(2.f);
+        for (size_t i = 0; i < count; i++) {
+            int16_t c[4];
+            std::memcpy(c, data.data() + i * sizeof(c), sizeof(c));
+            // the fourth component holds the scale in its high bits and which component was dropped in its low two
+            const float ss = scale / static_cast<float>(c[3] | 3);
+            const float x = static_cast<float>(c[0]) * ss;
+            const float y = static_cast<float>(c[1]) * ss;
+            const float z = static_cast<float>(c[2]) * ss;
+            const float w = std::sqrt(std::max(1.f - x * x - y * y - z * z, 0.f));
+            const int dropped = c[3] & 3;
+            int16_t q[4];
+            q[(dropped + 1) & 3] = static_cast<int16_t>(std::lround(x * 32767.f));
+            q[(dropped + 2) & 3] = static_cast<int16_t>(std::lround(y * 32767.f));
+            q[(dropped + 3) & 3] = static_cast<int16_t>(std::lround(z * 32767.f));
+            q[dropped] = static_cast<int16_t>(std::lround(w * 32767.f));
+            std::memcpy(data.data() + i * sizeof(q), q, sizeof(q));
+        }
+    }
+
+    // 24 bit signed mantissa and 8 bit signed exponent per float
+    void unfilter_exponential(std::span<std::byte> data, size_t words) {
+        size_t i = 0;
+#if defined(EXPERIRENDER_SIMD_AVX2) || defined(EXPERIRENDER_SIMD_SSE2)
+        for (; i + 4 <= words; i += 4) {
+            auto *p = reinterpret_cast<__m128i *>(data.data() + i * 4);
+            const __m128i v = _mm_loadu_si128(p);
+            const __m128i mantissa = _mm_srai_epi32(_mm_slli_epi32(v, 8), 8);
+            const __m128i exponent = _mm_srai_epi32(v, 24);
+            const __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(exponent, _mm_set1_epi32(127)), 23));
+            _mm_storeu_ps(reinterpret_cast<float *>(p), _mm_mul_ps(scale, _mm_cvtepi32_ps(mantissa)));
+        }
+#endif
+        for (; i < words; i++) {
+            uint32_t v;
+            std::memcpy(&v, data.data() + i * 4, 4);
+            const int32_t mantissa = static_cast<int32_t>(v << 8) >> 8;
+            const int32_t exponent = static_cast<int32_t>(v) >> 24;
+            const float value = std::ldexp(static_cast<float>(mantissa), exponent);
+            std::memcpy(data.data() + i * 4, &value, 4);
+        }
+    }
+} // namespace
+
+namespace meshoptdecode {
+
+    bool decode_vertex_buffer(std::span<std::byte> out, size_t count, size_t stride, std::span<const std::byte> in) {
+        if (stride == 0 || stride > VERTEX_BLOCK_MAX || stride % 4 != 0 || out.size() < count * stride) {
+            return false;
+        }
+        const size_t tailSize = std::max(stride, TAIL_MIN);
+        if (in.size() < 1 + tailSize) {
+            return false;
+        }
+        Cursor data = bytes_of(in);
+        Cursor end = data + in.size();
+        if ((*data & 0xf0) != VERTEX_HEADER || (*data & 0x0f) > 0) {
+            return false;
+        }
+        data++;
+        // the stream ends with the first element, the baseline of the first block's deltas
+        uint8_t previous[VERTEX_BLOCK_MAX];
+        std::memcpy(previous, end - stride, stride);
+
+        auto *vertices = reinterpret_cast<uint8_t *>(out.data());
+        const size_t blockSize = vertex_block_size(stride);
+        uint8_t deltas[VERTEX_BLOCK_MAX];
+        for (size_t first = 0; first < count; first += blockSize) {
+            const size_t elements = std::min(blockSize, count - first);
+            const size_t alignedElements = (elements + BYTE_GROUP - 1) & ~(BYTE_GROUP - 1);
+            for (size_t k = 0; k < stride; k++) {
+                data = decode_lane(data, end, deltas, alignedElements);
+                if (!data) {
+                    return false;
+                }
+                previous[k] = accumulate_lane(deltas, elements, previous[k], vertices + first * stride + k, stride);
+            }
+        }
+        return static_cast<size_t>(end - data) == tailSize;
+    }
+
+    bool decode_index_buffer(std::span<std::byte> out, size_t count, size_t indexSize, std::span<const std::byte> in) {
+        if (count % 3 != 0 || (indexSize != 2 && indexSize != 4) || out.size() < count * indexSize) {
+            return false;
+        }
+        // header, one code per triangle, the variable data and a 16 byte table of auxiliary codes
+        if (in.size() < 1 + count / 3 + 16) {
+            return false;
+        }
+        Cursor buffer = bytes_of(in);
+        if ((buffer[0] & 0xf0) != INDEX_HEADER || (buffer[0] & 0x0f) > 1) {
+            return false;
+        }
+        const int version = buffer[0] & 0x0f;
+
+        uint32_t edges[16][2];
+        uint32_t fifo[16];
+        std::memset(edges, 0xff, sizeof(edges));
+        std::memset(fifo, 0xff, sizeof(fifo));
+        size_t edgeOffset = 0;
+        size_t fifoOffset = 0;
+        auto push_edge = [&](uint32_t a, uint32_t b) {
+            edges[edgeOffset][0] = a;
+            edges[edgeOffset][1] = b;
+            edgeOffset = (edgeOffset + 1) & 15;
+        };
+        auto push_vertex = [&](uint32_t v, bool push = true) {
+            fifo[fifoOffset] = v;
+            fifoOffset = (fifoOffset + push) & 15;
+        };
+
+        uint32_t next = 0;
+        uint32_t last = 0;
+        // version 1 spends codes 13 and 14 on +-1 from the last explicit index
+        const int fecMax = version >= 1 ? 13 : 15;
+        Cursor code = buffer + 1;
+        Cursor data = code + count / 3;
+        // a triangle reads at most 16 bytes of data, so stopping here keeps every read inside the stream
+        Cursor dataEnd = buffer + in.size() - 16;
+        Cursor codeaux = dataEnd;
+
+        for (size_t i = 0; i < count; i += 3) {
+            if (data > dataEnd) {
+                return false;
+            }
+            const uint8_t codetri = *code++;
+            uint32_t a, b, c;
+            if (codetri < 0xf0) {
+                // a recent edge and a new, cached or nearby vertex
+                const size_t edge = (edgeOffset - 1 - (codetri >> 4)) & 15;
+                a = edges[edge][0];
+                b = edges[edge][1];
+                const int fec = codetri & 15;
+                if (fec < fecMax) {
+                    c = fec == 0 ? next++ : fifo[(fifoOffset - 1 - fec) & 15];
+                    push_vertex(c, fec == 0);
+                } else {
+                    last = c = fec != 15 ? last + (fec - (fec ^ 3)) : decode_index(data, last);
+                    push_vertex(c);
+                }
+                push_edge(c, b);
+                push_edge(a, c);
+                write_index(out, i + 0, indexSize, a);
+                write_index(out, i + 1, indexSize, b);
+                write_index(out, i + 2, indexSize, c);
+                continue;
+            }
+
+            if (codetri < 0xfe) {
+                // a new vertex followed by two new or cached ones, described by the auxiliary table
+                const uint8_t aux = codeaux[codetri & 15];
+                const int feb = aux >> 4;
+                const int fec = aux & 15;
+                a = next++;
+                b = feb == 0 ? next++ : fifo[(fifoOffset - feb) & 15];
+                c = fec == 0 ? next++ : fifo[(fifoOffset - fec) & 15];
+                push_vertex(a);
+                push_vertex(b, feb == 0);
+                push_vertex(c, fec == 0);
+            } else {
+                // three free vertices, the auxiliary byte inline. a zero byte restarts the new vertex counter
+                const uint8_t aux = *data++;
+                if (aux == 0) {
+                    next = 0;
+                }
+                const int fea = codetri == 0xfe ? 0 : 15;
+                const int feb = aux >> 4;
+                const int fec = aux & 15;
+                a = fea == 0 ? next++ : 0;
+                b = feb == 0 ? next++ : fifo[(fifoOffset - feb) & 15];
+                c = fec == 0 ? next++ : fifo[(fifoOffset - fec) & 15];
+                if (fea == 15) {
+                    last = a = decode_index(data, last);
+                }
+                if (feb == 15) {
+                    last = b = decode_index(data, last);
+                }
+                if (fec == 15) {
+                    last = c = decode_index(data, last);
+                }
+                push_vertex(a);
+                push_vertex(b, feb == 0 || feb == 15);
+                push_vertex(c, fec == 0 || fec == 15);
+            }
+            push_edge(b, a);
+            push_edge(c, b);
+            push_edge(a, c);
+            write_index(out, i + 0, indexSize, a);
+            write_index(out, i + 1, indexSize, b);
+            write_index(out, i + 2, indexSize, c);
+        }
+        return data == dataEnd;
+    }
+
+    bool decode_index_sequence(std::span<std::byte> out, size_t count, size_t indexSize,
+                               std::span<const std::byte> in) {
+        if ((indexSize != 2 && indexSize != 4) || out.size() < count * indexSize) {
+            return false;
+        }
+        // at least a byte per index and a 4 byte tail
+        if (in.size() < 1 + count + 4) {
+            return false;
+        }
+        Cursor buffer = bytes_of(in);
+        if ((buffer[0] & 0xf0) != SEQUENCE_HEADER || (buffer[0] & 0x0f) > 1) {
+            return false;
+        }
+        Cursor data = buffer + 1;
+        Cursor dataEnd = buffer + in.size() - 4;
+
+        // deltas alternate between two baselines, the low bit of each value picks one
+        uint32_t last[2] = {0, 0};
+        for (size_t i = 0; i < count; i++) {
+            if (data >= dataEnd) {
+                return false;
+            }
+            const uint32_t v = decode_vbyte(data);
+            const uint32_t baseline = v & 1;
+            last[baseline] += unzigzag32(v >> 1);
+            write_index(out, i, indexSize, last[baseline]);
+        }
+        return data == dataEnd;
+    }
+
+    bool apply_filter(Filter filter, std::span<std::byte> data, size_t count, size_t stride) {
+        if (data.size() < count * stride) {
+            return false;
+        }
+        switch (filter) {
+            case Filter::None:
+                return true;
+            case Filter::Octahedral:
+                if (stride == 4) {
+                    unfilter_octahedral<int8_t>(data, count);
+                    return true;
+                }
+                if (stride == 8) {
+                    unfilter_octahedral<int16_t>(data, count);
+                    return true;
+                }
+                return false;
+            case Filter::Quaternion:
+                if (stride != 8) {
+                    return false;
+                }
+                unfilter_quaternion(data, count);
+                return true;
+            case Filter::Exponential:
+                if (stride % 4 != 0) {
+                    return false;
+                }
+                unfilter_exponential(data, count * stride / 4);
+                return true;
+        }
+        return false;
+    }
+
+    bool decode(Mode mode, Filter filter, std::span<std::byte> out, size_t count, size_t stride,
+                std::span<const std::byte> in) {
+        switch (mode) {
+            case Mode::Attributes:
+                return decode_vertex_buffer(out, count, stride, in) && apply_filter(filter, out, count, stride);
+            case Mode::Triangles:
+                return filter == Filter::None && decode_index_buffer(out, count, stride, in);
+            case Mode::Indices:
+                return filter == Filter::None && decode_index_sequence(out, count, stride, in);
+        }
+        return false;
+    }
+
+} // namespace meshoptdecode
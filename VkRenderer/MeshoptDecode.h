@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// Decoder for the buffer views of EXT_meshopt_compression, following the bitstream of the extension's spec:
+// attributes (version 0) are byte-wise zigzag deltas in groups of 16 with 0/2/4/8 bit widths, triangles and
+// index sequences (version 1) are vertex/edge FIFO codes and varint deltas. The attribute delta prefix and the
+// exponential filter run on SSE2 when the build has it. Every function returns false on malformed input instead
+// of reading past `in`.
+namespace meshoptdecode {
+
+    enum class Mode : uint8_t { Attributes, Triangles, Indices };
+    enum class Filter : uint8_t { None, Octahedral, Quaternion, Exponential };
+
+    // `count` elements of `stride` bytes (a multiple of 4, at most 256), out holds count * stride bytes
+    bool decode_vertex_buffer(std::span<std::byte> out, size_t count, size_t stride, std::span<const std::byte> in);
+    // `count` indices (a multiple of 3) of `indexSize` 2 or 4 bytes
+    bool decode_index_buffer(std::span<std::byte> out, size_t count, size_t indexSize, std::span<const std::byte> in);
+    bool decode_index_sequence(std::span<std::byte> out, size_t count, size_t indexSize,
+                               std::span<const std::byte> in);
+
+    // undoes an attribute filter in place: octahedral for 4 or 8 byte normals/tangents, quaternion for 8 byte
+    // rotations, exponential for any stride of 32 bit floats
+    bool apply_filter(Filter filter, std::span<std::byte> data, size_t count, size_t stride);
+
+    // one compressed buffer view, the mode picks the codec and the filter only applies to attributes
+    bool decode(Mode mode, Filter filter, std::span<std::byte> out, size_t count, size_t stride,
+                std::span<const std::byte> in);
+
+} // namespace meshoptdecode
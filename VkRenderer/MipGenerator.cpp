@@ -0,0 +1,341 @@
+#include "MipGenerator.h"
+
+#include <ContentHash.h>
+#include <JobSystem.h>
+#include <Simd.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+    // kaiser lobes reach this many destination texels to each side, 8 taps per axis for a 2:1 level
+    constexpr float KAISER_RADIUS = 2.f;
+    constexpr float KAISER_ALPHA = 4.f;
+    constexpr float PI = 3.14159265358979f;
+
+    // linear values are looked up by their square root, which spends the entries where sRGB steps are finest
+    constexpr uint32_t SRGB_ENCODE_ENTRIES = 4096;
+
+    // destination rows per job, each job warms up its own row cache so fewer larger jobs convert less
+    constexpr size_t ROWS_PER_JOB = 16;
+
+    float srgb_to_linear(float s) { return s <= 0.04045f ? s / 12.92f : std::pow((s + 0.055f) / 1.055f, 2.4f); }
+
+    float linear_to_srgb(float l) { return l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.f / 2.4f) - 0.055f; }
+
+    const std::array<float, 256> &decode_table(bool srgb) {
+        static const std::array<float, 256> srgbTable = [] {
+            std::array<float, 256> table{};
+            for (uint32_t i = 0; i < 256; i++) {
+                table[i] = srgb_to_linear(static_cast<float>(i) / 255.f);
+            }
+            return table;
+        }();
+        static const std::array<float, 256> unormTable = [] {
+            std::array<float, 256> table{};
+            for (uint32_t i = 0; i < 256; i++) {
+                table[i] = static_cast<float>(i) / 255.f;
+            }
+            return table;
+        }();
+        return srgb ? srgbTable : unormTable;
+    }
+
+    uint8_t encode_unorm(float v) { return static_cast<uint8_t>(std::clamp(v, 0.f, 1.f) * 255.f + 0.5f); }
+
+    uint8_t encode_srgb(float v) {
+        static const std::array<uint8_t, SRGB_ENCODE_ENTRIES> table = [] {
+            std::array<uint8_t, SRGB_ENCODE_ENTRIES> encoded{};
+            for (uint32_t i = 0; i < SRGB_ENCODE_ENTRIES; i++) {
+                const float root = static_cast<float>(i) / (SRGB_ENCODE_ENTRIES - 1);
+                encoded[i] = encode_unorm(linear_to_srgb(root * root));
+            }
+            return encoded;
+        }();
+        const float root = std::sqrt(std::clamp(v, 0.f, 1.f));
+        return table[static_cast<uint32_t>(root * (SRGB_ENCODE_ENTRIES - 1) + 0.5f)];
+    }
+
+    // modified Bessel function of the first kind, order 0. the series converges long before 20 terms for alpha 4
+    float bessel_i0(float x) {
+        float sum = 1.f;
+        float term = 1.f;
+        for (int k = 1; k < 20; k++) {
+            term *= (x * 0.5f) / static_cast<float>(k);
+            sum += term * term;
+        }
+        return sum;
+    }
+
+    // x in destination texels from the center of the output texel
+    float kaiser(float x) {
+        const float t = x / KAISER_RADIUS;
+        if (std::abs(t) >= 1.f) {
+            return 0.f;
+        }
+        const float sinc = std::abs(x) < 1e-6f ? 1.f : std::sin(PI * x) / (PI * x);
+        return sinc * bessel_i0(KAISER_ALPHA * std::sqrt(1.f - t * t)) / bessel_i0(KAISER_ALPHA);
+    }
+
+    // resampling weights along one axis, `taps` per destination texel with the source indices clamped to the
+    // edge. the same kernel shape works for odd sizes, where a destination texel covers 2.x source texels
+    struct Kernel {
+        uint32_t taps{0};
+        std::vector<uint32_t> indices;
+        std::vector<float> weights;
+    };
+
+    Kernel make_kernel(mipgen::MipFilter filter, uint32_t srcSize, uint32_t dstSize) {
+        const float scale = static_cast<float>(srcSize) / static_cast<float>(dstSize);
+        const float support = filter == mipgen::MipFilter::Box ? 0.5f * scale : KAISER_RADIUS * scale;
+
+        Kernel kernel;
+        kernel.taps = static_cast<uint32_t>(std::ceil(2.f * support)) + 1;
+        kernel.indices.resize(size_t(dstSize) * kernel.taps);
+        kernel.weights.resize(size_t(dstSize) * kernel.taps);
+
+        for (uint32_t dst = 0; dst < dstSize; dst++) {
+            const float center = (static_cast<float>(dst) + 0.5f) * scale;
+            const int first = static_cast<int>(std::floor(center - support));
+            uint32_t *indices = kernel.indices.data() + size_t(dst) * kernel.taps;
+            float *weights = kernel.weights.data() + size_t(dst) * kernel.taps;
+
+            float sum = 0.f;
+            for (uint32_t t = 0; t < kernel.taps; t++) {
+                const int src = first + static_cast<int>(t);
+                float weight;
+                if (filter == mipgen::MipFilter::Box) {
+                    // area of the source texel inside the destination footprint
+                    const float lo = std::max(static_cast<float>(src), center - 0.5f * scale);
+                    const float hi = std::min(static_cast<float>(src + 1), center + 0.5f * scale);
+                    weight = std::max(hi - lo, 0.f);
+                } else {
+                    weight = kaiser((static_cast<float>(src) + 0.5f - center) / scale);
+                }
+                indices[t] = static_cast<uint32_t>(std::clamp(src, 0, static_cast<int>(srcSize) - 1));
+                weights[t] = weight;
+                sum += weight;
+            }
+            for (uint32_t t = 0; t < kernel.taps; t++) {
+                weights[t] /= sum;
+            }
+        }
+
+        // the candidate range is one texel wider than the footprint, drop the taps every texel weighs zero
+        uint32_t leading = kernel.taps;
+        uint32_t trailing = kernel.taps;
+        for (uint32_t dst = 0; dst < dstSize; dst++) {
+            const float *weights = kernel.weights.data() + size_t(dst) * kernel.taps;
+            uint32_t first = 0;
+            while (first < kernel.taps && weights[first] == 0.f) {
+                first++;
+            }
+            uint32_t last = kernel.taps;
+            while (last > first && weights[last - 1] == 0.f) {
+                last--;
+            }
+            leading = std::min(leading, first);
+            trailing = std::min(trailing, kernel.taps - last);
+        }
+        if (leading + trailing > 0 && leading + trailing < kernel.taps) {
+            const uint32_t taps = kernel.taps - leading - trailing;
+            for (uint32_t dst = 0; dst < dstSize; dst++) {
+                for (uint32_t t = 0; t < taps; t++) {
+                    kernel.indices[size_t(dst) * taps + t] = kernel.indices[size_t(dst) * kernel.taps + leading + t];
+                    kernel.weights[size_t(dst) * taps + t] = kernel.weights[size_t(dst) * kernel.taps + leading + t];
+                }
+            }
+            kernel.taps = taps;
+            kernel.indices.resize(size_t(dstSize) * taps);
+            kernel.weights.resize(size_t(dstSize) * taps);
+        }
+        return kernel;
+    }
+
+    // source rows converted to linear floats, a ring of as many rows as the vertical kernel has taps. the rows
+    // one destination row needs are consecutive, so they never share a slot
+    class RowCache {
+    public:
+        RowCache(const uint8_t *rgba, uint32_t width, bool srgb, uint32_t slots) :
+            _rgba(rgba), _width(width), _table(decode_table(srgb)), _slots(slots),
+            _rows(size_t(slots) * width * 4), _keys(slots, std::numeric_limits<uint32_t>::max()) {}
+
+        const float *row(uint32_t y) {
+            const uint32_t slot = y % _slots;
+            float *out = _rows.data() + size_t(slot) * _width * 4;
+            if (_keys[slot] != y) {
+                const uint8_t *src = _rgba + size_t(y) * _width * 4;
+                for (size_t i = 0; i < size_t(_width) * 4; i += 4) {
+                    out[i + 0] = _table[src[i + 0]];
+                    out[i + 1] = _table[src[i + 1]];
+                    out[i + 2] = _table[src[i + 2]];
+                    out[i + 3] = static_cast<float>(src[i + 3]) * (1.f / 255.f);
+                }
+                _keys[slot] = y;
+            }
+            return out;
+        }
+
+    private:
+        const uint8_t *_rgba;
+        uint32_t _width;
+        const std::array<float, 256> &_table;
+        uint32_t _slots;
+        std::vector<float> _rows;
+        std::vector<uint32_t> _keys;
+    };
+
+    // out = sum of weights[t] * rows[t], the vertical pass. a row is contiguous so every lane does useful work
+    void accumulate_rows(const float *const *rows, const float *weights, uint32_t taps, float *out, size_t count) {
+        size_t i = 0;
+        for (; i + simd::LANES <= count; i += simd::LANES) {
+            simd::vfloat sum = simd::mul(simd::loadu(rows[0] + i), simd::set1(weights[0]));
+            for (uint32_t t = 1; t < taps; t++) {
+                sum = simd::add(sum, simd::mul(simd::loadu(rows[t] + i), simd::set1(weights[t])));
+            }
+            simd::storeu(out + i, sum);
+        }
+        for (; i < count; i++) {
+            float sum = rows[0][i] * weights[0];
+            for (uint32_t t = 1; t < taps; t++) {
+                sum += rows[t][i] * weights[t];
+            }
+            out[i] = sum;
+        }
+    }
+
+    // horizontal pass over the vertically filtered row, then back to 8 bits
+    void filter_row(const float *column, const Kernel &kernel, bool srgb, uint32_t dstWidth, uint8_t *out) {
+        for (uint32_t x = 0; x < dstWidth; x++) {
+            const uint32_t *indices = kernel.indices.data() + size_t(x) * kernel.taps;
+            const float *weights = kernel.weights.data() + size_t(x) * kernel.taps;
+
+            float sum[4] = {};
+            for (uint32_t t = 0; t < kernel.taps; t++) {
+                const float *texel = column + size_t(indices[t]) * 4;
+                for (uint32_t c = 0; c < 4; c++) {
+                    sum[c] += texel[c] * weights[t];
+                }
+            }
+
+            uint8_t *texel = out + size_t(x) * 4;
+            for (uint32_t c = 0; c < 3; c++) {
+                texel[c] = srgb ? encode_srgb(sum[c]) : encode_unorm(sum[c]);
+            }
+            texel[3] = encode_unorm(sum[3]);
+        }
+    }
+
+    void build_level(const uint8_t *src, const MipLevel &srcLevel, uint8_t *dst, const MipLevel &dstLevel,
+                     const mipgen::MipSettings &settings, JobSystem *jobs) {
+        const Kernel horizontal = make_kernel(settings.filter, srcLevel.width, dstLevel.width);
+        const Kernel vertical = make_kernel(settings.filter, srcLevel.height, dstLevel.height);
+
+        auto build_rows = [&](size_t begin, size_t end) {
+            RowCache cache(src, srcLevel.width, settings.srgb, vertical.taps);
+            std::vector<float> column(size_t(srcLevel.width) * 4);
+            std::vector<const float *> rows(vertical.taps);
+
+            for (size_t y = begin; y < end; y++) {
+                const uint32_t *indices = vertical.indices.data() + y * vertical.taps;
+                for (uint32_t t = 0; t < vertical.taps; t++) {
+                    rows[t] = cache.row(indices[t]);
+                }
+                accumulate_rows(rows.data(), vertical.weights.data() + y * vertical.taps, vertical.taps,
+                                column.data(), column.size());
+                filter_row(column.data(), horizontal, settings.srgb, dstLevel.width,
+                           dst + y * size_t(dstLevel.width) * 4);
+            }
+        };
+
+        if (jobs && dstLevel.height > ROWS_PER_JOB) {
+            jobs->parallel_for(dstLevel.height, ROWS_PER_JOB, build_rows);
+        } else {
+            build_rows(0, dstLevel.height);
+        }
+    }
+
+    // texels passing `cutoff` once alpha is scaled by `scale`, counted per alpha value
+    uint64_t covered_texels(const uint64_t *histogram, float cutoff, float scale) {
+        uint64_t covered = 0;
+        for (uint32_t a = 0; a < 256; a++) {
+            if (std::min(static_cast<float>(a) * scale, 255.f) / 255.f >= cutoff) {
+                covered += histogram[a];
+            }
+        }
+        return covered;
+    }
+
+    // scales alpha so the level passes the alpha test on the same fraction of texels as the base level
+    // (Castano, "Computing Alpha Mipmaps"). filtering alone blends cutout edges toward the background and
+    // foliage or fences would otherwise dissolve in the distance
+    void preserve_coverage(uint8_t *rgba, size_t texels, float cutoff, float coverage) {
+        uint64_t histogram[256] = {};
+        for (size_t i = 0; i < texels; i++) {
+            histogram[rgba[i * 4 + 3]]++;
+        }
+
+        const auto target = static_cast<uint64_t>(std::ceil(coverage * static_cast<float>(texels)));
+        float lo = 0.f;
+        float hi = 4.f;
+        for (int i = 0; i < 20; i++) {
+            const float mid = 0.5f * (lo + hi);
+            if (covered_texels(histogram, cutoff, mid) < target) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+
+        for (size_t i = 0; i < texels; i++) {
+            rgba[i * 4 + 3] = encode_unorm(static_cast<float>(rgba[i * 4 + 3]) * hi / 255.f);
+        }
+    }
+} // namespace
+
+const char *mipgen::name(MipFilter filter) {
+    switch (filter) {
+        case MipFilter::Box:
+            return "Box";
+        case MipFilter::Kaiser:
+        default:
+            return "Kaiser";
+    }
+}
+
+uint64_t mipgen::settings_key(const MipSettings &settings) {
+    uint32_t cutoffBits;
+    memcpy(&cutoffBits, &settings.alphaCutoff, sizeof(cutoffBits));
+    return hash_combine(hash_combine(static_cast<uint64_t>(settings.filter), settings.srgb ? 1 : 0), cutoffBits);
+}
+
+float mipgen::alpha_coverage(const uint8_t *rgba, uint32_t width, uint32_t height, float cutoff) {
+    const size_t texels = size_t(width) * height;
+    size_t covered = 0;
+    for (size_t i = 0; i < texels; i++) {
+        covered += static_cast<float>(rgba[i * 4 + 3]) / 255.f >= cutoff ? 1 : 0;
+    }
+    return texels > 0 ? static_cast<float>(covered) / static_cast<float>(texels) : 0.f;
+}
+
+MipChain mipgen::generate(const uint8_t *rgba, uint32_t width, uint32_t height, const MipSettings &settings,
+                          JobSystem *jobs) {
+    MipChain chain = blockcompress::allocate(VK_FORMAT_R8G8B8A8_UNORM, width, height, true);
+    memcpy(chain.data.data(), rgba, chain.levels[0].size);
+
+    const bool alphaTested = settings.alphaCutoff > 0.f;
+    const float coverage = alphaTested ? alpha_coverage(rgba, width, height, settings.alphaCutoff) : 0.f;
+
+    for (size_t level = 1; level < chain.levels.size(); level++) {
+        const MipLevel &src = chain.levels[level - 1];
+        const MipLevel &dst = chain.levels[level];
+        uint8_t *out = chain.data.data() + dst.offset;
+        build_level(chain.data.data() + src.offset, src, out, dst, settings, jobs);
+        if (alphaTested) {
+            preserve_coverage(out, size_t(dst.width) * dst.height, settings.alphaCutoff, coverage);
+        }
+    }
+    return chain;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <BlockCompression.h>
+#include <cstdint>
+
+class JobSystem;
+
+// CPU mip chains for RGBA8 textures, the alternative to the vkCmdBlitImage chain of vkutil::generate_mipmaps.
+// sRGB colors are filtered in linear light, and alpha tested textures keep the coverage of their base level so
+// cutouts do not thin out with distance. Every level is built from the previous one.
+namespace mipgen {
+
+    enum class MipFilter : uint32_t {
+        Box, // area average, 2x2 for even sizes like the blit chain
+        Kaiser, // Kaiser windowed sinc over 4 texels per side, keeps distant textures sharper than the box
+    };
+
+    const char *name(MipFilter filter);
+
+    struct MipSettings {
+        MipFilter filter{MipFilter::Kaiser};
+        // rgb holds sRGB encoded colors: linearize, filter, re-encode. alpha is always linear
+        bool srgb{false};
+        // alpha test threshold of the material, above 0 every level's alpha is scaled to the base coverage
+        float alphaCutoff{0.f};
+    };
+
+    // tells chains built with different settings apart, mixed into the texture cache keys
+    uint64_t settings_key(const MipSettings &settings);
+
+    // fraction of texels whose alpha passes `cutoff`
+    float alpha_coverage(const uint8_t *rgba, uint32_t width, uint32_t height, float cutoff);
+
+    // full R8G8B8A8 chain down to 1x1 in one allocation, level 0 is a copy of `rgba`. rows of every level are
+    // spread over `jobs` when given, which is safe from inside a job
+    MipChain generate(const uint8_t *rgba, uint32_t width, uint32_t height, const MipSettings &settings,
+                      JobSystem *jobs = nullptr);
+
+} // namespace mipgen
@@ -0,0 +1,298 @@
+#include "OcclusionCull.h"
+
+#include <JobSystem.h>
+#include <Simd.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace occlusion {
+
+    namespace {
+
+        // pixel centers of one step, only the first simd::LANES are loaded
+        constexpr float LANE_CENTERS[8] = {0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f};
+        static_assert(simd::LANES <= 8 && TILE_WIDTH % simd::LANES == 0 && BLOCK_SIZE % simd::LANES == 0);
+
+        // scales the smallest edge function into a depth: a pixel outside the triangle gets a negative one that
+        // loses against every stored depth, one well inside gets something larger than any depth
+        constexpr float COVERAGE_SCALE = 1e20f;
+
+        // Sutherland-Hodgman against the reversed Z near plane z <= w, a triangle becomes at most a quad
+        uint32_t clip_near(const std::array<glm::vec4, 3> &in, std::array<glm::vec4, 4> &out) {
+            uint32_t count = 0;
+            for (uint32_t i = 0; i < 3; i++) {
+                const glm::vec4 &p = in[i];
+                const glm::vec4 &q = in[(i + 1) % 3];
+                const float dp = p.w - p.z;
+                const float dq = q.w - q.z;
+                if (dp >= 0.f) {
+                    out[count++] = p;
+                }
+                if ((dp >= 0.f) != (dq >= 0.f)) {
+                    out[count++] = p + (q - p) * (dp / (dp - dq));
+                }
+            }
+            return count;
+        }
+
+        void setup_triangle(const glm::vec4 &c0, const glm::vec4 &c1, const glm::vec4 &c2,
+                            std::vector<ScreenTriangle> &out) {
+            if (c0.w <= 0.f || c1.w <= 0.f || c2.w <= 0.f) {
+                return;
+            }
+            const std::array<const glm::vec4 *, 3> clip = {&c0, &c1, &c2};
+            std::array<glm::vec3, 3> v;
+            for (uint32_t i = 0; i < 3; i++) {
+                const float invW = 1.f / clip[i]->w;
+                v[i] = {(clip[i]->x * invW * 0.5f + 0.5f) * static_cast<float>(WIDTH),
+                        (clip[i]->y * invW * 0.5f + 0.5f) * static_cast<float>(HEIGHT), clip[i]->z * invW};
+            }
+
+            float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+            // no backface culling, an open wall hides things from both sides
+            if (area < 0.f) {
+                std::swap(v[1], v[2]);
+                area = -area;
+            }
+            const float zMax = std::max({v[0].z, v[1].z, v[2].z});
+            if (!(area > 1e-6f) || !(zMax > 0.f)) {
+                return;
+            }
+
+            // pixels that can be inside, clamped before converting so far off corners can't overflow
+            auto pixel = [](float coordinate, uint32_t size) {
+                return static_cast<int>(std::floor(std::clamp(coordinate, -1.f, static_cast<float>(size))));
+            };
+            ScreenTriangle t{};
+            t.minX = std::max(pixel(std::min({v[0].x, v[1].x, v[2].x}), WIDTH), 0);
+            t.maxX = std::min(pixel(std::max({v[0].x, v[1].x, v[2].x}), WIDTH), static_cast<int>(WIDTH) - 1);
+            t.minY = std::max(pixel(std::min({v[0].y, v[1].y, v[2].y}), HEIGHT), 0);
+            t.maxY = std::min(pixel(std::max({v[0].y, v[1].y, v[2].y}), HEIGHT), static_cast<int>(HEIGHT) - 1);
+            if (t.minX > t.maxX || t.minY > t.maxY) {
+                return;
+            }
+
+            // inner coverage: every edge moves inward by the most it changes within half a pixel, so a pixel whose
+            // center passes lies entirely inside the triangle. partly covered pixels stay empty, a box beside the
+            // silhouette is never hidden by them. edges two triangles share leave a crack, which only costs culling
+            for (uint32_t e = 0; e < 3; e++) {
+                const glm::vec3 &p = v[e];
+                const glm::vec3 &q = v[(e + 1) % 3];
+                t.a[e] = p.y - q.y;
+                t.b[e] = q.x - p.x;
+                t.c[e] = -(t.a[e] * p.x + t.b[e] * p.y) - 0.5f * (std::fabs(t.a[e]) + std::fabs(t.b[e]));
+            }
+
+            t.dzdx = ((v[1].z - v[0].z) * (v[2].y - v[0].y) - (v[2].z - v[0].z) * (v[1].y - v[0].y)) / area;
+            t.dzdy = ((v[2].z - v[0].z) * (v[1].x - v[0].x) - (v[1].z - v[0].z) * (v[2].x - v[0].x)) / area;
+            t.z0 = v[0].z - t.dzdx * v[0].x - t.dzdy * v[0].y - 0.5f * (std::fabs(t.dzdx) + std::fabs(t.dzdy));
+            t.zMax = zMax;
+            out.push_back(t);
+        }
+
+        void setup_occluder(const Occluder &occluder, std::vector<ScreenTriangle> &out) {
+            out.clear();
+            const std::vector<glm::vec3> &corners = occluder.mesh->corners;
+            for (size_t i = 0; i + 2 < corners.size(); i += 3) {
+                const std::array<glm::vec4, 3> clip = {occluder.modelViewProj * glm::vec4(corners[i], 1.f),
+                                                       occluder.modelViewProj * glm::vec4(corners[i + 1], 1.f),
+                                                       occluder.modelViewProj * glm::vec4(corners[i + 2], 1.f)};
+                std::array<glm::vec4, 4> clipped;
+                const uint32_t count = clip_near(clip, clipped);
+                for (uint32_t v = 2; v < count; v++) {
+                    setup_triangle(clipped[0], clipped[v - 1], clipped[v], out);
+                }
+            }
+        }
+
+        void rasterize_tile(DepthBuffer &buffer, uint32_t tile) {
+            const int tileX = static_cast<int>((tile % TILES_X) * TILE_WIDTH);
+            const int tileY = static_cast<int>((tile / TILES_X) * TILE_HEIGHT);
+            const simd::vfloat laneCenters = simd::loadu(LANE_CENTERS);
+            const simd::vfloat scale = simd::set1(COVERAGE_SCALE);
+            constexpr auto lanes = static_cast<float>(simd::LANES);
+
+            for (const uint32_t index: buffer.bins[tile]) {
+                const ScreenTriangle &t = buffer.triangles[index];
+                // starts on a lane boundary, the lanes past the triangle fail its edges
+                const int x0 = std::max(t.minX, tileX) / static_cast<int>(simd::LANES) * static_cast<int>(simd::LANES);
+                const int x1 = std::min(t.maxX, tileX + static_cast<int>(TILE_WIDTH) - 1);
+                const int y0 = std::max(t.minY, tileY);
+                const int y1 = std::min(t.maxY, tileY + static_cast<int>(TILE_HEIGHT) - 1);
+
+                const simd::vfloat a0 = simd::set1(t.a[0]);
+                const simd::vfloat a1 = simd::set1(t.a[1]);
+                const simd::vfloat a2 = simd::set1(t.a[2]);
+                const simd::vfloat step0 = simd::set1(t.a[0] * lanes);
+                const simd::vfloat step1 = simd::set1(t.a[1] * lanes);
+                const simd::vfloat step2 = simd::set1(t.a[2] * lanes);
+                const simd::vfloat dzdx = simd::set1(t.dzdx);
+                const simd::vfloat zStep = simd::set1(t.dzdx * lanes);
+                const simd::vfloat zMax = simd::set1(t.zMax);
+
+                for (int y = y0; y <= y1; y++) {
+                    const float py = static_cast<float>(y) + 0.5f;
+                    const simd::vfloat px = simd::add(simd::set1(static_cast<float>(x0)), laneCenters);
+                    simd::vfloat e0 = simd::add(simd::mul(a0, px), simd::set1(t.b[0] * py + t.c[0]));
+                    simd::vfloat e1 = simd::add(simd::mul(a1, px), simd::set1(t.b[1] * py + t.c[1]));
+                    simd::vfloat e2 = simd::add(simd::mul(a2, px), simd::set1(t.b[2] * py + t.c[2]));
+                    simd::vfloat z = simd::add(simd::mul(dzdx, px), simd::set1(t.dzdy * py + t.z0));
+
+                    float *row = buffer.depth.data() + static_cast<size_t>(y) * WIDTH;
+                    for (int x = x0; x <= x1; x += static_cast<int>(simd::LANES)) {
+                        const simd::vfloat inside = simd::mul(simd::min(e0, simd::min(e1, e2)), scale);
+                        const simd::vfloat covered = simd::min(simd::min(z, zMax), inside);
+                        simd::storeu(row + x, simd::max(simd::loadu(row + x), covered));
+                        e0 = simd::add(e0, step0);
+                        e1 = simd::add(e1, step1);
+                        e2 = simd::add(e2, step2);
+                        z = simd::add(z, zStep);
+                    }
+                }
+            }
+
+            // the coarse level of the blocks this tile owns
+            for (uint32_t by = tileY / BLOCK_SIZE; by < (tileY + TILE_HEIGHT) / BLOCK_SIZE; by++) {
+                for (uint32_t bx = tileX / BLOCK_SIZE; bx < (tileX + TILE_WIDTH) / BLOCK_SIZE; bx++) {
+                    simd::vfloat blockMin = simd::set1(std::numeric_limits<float>::max());
+                    for (uint32_t y = by * BLOCK_SIZE; y < (by + 1) * BLOCK_SIZE; y++) {
+                        for (uint32_t x = bx * BLOCK_SIZE; x < (bx + 1) * BLOCK_SIZE; x += simd::LANES) {
+                            blockMin = simd::min(blockMin, simd::loadu(&buffer.depth[y * WIDTH + x]));
+                        }
+                    }
+                    alignas(simd::ALIGNMENT) float lanesMin[simd::LANES];
+                    simd::store(lanesMin, blockMin);
+                    buffer.blockMin[by * BLOCKS_X + bx] = *std::min_element(lanesMin, lanesMin + simd::LANES);
+                }
+            }
+        }
+
+    } // namespace
+
+    DepthBuffer::DepthBuffer() : depth(WIDTH * HEIGHT, 0.f), blockMin(BLOCKS_X * BLOCKS_Y, 0.f) {}
+
+    void DepthBuffer::clear() {
+        std::fill(depth.begin(), depth.end(), 0.f);
+        std::fill(blockMin.begin(), blockMin.end(), 0.f);
+    }
+
+    uint32_t rasterize(DepthBuffer &buffer, std::span<const Occluder> occluders, JobSystem *jobs) {
+        buffer.clear();
+
+        // transform, clip and set up each occluder on its own, then bin the triangles into the tiles they touch
+        buffer.occluderTriangles.resize(std::max(buffer.occluderTriangles.size(), occluders.size()));
+        auto setup = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                setup_occluder(occluders[i], buffer.occluderTriangles[i]);
+            }
+        };
+        if (jobs && occluders.size() > 1) {
+            jobs->parallel_for(occluders.size(), 1, setup);
+        } else {
+            setup(0, occluders.size());
+        }
+
+        buffer.triangles.clear();
+        for (size_t i = 0; i < occluders.size(); i++) {
+            buffer.triangles.insert(buffer.triangles.end(), buffer.occluderTriangles[i].begin(),
+                                    buffer.occluderTriangles[i].end());
+        }
+        for (std::vector<uint32_t> &bin: buffer.bins) {
+            bin.clear();
+        }
+        for (uint32_t i = 0; i < buffer.triangles.size(); i++) {
+            const ScreenTriangle &t = buffer.triangles[i];
+            for (uint32_t ty = t.minY / TILE_HEIGHT; ty <= t.maxY / TILE_HEIGHT; ty++) {
+                for (uint32_t tx = t.minX / TILE_WIDTH; tx <= t.maxX / TILE_WIDTH; tx++) {
+                    buffer.bins[ty * TILES_X + tx].push_back(i);
+                }
+            }
+        }
+
+        // tiles share no pixels, each one is a job of its own
+        auto raster = [&](size_t begin, size_t end) {
+            for (size_t tile = begin; tile < end; tile++) {
+                rasterize_tile(buffer, static_cast<uint32_t>(tile));
+            }
+        };
+        if (jobs && !buffer.triangles.empty()) {
+            jobs->parallel_for(buffer.bins.size(), 1, raster);
+        } else {
+            raster(0, buffer.bins.size());
+        }
+        return static_cast<uint32_t>(buffer.triangles.size());
+    }
+
+    bool occluded(const DepthBuffer &buffer, const glm::vec3 &center, const glm::vec3 &extents,
+                  const glm::mat4 &viewproj) {
+        const glm::vec4 c = viewproj * glm::vec4(center, 1.f);
+        const glm::vec4 ax = viewproj[0] * extents.x;
+        const glm::vec4 ay = viewproj[1] * extents.y;
+        const glm::vec4 az = viewproj[2] * extents.z;
+
+        float minX = std::numeric_limits<float>::max();
+        float minY = std::numeric_limits<float>::max();
+        float maxX = std::numeric_limits<float>::lowest();
+        float maxY = std::numeric_limits<float>::lowest();
+        float nearest = 0.f;
+        for (uint32_t corner = 0; corner < 8; corner++) {
+            const glm::vec4 v = c + ((corner & 1) ? ax : -ax) + ((corner & 2) ? ay : -ay) + ((corner & 4) ? az : -az);
+            if (!(v.w - v.z >= 0.f) || !(v.w > 0.f)) {
+                return false;
+            }
+            const float invW = 1.f / v.w;
+            minX = std::min(minX, v.x * invW);
+            maxX = std::max(maxX, v.x * invW);
+            minY = std::min(minY, v.y * invW);
+            maxY = std::max(maxY, v.y * invW);
+            nearest = std::max(nearest, v.z * invW);
+        }
+
+        // every pixel the projection touches, not only the ones whose center it covers
+        minX = (minX * 0.5f + 0.5f) * static_cast<float>(WIDTH);
+        maxX = (maxX * 0.5f + 0.5f) * static_cast<float>(WIDTH);
+        minY = (minY * 0.5f + 0.5f) * static_cast<float>(HEIGHT);
+        maxY = (maxY * 0.5f + 0.5f) * static_cast<float>(HEIGHT);
+        if (maxX < 0.f || maxY < 0.f || minX >= static_cast<float>(WIDTH) || minY >= static_cast<float>(HEIGHT)) {
+            return false;
+        }
+        const auto x0 = static_cast<uint32_t>(std::max(minX, 0.f));
+        const auto y0 = static_cast<uint32_t>(std::max(minY, 0.f));
+        const auto x1 = static_cast<uint32_t>(std::min(maxX, static_cast<float>(WIDTH - 1)));
+        const auto y1 = static_cast<uint32_t>(std::min(maxY, static_cast<float>(HEIGHT - 1)));
+
+        // the blocks cover more than the box, when even their farthest depth is nearer the box is hidden
+        bool hidden = true;
+        for (uint32_t by = y0 / BLOCK_SIZE; hidden && by <= y1 / BLOCK_SIZE; by++) {
+            for (uint32_t bx = x0 / BLOCK_SIZE; bx <= x1 / BLOCK_SIZE; bx++) {
+                if (!(buffer.blockMin[by * BLOCKS_X + bx] > nearest)) {
+                    hidden = false;
+                    break;
+                }
+            }
+        }
+        if (hidden) {
+            return true;
+        }
+
+        const simd::vfloat boxDepth = simd::set1(nearest);
+        constexpr int allLanes = (1 << simd::LANES) - 1;
+        for (uint32_t y = y0; y <= y1; y++) {
+            const float *row = buffer.depth.data() + static_cast<size_t>(y) * WIDTH;
+            uint32_t x = x0;
+            for (; x + simd::LANES <= x1 + 1; x += simd::LANES) {
+                if (simd::mask_gt(simd::loadu(row + x), boxDepth) != allLanes) {
+                    return false;
+                }
+            }
+            for (; x <= x1; x++) {
+                if (!(row[x] > nearest)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+} // namespace occlusion
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <span>
+#include <vector>
+
+class JobSystem;
+
+// CPU occlusion culling against a small software rendered depth buffer. A few large occluders are rasterized
+// into it, tile by tile on the job system with simd::LANES pixels per step, then the screen space box of every
+// surface is tested against it. Depth is reversed like the engine's camera: 1 at the near plane, 0 where
+// nothing was drawn.
+namespace occlusion {
+
+    constexpr uint32_t WIDTH = 256;
+    constexpr uint32_t HEIGHT = 128;
+    // one rasterizer job per tile, a tile row is a whole number of simd lanes
+    constexpr uint32_t TILE_WIDTH = 64;
+    constexpr uint32_t TILE_HEIGHT = 32;
+    constexpr uint32_t TILES_X = WIDTH / TILE_WIDTH;
+    constexpr uint32_t TILES_Y = HEIGHT / TILE_HEIGHT;
+    // the coarse level the box test tries first, the farthest depth of every BLOCK_SIZE square
+    constexpr uint32_t BLOCK_SIZE = 8;
+    constexpr uint32_t BLOCKS_X = WIDTH / BLOCK_SIZE;
+    constexpr uint32_t BLOCKS_Y = HEIGHT / BLOCK_SIZE;
+    static_assert(WIDTH % TILE_WIDTH == 0 && HEIGHT % TILE_HEIGHT == 0);
+    static_assert(TILE_WIDTH % BLOCK_SIZE == 0 && TILE_HEIGHT % BLOCK_SIZE == 0);
+
+    // surfaces with more triangles keep no occluder geometry, their detail would cost more than they hide
+    constexpr uint32_t MAX_OCCLUDER_TRIANGLES = 4096;
+    // nor do surfaces with a smaller bounding sphere in mesh space (glTF metres), they would rarely cover
+    // enough of the screen to be picked
+    constexpr float MIN_OCCLUDER_RADIUS = 0.5f;
+
+    // whether a surface keeps its triangles for the rasterizer, alpha tested ones have holes and never occlude
+    constexpr bool keeps_occluder(uint32_t triangleCount, float sphereRadius, bool alphaMasked) {
+        return !alphaMasked && triangleCount <= MAX_OCCLUDER_TRIANGLES && sphereRadius >= MIN_OCCLUDER_RADIUS;
+    }
+
+    // model space triangle soup of a surface, three corners per triangle
+    struct OccluderMesh {
+        std::vector<glm::vec3> corners;
+
+        [[nodiscard]] uint32_t triangle_count() const { return static_cast<uint32_t>(corners.size() / 3); }
+    };
+
+    struct Occluder {
+        const OccluderMesh *mesh;
+        glm::mat4 modelViewProj;
+    };
+
+    // a triangle ready to rasterize, in pixel coordinates
+    struct ScreenTriangle {
+        // edge functions a * x + b * y + c, moved inward half a pixel: all three >= 0 at the center of a pixel
+        // lying entirely inside
+        std::array<float, 3> a, b, c;
+        // depth at a pixel center, lowered by the most it changes within half a pixel so the whole pixel is at
+        // least this near. zMax is the nearest corner, the plane never has to reach past it
+        float z0, dzdx, dzdy, zMax;
+        // inclusive pixel bounds, clamped to the buffer
+        int minX, minY, maxX, maxY;
+    };
+
+    struct DepthBuffer {
+        // WIDTH * HEIGHT, row major
+        std::vector<float> depth;
+        // BLOCKS_X * BLOCKS_Y, the smallest depth of each block
+        std::vector<float> blockMin;
+
+        // scratch of rasterize, kept so the allocations are reused from frame to frame
+        std::vector<std::vector<ScreenTriangle>> occluderTriangles;
+        std::vector<ScreenTriangle> triangles;
+        std::array<std::vector<uint32_t>, TILES_X * TILES_Y> bins;
+
+        DepthBuffer();
+        void clear();
+        [[nodiscard]] float at(uint32_t x, uint32_t y) const { return depth[y * WIDTH + x]; }
+    };
+
+    // clips every occluder triangle against the near plane (z <= w), then rasterizes it into the tiles it
+    // overlaps, keeping the nearest depth. Only pixels a triangle covers entirely are written, both faces are
+    // drawn. Returns the triangles that reached the rasterizer
+    uint32_t rasterize(DepthBuffer &buffer, std::span<const Occluder> occluders, JobSystem *jobs = nullptr);
+
+    // true when the world space box is behind the buffer at every pixel its projection touches. Written pixels
+    // are fully covered at no nearer than their depth, so a hidden box is hidden at every screen resolution. A
+    // box crossing the near plane or off screen is never occluded, frustum culling decides those
+    bool occluded(const DepthBuffer &buffer, const glm::vec3 &center, const glm::vec3 &extents,
+                  const glm::mat4 &viewproj);
+
+} // namespace occlusion
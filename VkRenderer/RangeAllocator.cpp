@@ -0,0 +1,86 @@
+#include "RangeAllocator.h"
+
+#include <cassert>
+
+RangeAllocator::RangeAllocator(uint64_t capacity, uint64_t granularity) :
+    _capacity(capacity), _granularity(granularity == 0 ? 1 : granularity) {
+    if (capacity > 0) {
+        insert_free(0, capacity);
+    }
+}
+
+uint64_t RangeAllocator::allocate(uint64_t size) {
+    // zero sized requests still get a distinct offset so they can be freed like any other range
+    size = size == 0 ? _granularity : (size + _granularity - 1) / _granularity * _granularity;
+
+    const auto best = _freeBySize.lower_bound(size);
+    if (best == _freeBySize.end()) {
+        return INVALID_OFFSET;
+    }
+
+    const uint64_t offset = best->second;
+    const uint64_t freeSize = best->first;
+    erase_free(_freeByOffset.find(offset));
+
+    // hand out the front, the rest stays free
+    if (freeSize > size) {
+        insert_free(offset + size, freeSize - size);
+    }
+
+    _allocations[offset] = size;
+    _used += size;
+    return offset;
+}
+
+void RangeAllocator::free(uint64_t offset) {
+    const auto allocation = _allocations.find(offset);
+    assert(allocation != _allocations.end() && "freeing a range that was not allocated");
+    if (allocation == _allocations.end()) {
+        return;
+    }
+
+    uint64_t start = offset;
+    uint64_t size = allocation->second;
+    _used -= size;
+    _allocations.erase(allocation);
+
+    // merge with the free range right after
+    const auto next = _freeByOffset.find(start + size);
+    if (next != _freeByOffset.end()) {
+        size += next->second;
+        erase_free(next);
+    }
+
+    // and with the one right before
+    auto prev = _freeByOffset.lower_bound(start);
+    if (prev != _freeByOffset.begin()) {
+        --prev;
+        if (prev->first + prev->second == start) {
+            start = prev->first;
+            size += prev->second;
+            erase_free(prev);
+        }
+    }
+
+    insert_free(start, size);
+}
+
+uint64_t RangeAllocator::largest_free_range() const {
+    return _freeBySize.empty() ? 0 : _freeBySize.rbegin()->first;
+}
+
+void RangeAllocator::insert_free(uint64_t offset, uint64_t size) {
+    _freeByOffset[offset] = size;
+    _freeBySize.emplace(size, offset);
+}
+
+void RangeAllocator::erase_free(std::map<uint64_t, uint64_t>::iterator it) {
+    auto [begin, end] = _freeBySize.equal_range(it->second);
+    for (auto bySize = begin; bySize != end; ++bySize) {
+        if (bySize->second == it->first) {
+            _freeBySize.erase(bySize);
+            break;
+        }
+    }
+    _freeByOffset.erase(it);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+
+// Free-list suballocator for one linear range, e.g. a megabuffer of the geometry arena.
+// Free ranges are kept both by offset (to merge neighbours on free) and by size (best fit on allocate),
+// so both operations are O(log n) in the number of free ranges. Sizes are rounded up to the granularity,
+// which keeps every offset aligned to it.
+class RangeAllocator {
+public:
+    static constexpr uint64_t INVALID_OFFSET = ~0ull;
+
+    RangeAllocator() = default;
+    RangeAllocator(uint64_t capacity, uint64_t granularity);
+
+    // offset of `size` free bytes, INVALID_OFFSET when no free range is large enough
+    uint64_t allocate(uint64_t size);
+    // returns a range handed out by allocate, merging it with free neighbours
+    void free(uint64_t offset);
+
+    [[nodiscard]] uint64_t capacity() const { return _capacity; }
+    [[nodiscard]] uint64_t used() const { return _used; }
+    [[nodiscard]] size_t allocation_count() const { return _allocations.size(); }
+    [[nodiscard]] size_t free_range_count() const { return _freeByOffset.size(); }
+    [[nodiscard]] uint64_t largest_free_range() const;
+    [[nodiscard]] bool empty() const { return _allocations.empty(); }
+
+private:
+    void insert_free(uint64_t offset, uint64_t size);
+    void erase_free(std::map<uint64_t, uint64_t>::iterator it);
+
+    uint64_t _capacity{0};
+    uint64_t _granularity{1};
+    uint64_t _used{0};
+
+    std::map<uint64_t, uint64_t> _freeByOffset; // offset -> size
+    std::multimap<uint64_t, uint64_t> _freeBySize; // size -> offset
+    std::unordered_map<uint64_t, uint64_t> _allocations; // offset -> size
+};
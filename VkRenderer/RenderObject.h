@@ -9,15 +9,56 @@ struct RenderObject {
     uint32_t firstIndex;
     uint32_t vertexCount;
     VkBuffer indexBuffer;
+    VkIndexType indexType;
+    int32_t vertexOffset; // added to every index, the surface's indices are rebased on its first vertex
 
     MaterialInstance *material;
     Bounds bounds;
     glm::mat4 transform;
     VkDeviceAddress vertexBufferAddress;
     VkDeviceAddress indexBufferAddress;
+    // first meshlet of the surface, 0 when it has none
+    VkDeviceAddress meshletBufferAddress;
+    uint32_t meshletCount;
+    // meshlets::cull_flags of the surface's material and pipeline, GPUMeshletCullJob::flags
+    uint32_t meshletCullFlags;
+    // coarser ranges of the surface, startIndex already offset like firstIndex. VulkanEngine::select_lods
+    // swaps one of them into firstIndex/indexCount and records its level, 0 being full detail
+    uint32_t lodCount;
+    std::array<SurfaceLod, simplify::MAX_LODS> lods;
+    uint32_t lod;
+    // what select_lods swaps back for level 0, the draw lists are kept across frames
+    uint32_t fullFirstIndex;
+    uint32_t fullIndexCount;
+    uint32_t fullMeshletCount;
+    // flat index of the surface's node in its scene's TransformHierarchy, a moved node patches its surfaces
+    uint32_t node;
+    // model space triangles the occlusion rasterizer can draw, null unless occlusion::keeps_occluder
+    const occlusion::OccluderMesh *occluder;
+    // pass, pipeline, material and index binding of the surface's drawsort key, VulkanEngine::sort_draws adds depth
+    uint64_t stateKey;
+    VertexFormat vertexFormat;
+    VertexQuantization quantization;
 };
 
+// push constants of the mesh passes, everything the vertex shaders need to fetch and decode r's vertices
+inline GPUDrawPushConstants draw_push_constants(const RenderObject &r) {
+    GPUDrawPushConstants push_constants{};
+    push_constants.worldMatrix = r.transform;
+    push_constants.vertexBuffer = r.vertexBufferAddress;
+    push_constants.vertexFormat = static_cast<uint32_t>(r.vertexFormat);
+    push_constants.positionScale = glm::vec4(r.quantization.scale, 0.f);
+    push_constants.positionOffset = glm::vec4(r.quantization.offset, 0.f);
+    return push_constants;
+}
+
 struct DrawContext {
     std::vector<RenderObject> OpaqueSurfaces;
     std::vector<RenderObject> TransparentSurfaces;
+};
+
+// the surfaces of a DrawContext one pass draws, as indices into its two lists
+struct VisibleSurfaces {
+    std::vector<uint32_t> opaque;
+    std::vector<uint32_t> transparent;
 };
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "SceneDiff.h"
+
+#include <algorithm>
+
+namespace scenediff {
+
+    namespace {
+
+        std::vector<uint32_t> changed_indices(const std::vector<uint64_t> &loaded,
+                                              const std::vector<uint64_t> &changed) {
+            std::vector<uint32_t> indices;
+            for (size_t i = 0; i < changed.size(); i++) {
+                if (i >= loaded.size() || loaded[i] != changed[i]) {
+                    indices.push_back(static_cast<uint32_t>(i));
+                }
+            }
+            return indices;
+        }
+
+    } // namespace
+
+    SceneDiff diff(const SceneHashes &loaded, const SceneHashes &changed) {
+        SceneDiff result;
+        if (loaded.structure != changed.structure || loaded.images.size() != changed.images.size() ||
+            loaded.materials.size() != changed.materials.size() || loaded.meshes.size() != changed.meshes.size() ||
+            loaded.nodes.size() != changed.nodes.size()) {
+            result.structural = true;
+            return result;
+        }
+
+        result.images = changed_indices(loaded.images, changed.images);
+        result.materials = changed_indices(loaded.materials, changed.materials);
+        result.meshes = changed_indices(loaded.meshes, changed.meshes);
+        result.nodes = changed_indices(loaded.nodes, changed.nodes);
+
+        // materials whose own hash held still but that sample a changed image
+        if (!result.images.empty()) {
+            for (size_t m = 0; m < changed.materialImages.size(); m++) {
+                const bool samplesChanged = std::ranges::any_of(changed.materialImages[m], [&](uint32_t image) {
+                    return std::ranges::binary_search(result.images, image);
+                });
+                if (samplesChanged && !std::ranges::binary_search(result.materials, static_cast<uint32_t>(m))) {
+                    result.materials.insert(std::ranges::upper_bound(result.materials, static_cast<uint32_t>(m)),
+                                            static_cast<uint32_t>(m));
+                }
+            }
+        }
+        return result;
+    }
+
+    InstanceDiff diff_instances(std::span<const Instance> built, std::span<const Instance> current) {
+        InstanceDiff result;
+        if (built.size() != current.size()) {
+            result.rebuildAll = true;
+            result.tlas = true;
+            return result;
+        }
+        for (size_t i = 0; i < current.size(); i++) {
+            if (built[i].transparent != current[i].transparent) {
+                // a material went from opaque to blended or back, the instance order changed with it
+                result.rebuildAll = true;
+                result.tlas = true;
+                result.blas.clear();
+                return result;
+            }
+            if (built[i].geometry != current[i].geometry) {
+                result.blas.push_back(static_cast<uint32_t>(i));
+            }
+            if (built[i].transform != current[i].transform) {
+                result.tlas = true;
+            }
+        }
+        result.tlas = result.tlas || !result.blas.empty();
+        return result;
+    }
+
+} // namespace scenediff
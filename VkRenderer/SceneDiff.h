@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// What a hot reload of a glTF has to redo, decided from content hashes so it is free of Vulkan and fastgltf. The
+// loader hashes every image, material, mesh and node of a file in glTF index order, a changed file is diffed
+// against the hashes of the scene already loaded and only the assets whose hash moved are uploaded again.
+namespace scenediff {
+
+    struct SceneHashes {
+        // asset counts, the node hierarchy and the texture and sampler tables. when it differs nothing can be
+        // patched in place and the file loads from scratch
+        uint64_t structure{0};
+        std::vector<uint64_t> images;
+        std::vector<uint64_t> materials;
+        std::vector<uint64_t> meshes;
+        std::vector<uint64_t> nodes;
+        // images every material samples, a material whose image changed has to rewrite its descriptor set
+        std::vector<std::vector<uint32_t>> materialImages;
+    };
+
+    // indices of the assets that changed, ascending
+    struct SceneDiff {
+        bool structural{false};
+        std::vector<uint32_t> images;
+        std::vector<uint32_t> materials;
+        std::vector<uint32_t> meshes;
+        std::vector<uint32_t> nodes;
+
+        [[nodiscard]] bool empty() const {
+            return !structural && images.empty() && materials.empty() && meshes.empty() && nodes.empty();
+        }
+    };
+
+    SceneDiff diff(const SceneHashes &loaded, const SceneHashes &changed);
+
+    // one ray tracing instance, hashed from the draw it was built from
+    struct Instance {
+        uint64_t geometry{0}; // buffers, ranges and vertex format the BLAS was built over
+        uint64_t transform{0};
+        bool transparent{false}; // picks the hit group, and transparent instances follow all opaque ones
+    };
+
+    struct InstanceDiff {
+        // the instance list changed shape, every acceleration structure and description buffer is rebuilt
+        bool rebuildAll{false};
+        // BLAS whose geometry changed, by instance index
+        std::vector<uint32_t> blas;
+        // a rebuilt BLAS has a new address and a moved instance a new transform, both need a new TLAS
+        bool tlas{false};
+    };
+
+    InstanceDiff diff_instances(std::span<const Instance> built, std::span<const Instance> current);
+
+} // namespace scenediff
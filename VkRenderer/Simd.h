@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+// Thin wrapper over the widest float SIMD the build targets, so CPU hot loops can be written once.
+// AVX2 is used when the compiler targets it (ENABLE_AVX2 in CMake), SSE2 on any other x86-64 build
+// and a one lane scalar fallback everywhere else.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define EXPERIRENDER_SIMD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define EXPERIRENDER_SIMD_SSE2 1
+#endif
+
+namespace simd {
+
+#if defined(EXPERIRENDER_SIMD_AVX2)
+    using vfloat = __m256;
+    constexpr size_t LANES = 8;
+    constexpr const char *NAME = "AVX2";
+
+    inline vfloat load(const float *p) { return _mm256_load_ps(p); }
+    inline void store(float *p, vfloat v) { _mm256_store_ps(p, v); }
+    inline vfloat loadu(const float *p) { return _mm256_loadu_ps(p); }
+    inline void storeu(float *p, vfloat v) { _mm256_storeu_ps(p, v); }
+    inline vfloat set1(float f) { return _mm256_set1_ps(f); }
+    inline vfloat add(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+    inline vfloat sub(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+    inline vfloat mul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+    inline vfloat div(vfloat a, vfloat b) { return _mm256_div_ps(a, b); }
+    inline vfloat sqrt(vfloat a) { return _mm256_sqrt_ps(a); }
+    inline vfloat min(vfloat a, vfloat b) { return _mm256_min_ps(a, b); }
+    inline vfloat max(vfloat a, vfloat b) { return _mm256_max_ps(a, b); }
+    // one bit per lane, set where the comparison holds
+    inline int mask_gt(vfloat a, vfloat b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_GT_OQ)); }
+    inline int mask_lt(vfloat a, vfloat b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LT_OQ)); }
+#elif defined(EXPERIRENDER_SIMD_SSE2)
+    using vfloat = __m128;
+    constexpr size_t LANES = 4;
+    constexpr const char *NAME = "SSE2";
+
+    inline vfloat load(const float *p) { return _mm_load_ps(p); }
+    inline void store(float *p, vfloat v) { _mm_store_ps(p, v); }
+    inline vfloat loadu(const float *p) { return _mm_loadu_ps(p); }
+    inline void storeu(float *p, vfloat v) { _mm_storeu_ps(p, v); }
+    inline vfloat set1(float f) { return _mm_set1_ps(f); }
+    inline vfloat add(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+    inline vfloat sub(vfloat a, vfloat b) { return _mm_sub_ps(a, b); }
+    inline vfloat mul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+    inline vfloat div(vfloat a, vfloat b) { return _mm_div_ps(a, b); }
+    inline vfloat sqrt(vfloat a) { return _mm_sqrt_ps(a); }
+    inline vfloat min(vfloat a, vfloat b) { return _mm_min_ps(a, b); }
+    inline vfloat max(vfloat a, vfloat b) { return _mm_max_ps(a, b); }
+    inline int mask_gt(vfloat a, vfloat b) { return _mm_movemask_ps(_mm_cmpgt_ps(a, b)); }
+    inline int mask_lt(vfloat a, vfloat b) { return _mm_movemask_ps(_mm_cmplt_ps(a, b)); }
+#else
+    using vfloat = float;
+    constexpr size_t LANES = 1;
+    constexpr const char *NAME = "scalar";
+
+    inline vfloat load(const float *p) { return *p; }
+    inline void store(float *p, vfloat v) { *p = v; }
+    inline vfloat loadu(const float *p) { return *p; }
+    inline void storeu(float *p, vfloat v) { *p = v; }
+    inline vfloat set1(float f) { return f; }
+    inline vfloat add(vfloat a, vfloat b) { return a + b; }
+    inline vfloat sub(vfloat a, vfloat b) { return a - b; }
+    inline vfloat mul(vfloat a, vfloat b) { return a * b; }
+    inline vfloat div(vfloat a, vfloat b) { return a / b; }
+    inline vfloat sqrt(vfloat a) { return std::sqrt(a); }
+    inline vfloat min(vfloat a, vfloat b) { return a < b ? a : b; }
+    inline vfloat max(vfloat a, vfloat b) { return a > b ? a : b; }
+    inline int mask_gt(vfloat a, vfloat b) { return a > b ? 1 : 0; }
+    inline int mask_lt(vfloat a, vfloat b) { return a < b ? 1 : 0; }
+#endif
+
+    // lane aligned scratch for gathering AoS data into SoA registers
+    constexpr size_t ALIGNMENT = LANES * sizeof(float) < 16 ? 16 : LANES * sizeof(float);
+
+} // namespace simd
@@ -0,0 +1,325 @@
+#include "Simplify.h"
+
+#include <MeshOptimize.h>
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <numeric>
+#include <unordered_map>
+
+namespace {
+    // a level has to drop at least this share of the previous level's triangles to be kept
+    constexpr float MIN_LEVEL_REDUCTION = 0.2f;
+
+    // sum of squared distances to a set of planes, area weighted: p^T A p + 2 b.p + c over the total area
+    struct Quadric {
+        double a00, a01, a02, a11, a12, a22;
+        double b0, b1, b2;
+        double c;
+        double weight;
+    };
+
+    void add_quadric(Quadric &q, const Quadric &other) {
+        q.a00 += other.a00;
+        q.a01 += other.a01;
+        q.a02 += other.a02;
+        q.a11 += other.a11;
+        q.a12 += other.a12;
+        q.a22 += other.a22;
+        q.b0 += other.b0;
+        q.b1 += other.b1;
+        q.b2 += other.b2;
+        q.c += other.c;
+        q.weight += other.weight;
+    }
+
+    Quadric plane_quadric(const glm::vec3 &p0, const glm::vec3 &p1, const glm::vec3 &p2) {
+        Quadric q{};
+        const glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        const float length = glm::length(normal);
+        if (length == 0.f) {
+            return q;
+        }
+
+        const double area = 0.5 * length;
+        const double x = normal.x / length;
+        const double y = normal.y / length;
+        const double z = normal.z / length;
+        const double d = -(x * p0.x + y * p0.y + z * p0.z);
+
+        q.a00 = area * x * x;
+        q.a01 = area * x * y;
+        q.a02 = area * x * z;
+        q.a11 = area * y * y;
+        q.a12 = area * y * z;
+        q.a22 = area * z * z;
+        q.b0 = area * x * d;
+        q.b1 = area * y * d;
+        q.b2 = area * z * d;
+        q.c = area * d * d;
+        q.weight = area;
+        return q;
+    }
+
+    // mean squared distance of p to the planes of a + b
+    double collapse_error(const Quadric &a, const Quadric &b, const glm::vec3 &p) {
+        Quadric q = a;
+        add_quadric(q, b);
+
+        const double x = p.x;
+        const double y = p.y;
+        const double z = p.z;
+        const double error = q.a00 * x * x + q.a11 * y * y + q.a22 * z * z +
+                             2.0 * (q.a01 * x * y + q.a02 * x * z + q.a12 * y * z) +
+                             2.0 * (q.b0 * x + q.b1 * y + q.b2 * z) + q.c;
+        return std::max(error, 0.0) / std::max(q.weight, 1e-12);
+    }
+
+    struct Collapse {
+        uint32_t from;
+        uint32_t to;
+        double cost;
+    };
+} // namespace
+
+namespace simplify {
+
+    std::vector<uint32_t> simplify(std::span<const uint32_t> indices, std::span<const Vertex> vertices,
+                                   uint32_t baseVertex, size_t targetIndexCount, float maxError, float *resultError) {
+        const size_t vertexCount = vertices.size();
+
+        // works on range local vertex numbers from here on
+        std::vector<uint32_t> result(indices.begin(), indices.end());
+        for (uint32_t &index: result) {
+            index -= baseVertex;
+        }
+
+        // vertices split for their normals or UVs share a position, topology is judged on welded positions
+        std::vector<uint32_t> order(vertexCount);
+        std::iota(order.begin(), order.end(), 0u);
+        auto position_less = [&](uint32_t a, uint32_t b) {
+            const glm::vec3 &pa = vertices[a].position;
+            const glm::vec3 &pb = vertices[b].position;
+            if (pa.x != pb.x) {
+                return pa.x < pb.x;
+            }
+            if (pa.y != pb.y) {
+                return pa.y < pb.y;
+            }
+            return pa.z < pb.z;
+        };
+        std::sort(order.begin(), order.end(), position_less);
+
+        std::vector<uint32_t> positionId(vertexCount);
+        std::vector<uint8_t> locked(vertexCount, 0);
+        for (size_t i = 0; i < vertexCount;) {
+            size_t end = i + 1;
+            while (end < vertexCount && vertices[order[end]].position == vertices[order[i]].position) {
+                end++;
+            }
+            for (size_t j = i; j < end; j++) {
+                positionId[order[j]] = order[i];
+                // collapsing one side of a seam would tear it open
+                locked[order[j]] = end - i > 1 ? 1 : 0;
+            }
+            i = end;
+        }
+
+        // edges used by anything but exactly two triangles are open borders or non-manifold, pin their ends
+        auto edge_key = [&](uint32_t a, uint32_t b) {
+            const uint64_t pa = positionId[a];
+            const uint64_t pb = positionId[b];
+            return pa < pb ? (pa << 32) | pb : (pb << 32) | pa;
+        };
+        std::unordered_map<uint64_t, uint32_t> edgeUses;
+        edgeUses.reserve(result.size());
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (uint32_t e = 0; e < 3; e++) {
+                edgeUses[edge_key(result[i + e], result[i + (e + 1) % 3])]++;
+            }
+        }
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (uint32_t e = 0; e < 3; e++) {
+                const uint32_t a = result[i + e];
+                const uint32_t b = result[i + (e + 1) % 3];
+                if (edgeUses[edge_key(a, b)] != 2) {
+                    locked[a] = 1;
+                    locked[b] = 1;
+                }
+            }
+        }
+
+        std::vector<Quadric> quadrics(vertexCount, Quadric{});
+        for (size_t i = 0; i < result.size(); i += 3) {
+            const Quadric q = plane_quadric(vertices[result[i]].position, vertices[result[i + 1]].position,
+                                            vertices[result[i + 2]].position);
+            add_quadric(quadrics[result[i]], q);
+            add_quadric(quadrics[result[i + 1]], q);
+            add_quadric(quadrics[result[i + 2]], q);
+        }
+
+        const double errorLimit = static_cast<double>(maxError) * static_cast<double>(maxError);
+        double worstError = 0.0;
+
+        std::vector<uint32_t> remap(vertexCount);
+        std::vector<uint8_t> touched(vertexCount);
+        std::vector<uint32_t> triangleOffsets(vertexCount + 1);
+        std::vector<uint32_t> vertexTriangles;
+        std::vector<Collapse> collapses;
+
+        // one pass collapses a set of independent edges, cheapest first, then rebuilds the adjacency
+        while (result.size() > targetIndexCount) {
+            const size_t triangleCount = result.size() / 3;
+
+            std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0u);
+            for (const uint32_t index: result) {
+                triangleOffsets[index + 1]++;
+            }
+            std::partial_sum(triangleOffsets.begin(), triangleOffsets.end(), triangleOffsets.begin());
+            vertexTriangles.resize(result.size());
+            {
+                std::vector<uint32_t> cursor(triangleOffsets.begin(), triangleOffsets.end() - 1);
+                for (size_t i = 0; i < result.size(); i++) {
+                    vertexTriangles[cursor[result[i]]++] = static_cast<uint32_t>(i / 3);
+                }
+            }
+
+            // interior edges show up once in each direction, border edges have both ends locked
+            collapses.clear();
+            for (size_t i = 0; i < result.size(); i += 3) {
+                for (uint32_t e = 0; e < 3; e++) {
+                    const uint32_t a = result[i + e];
+                    const uint32_t b = result[i + (e + 1) % 3];
+                    if (a > b) {
+                        continue;
+                    }
+                    if (!locked[a]) {
+                        collapses.push_back({a, b, collapse_error(quadrics[a], quadrics[b], vertices[b].position)});
+                    }
+                    if (!locked[b]) {
+                        collapses.push_back({b, a, collapse_error(quadrics[a], quadrics[b], vertices[a].position)});
+                    }
+                }
+            }
+            std::sort(collapses.begin(), collapses.end(),
+                      [](const Collapse &a, const Collapse &b) { return a.cost < b.cost; });
+
+            std::iota(remap.begin(), remap.end(), 0u);
+            std::fill(touched.begin(), touched.end(), uint8_t(0));
+
+            const size_t trianglesToRemove = (result.size() - targetIndexCount + 2) / 3;
+            size_t removed = 0;
+            size_t collapsed = 0;
+            for (const Collapse &c: collapses) {
+                if (c.cost > errorLimit || removed >= trianglesToRemove) {
+                    break;
+                }
+                if (touched[c.from] || touched[c.to]) {
+                    continue;
+                }
+
+                // moving `from` onto `to` must not turn any surviving triangle around
+                const glm::vec3 &target = vertices[c.to].position;
+                bool flips = false;
+                size_t dying = 0;
+                for (uint32_t t = triangleOffsets[c.from]; t < triangleOffsets[c.from + 1] && !flips; t++) {
+                    const uint32_t *tri = &result[vertexTriangles[t] * 3];
+                    if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) {
+                        dying++;
+                        continue;
+                    }
+                    glm::vec3 p[3];
+                    glm::vec3 moved[3];
+                    for (uint32_t k = 0; k < 3; k++) {
+                        p[k] = vertices[tri[k]].position;
+                        moved[k] = tri[k] == c.from ? target : p[k];
+                    }
+                    const glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                    const glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+                    flips = glm::dot(before, after) <= 0.f;
+                }
+                if (flips) {
+                    continue;
+                }
+
+                remap[c.from] = c.to;
+                add_quadric(quadrics[c.to], quadrics[c.from]);
+                worstError = std::max(worstError, c.cost);
+                removed += dying;
+                collapsed++;
+
+                // the neighbourhood of `from` changed, nothing in it may collapse again until the next pass
+                for (uint32_t t = triangleOffsets[c.from]; t < triangleOffsets[c.from + 1]; t++) {
+                    const uint32_t *tri = &result[vertexTriangles[t] * 3];
+                    touched[tri[0]] = 1;
+                    touched[tri[1]] = 1;
+                    touched[tri[2]] = 1;
+                }
+            }
+
+            if (collapsed == 0) {
+                break;
+            }
+
+            size_t write = 0;
+            for (size_t i = 0; i < triangleCount * 3; i += 3) {
+                const uint32_t a = remap[result[i]];
+                const uint32_t b = remap[result[i + 1]];
+                const uint32_t c = remap[result[i + 2]];
+                if (a != b && b != c && a != c) {
+                    result[write++] = a;
+                    result[write++] = b;
+                    result[write++] = c;
+                }
+            }
+            result.resize(write);
+        }
+
+        for (uint32_t &index: result) {
+            index += baseVertex;
+        }
+        if (resultError) {
+            *resultError = static_cast<float>(std::sqrt(worstError));
+        }
+        return result;
+    }
+
+    std::vector<LodLevel> build_lods(std::span<const uint32_t> indices, std::span<const Vertex> vertices,
+                                     uint32_t baseVertex, uint32_t maxLevels) {
+        std::vector<LodLevel> levels;
+        if (indices.size() / 3 < MIN_TRIANGLES || vertices.empty()) {
+            return levels;
+        }
+
+        glm::vec3 minpos = vertices[indices[0] - baseVertex].position;
+        glm::vec3 maxpos = minpos;
+        for (const uint32_t index: indices) {
+            minpos = glm::min(minpos, vertices[index - baseVertex].position);
+            maxpos = glm::max(maxpos, vertices[index - baseVertex].position);
+        }
+        const float errorBudget = MAX_RELATIVE_ERROR * 0.5f * glm::length(maxpos - minpos);
+
+        // every level is simplified from the one before it, so the errors add up
+        levels.reserve(maxLevels);
+        std::span<const uint32_t> source = indices;
+        float error = 0.f;
+        for (uint32_t level = 0; level < maxLevels && error < errorBudget; level++) {
+            const size_t target = source.size() / 6 * 3;
+            float levelError = 0.f;
+            std::vector<uint32_t> simplified =
+                simplify(source, vertices, baseVertex, target, errorBudget - error, &levelError);
+
+            const auto keepLimit = static_cast<size_t>(static_cast<float>(source.size()) * (1.f - MIN_LEVEL_REDUCTION));
+            if (simplified.empty() || simplified.size() > keepLimit) {
+                break;
+            }
+
+            meshoptimize::optimize_vertex_cache(simplified, vertices.size(), baseVertex);
+            error += levelError;
+            levels.push_back(LodLevel{std::move(simplified), error});
+            source = levels.back().indices;
+        }
+        return levels;
+    }
+
+} // namespace simplify
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Vertex.h>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// One coarser index range of a surface. LOD indices live in the mesh index buffer after the full detail ones
+// and reference the same vertices, so switching level only changes the range a draw reads.
+struct SurfaceLod {
+    uint32_t startIndex; // relative to the mesh, like GeoSurface::startIndex
+    uint32_t count;
+    float error; // distance from the full detail surface in mesh space
+};
+
+// Level of detail generation for the loader. Like meshoptimize, `indices` index the mesh and `baseVertex` is the
+// mesh index of vertices[0].
+namespace simplify {
+
+    // coarser levels per surface, on top of the full detail range
+    constexpr uint32_t MAX_LODS = 4;
+    // surfaces below this are cheap enough as they are
+    constexpr size_t MIN_TRIANGLES = 128;
+    // levels further than this fraction of the surface's radius from the original are not generated
+    constexpr float MAX_RELATIVE_ERROR = 0.1f;
+
+    // Quadric error edge collapse (Garland & Heckbert 1997). Every collapse moves a vertex onto one of its
+    // neighbours, so the result keeps indexing the original vertices. Vertices on open borders and attribute
+    // seams stay put, collapses that would flip a triangle are skipped. Stops at `targetIndexCount` or when the
+    // next collapse would move the surface further than `maxError`. `resultError` receives the largest error
+    // accepted, in mesh units.
+    std::vector<uint32_t> simplify(std::span<const uint32_t> indices, std::span<const Vertex> vertices,
+                                   uint32_t baseVertex, size_t targetIndexCount, float maxError,
+                                   float *resultError = nullptr);
+
+    struct LodLevel {
+        std::vector<uint32_t> indices;
+        float error;
+    };
+
+    // halves the triangle count per level, each level simplified from the previous one and reordered for the
+    // vertex cache. the chain ends early once a level stops saving a meaningful amount of triangles
+    std::vector<LodLevel> build_lods(std::span<const uint32_t> indices, std::span<const Vertex> vertices,
+                                     uint32_t baseVertex, uint32_t maxLevels = MAX_LODS);
+
+} // namespace simplify
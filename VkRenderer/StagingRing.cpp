@@ -0,0 +1,44 @@
+#include "StagingRing.h"
+
+#include <cassert>
+
+StagingRing::StagingRing(uint64_t capacity, uint64_t alignment) :
+    _capacity(capacity), _alignment(alignment == 0 ? 1 : alignment) {}
+
+uint64_t StagingRing::allocate(uint64_t size) {
+    if (_capacity == 0 || size > _capacity) {
+        return INVALID_OFFSET;
+    }
+
+    uint64_t start = (_head + _alignment - 1) / _alignment * _alignment;
+    // skip to the start of the ring when the tail end is too short
+    if (start % _capacity + size > _capacity) {
+        start += _capacity - start % _capacity;
+    }
+    if (start + size - _tail > _capacity) {
+        return INVALID_OFFSET;
+    }
+
+    _head = start + size;
+    return start % _capacity;
+}
+
+void StagingRing::close_batch(uint64_t batch) {
+    assert(_batches.empty() || batch > _batches.back().id);
+    if (_head == _openStart) {
+        return;
+    }
+    _batches.push_back(Batch{batch, _head});
+    _openStart = _head;
+}
+
+void StagingRing::retire(uint64_t completedBatch) {
+    while (!_batches.empty() && _batches.front().id <= completedBatch) {
+        _tail = _batches.front().end;
+        _batches.pop_front();
+    }
+    // nothing left in flight or open, start over at the front so large allocations don't have to wrap
+    if (_batches.empty() && _head == _tail && _head == _openStart) {
+        _head = _tail = _openStart = 0;
+    }
+}
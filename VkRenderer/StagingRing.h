@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+// Bookkeeping for a persistent staging buffer used as a ring. Allocations are handed out front to back and
+// grouped into batches; a batch's bytes only become reusable once retire() is told the GPU finished it.
+// Positions are kept as ever growing byte counts so a full ring and an empty one can't be confused.
+class StagingRing {
+public:
+    static constexpr uint64_t INVALID_OFFSET = ~0ull;
+
+    StagingRing() = default;
+    StagingRing(uint64_t capacity, uint64_t alignment);
+
+    // offset of `size` contiguous bytes, INVALID_OFFSET when the in flight batches leave no room.
+    // an allocation never wraps, the unused tail before the wrap is charged to the open batch
+    uint64_t allocate(uint64_t size);
+    // everything allocated since the last close belongs to `batch`, ids must increase
+    void close_batch(uint64_t batch);
+    // releases every closed batch with an id <= completedBatch
+    void retire(uint64_t completedBatch);
+
+    [[nodiscard]] uint64_t capacity() const { return _capacity; }
+    [[nodiscard]] uint64_t used() const { return _head - _tail; }
+    // bytes allocated since the last close_batch
+    [[nodiscard]] uint64_t open_bytes() const { return _head - _openStart; }
+    [[nodiscard]] size_t batches_in_flight() const { return _batches.size(); }
+    // id of the oldest closed batch still holding ring space, 0 when there is none
+    [[nodiscard]] uint64_t oldest_batch() const { return _batches.empty() ? 0 : _batches.front().id; }
+
+private:
+    struct Batch {
+        uint64_t id;
+        uint64_t end;
+    };
+
+    uint64_t _capacity{0};
+    uint64_t _alignment{1};
+    uint64_t _head{0};
+    uint64_t _tail{0};
+    uint64_t _openStart{0};
+    std::deque<Batch> _batches;
+};
@@ -0,0 +1,133 @@
+#include "StreamingPolicy.h"
+
+#include <algorithm>
+#include <queue>
+
+namespace streaming {
+
+    std::optional<uint32_t> requested_level(uint32_t feedback, uint32_t residentTop, uint32_t levelCount) {
+        if (feedback == NO_REQUEST || levelCount == 0) {
+            return {};
+        }
+        const int64_t level = int64_t(residentTop) + int64_t(feedback) - int64_t(FEEDBACK_BIAS);
+        return static_cast<uint32_t>(std::clamp<int64_t>(level, 0, int64_t(levelCount) - 1));
+    }
+
+    uint32_t floor_level(std::span<const MipLevel> levels, uint32_t floorSize) {
+        for (uint32_t level = 0; level < levels.size(); level++) {
+            if (std::max(levels[level].width, levels[level].height) <= floorSize) {
+                return level;
+            }
+        }
+        return levels.empty() ? 0 : static_cast<uint32_t>(levels.size() - 1);
+    }
+
+    uint64_t tail_bytes(std::span<const MipLevel> levels, uint32_t top) {
+        if (top >= levels.size()) {
+            return 0;
+        }
+        // levels are packed back to back
+        return levels.back().offset + levels.back().size - levels[top].offset;
+    }
+
+    MipChainView tail(const MipChainView &chain, uint32_t top) {
+        return {chain.format, chain.levels.subspan(top), chain.data};
+    }
+
+    uint32_t update_demand(Demand &demand, std::optional<uint32_t> requested, uint64_t frame, uint32_t floorTop,
+                           uint32_t retainFrames) {
+        const bool expired = frame - demand.frame >= retainFrames;
+        if (requested.has_value()) {
+            const uint32_t top = std::min(*requested, floorTop);
+            if (top <= demand.top || expired) {
+                demand = {top, frame};
+            }
+        } else if (expired) {
+            demand = {floorTop, frame};
+        }
+        return demand.top;
+    }
+
+    std::vector<Change> plan(std::span<const Residency> textures, const Budget &budget) {
+        std::vector<uint32_t> tops(textures.size());
+        uint64_t total = 0;
+        for (size_t i = 0; i < textures.size(); i++) {
+            tops[i] = textures[i].residentTop;
+            total += tail_bytes(textures[i].levels, tops[i]);
+        }
+
+        // drops are free on the budget and only stage the small tail again
+        for (size_t i = 0; i < textures.size(); i++) {
+            const Residency &t = textures[i];
+            const uint32_t wanted = std::min(t.wantedTop, t.floorTop);
+            if (wanted > tops[i]) {
+                total -= tail_bytes(t.levels, tops[i]) - tail_bytes(t.levels, wanted);
+                tops[i] = wanted;
+            }
+        }
+
+        // still over, e.g. after the budget was lowered: the largest give up a level at a time
+        if (total > budget.residentBytes) {
+            std::priority_queue<std::pair<uint64_t, uint32_t>> largest;
+            for (uint32_t i = 0; i < textures.size(); i++) {
+                if (tops[i] < textures[i].floorTop) {
+                    largest.emplace(tail_bytes(textures[i].levels, tops[i]), i);
+                }
+            }
+            while (total > budget.residentBytes && !largest.empty()) {
+                const uint32_t i = largest.top().second;
+                largest.pop();
+                const uint64_t bytes = tail_bytes(textures[i].levels, tops[i]);
+                tops[i]++;
+                total -= bytes - tail_bytes(textures[i].levels, tops[i]);
+                if (tops[i] < textures[i].floorTop) {
+                    largest.emplace(tail_bytes(textures[i].levels, tops[i]), i);
+                }
+            }
+        }
+
+        // upgrades, the texture missing the most levels first and the cheaper one among equals
+        std::vector<uint32_t> upgrades;
+        for (uint32_t i = 0; i < textures.size(); i++) {
+            if (textures[i].wantedTop < tops[i]) {
+                upgrades.push_back(i);
+            }
+        }
+        std::sort(upgrades.begin(), upgrades.end(), [&](uint32_t a, uint32_t b) {
+            const uint32_t missingA = tops[a] - textures[a].wantedTop;
+            const uint32_t missingB = tops[b] - textures[b].wantedTop;
+            if (missingA != missingB) {
+                return missingA > missingB;
+            }
+            return tail_bytes(textures[a].levels, textures[a].wantedTop) <
+                   tail_bytes(textures[b].levels, textures[b].wantedTop);
+        });
+
+        uint64_t uploadLeft = budget.uploadBytes;
+        bool uploaded = false;
+        for (const uint32_t i: upgrades) {
+            const Residency &t = textures[i];
+            const uint64_t current = tail_bytes(t.levels, tops[i]);
+            for (uint32_t top = t.wantedTop; top < tops[i]; top++) {
+                const uint64_t bytes = tail_bytes(t.levels, top);
+                if (total - current + bytes > budget.residentBytes || (uploaded && bytes > uploadLeft)) {
+                    continue;
+                }
+                total += bytes - current;
+                uploadLeft -= std::min(uploadLeft, bytes);
+                uploaded = true;
+                tops[i] = top;
+                break;
+            }
+        }
+
+        std::vector<Change> changes;
+        for (uint32_t i = 0; i < textures.size(); i++) {
+            if (tops[i] != textures[i].residentTop) {
+                changes.push_back({i, tops[i]});
+            }
+        }
+        return changes;
+    }
+
+} // namespace streaming
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <BlockCompression.h>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+// Residency decisions of the TextureStreamer, free of Vulkan so they can be tested and benchmarked. A streamed
+// texture keeps a tail of its mip chain on the GPU, levels [top, levelCount), and the feedback written by
+// mesh.frag tells which level the screen actually sampled.
+namespace streaming {
+
+    // mesh.frag stores the requested level plus this bias, so levels finer than the bound image (negative
+    // relative to it) still fit an unsigned atomicMin. must match FEEDBACK_BIAS in mesh.frag
+    constexpr uint32_t FEEDBACK_BIAS = 16;
+    // value of a feedback slot no pixel sampled
+    constexpr uint32_t NO_REQUEST = 0xFFFFFFFFu;
+
+    // absolute level a feedback value asks for, written while levels [residentTop, levelCount) were bound.
+    // empty for NO_REQUEST
+    std::optional<uint32_t> requested_level(uint32_t feedback, uint32_t residentTop, uint32_t levelCount);
+
+    // coarsest level a texture is streamed down to, the first whose larger side is at most `floorSize`
+    uint32_t floor_level(std::span<const MipLevel> levels, uint32_t floorSize);
+
+    // GPU bytes of levels [top, levelCount)
+    uint64_t tail_bytes(std::span<const MipLevel> levels, uint32_t top);
+
+    // levels [top, levelCount) as a chain of their own, for vkutil::create_image. offsets keep pointing into the
+    // data of the full chain
+    MipChainView tail(const MipChainView &chain, uint32_t top);
+
+    // finest level the feedback asked for lately
+    struct Demand {
+        uint32_t top;
+        uint64_t frame; // when `top` was last asked for
+    };
+
+    // folds one frame's request into the demand and returns the level the texture should be resident from.
+    // finer requests apply at once, coarser ones only once the finer demand is `retainFrames` old, so residency
+    // does not thrash while the camera moves
+    uint32_t update_demand(Demand &demand, std::optional<uint32_t> requested, uint64_t frame, uint32_t floorTop,
+                           uint32_t retainFrames);
+
+    struct Residency {
+        std::span<const MipLevel> levels;
+        uint32_t residentTop;
+        uint32_t wantedTop;
+        uint32_t floorTop;
+    };
+
+    struct Budget {
+        uint64_t residentBytes; // all streamed textures together
+        uint64_t uploadBytes; // staged per frame, the first upgrade of a frame may go over it
+    };
+
+    struct Change {
+        uint32_t texture; // index into the planned textures
+        uint32_t top;
+    };
+
+    // residency changes for one frame. textures no longer asked for drop to their wanted level, while still over
+    // budget the largest step towards their floor, then upgrades go most starved first, each as fine as both
+    // budgets allow
+    std::vector<Change> plan(std::span<const Residency> textures, const Budget &budget);
+
+} // namespace streaming
@@ -0,0 +1,175 @@
+#include "TangentSpace.h"
+
+#include <Simd.h>
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace {
+    constexpr float DEGENERATE_LENGTH2 = 1e-12f;
+
+    // stable tangent for vertices whose UVs don't define one
+    glm::vec3 any_perpendicular(const glm::vec3 &n) {
+        const glm::vec3 axis = std::fabs(n.x) < 0.9f ? glm::vec3(1.f, 0.f, 0.f) : glm::vec3(0.f, 1.f, 0.f);
+        const glm::vec3 t = glm::cross(n, axis);
+        const float len2 = glm::dot(t, t);
+        return len2 > DEGENERATE_LENGTH2 ? t / std::sqrt(len2) : glm::vec3(1.f, 0.f, 0.f);
+    }
+
+    void orthonormalize_vertex(Vertex &v, float handedness) {
+        const glm::vec3 n = v.normal;
+        glm::vec3 t = v.tangent - n * glm::dot(n, v.tangent);
+        const float len2 = glm::dot(t, t);
+        t = len2 > DEGENERATE_LENGTH2 ? t / std::sqrt(len2) : any_perpendicular(n);
+
+        v.tangent = t;
+        v.bitangent = glm::cross(n, t) * handedness;
+    }
+
+    float corner_angle(const glm::vec3 &corner, const glm::vec3 &a, const glm::vec3 &b) {
+        const glm::vec3 e0 = a - corner;
+        const glm::vec3 e1 = b - corner;
+        const float denom = std::sqrt(glm::dot(e0, e0) * glm::dot(e1, e1));
+        if (denom <= DEGENERATE_LENGTH2) {
+            return 0.f;
+        }
+        return std::acos(std::clamp(glm::dot(e0, e1) / denom, -1.f, 1.f));
+    }
+} // namespace
+
+void tangentspace::orthonormalize_frames_scalar(std::span<Vertex> vertices, std::span<const float> handedness) {
+    for (size_t i = 0; i < vertices.size(); i++) {
+        orthonormalize_vertex(vertices[i], handedness.empty() ? 1.f : handedness[i]);
+    }
+}
+
+void tangentspace::orthonormalize_frames(std::span<Vertex> vertices, std::span<const float> handedness) {
+    constexpr size_t L = simd::LANES;
+    alignas(simd::ALIGNMENT) float nx[L], ny[L], nz[L], tx[L], ty[L], tz[L], w[L], bx[L], by[L], bz[L];
+
+    const simd::vfloat eps = simd::set1(DEGENERATE_LENGTH2);
+
+    size_t i = 0;
+    for (; i + L <= vertices.size(); i += L) {
+        // gather the AoS vertices into SoA lanes
+        for (size_t l = 0; l < L; l++) {
+            const Vertex &v = vertices[i + l];
+            nx[l] = v.normal.x;
+            ny[l] = v.normal.y;
+            nz[l] = v.normal.z;
+            tx[l] = v.tangent.x;
+            ty[l] = v.tangent.y;
+            tz[l] = v.tangent.z;
+            w[l] = handedness.empty() ? 1.f : handedness[i + l];
+        }
+
+        const simd::vfloat vnx = simd::load(nx), vny = simd::load(ny), vnz = simd::load(nz);
+        simd::vfloat vtx = simd::load(tx), vty = simd::load(ty), vtz = simd::load(tz);
+
+        // t -= n * dot(n, t)
+        const simd::vfloat ndt =
+            simd::add(simd::add(simd::mul(vnx, vtx), simd::mul(vny, vty)), simd::mul(vnz, vtz));
+        vtx = simd::sub(vtx, simd::mul(vnx, ndt));
+        vty = simd::sub(vty, simd::mul(vny, ndt));
+        vtz = simd::sub(vtz, simd::mul(vnz, ndt));
+
+        // t = normalize(t), degenerate lanes are fixed up below
+        const simd::vfloat len2 =
+            simd::add(simd::add(simd::mul(vtx, vtx), simd::mul(vty, vty)), simd::mul(vtz, vtz));
+        const int degenerate = simd::mask_gt(eps, len2);
+        const simd::vfloat invLen = simd::div(simd::set1(1.f), simd::sqrt(simd::max(len2, eps)));
+        vtx = simd::mul(vtx, invLen);
+        vty = simd::mul(vty, invLen);
+        vtz = simd::mul(vtz, invLen);
+
+        // b = cross(n, t) * w
+        const simd::vfloat vw = simd::load(w);
+        simd::store(bx, simd::mul(simd::sub(simd::mul(vny, vtz), simd::mul(vnz, vty)), vw));
+        simd::store(by, simd::mul(simd::sub(simd::mul(vnz, vtx), simd::mul(vnx, vtz)), vw));
+        simd::store(bz, simd::mul(simd::sub(simd::mul(vnx, vty), simd::mul(vny, vtx)), vw));
+        simd::store(tx, vtx);
+        simd::store(ty, vty);
+        simd::store(tz, vtz);
+
+        for (size_t l = 0; l < L; l++) {
+            Vertex &v = vertices[i + l];
+            if (degenerate & (1 << l)) {
+                orthonormalize_vertex(v, w[l]);
+                continue;
+            }
+            v.tangent = glm::vec3(tx[l], ty[l], tz[l]);
+            v.bitangent = glm::vec3(bx[l], by[l], bz[l]);
+        }
+    }
+
+    // tail
+    for (; i < vertices.size(); i++) {
+        orthonormalize_vertex(vertices[i], handedness.empty() ? 1.f : handedness[i]);
+    }
+}
+
+void tangentspace::generate_tangents(std::span<Vertex> vertices, std::span<const uint32_t> indices,
+                                     uint32_t baseVertex, std::span<float> handedness) {
+    std::vector<glm::vec3> tangents(vertices.size(), glm::vec3(0.f));
+    std::vector<glm::vec3> bitangents(vertices.size(), glm::vec3(0.f));
+
+    // glTF v runs top to bottom, flip it so generated frames agree with exporter (MikkTSpace) tangents
+    auto uv_of = [&](uint32_t i) { return glm::vec2(vertices[i].uv_x, 1.f - vertices[i].uv_y); };
+
+    for (size_t tri = 0; tri + 2 < indices.size(); tri += 3) {
+        const uint32_t corners[3] = {indices[tri] - baseVertex, indices[tri + 1] - baseVertex,
+                                     indices[tri + 2] - baseVertex};
+        if (corners[0] >= vertices.size() || corners[1] >= vertices.size() || corners[2] >= vertices.size()) {
+            continue;
+        }
+
+        const glm::vec3 p0 = vertices[corners[0]].position;
+        const glm::vec3 p1 = vertices[corners[1]].position;
+        const glm::vec3 p2 = vertices[corners[2]].position;
+        const glm::vec2 uv0 = uv_of(corners[0]);
+        const glm::vec2 d1 = uv_of(corners[1]) - uv0;
+        const glm::vec2 d2 = uv_of(corners[2]) - uv0;
+        const glm::vec3 e1 = p1 - p0;
+        const glm::vec3 e2 = p2 - p0;
+
+        const float det = d1.x * d2.y - d2.x * d1.y;
+        if (std::fabs(det) <= DEGENERATE_LENGTH2) {
+            continue;
+        }
+
+        // the sign of det flips both directions, which keeps the handedness information intact
+        glm::vec3 t = (e1 * d2.y - e2 * d1.y) / det;
+        glm::vec3 b = (e2 * d1.x - e1 * d2.x) / det;
+        const float tLen2 = glm::dot(t, t);
+        const float bLen2 = glm::dot(b, b);
+        if (tLen2 <= DEGENERATE_LENGTH2 || bLen2 <= DEGENERATE_LENGTH2) {
+            continue;
+        }
+        t /= std::sqrt(tLen2);
+        b /= std::sqrt(bLen2);
+
+        const glm::vec3 positions[3] = {p0, p1, p2};
+        for (int c = 0; c < 3; c++) {
+            const float angle = corner_angle(positions[c], positions[(c + 1) % 3], positions[(c + 2) % 3]);
+            tangents[corners[c]] += t * angle;
+            bitangents[corners[c]] += b * angle;
+        }
+    }
+
+    for (size_t i = 0; i < vertices.size(); i++) {
+        Vertex &v = vertices[i];
+        const glm::vec3 n = v.normal;
+
+        glm::vec3 t = tangents[i] - n * glm::dot(n, tangents[i]);
+        const float len2 = glm::dot(t, t);
+        if (len2 <= DEGENERATE_LENGTH2) {
+            v.tangent = any_perpendicular(n);
+            handedness[i] = 1.f;
+            continue;
+        }
+
+        v.tangent = t / std::sqrt(len2);
+        handedness[i] = glm::dot(glm::cross(n, v.tangent), bitangents[i]) < 0.f ? -1.f : 1.f;
+    }
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <Vertex.h>
+#include <cstdint>
+#include <span>
+
+// Tangent frame stage of the glTF loader, run once per primitive on that primitive's vertex range.
+namespace tangentspace {
+
+    // Gram-Schmidt the tangent against the normal and write bitangent = cross(normal, tangent) * handedness,
+    // handedness being the w of the glTF TANGENT attribute. Batched over simd::LANES vertices at a time.
+    void orthonormalize_frames(std::span<Vertex> vertices, std::span<const float> handedness);
+
+    // one vertex at a time reference of orthonormalize_frames, for tests and benchmarks
+    void orthonormalize_frames_scalar(std::span<Vertex> vertices, std::span<const float> handedness);
+
+    // MikkTSpace style tangent generation for primitives without a TANGENT attribute: per triangle tangents
+    // from the UV derivatives, accumulated per corner weighted by the corner angle, then projected onto the
+    // normal's plane. `indices` index the mesh, `baseVertex` is the mesh index of vertices[0].
+    // Writes vertices[].tangent and the matching handedness sign.
+    void generate_tangents(std::span<Vertex> vertices, std::span<const uint32_t> indices, uint32_t baseVertex,
+                           std::span<float> handedness);
+
+} // namespace tangentspace
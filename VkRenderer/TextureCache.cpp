@@ -0,0 +1,68 @@
+#include "TextureCache.h"
+
+#include <ContentHash.h>
+#include <cassert>
+
+uint64_t TextureCache::key(std::span<const uint8_t> encoded, VkFormat format, bool mipmapped) {
+    const uint64_t content = hash_bytes(encoded.data(), encoded.size());
+    return hash_combine(hash_combine(content, static_cast<uint64_t>(format)), mipmapped ? 1 : 0);
+}
+
+bool TextureCache::contains(uint64_t key) const {
+    std::lock_guard lock(_mutex);
+    return _entries.contains(key);
+}
+
+std::optional<AllocatedImage> TextureCache::acquire(uint64_t key) {
+    std::lock_guard lock(_mutex);
+    _stats.lookups++;
+
+    const auto it = _entries.find(key);
+    if (it == _entries.end()) {
+        return {};
+    }
+    it->second.references++;
+    _stats.hits++;
+    _stats.bytesSaved += it->second.bytes;
+    return it->second.image;
+}
+
+void TextureCache::insert(uint64_t key, const AllocatedImage &image, uint64_t bytes) {
+    std::lock_guard lock(_mutex);
+    [[maybe_unused]] const bool inserted = _entries.try_emplace(key, Entry{image, bytes, 1}).second;
+    assert(inserted);
+    _stats.textureCount++;
+    _stats.residentBytes += bytes;
+}
+
+std::optional<AllocatedImage> TextureCache::release(uint64_t key) {
+    std::lock_guard lock(_mutex);
+    const auto it = _entries.find(key);
+    if (it == _entries.end() || --it->second.references > 0) {
+        return {};
+    }
+
+    const AllocatedImage image = it->second.image;
+    _stats.textureCount--;
+    _stats.residentBytes -= it->second.bytes;
+    _entries.erase(it);
+    return image;
+}
+
+AllocatedImage TextureCache::replace(uint64_t key, const AllocatedImage &image, uint64_t bytes) {
+    std::lock_guard lock(_mutex);
+    const auto it = _entries.find(key);
+    assert(it != _entries.end());
+
+    const AllocatedImage old = it->second.image;
+    _stats.residentBytes += bytes;
+    _stats.residentBytes -= it->second.bytes;
+    it->second.image = image;
+    it->second.bytes = bytes;
+    return old;
+}
+
+TextureCache::Stats TextureCache::stats() const {
+    std::lock_guard lock(_mutex);
+    return _stats;
+}
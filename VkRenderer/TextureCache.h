@@ -0,0 +1,55 @@
+#pragma once
+
+#include <AllocatedImage.h>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+
+// Engine wide, reference counted set of the textures every loaded scene uses, keyed by the content hash of the
+// encoded image plus how it was decoded. A scene that asks for a texture another scene already uploaded gets
+// the same AllocatedImage and skips the decode and upload. The image is handed back for destruction once the
+// last scene releases it. Lookups are thread safe so decode jobs can check for hits before decoding.
+class TextureCache {
+public:
+    // identity of a texture: the encoded file bytes and every parameter that changes what ends up on the GPU
+    static uint64_t key(std::span<const uint8_t> encoded, VkFormat format, bool mipmapped);
+
+    // true when the texture is resident. only a hint, it may be released before the caller acquires it
+    [[nodiscard]] bool contains(uint64_t key) const;
+
+    // adds a reference to a resident texture and counts the lookup towards the hit rate
+    std::optional<AllocatedImage> acquire(uint64_t key);
+
+    // takes a freshly uploaded texture with one reference, `bytes` is its GPU footprint. only after acquire()
+    // missed on the same thread, so the key is never resident yet
+    void insert(uint64_t key, const AllocatedImage &image, uint64_t bytes);
+
+    // drops a reference and returns the image once nothing uses it anymore, the caller destroys it
+    std::optional<AllocatedImage> release(uint64_t key);
+
+    // swaps a resident texture's image for one holding other mip levels, keeping its references. returns the old
+    // image, the caller destroys it once no frame in flight samples it anymore
+    AllocatedImage replace(uint64_t key, const AllocatedImage &image, uint64_t bytes);
+
+    struct Stats {
+        uint64_t lookups;
+        uint64_t hits;
+        uint64_t bytesSaved; // GPU memory and upload traffic the hits did not need
+        uint32_t textureCount;
+        uint64_t residentBytes;
+    };
+    [[nodiscard]] Stats stats() const;
+
+private:
+    struct Entry {
+        AllocatedImage image;
+        uint64_t bytes;
+        uint32_t references;
+    };
+
+    mutable std::mutex _mutex;
+    std::unordered_map<uint64_t, Entry> _entries;
+    Stats _stats{};
+};
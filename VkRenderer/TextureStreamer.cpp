@@ -0,0 +1,283 @@
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <vk_buffers.h>
+#include <vk_images.h>
+#include "vk_engine.h"
+
+namespace {
+    // bindings of GLTFMetallic_Roughness::materialLayout: constants, color, metal rough, normal, ssao, shadow map
+    constexpr uint32_t MATERIAL_BINDINGS = 6;
+
+    AllocatedImage &material_image(MaterialInstance &material, uint32_t binding) {
+        switch (binding) {
+            case 1:
+                return material.colImage;
+            case 2:
+                return material.metalRoughImage;
+            case 3:
+                return material.normImage;
+            default:
+                return material.emissiveImage;
+        }
+    }
+
+    VkSampler material_sampler(const MaterialInstance &material, uint32_t binding) {
+        switch (binding) {
+            case 1:
+                return material.colSampler;
+            case 2:
+                return material.metalRoughSampler;
+            default:
+                return material.normSampler;
+        }
+    }
+} // namespace
+
+void TextureStreamer::init(VulkanEngine *engine) {
+    _engine = engine;
+    for (Feedback &feedback: _feedback) {
+        // read back on the host every frame, so it lives in host visible memory the shader writes through
+        feedback.buffer = vkutil::create_buffer(
+            engine, MAX_TEXTURES * sizeof(uint32_t),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            VMA_MEMORY_USAGE_GPU_TO_CPU, "TextureFeedback");
+        const VkBufferDeviceAddressInfo addressInfo{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+                                                    .buffer = feedback.buffer.buffer};
+        feedback.address = vkGetBufferDeviceAddress(engine->_device, &addressInfo);
+        feedback.residentTops.assign(MAX_TEXTURES, 0);
+        feedback.recorded = false;
+    }
+
+    _freeSlots.resize(MAX_TEXTURES);
+    for (uint32_t i = 0; i < MAX_TEXTURES; i++) {
+        _freeSlots[i] = MAX_TEXTURES - 1 - i;
+    }
+}
+
+void TextureStreamer::cleanup() {
+    for (Feedback &feedback: _feedback) {
+        vkutil::destroy_buffer(_engine, feedback.buffer);
+        feedback = {};
+    }
+    // the images belong to the texture cache
+    _textures.clear();
+    _materialSwaps.clear();
+}
+
+uint32_t TextureStreamer::initial_top(const MipChainView &chain) const {
+    if (chain.levels.size() <= 1 || _freeSlots.empty()) {
+        return 0;
+    }
+    return streaming::floor_level(chain.levels, settings.floorSize);
+}
+
+void TextureStreamer::add(uint64_t key, const AllocatedImage &image, Source &&source, uint32_t residentTop,
+                          std::string name) {
+    assert(!_freeSlots.empty() && !_textures.contains(key));
+    Texture texture{};
+    texture.image = image;
+    texture.source = std::move(source);
+    texture.name = std::move(name);
+    texture.slot = _freeSlots.back();
+    texture.residentTop = residentTop;
+    texture.floorTop = residentTop;
+    texture.demand = {residentTop, static_cast<uint64_t>(_engine->_frameNumber)};
+    _freeSlots.pop_back();
+    // the slot may come from a removed texture, frames recorded from now on report relative to this top
+    for (Feedback &feedback: _feedback) {
+        feedback.residentTops[texture.slot] = static_cast<uint8_t>(residentTop);
+    }
+    _textures.emplace(key, std::move(texture));
+}
+
+void TextureStreamer::remove(uint64_t key) {
+    const auto it = _textures.find(key);
+    if (it == _textures.end()) {
+        return;
+    }
+    _freeSlots.push_back(it->second.slot);
+    _textures.erase(it);
+}
+
+int32_t TextureStreamer::feedback_slot(uint64_t key) const {
+    const auto it = _textures.find(key);
+    return it != _textures.end() ? static_cast<int32_t>(it->second.slot) : -1;
+}
+
+std::optional<AllocatedImage> TextureStreamer::image(uint64_t key) const {
+    const auto it = _textures.find(key);
+    if (it == _textures.end()) {
+        return {};
+    }
+    return it->second.image;
+}
+
+void TextureStreamer::bind(MaterialInstance *material, uint32_t binding, uint64_t key) {
+    assert(material->spareSet != VK_NULL_HANDLE);
+    _textures.at(key).bindings.push_back({material, binding});
+    // a fresh set pair is not bound by any frame yet
+    _materialSwaps.try_emplace(material, INT64_MIN / 2);
+}
+
+void TextureStreamer::unbind(const MaterialInstance *material) {
+    if (_materialSwaps.erase(material) == 0) {
+        return;
+    }
+    for (auto &[key, texture]: _textures) {
+        std::erase_if(texture.bindings, [&](const Binding &b) { return b.material == material; });
+    }
+}
+
+void TextureStreamer::update(bool paused) {
+    Feedback &feedback = _feedback[_engine->_frameNumber % FRAME_OVERLAP];
+    if (feedback.recorded) {
+        read_feedback(feedback);
+    }
+
+    _paused = paused;
+    if (!paused && !_textures.empty()) {
+        std::vector<uint64_t> keys;
+        std::vector<streaming::Residency> residency;
+        keys.reserve(_textures.size());
+        residency.reserve(_textures.size());
+        for (const auto &[key, texture]: _textures) {
+            keys.push_back(key);
+            residency.push_back(
+                {texture.source.view().levels, texture.residentTop, texture.demand.top, texture.floorTop});
+        }
+
+        const streaming::Budget budget{uint64_t(settings.budgetMB) * 1024 * 1024,
+                                       uint64_t(settings.uploadMBPerFrame) * 1024 * 1024};
+        for (const streaming::Change &change: streaming::plan(residency, budget)) {
+            const uint64_t key = keys[change.texture];
+            apply(key, _textures.at(key), change.top);
+        }
+        rebind_materials();
+    }
+
+    // the frame about to be recorded starts from no requests and the tops it binds
+    feedback.recorded = !paused;
+    if (feedback.recorded) {
+        memset(feedback.buffer.info.pMappedData, 0xFF, MAX_TEXTURES * sizeof(uint32_t));
+        vmaFlushAllocation(_engine->_allocator, feedback.buffer.allocation, 0, VK_WHOLE_SIZE);
+        for (const auto &[key, texture]: _textures) {
+            feedback.residentTops[texture.slot] = static_cast<uint8_t>(texture.residentTop);
+        }
+    }
+}
+
+void TextureStreamer::read_feedback(Feedback &feedback) {
+    vmaInvalidateAllocation(_engine->_allocator, feedback.buffer.allocation, 0, VK_WHOLE_SIZE);
+    const auto *levels = static_cast<const uint32_t *>(feedback.buffer.info.pMappedData);
+    const auto frame = static_cast<uint64_t>(_engine->_frameNumber);
+
+    for (auto &[key, texture]: _textures) {
+        const auto levelCount = static_cast<uint32_t>(texture.source.view().levels.size());
+        const std::optional<uint32_t> requested =
+            streaming::requested_level(levels[texture.slot], feedback.residentTops[texture.slot], levelCount);
+        streaming::update_demand(texture.demand, requested, frame, texture.floorTop, settings.retainFrames);
+    }
+}
+
+void TextureStreamer::apply(uint64_t key, Texture &texture, uint32_t top) {
+    const int64_t frame = _engine->_frameNumber;
+    for (const Binding &b: texture.bindings) {
+        if (frame - _materialSwaps.at(b.material) < FRAME_OVERLAP) {
+            return;
+        }
+    }
+
+    const MipChainView chain = streaming::tail(texture.source.view(), top);
+    const AllocatedImage image =
+        vkutil::create_image(_engine, chain, VK_IMAGE_USAGE_SAMPLED_BIT, texture.name.c_str());
+    const uint64_t bytes = streaming::tail_bytes(chain.levels, 0);
+    const AllocatedImage old = _engine->textureCache.replace(key, image, bytes);
+
+    // frames in flight may still sample the old image, the frame's deletion queue runs after its fence
+    VulkanEngine *engine = _engine;
+    engine->get_current_frame()._deletionQueue.push_function([=] { vkutil::destroy_image(engine, old); });
+
+    (top < texture.residentTop ? _upgrades : _drops)++;
+    _uploadedBytes += bytes;
+    texture.image = image;
+    texture.residentTop = top;
+    for (const Binding &b: texture.bindings) {
+        _rebinds[b.material].emplace_back(b.binding, image);
+    }
+}
+
+void TextureStreamer::rebind_materials() {
+    if (_rebinds.empty()) {
+        return;
+    }
+
+    for (auto &[material, images]: _rebinds) {
+        // writes of one vkUpdateDescriptorSets call go before its copies, so the copy is a call of its own
+        VkCopyDescriptorSet copies[MATERIAL_BINDINGS];
+        for (uint32_t binding = 0; binding < MATERIAL_BINDINGS; binding++) {
+            copies[binding] = {.sType = VK_STRUCTURE_TYPE_COPY_DESCRIPTOR_SET,
+                               .srcSet = material->materialSet,
+                               .srcBinding = binding,
+                               .dstSet = material->spareSet,
+                               .dstBinding = binding,
+                               .descriptorCount = 1};
+        }
+        vkUpdateDescriptorSets(_engine->_device, 0, nullptr, MATERIAL_BINDINGS, copies);
+
+        DescriptorWriter writer;
+        for (const auto &[binding, image]: images) {
+            if (binding < MATERIAL_BINDINGS) {
+                writer.write_image(static_cast<int>(binding), image.imageView, material_sampler(*material, binding),
+                                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                   VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+            }
+            material_image(*material, binding) = image;
+        }
+        writer.update_set(_engine->_device, material->spareSet);
+
+        std::swap(material->materialSet, material->spareSet);
+        _materialSwaps[material] = _engine->_frameNumber;
+    }
+    _rebinds.clear();
+    _generation++;
+}
+
+VkDeviceAddress TextureStreamer::feedback_address() const {
+    if (_paused || _textures.empty()) {
+        return 0;
+    }
+    return _feedback[_engine->_frameNumber % FRAME_OVERLAP].address;
+}
+
+void TextureStreamer::finish_frame(VkCommandBuffer cmd) const {
+    if (feedback_address() == 0) {
+        return;
+    }
+    VkMemoryBarrier2 barrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2};
+    barrier.srcStageMask = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+    barrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+    barrier.dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT;
+    barrier.dstAccessMask = VK_ACCESS_2_HOST_READ_BIT;
+
+    VkDependencyInfo depInfo{.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+    depInfo.memoryBarrierCount = 1;
+    depInfo.pMemoryBarriers = &barrier;
+    vkCmdPipelineBarrier2(cmd, &depInfo);
+}
+
+TextureStreamer::Stats TextureStreamer::stats() const {
+    Stats stats{};
+    stats.textures = static_cast<uint32_t>(_textures.size());
+    for (const auto &[key, texture]: _textures) {
+        const std::span<const MipLevel> levels = texture.source.view().levels;
+        stats.residentBytes += streaming::tail_bytes(levels, texture.residentTop);
+        stats.fullBytes += streaming::tail_bytes(levels, 0);
+    }
+    stats.uploadedBytes = _uploadedBytes;
+    stats.upgrades = _upgrades;
+    stats.drops = _drops;
+    return stats;
+}
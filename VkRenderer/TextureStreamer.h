@@ -0,0 +1,132 @@
+#pragma once
+
+#include <CompressedTextureCache.h>
+#include <RenderConfig.h>
+#include <StreamingPolicy.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <vk_types.h>
+
+class VulkanEngine;
+
+// Demand driven mip streaming of the textures the raster passes sample. A streamed texture is uploaded with only
+// the levels from streaming::floor_level down. mesh.frag writes the level it would sample into a feedback buffer,
+// one uint per texture, and update() reads a frame's copy back once its fence signalled, so nothing waits on the
+// GPU. When residency changes, the tail is staged again from the CPU copy of the chain into a new image; the
+// texture cache and the materials sampling it move over and the old image is destroyed with the frame.
+class TextureStreamer {
+public:
+    // feedback slots per frame, textures past it stay fully resident
+    static constexpr uint32_t MAX_TEXTURES = 4096;
+    // bind() target of MaterialInstance::emissiveImage, which only the ray tracer samples
+    static constexpr uint32_t EMISSIVE_IMAGE = 6;
+
+    // the full mip chain of a streamed texture, kept in memory or mapped from the compressed texture cache
+    struct Source {
+        MipChain chain;
+        CompressedTextureCache mapped;
+
+        [[nodiscard]] MipChainView view() const { return mapped.is_open() ? mapped.view() : chain.view(); }
+    };
+
+    struct Settings {
+        uint32_t budgetMB{512}; // GPU memory of all streamed textures together
+        uint32_t uploadMBPerFrame{16};
+        uint32_t floorSize{128}; // textures keep at least the level this size, smaller ones are not streamed
+        uint32_t retainFrames{120}; // how long a level nobody samples anymore stays resident
+    };
+    Settings settings;
+
+    void init(VulkanEngine *engine);
+    void cleanup();
+
+    // level a texture with this chain is uploaded from, 0 when it is not worth streaming or no slot is left
+    [[nodiscard]] uint32_t initial_top(const MipChainView &chain) const;
+
+    // starts streaming a texture the cache holds as `image`, uploaded from `residentTop` = initial_top()
+    void add(uint64_t key, const AllocatedImage &image, Source &&source, uint32_t residentTop, std::string name);
+    // stops streaming a texture, after the texture cache released its last reference
+    void remove(uint64_t key);
+
+    [[nodiscard]] bool is_streamed(uint64_t key) const { return _textures.contains(key); }
+    // slot mesh.frag reports the texture's level in, -1 when it is not streamed
+    [[nodiscard]] int32_t feedback_slot(uint64_t key) const;
+    // what is resident right now, the image a loader should bind
+    [[nodiscard]] std::optional<AllocatedImage> image(uint64_t key) const;
+
+    // keeps `binding` of the material's set (1 color, 2 metal rough, 3 normal) or EMISSIVE_IMAGE on the
+    // texture's current image. the material needs a spareSet from the material layout
+    void bind(MaterialInstance *material, uint32_t binding, uint64_t key);
+    // before the material's descriptor sets are freed
+    void unbind(const MaterialInstance *material);
+
+    // once per frame after its fence: folds in the feedback that frame recorded, applies residency changes and
+    // hands the buffer to the frame about to be recorded. while paused residency stays as it is and nothing is
+    // recorded, the ray tracer samples material images without feedback
+    void update(bool paused);
+
+    // address of the feedback buffer the frame being recorded writes, 0 while paused
+    [[nodiscard]] VkDeviceAddress feedback_address() const;
+    // makes the shader writes of the feedback visible to the host, last thing recorded in the frame
+    void finish_frame(VkCommandBuffer cmd) const;
+
+    // changes whenever a material image is replaced, the ray tracer rewrites its texture set when it lags behind
+    [[nodiscard]] uint64_t generation() const { return _generation; }
+
+    struct Stats {
+        uint32_t textures;
+        uint64_t residentBytes;
+        uint64_t fullBytes; // the same textures with every level resident
+        uint64_t uploadedBytes; // staged since start
+        uint32_t upgrades;
+        uint32_t drops;
+    };
+    [[nodiscard]] Stats stats() const;
+
+private:
+    struct Binding {
+        MaterialInstance *material;
+        uint32_t binding;
+    };
+
+    struct Texture {
+        AllocatedImage image;
+        Source source;
+        std::string name;
+        uint32_t slot;
+        uint32_t residentTop;
+        uint32_t floorTop;
+        streaming::Demand demand;
+        std::vector<Binding> bindings;
+    };
+
+    struct Feedback {
+        AllocatedBuffer buffer;
+        VkDeviceAddress address;
+        // residentTop of every slot when the frame was recorded, the shader's levels are relative to it
+        std::vector<uint8_t> residentTops;
+        bool recorded;
+    };
+
+    void read_feedback(Feedback &feedback);
+    // new image for the tail from `top`, skipped while a material sampling it cannot swap sets yet
+    void apply(uint64_t key, Texture &texture, uint32_t top);
+    void rebind_materials();
+
+    VulkanEngine *_engine{nullptr};
+    Feedback _feedback[FRAME_OVERLAP]{};
+    bool _paused{false};
+
+    std::unordered_map<uint64_t, Texture> _textures;
+    std::vector<uint32_t> _freeSlots;
+    // frame a material last swapped its sets, its spare may be bound by frames in flight until FRAME_OVERLAP later
+    std::unordered_map<const MaterialInstance *, int64_t> _materialSwaps;
+    // descriptor writes of this update, applied per material after every texture changed
+    std::unordered_map<MaterialInstance *, std::vector<std::pair<uint32_t, AllocatedImage>>> _rebinds;
+
+    uint64_t _generation{0};
+    uint64_t _uploadedBytes{0};
+    uint32_t _upgrades{0};
+    uint32_t _drops{0};
+};
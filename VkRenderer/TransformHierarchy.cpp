@@ -0,0 +1,126 @@
+#include "TransformHierarchy.h"
+
+#include <algorithm>
+#include <utility>
+
+void TransformHierarchy::build(std::span<const glm::mat4> localTransforms,
+                               std::span<const std::vector<uint32_t>> children) {
+    clear();
+    const auto sourceCount = static_cast<uint32_t>(localTransforms.size());
+    _flatIndex.assign(sourceCount, NO_PARENT);
+
+    std::vector<uint8_t> listed(sourceCount, 0);
+    for (const std::vector<uint32_t> &list: children) {
+        for (const uint32_t child: list) {
+            listed[child] = 1;
+        }
+    }
+
+    _sourceIndex.reserve(sourceCount);
+    _parent.reserve(sourceCount);
+    _subtreeEnd.reserve(sourceCount);
+
+    // depth first from each root, a node stays on the stack while its subtree is placed and its end is known
+    // once it is popped. the second member is the next of its children to visit
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    auto place = [&](uint32_t source, uint32_t parent) {
+        _flatIndex[source] = static_cast<uint32_t>(_sourceIndex.size());
+        _sourceIndex.push_back(source);
+        _parent.push_back(parent);
+        _subtreeEnd.push_back(0);
+        stack.emplace_back(source, 0);
+    };
+
+    for (uint32_t root = 0; root < sourceCount; root++) {
+        if (listed[root]) {
+            continue;
+        }
+        _rootCount++;
+        place(root, NO_PARENT);
+
+        while (!stack.empty()) {
+            auto &[source, next] = stack.back();
+            const std::vector<uint32_t> &list = children[source];
+            while (next < list.size() && _flatIndex[list[next]] != NO_PARENT) {
+                next++;
+            }
+            if (next < list.size()) {
+                const uint32_t child = list[next++];
+                place(child, _flatIndex[source]);
+                continue;
+            }
+            _subtreeEnd[_flatIndex[source]] = static_cast<uint32_t>(_sourceIndex.size());
+            stack.pop_back();
+        }
+    }
+
+    _local.resize(_sourceIndex.size());
+    for (uint32_t i = 0; i < size(); i++) {
+        _local[i] = localTransforms[_sourceIndex[i]];
+    }
+    _world.resize(size());
+    _dirty.assign(size(), 0);
+    for (uint32_t i = 0; i < size(); i = _subtreeEnd[i]) {
+        _dirty[i] = 1;
+    }
+    _firstDirty = 0;
+}
+
+void TransformHierarchy::clear() {
+    _rootCount = 0;
+    _parent.clear();
+    _subtreeEnd.clear();
+    _local.clear();
+    _world.clear();
+    _dirty.clear();
+    _firstDirty = 0;
+    _flatIndex.clear();
+    _sourceIndex.clear();
+    _updated.clear();
+}
+
+void TransformHierarchy::set_local(uint32_t index, const glm::mat4 &transform) {
+    _local[index] = transform;
+    mark_dirty(index);
+}
+
+void TransformHierarchy::set_root(const glm::mat4 &transform) {
+    if (transform == _root) {
+        return;
+    }
+    _root = transform;
+    for (uint32_t i = 0; i < size(); i = _subtreeEnd[i]) {
+        mark_dirty(i);
+    }
+}
+
+void TransformHierarchy::mark_dirty(uint32_t index) {
+    _dirty[index] = 1;
+    _firstDirty = std::min(_firstDirty, index);
+}
+
+uint32_t TransformHierarchy::update() {
+    _updated.clear();
+    uint32_t updated = 0;
+    uint32_t i = _firstDirty;
+    while (i < size()) {
+        if (!_dirty[i]) {
+            i++;
+            continue;
+        }
+        // the parent of a dirty node is up to date by now, it comes earlier and was either clean or swept.
+        // everything below the node follows it in one range, so the subtree is a straight run over the arrays
+        const uint32_t end = _subtreeEnd[i];
+        _world[i] = (_parent[i] == NO_PARENT ? _root : _world[_parent[i]]) * _local[i];
+        _dirty[i] = 0;
+        for (uint32_t n = i + 1; n < end; n++) {
+            _world[n] = _world[_parent[n]] * _local[n];
+            _dirty[n] = 0;
+        }
+        updated += end - i;
+        _updated.emplace_back(i, end);
+        i = end;
+    }
+    _firstDirty = size();
+    return updated;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/mat4x4.hpp>
+#include <span>
+#include <utility>
+#include <vector>
+
+// The node transforms of a scene flattened into arrays in depth first order: every parent comes before its
+// children and every subtree is one contiguous range. Changing a local transform only marks its node dirty,
+// update() then recomputes the world transforms of the dirty subtrees in one forward sweep.
+class TransformHierarchy {
+public:
+    static constexpr uint32_t NO_PARENT = UINT32_MAX;
+
+    // `children[i]` lists the source node indices under source node i, e.g. in glTF node order. Nodes nobody
+    // lists are the roots, taken in source order, children keep their listed order. Nodes only reachable
+    // through a cycle are left out, a node listed under several parents is kept under the first one.
+    void build(std::span<const glm::mat4> localTransforms, std::span<const std::vector<uint32_t>> children);
+    void clear();
+
+    [[nodiscard]] uint32_t size() const { return static_cast<uint32_t>(_local.size()); }
+    [[nodiscard]] uint32_t root_count() const { return _rootCount; }
+
+    // flat index of a source node, NO_PARENT when it was left out
+    [[nodiscard]] uint32_t flat_index(uint32_t sourceIndex) const { return _flatIndex[sourceIndex]; }
+    [[nodiscard]] uint32_t source_index(uint32_t index) const { return _sourceIndex[index]; }
+    [[nodiscard]] uint32_t parent(uint32_t index) const { return _parent[index]; }
+    // one past the last node of the subtree under `index`
+    [[nodiscard]] uint32_t subtree_end(uint32_t index) const { return _subtreeEnd[index]; }
+
+    [[nodiscard]] const glm::mat4 &local(uint32_t index) const { return _local[index]; }
+    [[nodiscard]] const glm::mat4 &world(uint32_t index) const { return _world[index]; }
+
+    void set_local(uint32_t index, const glm::mat4 &transform);
+    // parent of every root, e.g. where the scene was placed. Only a changed matrix dirties the roots
+    void set_root(const glm::mat4 &transform);
+
+    [[nodiscard]] bool dirty() const { return _firstDirty < size(); }
+    // brings the world transforms of every dirty subtree up to date, returns how many were recomputed
+    uint32_t update();
+    // the [begin, end) node ranges the last update() recomputed, in increasing order. Whatever was derived from
+    // the world transforms, e.g. retained draw lists, only needs these ranges patched
+    [[nodiscard]] std::span<const std::pair<uint32_t, uint32_t>> updated_ranges() const { return _updated; }
+
+private:
+    void mark_dirty(uint32_t index);
+
+    glm::mat4 _root{1.f};
+    uint32_t _rootCount{0};
+    std::vector<uint32_t> _parent;
+    std::vector<uint32_t> _subtreeEnd;
+    std::vector<glm::mat4> _local;
+    std::vector<glm::mat4> _world;
+    std::vector<uint8_t> _dirty;
+    // where the sweep starts, nothing before it is dirty
+    uint32_t _firstDirty{0};
+    std::vector<uint32_t> _flatIndex;
+    std::vector<uint32_t> _sourceIndex;
+    std::vector<std::pair<uint32_t, uint32_t>> _updated;
+};
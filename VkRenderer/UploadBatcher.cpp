@@ -0,0 +1,272 @@
+#include "UploadBatcher.h"
+
+#include <cstring>
+#include <spdlog/spdlog.h>
+#include <vk_buffers.h>
+#include <vk_images.h>
+#include <vk_initializers.h>
+#include "vk_engine.h"
+
+void UploadBatcher::init(VulkanEngine *engine) {
+    _engine = engine;
+
+    _ringBuffer = vkutil::create_buffer(engine, RING_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                        VMA_MEMORY_USAGE_CPU_TO_GPU, "Upload Staging Ring");
+    _ring = StagingRing(RING_SIZE, STAGING_ALIGNMENT);
+
+    const VkCommandPoolCreateInfo poolInfo =
+        vkinit::command_pool_create_info(engine->_graphicsQueueFamily, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+    VK_CHECK(vkCreateCommandPool(engine->_device, &poolInfo, nullptr, &_commandPool));
+
+    VkSemaphoreTypeCreateInfo timelineInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO};
+    timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    timelineInfo.initialValue = 0;
+    VkSemaphoreCreateInfo semaphoreInfo = vkinit::semaphore_create_info();
+    semaphoreInfo.pNext = &timelineInfo;
+    VK_CHECK(vkCreateSemaphore(engine->_device, &semaphoreInfo, nullptr, &_timeline));
+}
+
+void UploadBatcher::cleanup() {
+    wait(flush());
+
+    vkDestroyCommandPool(_engine->_device, _commandPool, nullptr);
+    vkDestroySemaphore(_engine->_device, _timeline, nullptr);
+    vkutil::destroy_buffer(_engine, _ringBuffer);
+    for (const AllocatedBuffer &buffer: _open.dedicated) {
+        vkutil::destroy_buffer(_engine, buffer);
+    }
+    _open = Batch{};
+    _freeCommandBuffers.clear();
+}
+
+UploadBatcher::Staging UploadBatcher::stage(VkDeviceSize size) {
+    if (size > DEDICATED_STAGING_SIZE) {
+        AllocatedBuffer buffer = vkutil::create_buffer(_engine, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                       VMA_MEMORY_USAGE_CPU_TO_GPU, "Upload Staging (dedicated)");
+        _open.dedicated.push_back(buffer);
+        return Staging{static_cast<std::byte *>(buffer.info.pMappedData), buffer.buffer, 0, size};
+    }
+
+    uint64_t offset = _ring.allocate(size);
+    while (offset == StagingRing::INVALID_OFFSET) {
+        // the ring is full of batches the GPU hasn't consumed yet, wait for the oldest one
+        if (_ring.open_bytes() > 0) {
+            flush();
+        }
+        _stats.ringStalls++;
+        wait(_ring.oldest_batch());
+        offset = _ring.allocate(size);
+    }
+
+    std::byte *ringData = static_cast<std::byte *>(_ringBuffer.info.pMappedData);
+    return Staging{ringData + offset, _ringBuffer.buffer, offset, size};
+}
+
+UploadBatcher::Ticket UploadBatcher::upload_buffer(VkBuffer dst, VkDeviceSize dstOffset, const void *data,
+                                                   VkDeviceSize size) {
+    if (size == 0) {
+        // nothing to wait for
+        return _nextTicket - 1;
+    }
+
+    const Staging staging = stage(size);
+    memcpy(staging.data, data, size);
+    return copy_to_buffer(dst, dstOffset, staging);
+}
+
+UploadBatcher::Ticket UploadBatcher::copy_to_buffer(VkBuffer dst, VkDeviceSize dstOffset, const Staging &staging) {
+    const VkBufferCopy copy{.srcOffset = staging.offset, .dstOffset = dstOffset, .size = staging.size};
+    vkCmdCopyBuffer(open_command_buffer(), staging.buffer, dst, 1, &copy);
+
+    const Ticket ticket = _nextTicket;
+    recorded(staging.size);
+    return ticket;
+}
+
+UploadBatcher::Ticket UploadBatcher::upload_image(const AllocatedImage &image, const void *data, VkDeviceSize size,
+                                                  bool mipmapped) {
+    const Staging staging = stage(size);
+    memcpy(staging.data, data, size);
+    return copy_to_image(image, staging, mipmapped);
+}
+
+UploadBatcher::Ticket UploadBatcher::copy_to_image(const AllocatedImage &image, const Staging &staging,
+                                                   bool mipmapped) {
+    VkCommandBuffer cmd = open_command_buffer();
+
+    vkutil::transition_image(cmd, image.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                             VK_IMAGE_ASPECT_COLOR_BIT);
+
+    VkBufferImageCopy copyRegion = {};
+    copyRegion.bufferOffset = staging.offset;
+    copyRegion.bufferRowLength = 0;
+    copyRegion.bufferImageHeight = 0;
+
+    copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    copyRegion.imageSubresource.mipLevel = 0;
+    copyRegion.imageSubresource.baseArrayLayer = 0;
+    copyRegion.imageSubresource.layerCount = 1;
+    copyRegion.imageExtent = image.imageExtent;
+
+    vkCmdCopyBufferToImage(cmd, staging.buffer, image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
+
+    if (mipmapped) {
+        vkutil::generate_mipmaps(cmd, image.image, VkExtent2D{image.imageExtent.width, image.imageExtent.height});
+    } else {
+        vkutil::transition_image(cmd, image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT);
+    }
+
+    const Ticket ticket = _nextTicket;
+    recorded(staging.size);
+    return ticket;
+}
+
+UploadBatcher::Ticket UploadBatcher::upload_mip_chain(const AllocatedImage &image, const MipChainView &chain) {
+    // only the levels of the view are staged, a mip tail of a streamed texture starts inside the chain's data.
+    // level offsets are multiples of the block size, the staging alignment covers the largest block
+    const uint64_t begin = chain.levels.front().offset;
+    const uint64_t end = chain.levels.back().offset + chain.levels.back().size;
+    const Staging staging = stage(end - begin);
+    memcpy(staging.data, chain.data.data() + begin, end - begin);
+
+    std::vector<VkBufferImageCopy> regions;
+    regions.reserve(chain.levels.size());
+    for (uint32_t level = 0; level < chain.levels.size(); level++) {
+        const MipLevel &mip = chain.levels[level];
+        VkBufferImageCopy region = {};
+        region.bufferOffset = staging.offset + (mip.offset - begin);
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {mip.width, mip.height, 1};
+        regions.push_back(region);
+    }
+
+    VkCommandBuffer cmd = open_command_buffer();
+    vkutil::transition_image(cmd, image.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                             VK_IMAGE_ASPECT_COLOR_BIT);
+    vkCmdCopyBufferToImage(cmd, staging.buffer, image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           static_cast<uint32_t>(regions.size()), regions.data());
+    vkutil::transition_image(cmd, image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                             VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT);
+
+    const Ticket ticket = _nextTicket;
+    recorded(staging.size);
+    return ticket;
+}
+
+UploadBatcher::Ticket UploadBatcher::flush() {
+    if (_open.cmd == VK_NULL_HANDLE) {
+        // nothing recorded, but dedicated staging may still wait for a batch
+        if (!_open.dedicated.empty()) {
+            open_command_buffer();
+        } else {
+            return _nextTicket - 1;
+        }
+    }
+
+    // make every copy of the batch visible to whatever the queue runs after it
+    VkMemoryBarrier2 barrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2};
+    barrier.srcStageMask = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+    barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    barrier.dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+    barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+    VkDependencyInfo depInfo{.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
+    depInfo.memoryBarrierCount = 1;
+    depInfo.pMemoryBarriers = &barrier;
+    vkCmdPipelineBarrier2(_open.cmd, &depInfo);
+
+    VK_CHECK(vkEndCommandBuffer(_open.cmd));
+
+    VkCommandBufferSubmitInfo cmdInfo = vkinit::command_buffer_submit_info(_open.cmd);
+    VkSemaphoreSubmitInfo signalInfo =
+        vkinit::semaphore_submit_info(VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, _timeline);
+    signalInfo.value = _nextTicket;
+    const VkSubmitInfo2 submit = vkinit::submit_info(&cmdInfo, &signalInfo, nullptr);
+    VK_CHECK(vkQueueSubmit2(_engine->_graphicsQueue, 1, &submit, VK_NULL_HANDLE));
+
+    _open.ticket = _nextTicket;
+    _ring.close_batch(_nextTicket);
+    _inFlight.push_back(std::move(_open));
+    _open = Batch{};
+    _stats.batches++;
+
+    return _nextTicket++;
+}
+
+bool UploadBatcher::is_complete(Ticket ticket) const {
+    if (ticket >= _nextTicket) {
+        return false;
+    }
+    uint64_t completed = 0;
+    VK_CHECK(vkGetSemaphoreCounterValue(_engine->_device, _timeline, &completed));
+    return completed >= ticket;
+}
+
+void UploadBatcher::wait(Ticket ticket) {
+    if (ticket >= _nextTicket) {
+        flush();
+    }
+    if (ticket == 0) {
+        return;
+    }
+
+    const VkSemaphoreWaitInfo waitInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+                                       .semaphoreCount = 1,
+                                       .pSemaphores = &_timeline,
+                                       .pValues = &ticket};
+    VK_CHECK(vkWaitSemaphores(_engine->_device, &waitInfo, UINT64_MAX));
+    reclaim();
+}
+
+VkCommandBuffer UploadBatcher::open_command_buffer() {
+    if (_open.cmd != VK_NULL_HANDLE) {
+        return _open.cmd;
+    }
+
+    reclaim();
+    if (_freeCommandBuffers.empty()) {
+        const VkCommandBufferAllocateInfo allocInfo = vkinit::command_buffer_allocate_info(_commandPool, 1);
+        VK_CHECK(vkAllocateCommandBuffers(_engine->_device, &allocInfo, &_open.cmd));
+    } else {
+        _open.cmd = _freeCommandBuffers.back();
+        _freeCommandBuffers.pop_back();
+    }
+
+    const VkCommandBufferBeginInfo beginInfo =
+        vkinit::command_buffer_begin_info(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    VK_CHECK(vkBeginCommandBuffer(_open.cmd, &beginInfo));
+    return _open.cmd;
+}
+
+void UploadBatcher::recorded(VkDeviceSize bytes) {
+    _stats.copies++;
+    _stats.bytes += bytes;
+    if (_ring.open_bytes() >= BATCH_FLUSH_SIZE || !_open.dedicated.empty()) {
+        flush();
+    }
+}
+
+void UploadBatcher::reclaim() {
+    if (_inFlight.empty()) {
+        return;
+    }
+
+    uint64_t completed = 0;
+    VK_CHECK(vkGetSemaphoreCounterValue(_engine->_device, _timeline, &completed));
+
+    // batches complete in submission order, so the finished ones are always at the front
+    size_t finished = 0;
+    for (; finished < _inFlight.size() && _inFlight[finished].ticket <= completed; finished++) {
+        Batch &batch = _inFlight[finished];
+        for (const AllocatedBuffer &buffer: batch.dedicated) {
+            vkutil::destroy_buffer(_engine, buffer);
+        }
+        _freeCommandBuffers.push_back(batch.cmd);
+    }
+    _inFlight.erase(_inFlight.begin(), _inFlight.begin() + static_cast<std::ptrdiff_t>(finished));
+    _ring.retire(completed);
+}
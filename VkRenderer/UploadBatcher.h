@@ -0,0 +1,89 @@
+#pragma once
+
+#include <BlockCompression.h>
+#include <StagingRing.h>
+#include <cstddef>
+#include <vector>
+#include <vk_types.h>
+
+class VulkanEngine;
+
+// Collects buffer and image uploads into one command buffer per batch, staged through a persistent ring buffer.
+// A batch is submitted when flush() is called, when enough has been staged to keep the queue busy, or when the
+// ring runs out of room. Each batch signals a timeline semaphore value, the ticket returned for its uploads, so a
+// caller only blocks when it needs a resource on the CPU side; GPU work submitted after the batch on the same
+// queue sees the data through the barrier closing the batch. Main thread only, like immediate_submit.
+class UploadBatcher {
+public:
+    static constexpr VkDeviceSize RING_SIZE = 64ull * 1024 * 1024;
+    // submit once this much is staged so the GPU starts copying while the loader keeps going
+    static constexpr VkDeviceSize BATCH_FLUSH_SIZE = RING_SIZE / 4;
+    // bigger uploads get a staging buffer of their own instead of draining the ring
+    static constexpr VkDeviceSize DEDICATED_STAGING_SIZE = RING_SIZE / 2;
+    // covers the texel size of every format we upload and the 4 byte rule for buffer copies
+    static constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+    // timeline value signalled by the batch that carries an upload
+    using Ticket = uint64_t;
+
+    struct Staging {
+        std::byte *data;
+        VkBuffer buffer;
+        VkDeviceSize offset;
+        VkDeviceSize size;
+    };
+
+    void init(VulkanEngine *engine);
+    void cleanup();
+
+    // staging memory in the open batch, for callers that convert straight into it
+    Staging stage(VkDeviceSize size);
+
+    Ticket upload_buffer(VkBuffer dst, VkDeviceSize dstOffset, const void *data, VkDeviceSize size);
+    // copies memory from stage() the caller already filled
+    Ticket copy_to_buffer(VkBuffer dst, VkDeviceSize dstOffset, const Staging &staging);
+    // whole image from tightly packed texels, leaves it in SHADER_READ_ONLY_OPTIMAL
+    Ticket upload_image(const AllocatedImage &image, const void *data, VkDeviceSize size, bool mipmapped);
+    Ticket copy_to_image(const AllocatedImage &image, const Staging &staging, bool mipmapped);
+    // one copy per level of a pre-built chain, no blits, so it also works for block compressed formats. the
+    // chain may be a tail of a longer one, see streaming::tail
+    Ticket upload_mip_chain(const AllocatedImage &image, const MipChainView &chain);
+
+    // submits the open batch, returns the ticket of the last submitted batch
+    Ticket flush();
+    [[nodiscard]] bool is_complete(Ticket ticket) const;
+    // blocks until the batch carrying `ticket` finished, submitting it first if it is still open
+    void wait(Ticket ticket);
+
+    struct Stats {
+        uint64_t batches;
+        uint64_t copies;
+        uint64_t bytes;
+        uint64_t ringStalls;
+    };
+    [[nodiscard]] Stats stats() const { return _stats; }
+
+private:
+    struct Batch {
+        VkCommandBuffer cmd{VK_NULL_HANDLE};
+        Ticket ticket{0};
+        std::vector<AllocatedBuffer> dedicated;
+    };
+
+    VkCommandBuffer open_command_buffer();
+    void recorded(VkDeviceSize bytes);
+    void reclaim();
+
+    VulkanEngine *_engine{nullptr};
+    AllocatedBuffer _ringBuffer{};
+    StagingRing _ring;
+    VkCommandPool _commandPool{VK_NULL_HANDLE};
+    VkSemaphore _timeline{VK_NULL_HANDLE};
+
+    // the open batch always carries _nextTicket
+    Ticket _nextTicket{1};
+    Batch _open;
+    std::vector<Batch> _inFlight;
+    std::vector<VkCommandBuffer> _freeCommandBuffers;
+    Stats _stats{};
+};
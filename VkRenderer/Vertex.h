@@ -1,8 +1,13 @@
 #pragma once
 
+#include <cstdint>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
 
+// layout of a mesh's vertex buffer, the values match the VERTEX_FORMAT_* defines in vertex_fetch.glsl
+enum class VertexFormat : uint32_t { Full = 0, Packed = 1, PackedQuantized = 2 };
+
+// full precision vertex, 80 bytes. also what the loader and the mesh cache work with on the cpu
 struct Vertex {
 
     glm::vec3 position;
@@ -12,4 +17,34 @@ struct Vertex {
     alignas(16) glm::vec4 color;
     alignas(16) glm::vec3 tangent;
     alignas(16) glm::vec3 bitangent;
-};
\ No newline at end of file
+};
+
+// 32 bytes: float position, octahedral normal and tangent as 2x snorm16 (bit 0 of the tangent word holds the
+// bitangent sign), half float UVs and RGBA8 color
+struct PackedVertex {
+    glm::vec3 position;
+    uint32_t normal;
+    uint32_t tangent;
+    uint32_t uv;
+    uint32_t color;
+    uint32_t padding;
+};
+
+// 24 bytes: PackedVertex with the position stored as snorm16 inside the mesh bounds, w is unused
+struct QuantizedVertex {
+    int16_t position[4];
+    uint32_t normal;
+    uint32_t tangent;
+    uint32_t uv;
+    uint32_t color;
+};
+
+// per mesh dequantization of QuantizedVertex positions: position = offset + snorm * scale
+struct VertexQuantization {
+    glm::vec3 offset{0.f};
+    glm::vec3 scale{1.f};
+};
+
+static_assert(sizeof(Vertex) == 80);
+static_assert(sizeof(PackedVertex) == 32);
+static_assert(sizeof(QuantizedVertex) == 24);
@@ -0,0 +1,207 @@
+#include "VertexPacking.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <glm/packing.hpp>
+
+namespace {
+    constexpr float SNORM16_MAX = 32767.f;
+
+    // octahedral tangent with the bitangent sign in bit 0, costs the x component one bit of precision
+    uint32_t pack_tangent(const Vertex &v) {
+        const uint32_t bits = glm::packSnorm2x16(vertexpacking::oct_encode(v.tangent)) & ~1u;
+        const bool negative = glm::dot(glm::cross(v.normal, v.tangent), v.bitangent) < 0.f;
+        return bits | (negative ? 1u : 0u);
+    }
+
+    void unpack_frame(uint32_t normal, uint32_t tangent, Vertex &v) {
+        v.normal = vertexpacking::oct_decode(glm::unpackSnorm2x16(normal));
+        v.tangent = vertexpacking::oct_decode(glm::unpackSnorm2x16(tangent & ~1u));
+        v.bitangent = glm::cross(v.normal, v.tangent) * ((tangent & 1u) != 0 ? -1.f : 1.f);
+    }
+
+    uint32_t pack_color(const glm::vec4 &color) { return glm::packUnorm4x8(glm::clamp(color, 0.f, 1.f)); }
+
+    int16_t quantize_snorm16(float value) {
+        return static_cast<int16_t>(std::lround(std::clamp(value, -1.f, 1.f) * SNORM16_MAX));
+    }
+} // namespace
+
+size_t vertexpacking::stride(VertexFormat format) {
+    switch (format) {
+        case VertexFormat::Packed:
+            return sizeof(PackedVertex);
+        case VertexFormat::PackedQuantized:
+            return sizeof(QuantizedVertex);
+        case VertexFormat::Full:
+        default:
+            return sizeof(Vertex);
+    }
+}
+
+const char *vertexpacking::name(VertexFormat format) {
+    switch (format) {
+        case VertexFormat::Packed:
+            return "Packed (32 B)";
+        case VertexFormat::PackedQuantized:
+            return "Packed + quantized positions (24 B)";
+        case VertexFormat::Full:
+        default:
+            return "Full precision (80 B)";
+    }
+}
+
+glm::vec2 vertexpacking::oct_encode(const glm::vec3 &n) {
+    const float l1 = std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+    if (l1 <= 0.f) {
+        return glm::vec2(0.f);
+    }
+
+    glm::vec2 e(n.x / l1, n.y / l1);
+    if (n.z < 0.f) {
+        // fold the lower hemisphere over the diagonals
+        e = glm::vec2((1.f - std::fabs(e.y)) * (e.x >= 0.f ? 1.f : -1.f),
+                      (1.f - std::fabs(e.x)) * (e.y >= 0.f ? 1.f : -1.f));
+    }
+    return e;
+}
+
+glm::vec3 vertexpacking::oct_decode(const glm::vec2 &e) {
+    glm::vec3 v(e.x, e.y, 1.f - std::fabs(e.x) - std::fabs(e.y));
+    const float t = std::max(-v.z, 0.f);
+    v.x += v.x >= 0.f ? -t : t;
+    v.y += v.y >= 0.f ? -t : t;
+    return glm::normalize(v);
+}
+
+PackedVertex vertexpacking::pack(const Vertex &v) {
+    PackedVertex packed{};
+    packed.position = v.position;
+    packed.normal = glm::packSnorm2x16(oct_encode(v.normal));
+    packed.tangent = pack_tangent(v);
+    packed.uv = glm::packHalf2x16(glm::vec2(v.uv_x, v.uv_y));
+    packed.color = pack_color(v.color);
+    return packed;
+}
+
+QuantizedVertex vertexpacking::quantize(const Vertex &v, const VertexQuantization &quantization) {
+    const glm::vec3 q = (v.position - quantization.offset) / quantization.scale;
+
+    QuantizedVertex packed{};
+    packed.position[0] = quantize_snorm16(q.x);
+    packed.position[1] = quantize_snorm16(q.y);
+    packed.position[2] = quantize_snorm16(q.z);
+    packed.normal = glm::packSnorm2x16(oct_encode(v.normal));
+    packed.tangent = pack_tangent(v);
+    packed.uv = glm::packHalf2x16(glm::vec2(v.uv_x, v.uv_y));
+    packed.color = pack_color(v.color);
+    return packed;
+}
+
+Vertex vertexpacking::unpack(const PackedVertex &v) {
+    Vertex out{};
+    out.position = v.position;
+    unpack_frame(v.normal, v.tangent, out);
+    const glm::vec2 uv = glm::unpackHalf2x16(v.uv);
+    out.uv_x = uv.x;
+    out.uv_y = uv.y;
+    out.color = glm::unpackUnorm4x8(v.color);
+    return out;
+}
+
+Vertex vertexpacking::unpack(const QuantizedVertex &v, const VertexQuantization &quantization) {
+    Vertex out{};
+    const glm::vec3 q(static_cast<float>(v.position[0]) / SNORM16_MAX, static_cast<float>(v.position[1]) / SNORM16_MAX,
+                      static_cast<float>(v.position[2]) / SNORM16_MAX);
+    out.position = quantization.offset + q * quantization.scale;
+    unpack_frame(v.normal, v.tangent, out);
+    const glm::vec2 uv = glm::unpackHalf2x16(v.uv);
+    out.uv_x = uv.x;
+    out.uv_y = uv.y;
+    out.color = glm::unpackUnorm4x8(v.color);
+    return out;
+}
+
+VertexQuantization vertexpacking::compute_quantization(std::span<const Vertex> vertices) {
+    if (vertices.empty()) {
+        return {};
+    }
+
+    glm::vec3 minpos = vertices[0].position;
+    glm::vec3 maxpos = vertices[0].position;
+    for (const Vertex &v: vertices) {
+        minpos = glm::min(minpos, v.position);
+        maxpos = glm::max(maxpos, v.position);
+    }
+
+    VertexQuantization quantization;
+    quantization.offset = (maxpos + minpos) / 2.f;
+    quantization.scale = (maxpos - minpos) / 2.f;
+    // flat axes would divide by zero, any scale decodes them exactly
+    for (int i = 0; i < 3; i++) {
+        if (quantization.scale[i] <= 0.f) {
+            quantization.scale[i] = 1.f;
+        }
+    }
+    return quantization;
+}
+
+glm::mat4 vertexpacking::dequantize_matrix(const VertexQuantization &quantization) {
+    glm::mat4 m(1.f);
+    m[0][0] = quantization.scale.x;
+    m[1][1] = quantization.scale.y;
+    m[2][2] = quantization.scale.z;
+    m[3] = glm::vec4(quantization.offset, 1.f);
+    return m;
+}
+
+VertexFormat vertexpacking::select_format(std::span<const Vertex> vertices, VertexFormat requested) {
+    if (requested == VertexFormat::Full) {
+        return requested;
+    }
+
+    for (const Vertex &v: vertices) {
+        if (std::fabs(v.uv_x) > PACKED_UV_LIMIT || std::fabs(v.uv_y) > PACKED_UV_LIMIT) {
+            return VertexFormat::Full;
+        }
+    }
+    return requested;
+}
+
+VertexQuantization vertexpacking::pack_vertices(std::span<const Vertex> vertices, VertexFormat format,
+                                                std::vector<std::byte> &out) {
+    out.resize(vertices.size() * stride(format));
+    return pack_vertices(vertices, format, std::span<std::byte>(out));
+}
+
+VertexQuantization vertexpacking::pack_vertices(std::span<const Vertex> vertices, VertexFormat format,
+                                                std::span<std::byte> out) {
+    assert(out.size() >= vertices.size() * stride(format));
+
+    VertexQuantization quantization;
+    switch (format) {
+        case VertexFormat::Packed: {
+            auto *dst = reinterpret_cast<PackedVertex *>(out.data());
+            for (size_t i = 0; i < vertices.size(); i++) {
+                dst[i] = pack(vertices[i]);
+            }
+            break;
+        }
+        case VertexFormat::PackedQuantized: {
+            quantization = compute_quantization(vertices);
+            auto *dst = reinterpret_cast<QuantizedVertex *>(out.data());
+            for (size_t i = 0; i < vertices.size(); i++) {
+                dst[i] = quantize(vertices[i], quantization);
+            }
+            break;
+        }
+        case VertexFormat::Full:
+        default:
+            memcpy(out.data(), vertices.data(), vertices.size_bytes());
+            break;
+    }
+    return quantization;
+}
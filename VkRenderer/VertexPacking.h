@@ -0,0 +1,45 @@
+#pragma once
+
+#include <Vertex.h>
+#include <cstddef>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <span>
+#include <vector>
+
+// Conversion of loader vertices into the compact GPU layouts of Vertex.h. The unpack functions mirror
+// shaders/vertex_fetch.glsl and exist for tests and tooling.
+namespace vertexpacking {
+
+    // half float UVs lose more than a texel of precision past this, meshes beyond it stay full precision
+    constexpr float PACKED_UV_LIMIT = 2.f;
+
+    [[nodiscard]] size_t stride(VertexFormat format);
+    [[nodiscard]] const char *name(VertexFormat format);
+
+    // octahedral mapping of a unit vector onto [-1, 1]^2 and back
+    [[nodiscard]] glm::vec2 oct_encode(const glm::vec3 &n);
+    [[nodiscard]] glm::vec3 oct_decode(const glm::vec2 &e);
+
+    [[nodiscard]] PackedVertex pack(const Vertex &v);
+    [[nodiscard]] QuantizedVertex quantize(const Vertex &v, const VertexQuantization &quantization);
+    [[nodiscard]] Vertex unpack(const PackedVertex &v);
+    [[nodiscard]] Vertex unpack(const QuantizedVertex &v, const VertexQuantization &quantization);
+
+    // offset/scale that map the bounding box of `vertices` onto the snorm16 range
+    [[nodiscard]] VertexQuantization compute_quantization(std::span<const Vertex> vertices);
+
+    // object space from quantized space, for consumers that can't decode positions themselves (BLAS instances)
+    [[nodiscard]] glm::mat4 dequantize_matrix(const VertexQuantization &quantization);
+
+    // the format a mesh actually gets when `requested` is asked for, packed formats fall back to full
+    // precision for meshes whose UVs don't fit in half floats
+    [[nodiscard]] VertexFormat select_format(std::span<const Vertex> vertices, VertexFormat requested);
+
+    // writes `vertices` in `format` to `out` and returns the quantization the positions were stored with
+    VertexQuantization pack_vertices(std::span<const Vertex> vertices, VertexFormat format,
+                                     std::vector<std::byte> &out);
+    // same into memory the caller owns, e.g. mapped staging. `out` holds vertices.size() * stride(format) bytes
+    VertexQuantization pack_vertices(std::span<const Vertex> vertices, VertexFormat format, std::span<std::byte> out);
+
+} // namespace vertexpacking
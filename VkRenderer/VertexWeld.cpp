@@ -0,0 +1,89 @@
+#include "VertexWeld.h"
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace {
+    // position, normal, uv, color, tangent and handedness
+    constexpr size_t KEY_WORDS = 16;
+    using Key = std::array<uint32_t, KEY_WORDS>;
+    constexpr uint32_t EMPTY = ~0u;
+
+    uint32_t exact_word(float value) {
+        // +0 and -0 are the same attribute value
+        return value == 0.f ? 0u : std::bit_cast<uint32_t>(value);
+    }
+
+    Key make_key(const Vertex &v, float handedness, float epsilon) {
+        const float components[KEY_WORDS] = {
+            v.position.x, v.position.y, v.position.z, v.normal.x,  v.normal.y,  v.normal.z,  v.uv_x,    v.uv_y,
+            v.color.x,    v.color.y,    v.color.z,    v.color.w,   v.tangent.x, v.tangent.y, v.tangent.z, handedness};
+        Key key;
+        for (size_t i = 0; i < KEY_WORDS; i++) {
+            key[i] = epsilon > 0.f ? static_cast<uint32_t>(static_cast<int32_t>(std::lround(components[i] / epsilon)))
+                                   : exact_word(components[i]);
+        }
+        // the sign of the handedness never rounds away
+        key[KEY_WORDS - 1] = handedness < 0.f ? 1u : 0u;
+        return key;
+    }
+
+    uint32_t hash_key(const Key &key) {
+        uint32_t hash = 2166136261u;
+        for (const uint32_t word: key) {
+            hash = (hash ^ word) * 16777619u;
+            hash ^= hash >> 15;
+        }
+        return hash;
+    }
+} // namespace
+
+namespace vertexweld {
+
+    size_t weld(std::span<Vertex> vertices, std::span<float> handedness, std::span<uint32_t> indices,
+                uint32_t baseVertex, float epsilon) {
+        assert(handedness.size() == vertices.size());
+        const size_t count = vertices.size();
+        if (count == 0) {
+            return 0;
+        }
+
+        std::vector<Key> keys(count);
+        for (size_t v = 0; v < count; v++) {
+            keys[v] = make_key(vertices[v], handedness[v], epsilon);
+        }
+
+        // open addressing over vertex numbers, at most half full
+        const size_t capacity = std::bit_ceil(count * 2);
+        const size_t mask = capacity - 1;
+        std::vector<uint32_t> table(capacity, EMPTY);
+        std::vector<uint32_t> remap(count);
+        size_t unique = 0;
+        for (size_t v = 0; v < count; v++) {
+            size_t slot = hash_key(keys[v]) & mask;
+            while (table[slot] != EMPTY && keys[table[slot]] != keys[v]) {
+                slot = (slot + 1) & mask;
+            }
+            if (table[slot] != EMPTY) {
+                remap[v] = remap[table[slot]];
+                continue;
+            }
+            // unique <= v, so compacting in place never overwrites a vertex that is still to be visited
+            table[slot] = static_cast<uint32_t>(v);
+            remap[v] = static_cast<uint32_t>(unique);
+            vertices[unique] = vertices[v];
+            handedness[unique] = handedness[v];
+            unique++;
+        }
+
+        for (uint32_t &index: indices) {
+            assert(index >= baseVertex && index - baseVertex < count);
+            index = baseVertex + remap[index - baseVertex];
+        }
+        return unique;
+    }
+
+} // namespace vertexweld
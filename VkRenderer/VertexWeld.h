@@ -0,0 +1,19 @@
+#pragma once
+
+#include <Vertex.h>
+#include <cstdint>
+#include <span>
+
+// Vertex welding pass of the glTF loader, run once per primitive before its tangent frames are built. Exporters
+// split vertices per face or emit unindexed triangles, so many primitives carry identical vertices. Like
+// meshoptimize, `indices` index the mesh and `baseVertex` is the mesh index of vertices[0].
+namespace vertexweld {
+
+    // merges vertices whose position, normal, uv, color, tangent and handedness all match and rewrites `indices`
+    // to the first of each group. with an epsilon > 0 components match when they round to the same multiple of
+    // it, so near duplicates merge too (pairs straddling a rounding boundary stay apart). the kept vertices move
+    // to the front in their original order, returns how many there are
+    size_t weld(std::span<Vertex> vertices, std::span<float> handedness, std::span<uint32_t> indices,
+                uint32_t baseVertex, float epsilon = 0.f);
+
+} // namespace vertexweld
@@ -5,7 +5,7 @@
  */
 
 #include "VulkanGeometryKHR.h"
-#include <Vertex.h>
+#include <VertexPacking.h>
 #include "raytraceKHR_vk.h"
 
 namespace experirender::vk {
@@ -15,15 +15,17 @@ namespace experirender::vk {
 
         const uint32_t max_primitive_count = mesh.indexCount / 3;
 
-        // Describe buffer as array of VertexObj
+        // Describe buffer as array of VertexObj. every layout starts with the position, quantized ones as snorm16
+        // in mesh bounds space which the instance transform undoes
         VkAccelerationStructureGeometryTrianglesDataKHR triangles{
             .sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR,
             .pNext = nullptr,
-            .vertexFormat = VK_FORMAT_R32G32B32_SFLOAT,
+            .vertexFormat = mesh.vertexFormat == VertexFormat::PackedQuantized ? VK_FORMAT_R16G16B16A16_SNORM
+                                                                               : VK_FORMAT_R32G32B32_SFLOAT,
             .vertexData = {.deviceAddress = vertex_address},
-            .vertexStride = sizeof(Vertex),
+            .vertexStride = vertexpacking::stride(mesh.vertexFormat),
             .maxVertex = mesh.vertexCount,
-            .indexType = VK_INDEX_TYPE_UINT32,
+            .indexType = mesh.indexType,
             .indexData = {.deviceAddress = index_address},
             .transformData = {}, // null implies identity transform
         };
@@ -43,8 +45,8 @@ namespace experirender::vk {
         // The entire array will be used to build the BLAS
         VkAccelerationStructureBuildRangeInfoKHR offset{
             .primitiveCount = max_primitive_count,
-            .primitiveOffset = static_cast<uint32_t>(mesh.firstIndex * sizeof(std::uint32_t)),
-            .firstVertex = 0,
+            .primitiveOffset = mesh.firstIndex * (mesh.indexType == VK_INDEX_TYPE_UINT16 ? 2u : 4u),
+            .firstVertex = static_cast<uint32_t>(mesh.vertexOffset),
             .transformOffset = 0,
         };
 
@@ -1,8 +1,19 @@
+#include <string_view>
 #include <vk_engine.h>
 
-int main() {
+int main(int argc, char *argv[]) {
     VulkanEngine engine;
 
+    // --load-report [directory] writes a JSON report of every scene load, next to the scene without a directory
+    for (int i = 1; i < argc; i++) {
+        if (std::string_view(argv[i]) == "--load-report") {
+            engine.loaderSettings.writeLoadReports = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                engine.loaderSettings.loadReportDirectory = argv[++i];
+            }
+        }
+    }
+
     engine.init();
 
     engine.run();
@@ -10,4 +21,4 @@ int main() {
     engine.cleanup();
 
     return 0;
-}
\ No newline at end of file
+}
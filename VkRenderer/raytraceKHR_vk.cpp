@@ -163,24 +163,33 @@ nvvk::RaytracingBuilderKHR::RaytracingBuilderKHR(VulkanEngine *engine, uint32_t
 // Destroying all allocations
 //
 void nvvk::RaytracingBuilderKHR::destroy() {
-
-    if (m_tlas.buffer.buffer != VK_NULL_HANDLE) {
-        vkutil::destroy_buffer(m_engine_ptr, m_tlas.buffer);
-    }
-    if (m_tlas.accel != VK_NULL_HANDLE) {
-        vkDestroyAccelerationStructureKHR(m_engine_ptr->_device, m_tlas.accel, nullptr);
+    destroyAccelerationStructures();
+    if (m_cmd_pool != VK_NULL_HANDLE) {
+        vkDestroyCommandPool(m_engine_ptr->_device, m_cmd_pool, nullptr);
     }
+}
+
+//--------------------------------------------------------------------------------------------------
+// Destroying the acceleration structures, the command pool stays for the next build
+//
+void nvvk::RaytracingBuilderKHR::destroyAccelerationStructures() {
+    destroyTlas();
     for (auto &blas: m_blas) {
-        if (blas.buffer.buffer != VK_NULL_HANDLE) {
-            vkutil::destroy_buffer(m_engine_ptr, blas.buffer);
-        }
-        if (blas.accel != VK_NULL_HANDLE) {
-            vkDestroyAccelerationStructureKHR(m_engine_ptr->_device, blas.accel, nullptr);
-        }
+        destroyAccel(blas);
     }
-    if (m_cmd_pool != VK_NULL_HANDLE) {
-        vkDestroyCommandPool(m_engine_ptr->_device, m_cmd_pool, nullptr);
+    m_blas.clear();
+}
+
+void nvvk::RaytracingBuilderKHR::destroyTlas() { destroyAccel(m_tlas); }
+
+void nvvk::RaytracingBuilderKHR::destroyAccel(nvvk::AccelKHR &accel) {
+    if (accel.buffer.buffer != VK_NULL_HANDLE) {
+        vkutil::destroy_buffer(m_engine_ptr, accel.buffer);
+    }
+    if (accel.accel != VK_NULL_HANDLE) {
+        vkDestroyAccelerationStructureKHR(m_engine_ptr->_device, accel.accel, nullptr);
     }
+    accel = {};
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -325,6 +334,24 @@ void nvvk::RaytracingBuilderKHR::buildBlas(const std::vector<BlasInput> &input,
     // m_cmdPool.deinit();
 }
 
+//--------------------------------------------------------------------------------------------------
+// Replace some of the BLAS, e.g. after their geometry was reloaded
+// - The new BLAS are built after the existing ones, then moved into the slots in `ids`
+// - The replaced BLAS are destroyed, the caller waits for the device to be done with them
+//
+void nvvk::RaytracingBuilderKHR::rebuildBlas(const std::vector<uint32_t> &ids, const std::vector<BlasInput> &input,
+                                             VkBuildAccelerationStructureFlagsKHR flags) {
+    assert(ids.size() == input.size());
+    const size_t firstNew = m_blas.size();
+    buildBlas(input, flags);
+    for (size_t i = 0; i < ids.size(); i++) {
+        assert(ids[i] < firstNew);
+        destroyAccel(m_blas[ids[i]]);
+        m_blas[ids[i]] = m_blas[firstNew + i];
+    }
+    m_blas.resize(firstNew);
+}
+
 //--------------------------------------------------------------------------------------------------
 // Creating the bottom level acceleration structure for all indices of `buildAs` vector.
 // The array of BuildAccelerationStructure was created in buildBlas and the vector of
@@ -134,6 +134,12 @@ namespace nvvk {
         // Destroying all allocations
         void destroy();
 
+        // Destroying the BLAS and the TLAS, a new scene builds its own
+        void destroyAccelerationStructures();
+
+        // Destroying the TLAS only, so it can be built again over replaced BLAS
+        void destroyTlas();
+
         // Returning the constructed top-level acceleration structure
         VkAccelerationStructureKHR getAccelerationStructure() const;
 
@@ -145,6 +151,12 @@ namespace nvvk {
             const std::vector<BlasInput> &input,
             VkBuildAccelerationStructureFlagsKHR flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR);
 
+        // Build new BLAS for the ids in `ids` from `input` and replace the old ones, every other BLAS keeps its
+        // device address
+        void rebuildBlas(
+            const std::vector<uint32_t> &ids, const std::vector<BlasInput> &input,
+            VkBuildAccelerationStructureFlagsKHR flags = VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR);
+
         // Refit BLAS number blasIdx from updated buffer contents.
         void updateBlas(uint32_t blasIdx, BlasInput &blas, VkBuildAccelerationStructureFlagsKHR flags);
 
@@ -219,6 +231,7 @@ namespace nvvk {
         void cmdCompactBlas(VkCommandBuffer cmdBuf, std::vector<uint32_t> indices,
                             std::vector<BuildAccelerationStructure> &buildAs, VkQueryPool queryPool);
         void destroyNonCompacted(std::vector<uint32_t> indices, std::vector<BuildAccelerationStructure> &buildAs);
+        void destroyAccel(nvvk::AccelKHR &accel);
         bool hasFlag(VkFlags item, VkFlags flag) { return (item & flag) == flag; }
     };
 
@@ -1,12 +1,27 @@
 #include "raytracer.h"
 #include "vk_engine.h"
 
+#include <ContentHash.h>
+#include <VertexPacking.h>
 #include <VulkanGeometryKHR.h>
 #include <random>
 #include <spdlog/spdlog.h>
 #include <vk_buffers.h>
 #include <vk_images.h>
 
+// the ray tracer indexes its instances over both draw lists, opaque surfaces first
+static const RenderObject &rt_surface(const DrawContext &ctx, uint32_t index) {
+    return index < ctx.OpaqueSurfaces.size() ? ctx.OpaqueSurfaces[index]
+                                             : ctx.TransparentSurfaces[index - ctx.OpaqueSurfaces.size()];
+}
+
+// quantized positions are built into the BLAS as is, the instance transform dequantizes them
+static glm::mat4 rt_instance_matrix(const RenderObject &surface) {
+    return surface.vertexFormat == VertexFormat::PackedQuantized
+               ? surface.transform * vertexpacking::dequantize_matrix(surface.quantization)
+               : surface.transform;
+}
+
 void Raytracer::init_ray_tracing(VulkanEngine *engine) {
 
     // Requesting ray tracing properties
@@ -26,7 +41,10 @@ void Raytracer::setRTDefaultData() {
     prevUseMicrofacetSampling = useMicrofacetSampling;
 }
 
-void Raytracer::createBottomLevelAS(const VulkanEngine *engine) const {
+void Raytracer::createBottomLevelAS(const VulkanEngine *engine) {
+    // a new scene replaces whatever the last one built
+    m_rt_builder->destroyAccelerationStructures();
+    m_instances = collectInstances(engine);
 
     // BLAS - Storing each primitive in a geometry
     std::vector<nvvk::RaytracingBuilderKHR::BlasInput> blas_inputs;
@@ -69,7 +87,7 @@ void Raytracer::createTopLevelAS(const VulkanEngine *engine) const {
     // Add opaque surfaces first
     for (std::uint32_t i = 0; i < engine->mainDrawContext.OpaqueSurfaces.size(); i++) {
         VkTransformMatrixKHR vk_transform = {};
-        const glm::mat4 &t = engine->mainDrawContext.OpaqueSurfaces[i].transform;
+        const glm::mat4 t = rt_instance_matrix(engine->mainDrawContext.OpaqueSurfaces[i]);
 
         vk_transform.matrix[0][0] = t[0][0];
         vk_transform.matrix[0][1] = t[1][0];
@@ -101,7 +119,7 @@ void Raytracer::createTopLevelAS(const VulkanEngine *engine) const {
     const auto opaqueCount = static_cast<uint32_t>(engine->mainDrawContext.OpaqueSurfaces.size());
     for (std::uint32_t i = 0; i < static_cast<uint32_t>(engine->mainDrawContext.TransparentSurfaces.size()); i++) {
         VkTransformMatrixKHR vk_transform = {};
-        const glm::mat4 &t = engine->mainDrawContext.TransparentSurfaces[i].transform;
+        const glm::mat4 t = rt_instance_matrix(engine->mainDrawContext.TransparentSurfaces[i]);
 
         vk_transform.matrix[0][0] = t[0][0];
         vk_transform.matrix[0][1] = t[1][0];
@@ -176,65 +194,28 @@ void Raytracer::createRtDescriptorSet(VulkanEngine *engine) {
                                                                                VK_SHADER_STAGE_ANY_HIT_BIT_KHR);
     }
 
-    std::vector<ObjDesc> objDescs;
-    const auto totalSurfaces = static_cast<uint32_t>(engine->mainDrawContext.OpaqueSurfaces.size() +
-                                                     engine->mainDrawContext.TransparentSurfaces.size());
-    objDescs.reserve(totalSurfaces);
-
-    // Add opaque surfaces first
-    for (auto &OpaqueSurface: engine->mainDrawContext.OpaqueSurfaces) {
-        ObjDesc desc = {.vertexAddress = OpaqueSurface.vertexBufferAddress,
-                        .indexAddress = OpaqueSurface.indexBufferAddress,
-                        .firstIndex = OpaqueSurface.firstIndex};
-        objDescs.push_back(desc);
-    }
-
-    // Add transparent surfaces
-    for (auto &TransparentSurface: engine->mainDrawContext.TransparentSurfaces) {
-        ObjDesc desc = {.vertexAddress = TransparentSurface.vertexBufferAddress,
-                        .indexAddress = TransparentSurface.indexBufferAddress,
-                        .firstIndex = TransparentSurface.firstIndex};
-        objDescs.push_back(desc);
-    }
+    const std::vector<ObjDesc> objDescs = collectObjDescs(engine);
 
     m_objDescSet = engine->globalDescriptorAllocator.allocate(engine->_device, m_objDescSetLayout);
 
-    AllocatedBuffer m_objDescSetBuffer =
-        vkutil::create_buffer(engine, sizeof(ObjDesc) * objDescs.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
-                              VMA_MEMORY_USAGE_CPU_TO_GPU, "RT ObjDesc Buffer");
+    // kept so a hot reload can rewrite it in place, the deletion below destroys this one
+    m_objDescBuffer = vkutil::create_buffer(engine, sizeof(ObjDesc) * objDescs.size(),
+                                            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU,
+                                            "RT ObjDesc Buffer");
 
     ObjDesc *objDescsToMap;
-    VK_CHECK(
-        vmaMapMemory(engine->_allocator, m_objDescSetBuffer.allocation, reinterpret_cast<void **>(&objDescsToMap)));
+    VK_CHECK(vmaMapMemory(engine->_allocator, m_objDescBuffer.allocation, reinterpret_cast<void **>(&objDescsToMap)));
     memcpy(objDescsToMap, objDescs.data(), sizeof(ObjDesc) * objDescs.size());
-    vmaUnmapMemory(engine->_allocator, m_objDescSetBuffer.allocation);
+    vmaUnmapMemory(engine->_allocator, m_objDescBuffer.allocation);
 
     DescriptorWriter obj_writer;
-    obj_writer.write_buffer(0, m_objDescSetBuffer.buffer, sizeof(ObjDesc) * objDescs.size(), 0,
+    obj_writer.write_buffer(0, m_objDescBuffer.buffer, sizeof(ObjDesc) * objDescs.size(), 0,
                             VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
     obj_writer.update_set(engine->_device, m_objDescSet);
 
     // Tex Descriptions
     // Put all textures in loadScenes to a vector
-    uint32_t textureIndex = 0;
-
-    // Add opaque surface textures first
-    for (std::uint32_t i = 0; i < engine->mainDrawContext.OpaqueSurfaces.size(); i++) {
-        loadedTextures.push_back(engine->mainDrawContext.OpaqueSurfaces[i].material->colImage);
-        loadedNormTextures.push_back(engine->mainDrawContext.OpaqueSurfaces[i].material->normImage);
-        loadedMetalRoughTextures.push_back(engine->mainDrawContext.OpaqueSurfaces[i].material->metalRoughImage);
-        loadedEmissiveTextures.push_back(engine->mainDrawContext.OpaqueSurfaces[i].material->emissiveImage);
-        engine->mainDrawContext.OpaqueSurfaces[i].material->albedoTexIndex = textureIndex++;
-    }
-
-    // Add transparent surface textures
-    for (std::uint32_t i = 0; i < static_cast<uint32_t>(engine->mainDrawContext.TransparentSurfaces.size()); i++) {
-        loadedTextures.push_back(engine->mainDrawContext.TransparentSurfaces[i].material->colImage);
-        loadedNormTextures.push_back(engine->mainDrawContext.TransparentSurfaces[i].material->normImage);
-        loadedMetalRoughTextures.push_back(engine->mainDrawContext.TransparentSurfaces[i].material->metalRoughImage);
-        loadedEmissiveTextures.push_back(engine->mainDrawContext.TransparentSurfaces[i].material->emissiveImage);
-        engine->mainDrawContext.TransparentSurfaces[i].material->albedoTexIndex = textureIndex++;
-    }
+    collectTextures(engine);
 
     // Always create texture descriptor set (even when no textures, we need default ones)
     {
@@ -259,98 +240,15 @@ void Raytracer::createRtDescriptorSet(VulkanEngine *engine) {
 
         m_texDescSet = engine->globalDescriptorAllocator.allocate(engine->_device, m_texSetLayout);
 
-        // Color Texture
-        std::vector<VkDescriptorImageInfo> texDescs;
-        texDescs.reserve(nbTxt);
-        for (uint32_t i = 0; i < nbTxt; i++) {
-            VkDescriptorImageInfo imageInfo{.sampler = engine->_resourceManager.getLinearSampler(),
-                                            .imageView = i < loadedTextures.size()
-                                                             ? loadedTextures[i].imageView
-                                                             : engine->_resourceManager.getWhiteImage().imageView,
-                                            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
-            texDescs.push_back(imageInfo);
-        }
-
-        // Normal Texture
-        std::vector<VkDescriptorImageInfo> normTexDescs;
-        normTexDescs.reserve(nbNormText);
-        for (uint32_t i = 0; i < nbNormText; i++) {
-            VkDescriptorImageInfo imageInfo{.sampler = engine->_resourceManager.getLinearSampler(),
-                                            .imageView = i < loadedNormTextures.size()
-                                                             ? loadedNormTextures[i].imageView
-                                                             : engine->_resourceManager.getGreyImage().imageView,
-                                            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
-            normTexDescs.push_back(imageInfo);
-        }
-
-        // Metal Rough Texture
-        std::vector<VkDescriptorImageInfo> metalRoughTexDescs;
-        metalRoughTexDescs.reserve(nbMetalRoughText);
-        for (uint32_t i = 0; i < nbMetalRoughText; i++) {
-            VkDescriptorImageInfo imageInfo{.sampler = engine->_resourceManager.getLinearSampler(),
-                                            .imageView = i < loadedMetalRoughTextures.size()
-                                                             ? loadedMetalRoughTextures[i].imageView
-                                                             : engine->_resourceManager.getWhiteImage().imageView,
-                                            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
-            metalRoughTexDescs.push_back(imageInfo);
-        }
-
-        std::vector<VkDescriptorImageInfo> emissiveTexDescs;
-        emissiveTexDescs.reserve(nbEmissiveText);
-        for (uint32_t i = 0; i < nbEmissiveText; i++) {
-            VkDescriptorImageInfo imageInfo{.sampler = engine->_resourceManager.getLinearSampler(),
-                                            .imageView = i < loadedEmissiveTextures.size()
-                                                             ? loadedEmissiveTextures[i].imageView
-                                                             : engine->_resourceManager.getBlackImage().imageView,
-                                            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
-            emissiveTexDescs.push_back(imageInfo);
-        }
-
-        DescriptorWriter tex_writer;
-        tex_writer.write_images(0, *texDescs.data(), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, nbTxt);
-        tex_writer.write_images(1, *normTexDescs.data(), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, nbNormText);
-        tex_writer.write_image(2, engine->hdrImage.get_hdriMap().imageView, engine->hdrImage.get_hdriMapSampler(),
-                               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
-        tex_writer.write_images(3, *metalRoughTexDescs.data(), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                                nbMetalRoughText); // Metal Roughness
-        tex_writer.write_images(4, *emissiveTexDescs.data(), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                                nbEmissiveText); // Emissive Maps
-        tex_writer.update_set(engine->_device, m_texDescSet);
+        writeRtTextureDescriptors(engine);
+        textureGeneration = engine->textureStreamer.generation();
 
         engine->_mainDeletionQueue.push_function(
             [=, this] { vkDestroyDescriptorSetLayout(engine->_device, m_texSetLayout, nullptr); });
     }
 
     // Mat descriptions
-    std::vector<MaterialRTData> materialRTShaderData;
-
-    // Add opaque surface materials first
-    for (auto &OpaqueSurface: engine->mainDrawContext.OpaqueSurfaces) {
-        MaterialRTData matDesc{};
-        matDesc.albedo = OpaqueSurface.material->albedo;
-        matDesc.albedoTexIndex = OpaqueSurface.material->albedoTexIndex;
-        matDesc.metal_rough_factors = OpaqueSurface.material->metalRoughFactors;
-        matDesc.transmissionFactor = 0.0f; // Opaque materials have no transmission
-        matDesc.hasTransmissionTex = 0;
-        matDesc.ior = OpaqueSurface.material->ior;
-        matDesc.emissiveFactor = OpaqueSurface.material->emissiveFactor;
-        matDesc.hasEmissiveTex = OpaqueSurface.material->emissiveTexIndex != 0 ? 1 : 0;
-        materialRTShaderData.push_back(matDesc);
-    }
-
-    // Add transparent surface materials
-    for (auto &TransparentSurface: engine->mainDrawContext.TransparentSurfaces) {
-        MaterialRTData matDesc{};
-        matDesc.albedo = TransparentSurface.material->albedo;
-        matDesc.albedoTexIndex = TransparentSurface.material->albedoTexIndex;
-        matDesc.metal_rough_factors = TransparentSurface.material->metalRoughFactors;
-        matDesc.transmissionFactor = TransparentSurface.material->transmissionFactor;
-        matDesc.hasTransmissionTex = 0;
-        matDesc.ior = TransparentSurface.material->ior;
-        matDesc.emissiveFactor = TransparentSurface.material->emissiveFactor;
-        matDesc.hasEmissiveTex = TransparentSurface.material->emissiveTexIndex != 0 ? 1 : 0;
-        materialRTShaderData.push_back(matDesc);
-    }
+    const std::vector<MaterialRTData> materialRTShaderData = collectMaterialData(engine);
 
     {
         DescriptorLayoutBuilder m_matDescSetLayoutBind;
@@ -361,32 +259,236 @@ void Raytracer::createRtDescriptorSet(VulkanEngine *engine) {
 
     m_matDescSet = engine->globalDescriptorAllocator.allocate(engine->_device, m_matDescSetLayout);
 
-    AllocatedBuffer m_matDescSetBuffer =
+    m_matDescBuffer =
         vkutil::create_buffer(engine, sizeof(MaterialRTData) * materialRTShaderData.size(),
                               VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU, "RT MatDesc Buffer");
 
     MaterialRTData *matDescsToMap;
-    VK_CHECK(
-        vmaMapMemory(engine->_allocator, m_matDescSetBuffer.allocation, reinterpret_cast<void **>(&matDescsToMap)));
+    VK_CHECK(vmaMapMemory(engine->_allocator, m_matDescBuffer.allocation, reinterpret_cast<void **>(&matDescsToMap)));
     memcpy(matDescsToMap, materialRTShaderData.data(), sizeof(MaterialRTData) * materialRTShaderData.size());
-    vmaUnmapMemory(engine->_allocator, m_matDescSetBuffer.allocation);
+    vmaUnmapMemory(engine->_allocator, m_matDescBuffer.allocation);
 
     DescriptorWriter mat_writer;
-    mat_writer.write_buffer(0, m_matDescSetBuffer.buffer, sizeof(MaterialRTData) * materialRTShaderData.size(), 0,
+    mat_writer.write_buffer(0, m_matDescBuffer.buffer, sizeof(MaterialRTData) * materialRTShaderData.size(), 0,
                             VK_DESCRIPTOR_TYPE_STORAGE_BUFFER);
 
     mat_writer.update_set(engine->_device, m_matDescSet);
 
-    engine->_mainDeletionQueue.push_function([=, this] {
+    engine->_mainDeletionQueue.push_function([=, this, objDescBuffer = m_objDescBuffer,
+                                              matDescBuffer = m_matDescBuffer] {
         vkDestroyDescriptorSetLayout(engine->_device, m_rtDescSetLayout, nullptr);
         vkDestroyDescriptorSetLayout(engine->_device, m_objDescSetLayout, nullptr);
         vkDestroyDescriptorSetLayout(engine->_device, m_matDescSetLayout, nullptr);
         // _rtOutputImage is already handled by its own deletion function
-        vkutil::destroy_buffer(engine, m_objDescSetBuffer);
-        vkutil::destroy_buffer(engine, m_matDescSetBuffer);
+        vkutil::destroy_buffer(engine, objDescBuffer);
+        vkutil::destroy_buffer(engine, matDescBuffer);
     });
 }
 
+std::vector<ObjDesc> Raytracer::collectObjDescs(const VulkanEngine *engine) const {
+    const DrawContext &ctx = engine->mainDrawContext;
+    std::vector<ObjDesc> objDescs;
+    objDescs.reserve(ctx.OpaqueSurfaces.size() + ctx.TransparentSurfaces.size());
+    for (uint32_t i = 0; i < ctx.OpaqueSurfaces.size() + ctx.TransparentSurfaces.size(); i++) {
+        const RenderObject &surface = rt_surface(ctx, i);
+        objDescs.push_back({.vertexAddress = surface.vertexBufferAddress,
+                            .indexAddress = surface.indexBufferAddress,
+                            .firstIndex = surface.firstIndex,
+                            .vertexFormat = static_cast<uint32_t>(surface.vertexFormat),
+                            .indexType = surface.indexType == VK_INDEX_TYPE_UINT16 ? 1u : 0u,
+                            .vertexOffset = surface.vertexOffset});
+    }
+    return objDescs;
+}
+
+std::vector<MaterialRTData> Raytracer::collectMaterialData(const VulkanEngine *engine) const {
+    const DrawContext &ctx = engine->mainDrawContext;
+    std::vector<MaterialRTData> materialRTShaderData;
+    materialRTShaderData.reserve(ctx.OpaqueSurfaces.size() + ctx.TransparentSurfaces.size());
+    for (uint32_t i = 0; i < ctx.OpaqueSurfaces.size() + ctx.TransparentSurfaces.size(); i++) {
+        const MaterialInstance *material = rt_surface(ctx, i).material;
+        MaterialRTData matDesc{};
+        matDesc.albedo = material->albedo;
+        matDesc.albedoTexIndex = material->albedoTexIndex;
+        matDesc.metal_rough_factors = material->metalRoughFactors;
+        // Opaque materials have no transmission
+        matDesc.transmissionFactor = i < ctx.OpaqueSurfaces.size() ? 0.0f : material->transmissionFactor;
+        matDesc.hasTransmissionTex = 0;
+        matDesc.ior = material->ior;
+        matDesc.emissiveFactor = material->emissiveFactor;
+        matDesc.hasEmissiveTex = material->emissiveTexIndex != 0 ? 1 : 0;
+        materialRTShaderData.push_back(matDesc);
+    }
+    return materialRTShaderData;
+}
+
+void Raytracer::collectTextures(const VulkanEngine *engine) {
+    const DrawContext &ctx = engine->mainDrawContext;
+    loadedTextures.clear();
+    loadedNormTextures.clear();
+    loadedMetalRoughTextures.clear();
+    loadedEmissiveTextures.clear();
+    loadedMaterials.clear();
+
+    // Add opaque surface textures first, then the transparent ones
+    for (uint32_t i = 0; i < ctx.OpaqueSurfaces.size() + ctx.TransparentSurfaces.size(); i++) {
+        MaterialInstance *material = rt_surface(ctx, i).material;
+        loadedTextures.push_back(material->colImage);
+        loadedNormTextures.push_back(material->normImage);
+        loadedMetalRoughTextures.push_back(material->metalRoughImage);
+        loadedEmissiveTextures.push_back(material->emissiveImage);
+        loadedMaterials.push_back(material);
+        material->albedoTexIndex = i;
+    }
+}
+
+std::vector<scenediff::Instance> Raytracer::collectInstances(const VulkanEngine *engine) const {
+    const DrawContext &ctx = engine->mainDrawContext;
+    std::vector<scenediff::Instance> instances;
+    instances.reserve(ctx.OpaqueSurfaces.size() + ctx.TransparentSurfaces.size());
+    for (uint32_t i = 0; i < ctx.OpaqueSurfaces.size() + ctx.TransparentSurfaces.size(); i++) {
+        const RenderObject &surface = rt_surface(ctx, i);
+        // everything objectToVkGeometryKHR builds the BLAS from
+        uint64_t geometry = hash_combine(surface.vertexBufferAddress, surface.indexBufferAddress);
+        geometry = hash_combine(geometry, (uint64_t{surface.firstIndex} << 32) | surface.indexCount);
+        geometry = hash_combine(geometry, (uint64_t{surface.vertexCount} << 32) |
+                                              static_cast<uint32_t>(surface.vertexOffset));
+        geometry = hash_combine(geometry, (static_cast<uint64_t>(surface.vertexFormat) << 32) |
+                                              static_cast<uint32_t>(surface.indexType));
+        const glm::mat4 transform = rt_instance_matrix(surface);
+        instances.push_back({geometry, hash_bytes(&transform, sizeof(transform)), i >= ctx.OpaqueSurfaces.size()});
+    }
+    return instances;
+}
+
+scenediff::InstanceDiff Raytracer::patchScene(VulkanEngine *engine) {
+    std::vector<scenediff::Instance> instances = collectInstances(engine);
+    const scenediff::InstanceDiff diff = scenediff::diff_instances(m_instances, instances);
+    if (diff.rebuildAll) {
+        // the set layouts are sized by the surface count, the pipeline and SBT depend on them
+        createBottomLevelAS(engine);
+        createTopLevelAS(engine);
+        createRtDescriptorSet(engine);
+        createRtPipeline(engine);
+        createRtShaderBindingTable(engine);
+        resetSamples();
+        return diff;
+    }
+
+    const DrawContext &ctx = engine->mainDrawContext;
+    if (!diff.blas.empty()) {
+        std::vector<nvvk::RaytracingBuilderKHR::BlasInput> inputs;
+        inputs.reserve(diff.blas.size());
+        for (const uint32_t id: diff.blas) {
+            inputs.push_back(experirender::vk::objectToVkGeometryKHR(rt_surface(ctx, id)));
+        }
+        m_rt_builder->rebuildBlas(diff.blas, inputs, VK_BUILD_ACCELERATION_STRUCTURE_PREFER_FAST_TRACE_BIT_KHR);
+    }
+    if (diff.tlas) {
+        m_rt_builder->destroyTlas();
+        createTopLevelAS(engine);
+
+        VkAccelerationStructureKHR tlas = m_rt_builder->getAccelerationStructure();
+        VkWriteDescriptorSetAccelerationStructureKHR asInfo = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET_ACCELERATION_STRUCTURE_KHR};
+        asInfo.accelerationStructureCount = 1;
+        asInfo.pAccelerationStructures = &tlas;
+        DescriptorWriter rt_writer;
+        rt_writer.write_accel_struct(0, asInfo, VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR);
+        rt_writer.update_set(engine->_device, m_rtDescSet);
+    }
+    m_instances = std::move(instances);
+
+    // same surface count, the descriptions and textures are rewritten into the buffers and set they already have
+    collectTextures(engine);
+    writeRtTextureDescriptors(engine);
+    textureGeneration = engine->textureStreamer.generation();
+    const std::vector<ObjDesc> objDescs = collectObjDescs(engine);
+    vkutil::upload_to_buffer(engine, objDescs.data(), sizeof(ObjDesc) * objDescs.size(), m_objDescBuffer);
+    const std::vector<MaterialRTData> materialRTShaderData = collectMaterialData(engine);
+    vkutil::upload_to_buffer(engine, materialRTShaderData.data(),
+                             sizeof(MaterialRTData) * materialRTShaderData.size(), m_matDescBuffer);
+    resetSamples();
+    return diff;
+}
+
+void Raytracer::writeRtTextureDescriptors(const VulkanEngine *engine) const {
+    const auto nbTxt = static_cast<uint32_t>(std::max(loadedTextures.size(), size_t(1)));
+    const auto nbNormText = static_cast<uint32_t>(std::max(loadedNormTextures.size(), size_t(1)));
+    const auto nbMetalRoughText = static_cast<uint32_t>(std::max(loadedMetalRoughTextures.size(), size_t(1)));
+    const auto nbEmissiveText = static_cast<uint32_t>(std::max(loadedEmissiveTextures.size(), size_t(1)));
+
+    // Color Texture
+    std::vector<VkDescriptorImageInfo> texDescs;
+    texDescs.reserve(nbTxt);
+    for (uint32_t i = 0; i < nbTxt; i++) {
+        VkDescriptorImageInfo imageInfo{.sampler = engine->_resourceManager.getLinearSampler(),
+                                        .imageView = i < loadedTextures.size()
+                                                         ? loadedTextures[i].imageView
+                                                         : engine->_resourceManager.getWhiteImage().imageView,
+                                        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        texDescs.push_back(imageInfo);
+    }
+
+    // Normal Texture
+    std::vector<VkDescriptorImageInfo> normTexDescs;
+    normTexDescs.reserve(nbNormText);
+    for (uint32_t i = 0; i < nbNormText; i++) {
+        VkDescriptorImageInfo imageInfo{.sampler = engine->_resourceManager.getLinearSampler(),
+                                        .imageView = i < loadedNormTextures.size()
+                                                         ? loadedNormTextures[i].imageView
+                                                         : engine->_resourceManager.getGreyImage().imageView,
+                                        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        normTexDescs.push_back(imageInfo);
+    }
+
+    // Metal Rough Texture
+    std::vector<VkDescriptorImageInfo> metalRoughTexDescs;
+    metalRoughTexDescs.reserve(nbMetalRoughText);
+    for (uint32_t i = 0; i < nbMetalRoughText; i++) {
+        VkDescriptorImageInfo imageInfo{.sampler = engine->_resourceManager.getLinearSampler(),
+                                        .imageView = i < loadedMetalRoughTextures.size()
+                                                         ? loadedMetalRoughTextures[i].imageView
+                                                         : engine->_resourceManager.getWhiteImage().imageView,
+                                        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        metalRoughTexDescs.push_back(imageInfo);
+    }
+
+    std::vector<VkDescriptorImageInfo> emissiveTexDescs;
+    emissiveTexDescs.reserve(nbEmissiveText);
+    for (uint32_t i = 0; i < nbEmissiveText; i++) {
+        VkDescriptorImageInfo imageInfo{.sampler = engine->_resourceManager.getLinearSampler(),
+                                        .imageView = i < loadedEmissiveTextures.size()
+                                                         ? loadedEmissiveTextures[i].imageView
+                                                         : engine->_resourceManager.getBlackImage().imageView,
+                                        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+        emissiveTexDescs.push_back(imageInfo);
+    }
+
+    DescriptorWriter tex_writer;
+    tex_writer.write_images(0, *texDescs.data(), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, nbTxt);
+    tex_writer.write_images(1, *normTexDescs.data(), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, nbNormText);
+    tex_writer.write_image(2, engine->hdrImage.get_hdriMap().imageView, engine->hdrImage.get_hdriMapSampler(),
+                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+    tex_writer.write_images(3, *metalRoughTexDescs.data(), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                            nbMetalRoughText); // Metal Roughness
+    tex_writer.write_images(4, *emissiveTexDescs.data(), VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                            nbEmissiveText); // Emissive Maps
+    tex_writer.update_set(engine->_device, m_texDescSet);
+}
+
+void Raytracer::updateRtTextureDescriptors(VulkanEngine *engine) {
+    // the texture streamer moved some materials to new images since the set was written
+    for (size_t i = 0; i < loadedMaterials.size(); i++) {
+        loadedTextures[i] = loadedMaterials[i]->colImage;
+        loadedNormTextures[i] = loadedMaterials[i]->normImage;
+        loadedMetalRoughTextures[i] = loadedMaterials[i]->metalRoughImage;
+        loadedEmissiveTextures[i] = loadedMaterials[i]->emissiveImage;
+    }
+    writeRtTextureDescriptors(engine);
+    textureGeneration = engine->textureStreamer.generation();
+}
+
 void Raytracer::updateRtDescriptorSet(const VulkanEngine *engine) const {
     // (1) Output buffer
     // VkDescriptorImageInfo imageInfo{ {}, _rtOutputImage.imageView, VK_IMAGE_LAYOUT_GENERAL };
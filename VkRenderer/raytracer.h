@@ -1,5 +1,6 @@
 #pragma once
 
+#include <SceneDiff.h>
 #include <raytraceKHR_vk.h>
 #include <vk_loader.h>
 #include <vk_types.h>
@@ -29,13 +30,19 @@ struct MaterialRTData {
 class Raytracer {
 public:
     void init_ray_tracing(VulkanEngine *engine);
-    void createBottomLevelAS(const VulkanEngine *engine) const;
+    void createBottomLevelAS(const VulkanEngine *engine);
     void createTopLevelAS(const VulkanEngine *engine) const;
     void createRtDescriptorSet(VulkanEngine *engine);
     void createRtOutputImageOnly(VulkanEngine *engine);
     void updateRtDescriptorSet(const VulkanEngine *engine) const;
+    // rewrites the texture set from the images the loaded materials sample now
+    void updateRtTextureDescriptors(VulkanEngine *engine);
     void createRtPipeline(VulkanEngine *engine);
     void createRtShaderBindingTable(VulkanEngine *engine);
+    // after a hot reload changed the draw context: rebuilds only the BLAS whose surface geometry changed and the
+    // TLAS when any instance moved, and rewrites the object, material and texture descriptions in place. builds
+    // everything again when the surface list changed shape
+    scenediff::InstanceDiff patchScene(VulkanEngine *engine);
     void resetSamples();
     void raytrace(VulkanEngine *engine, const VkCommandBuffer &cmdBuf);
     void rtSampleUpdates(const VulkanEngine *engine);
@@ -66,6 +73,10 @@ public:
     std::vector<AllocatedImage> loadedNormTextures;
     std::vector<AllocatedImage> loadedMetalRoughTextures;
     std::vector<AllocatedImage> loadedEmissiveTextures;
+    // material of every entry above, the texture streamer swaps their images
+    std::vector<MaterialInstance *> loadedMaterials;
+    // TextureStreamer::generation() the texture set was written at
+    uint64_t textureGeneration{0};
 
     AllocatedBuffer m_rtSBTBuffer{};
     VkStridedDeviceAddressRegionKHR m_rgenRegion{};
@@ -94,4 +105,17 @@ public:
 
     // Rendering options
     bool useMicrofacetSampling = true;
+
+private:
+    void writeRtTextureDescriptors(const VulkanEngine *engine) const;
+    // per surface inputs of the hit shaders, opaque surfaces first like the TLAS instances
+    [[nodiscard]] std::vector<ObjDesc> collectObjDescs(const VulkanEngine *engine) const;
+    [[nodiscard]] std::vector<MaterialRTData> collectMaterialData(const VulkanEngine *engine) const;
+    void collectTextures(const VulkanEngine *engine);
+    [[nodiscard]] std::vector<scenediff::Instance> collectInstances(const VulkanEngine *engine) const;
+
+    AllocatedBuffer m_objDescBuffer{};
+    AllocatedBuffer m_matDescBuffer{};
+    // the surfaces the acceleration structures were built from, what patchScene diffs against
+    std::vector<scenediff::Instance> m_instances;
 };
\ No newline at end of file
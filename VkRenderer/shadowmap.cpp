@@ -127,25 +127,8 @@ void shadowMap::draw_depthShadowMap(VulkanEngine *engine, VkCommandBuffer cmd) c
 
     vkCmdBeginRendering(cmd, &renderInfo);
 
-    std::vector<uint32_t> opaque_draws;
-    opaque_draws.reserve(engine->mainDrawContext.OpaqueSurfaces.size());
-
-    for (int i = 0; i < static_cast<int>(engine->mainDrawContext.OpaqueSurfaces.size()); i++) {
-        /*if (is_visible(mainDrawContext.OpaqueSurfaces[i], sceneData.viewproj)) {*/
-        opaque_draws.push_back(i);
-        /*}*/
-    }
-
-    // sort the opaque surfaces by material and mesh
-    auto &surfaces = engine->mainDrawContext.OpaqueSurfaces;
-    std::ranges::sort(opaque_draws, [&](const auto &iA, const auto &iB) {
-        const RenderObject &A = surfaces[iA];
-        const RenderObject &B = surfaces[iB];
-        if (A.material == B.material) {
-            return A.indexBuffer < B.indexBuffer;
-        }
-        return A.material < B.material;
-    });
+    // sorted by material and mesh, front to back from the light, see VulkanEngine::sort_draws
+    const std::vector<uint32_t> &opaque_draws = engine->shadowVisible.opaque;
 
     // allocate a new uniform buffer for the scene data
     AllocatedBuffer gpuSceneDataBuffer =
@@ -172,6 +155,7 @@ void shadowMap::draw_depthShadowMap(VulkanEngine *engine, VkCommandBuffer cmd) c
     writer.update_set(engine->_device, globalDescriptor);
 
     VkBuffer lastIndexBuffer = VK_NULL_HANDLE;
+    VkIndexType lastIndexType = VK_INDEX_TYPE_UINT32;
 
     auto draw = [&](const RenderObject &r) {
         vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, _depthShadowMapPipeline);
@@ -199,28 +183,28 @@ void shadowMap::draw_depthShadowMap(VulkanEngine *engine, VkCommandBuffer cmd) c
         /*vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, r.material->pipeline->layout, 1, 1,
             &r.material->materialSet, 0, nullptr);*/
 
-        if (r.indexBuffer != lastIndexBuffer) {
+        // the arena block and the surface's index type together, surfaces of one block mix 16 and 32 bit
+        if (r.indexBuffer != lastIndexBuffer || r.indexType != lastIndexType) {
             lastIndexBuffer = r.indexBuffer;
-            vkCmdBindIndexBuffer(cmd, r.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+            lastIndexType = r.indexType;
+            vkCmdBindIndexBuffer(cmd, r.indexBuffer, 0, r.indexType);
         }
         // calculate final mesh matrix
-        GPUDrawPushConstants push_constants{};
-        push_constants.worldMatrix = r.transform;
-        push_constants.vertexBuffer = r.vertexBufferAddress;
+        const GPUDrawPushConstants push_constants = draw_push_constants(r);
 
         vkCmdPushConstants(cmd, _depthShadowMapPipelineLayout,
                            VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(GPUDrawPushConstants),
                            &push_constants);
 
-        vkCmdDrawIndexed(cmd, r.indexCount, 1, r.firstIndex, 0, 0);
+        vkCmdDrawIndexed(cmd, r.indexCount, 1, r.firstIndex, r.vertexOffset, 0);
     };
 
     for (auto &r: opaque_draws) {
         draw(engine->mainDrawContext.OpaqueSurfaces[r]);
     }
 
-    for (auto &r: engine->mainDrawContext.TransparentSurfaces) {
-        draw(r);
+    for (const uint32_t r: engine->shadowVisible.transparent) {
+        draw(engine->mainDrawContext.TransparentSurfaces[r]);
     }
 
 
@@ -1,4 +1,6 @@
 #include <spdlog/spdlog.h>
+#include <Simd.h>
+#include <VertexPacking.h>
 #include <ui.h>
 #include "backends/imgui_impl_sdl2.h"
 #include "backends/imgui_impl_vulkan.h"
@@ -317,6 +319,114 @@ void ui::create_settings_panel(VulkanEngine *engine) {
         "Ray Tracer mode",
         reinterpret_cast<bool *>(&engine->postProcessor._compositorData)); // Switch between raster and ray tracing
 
+    if (ImGui::CollapsingHeader("Loader Settings")) {
+        ImGui::Checkbox("Parallel image decode", &engine->loaderSettings.parallelImageDecode);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Decode glTF textures on %u worker threads, applies to the next loaded scene.",
+                              engine->jobSystem.thread_count());
+        }
+        ImGui::Checkbox("Map glTF buffers", &engine->loaderSettings.mapBuffers);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Memory map external .bin files and read accessors in place instead of loading a copy "
+                              "of each.");
+        }
+        ImGui::Checkbox("Mesh cache", &engine->loaderSettings.useMeshCache);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Reuse processed geometry from %s when the glTF content hash matches.",
+                              engine->loaderSettings.meshCacheDirectory.string().c_str());
+        }
+        ImGui::Checkbox("Weld vertices", &engine->loaderSettings.weldVertices);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Merge duplicate vertices of every primitive, applies to the next loaded scene.");
+        }
+        ImGui::BeginDisabled(!engine->loaderSettings.weldVertices);
+        ImGui::DragFloat("Weld epsilon", &engine->loaderSettings.weldEpsilon, 0.0001f, 0.f, 0.1f, "%.4f");
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("0 merges exact duplicates only, larger values also merge vertices whose attributes "
+                              "round to the same multiple of it.");
+        }
+        ImGui::EndDisabled();
+        ImGui::Checkbox("Optimize meshes", &engine->loaderSettings.optimizeMeshes);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Reorder triangles and vertices of every primitive for the vertex cache and overdraw.");
+        }
+        ImGui::Checkbox("Generate LODs", &engine->loaderSettings.generateLods);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Simplify every primitive into up to %u coarser levels.", simplify::MAX_LODS);
+        }
+        ImGui::Checkbox("16 bit indices", &engine->loaderSettings.narrowIndices);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Upload the indices of surfaces spanning at most 65536 vertices as 16 bit, rebased on "
+                              "their first vertex.");
+        }
+        ImGui::BeginDisabled(!engine->_textureCompressionBC);
+        ImGui::Checkbox("Compress textures", &engine->loaderSettings.compressTextures);
+        ImGui::EndDisabled();
+        if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+            ImGui::SetTooltip("BC7 color, BC5 normal and BC1 metal/roughness textures, cached in %s.%s",
+                              engine->loaderSettings.textureCacheDirectory.string().c_str(),
+                              engine->_textureCompressionBC ? "" : " Not supported by this GPU.");
+        }
+        ImGui::Checkbox("CPU mipmaps", &engine->loaderSettings.cpuMipmaps);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Build mips on the job system in linear light, keeping the alpha coverage of cutout "
+                              "materials, instead of blitting them on the GPU.");
+        }
+        ImGui::BeginDisabled(!engine->loaderSettings.cpuMipmaps);
+        const mipgen::MipFilter filters[] = {mipgen::MipFilter::Box, mipgen::MipFilter::Kaiser};
+        mipgen::MipFilter &current_filter = engine->loaderSettings.mipFilter;
+        if (ImGui::BeginCombo("Mip filter", mipgen::name(current_filter))) {
+            for (const mipgen::MipFilter filter: filters) {
+                const bool is_selected = current_filter == filter;
+                if (ImGui::Selectable(mipgen::name(filter), is_selected))
+                    current_filter = filter;
+                if (is_selected)
+                    ImGui::SetItemDefaultFocus();
+            }
+            ImGui::EndCombo();
+        }
+        ImGui::Checkbox("Stream texture mips", &engine->loaderSettings.streamTextures);
+        if (ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenDisabled)) {
+            ImGui::SetTooltip("Upload textures with their mips up to %u px only, finer mips follow once the "
+                              "screen samples them.",
+                              engine->textureStreamer.settings.floorSize);
+        }
+        ImGui::EndDisabled();
+
+        const VertexFormat formats[] = {VertexFormat::Full, VertexFormat::Packed, VertexFormat::PackedQuantized};
+        VertexFormat &current_format = engine->loaderSettings.vertexFormat;
+        if (ImGui::BeginCombo("Vertex format", vertexpacking::name(current_format))) {
+            for (const VertexFormat format: formats) {
+                const bool is_selected = current_format == format;
+                if (ImGui::Selectable(vertexpacking::name(format), is_selected))
+                    current_format = format;
+                if (is_selected)
+                    ImGui::SetItemDefaultFocus();
+            }
+            ImGui::EndCombo();
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Vertex layout of the next loaded scene. Meshes with tiled UVs stay full precision.");
+        }
+
+        ImGui::SliderFloat("Upload budget (ms)", &engine->loaderSettings.uploadBudgetMs, 0.5f, 33.f, "%.1f");
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Time per frame spent creating GPU resources while a dropped scene streams in.");
+        }
+        ImGui::Checkbox("Write load reports", &engine->loaderSettings.writeLoadReports);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Write the per phase timings of every load to <scene>.load.json in %s.",
+                              engine->loaderSettings.loadReportDirectory.empty()
+                                  ? "the scene's directory"
+                                  : engine->loaderSettings.loadReportDirectory.string().c_str());
+        }
+        ImGui::Checkbox("Hot reload", &engine->loaderSettings.hotReload);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Watch the dropped scene and patch only the textures, materials, meshes and nodes that "
+                              "changed on disk. Takes effect with the next dropped scene.");
+        }
+    }
+
     if (ImGui::CollapsingHeader("Compositor Settings")) {
         ImGui::SliderFloat("Exposure", &engine->postProcessor._compositorData.exposure, 0.1f, 10.0f);
         ImGui::Checkbox("Show Grid Helper", reinterpret_cast<bool *>(&engine->postProcessor._compositorData.showGrid));
@@ -400,12 +510,142 @@ void ui::create_stats_panel(VulkanEngine *engine) {
     ImGui::Text("Yaw: %.3f", engine->mainCamera.yaw);
 
     if (ImGui::CollapsingHeader("Detailed Stats")) {
-        ImGui::Text("Triangles: %i", engine->stats.triangle_count);
+        ImGui::Text("Triangles: %i (%i at full detail)", engine->stats.triangle_count,
+                    engine->stats.full_detail_triangle_count);
         ImGui::Text("Draw calls: %i", engine->stats.drawcall_count);
-        ImGui::Text("Scene update time: %.2f ms", engine->stats.scene_update_time);
+        ImGui::Text("Draw sort time: %.3f ms", engine->stats.sort_time);
+        ImGui::Text("Scene update time: %.2f ms (%i transforms updated)", engine->stats.scene_update_time,
+                    engine->stats.transform_update_count);
+        ImGui::Text("Patched surfaces: %i, draw list rebuilds: %.1f/s", engine->stats.patched_surface_count,
+                    engine->stats.draw_list_rebuilds_per_second);
         ImGui::Text("Mesh draw time: %.2f ms", engine->stats.mesh_draw_time);
     }
 
+    if (engine->sceneLoad) {
+        const GltfLoadTask &task = *engine->sceneLoad;
+        const uint32_t total = task.stage_total();
+        const float fraction = total > 0 ? static_cast<float>(task.stage_done()) / static_cast<float>(total) : 0.f;
+        ImGui::Text("Loading %s", std::filesystem::path(task.path()).filename().string().c_str());
+        ImGui::ProgressBar(fraction, ImVec2(-1.f, 0.f), GltfLoadTask::stage_name(task.stage()));
+    }
+
+    if (ImGui::CollapsingHeader("Scene Load")) {
+        const GLTFLoadStats &load = engine->stats.scene_load;
+        ImGui::Text("Total load time: %.2f ms", load.totalTime);
+        if (load.hotReload) {
+            ImGui::Text("Hot reload: %u images, %u materials, %u meshes, %u nodes", load.reloadedImages,
+                        load.reloadedMaterials, load.reloadedMeshes, load.reloadedNodes);
+            ImGui::Text("  Rebuilt %u BLAS%s", load.rebuiltBlas, load.rebuiltTlas ? " and the TLAS" : "");
+        }
+        ImGui::Text("Images: %u (%u decode threads, %u from the texture cache)", load.imageCount, load.decodeThreads,
+                    load.textureCacheHits);
+        ImGui::Text("Image stage: %.2f ms", load.imageTotalTime);
+        ImGui::Text("  Decode (cpu): %.2f ms", load.imageDecodeCpuTime);
+        ImGui::Text("  Mips: %.2f ms on the CPU", load.imageMipTime);
+        ImGui::Text("  Encode: %.2f ms (%u of %u compressed textures from the disk cache)", load.imageEncodeTime,
+                    load.textureDiskCacheHits, load.compressedTextures);
+        ImGui::Text("  Upload: %.2f ms", load.imageUploadTime);
+        ImGui::Text("Texture memory: %.2f MB (%.2f MB as RGBA8)",
+                    static_cast<double>(load.textureBytes) / (1024.0 * 1024.0),
+                    static_cast<double>(load.uncompressedTextureBytes) / (1024.0 * 1024.0));
+        ImGui::Text("Geometry: %.2f ms (%s)", load.geometryTime, load.meshCacheHit ? "mesh cache" : "processed");
+        if (load.sourceVertices > 0) {
+            ImGui::Text("  Welded: %llu of %llu vertices left (%.1f%%)",
+                        static_cast<unsigned long long>(load.weldedVertices),
+                        static_cast<unsigned long long>(load.sourceVertices),
+                        100.0 * static_cast<double>(load.weldedVertices) / static_cast<double>(load.sourceVertices));
+        }
+        if (load.compressedViews > 0) {
+            ImGui::Text("  Meshopt: %u views, %.2f MB from %.2f MB in %.2f ms", load.compressedViews,
+                        static_cast<double>(load.decodedViewBytes) / (1024.0 * 1024.0),
+                        static_cast<double>(load.compressedViewBytes) / (1024.0 * 1024.0), load.meshoptDecodeTime);
+        }
+        ImGui::Text("Mesh upload: %.2f ms", load.meshUploadTime);
+        ImGui::Text("Upload spread over %u frame(s)", load.uploadFrames);
+        ImGui::Text("Vertex memory: %.2f MB (%.2f MB at full precision)",
+                    static_cast<double>(load.vertexBytes) / (1024.0 * 1024.0),
+                    static_cast<double>(load.fullVertexBytes) / (1024.0 * 1024.0));
+        ImGui::Text("Index memory: %.2f MB (%.2f MB as 32 bit)",
+                    static_cast<double>(load.indexBytes) / (1024.0 * 1024.0),
+                    static_cast<double>(load.fullIndexBytes) / (1024.0 * 1024.0));
+    }
+
+    if (ImGui::CollapsingHeader("Texture Cache")) {
+        const TextureCache::Stats textures = engine->textureCache.stats();
+        const double hitRate = textures.lookups > 0 ? 100.0 * static_cast<double>(textures.hits) /
+                                                          static_cast<double>(textures.lookups)
+                                                    : 0.0;
+        ImGui::Text("Hit rate: %.1f%% (%llu of %llu)", hitRate, static_cast<unsigned long long>(textures.hits),
+                    static_cast<unsigned long long>(textures.lookups));
+        ImGui::Text("Saved: %.2f MB", static_cast<double>(textures.bytesSaved) / (1024.0 * 1024.0));
+        ImGui::Text("Resident: %u textures, %.2f MB", textures.textureCount,
+                    static_cast<double>(textures.residentBytes) / (1024.0 * 1024.0));
+    }
+
+    if (ImGui::CollapsingHeader("Texture Streaming")) {
+        TextureStreamer::Settings &streaming = engine->textureStreamer.settings;
+        ImGui::SliderInt("Budget (MB)", reinterpret_cast<int *>(&streaming.budgetMB), 16, 4096);
+        ImGui::SliderInt("Upload per frame (MB)", reinterpret_cast<int *>(&streaming.uploadMBPerFrame), 1, 128);
+        ImGui::SliderInt("Keep unused mips (frames)", reinterpret_cast<int *>(&streaming.retainFrames), 1, 1000);
+        const TextureStreamer::Stats stats = engine->textureStreamer.stats();
+        ImGui::Text("Streamed: %u textures", stats.textures);
+        ImGui::Text("Resident: %.2f / %.2f MB", static_cast<double>(stats.residentBytes) / (1024.0 * 1024.0),
+                    static_cast<double>(stats.fullBytes) / (1024.0 * 1024.0));
+        ImGui::Text("Uploaded: %.2f MB", static_cast<double>(stats.uploadedBytes) / (1024.0 * 1024.0));
+        ImGui::Text("Upgrades: %u, drops: %u", stats.upgrades, stats.drops);
+    }
+
+    if (ImGui::CollapsingHeader("Geometry Arena")) {
+        const GeometryArena::Stats arena = engine->geometryArena.stats();
+        ImGui::Text("Blocks: %u", arena.blockCount);
+        ImGui::Text("Allocations: %u", arena.allocationCount);
+        ImGui::Text("Used: %.2f / %.2f MB", static_cast<double>(arena.used) / (1024.0 * 1024.0),
+                    static_cast<double>(arena.capacity) / (1024.0 * 1024.0));
+    }
+
+    if (ImGui::CollapsingHeader("Level of Detail")) {
+        ImGui::Checkbox("Select LODs by screen error", &engine->useLods);
+        ImGui::SliderFloat("Error threshold (px)", &engine->lodErrorPixels, 0.25f, 8.f);
+        for (size_t lod = 0; lod < engine->stats.lod_surface_count.size(); lod++) {
+            ImGui::Text("LOD %zu: %i surfaces", lod, engine->stats.lod_surface_count[lod]);
+        }
+    }
+
+    if (ImGui::CollapsingHeader("Frustum Culling")) {
+        ImGui::Checkbox("Cull surfaces on the CPU", &engine->frustumCulling);
+        ImGui::Text("Camera: %i / %i surfaces", engine->stats.visible_surface_count, engine->stats.surface_count);
+        ImGui::Text("Shadow map: %i / %i surfaces", engine->stats.shadow_visible_surface_count,
+                    engine->stats.surface_count);
+        ImGui::Text("Cull time: %.3f ms (simd %s)", engine->stats.cull_time, simd::NAME);
+    }
+
+    if (ImGui::CollapsingHeader("Occlusion Culling")) {
+        ImGui::Checkbox("Cull hidden surfaces on the CPU", &engine->occlusionCulling);
+        ImGui::SliderInt("Max occluders", &engine->maxOccluders, 0, 128);
+        ImGui::SliderFloat("Min occluder size", &engine->minOccluderSize, 0.01f, 0.5f);
+        ImGui::Text("Occluders: %i (%i triangles, %ux%u depth)", engine->stats.occluder_count,
+                    engine->stats.occluder_triangle_count, occlusion::WIDTH, occlusion::HEIGHT);
+        ImGui::Text("Occluded: %i surfaces, %.1f%% of the camera's draws", engine->stats.occluded_surface_count,
+                    engine->stats.occluded_fraction * 100.f);
+        ImGui::Text("Occlusion time: %.3f ms", engine->stats.occlusion_time);
+    }
+
+    if (ImGui::CollapsingHeader("Meshlet Culling")) {
+        ImGui::Checkbox("Cull meshlets on the GPU", &engine->meshletCuller.enabled);
+        const MeshletCuller::Stats culling = engine->meshletCuller.stats();
+        ImGui::Text("Surfaces: %u", culling.surfaces);
+        ImGui::Text("Meshlets tested: %u", culling.meshlets);
+    }
+
+    if (ImGui::CollapsingHeader("Uploads")) {
+        const UploadBatcher::Stats uploads = engine->uploadBatcher.stats();
+        ImGui::Text("Batches: %llu (%llu last scene)", static_cast<unsigned long long>(uploads.batches),
+                    static_cast<unsigned long long>(engine->stats.scene_load.uploadBatches));
+        ImGui::Text("Copies: %llu", static_cast<unsigned long long>(uploads.copies));
+        ImGui::Text("Staged: %.2f MB", static_cast<double>(uploads.bytes) / (1024.0 * 1024.0));
+        ImGui::Text("Ring stalls: %llu", static_cast<unsigned long long>(uploads.ringStalls));
+    }
+
     ImGui::End();
 }
 
@@ -29,11 +29,16 @@
 #include <vk_types.h>
 #include <vk_utils.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <numeric>
 #include <random>
 #include <sstream>
 
@@ -65,6 +70,12 @@ void VulkanEngine::init() {
 
     init_sync_structures();
 
+    uploadBatcher.init(this);
+    _mainDeletionQueue.push_function([this] { uploadBatcher.cleanup(); });
+
+    textureStreamer.init(this);
+    _mainDeletionQueue.push_function([this] { textureStreamer.cleanup(); });
+
     init_descriptors();
 
     init_pipelines();
@@ -87,60 +98,140 @@ void VulkanEngine::init() {
 }
 
 void VulkanEngine::load_scene_from_file(const std::string &filePath) {
-    try {
-        spdlog::info("Loading GLTF scene from: {}", filePath);
+    if (sceneLoad) {
+        spdlog::warn("Still loading {}, ignoring {}", sceneLoad->path(), filePath);
+        return;
+    }
 
-        // Load the GLTF file
-        const auto sceneFile = loadGltf(this, filePath);
+    spdlog::info("Loading GLTF scene from: {}", filePath);
 
-        if (sceneFile.has_value()) {
-            // Extract filename for scene name
-            std::filesystem::path path(filePath);
-            std::string sceneName = path.stem().string();
+    // parsing, decoding and geometry run on the job system, update_scene_load picks the task up once it is prepared
+    sceneLoad = std::make_unique<GltfLoadTask>(this, filePath);
+    jobSystem.submit([task = sceneLoad.get()] { task->prepare(); });
+}
 
-            // Destroy cube pipeline since we're loading a scene
-            if (cubePipeline.isInitialized()) {
-                cubePipeline.destroy();
-            }
+void VulkanEngine::update_scene_load() {
+    if (!sceneLoad || !sceneLoad->upload(loaderSettings.uploadBudgetMs)) {
+        return;
+    }
 
-            // Clear existing scenes and ray tracing texture references
-            loadedScenes.clear();
-            sceneInfos.clear();
+    if (const std::shared_ptr<LoadedGLTF> scene = sceneLoad->scene()) {
+        activate_scene(scene, sceneLoad->path());
+    } else if (const std::shared_ptr<LoadedGLTF> patched = sceneLoad->patched_scene()) {
+        // the draw lists point at the patched meshes and materials, the ray tracer rebuilds what moved
+        const auto rtStart = std::chrono::high_resolution_clock::now();
+        mainDrawContext.OpaqueSurfaces.clear();
+        mainDrawContext.TransparentSurfaces.clear();
+        traverseScenes();
+        const scenediff::InstanceDiff rebuilt = raytracerPipeline.patchScene(this);
+        const double rtMs =
+            std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - rtStart).count();
+
+        stats.scene_load = sceneLoad->load_stats();
+        stats.scene_load.rebuiltBlas = static_cast<uint32_t>(
+            rebuilt.rebuildAll ? mainDrawContext.OpaqueSurfaces.size() + mainDrawContext.TransparentSurfaces.size()
+                               : rebuilt.blas.size());
+        stats.scene_load.rebuiltTlas = rebuilt.tlas;
+        spdlog::info("Ray tracer patched in {:.2f} ms: {} BLAS rebuilt{}", rtMs, stats.scene_load.rebuiltBlas,
+                     rebuilt.tlas ? ", TLAS rebuilt" : "");
+        writeLoadReport(sceneLoad->load_profile(), sceneLoad->path(), loaderSettings,
+                        stats.scene_load.totalTime + rtMs);
+        sceneWatcher.watch(patched->sourceFiles);
+    } else {
+        spdlog::error("Failed to load GLTF file: {}", sceneLoad->path());
+    }
+    sceneLoad.reset();
+}
 
-            // Clear main draw context from previous scene
-            mainDrawContext.OpaqueSurfaces.clear();
-            mainDrawContext.TransparentSurfaces.clear();
+void VulkanEngine::update_scene_watch() {
+    if (!loaderSettings.hotReload || sceneLoad || !sceneWatcher.poll(FileWatcher::Clock::now())) {
+        return;
+    }
+    std::shared_ptr<LoadedGLTF> scene = watchedScene.lock();
+    if (!scene) {
+        sceneWatcher.clear();
+        return;
+    }
+
+    spdlog::info("{} changed on disk, hot reloading it", watchedScenePath);
+    sceneLoad = std::make_unique<GltfLoadTask>(this, watchedScenePath, std::move(scene));
+    jobSystem.submit([task = sceneLoad.get()] { task->prepare(); });
+}
 
-            // Clear ray tracing texture references
-            raytracerPipeline.loadedTextures.clear();
-            raytracerPipeline.loadedNormTextures.clear();
-            raytracerPipeline.loadedMetalRoughTextures.clear();
+void VulkanEngine::activate_scene(const std::shared_ptr<LoadedGLTF> &scene, const std::string &filePath) {
+    try {
+        stats.scene_load = scene->loadStats;
 
-            // Add to loaded scenes
-            loadedScenes[sceneName] = *sceneFile;
+        // Extract filename for scene name
+        std::filesystem::path path(filePath);
+        std::string sceneName = path.stem().string();
 
-            // Create a scene info with same position as cube
-            SceneDesc::SceneInfo sceneInfo;
-            sceneInfo.name = sceneName;
-            sceneInfo.filePath = filePath;
-            sceneInfo.hasTransform = true;
-            sceneInfo.scale = glm::vec3(1.0f); // Keep original scale
-            sceneInfo.translate = glm::vec3(0.0f, -0.5f, 0.0f); // Same Y offset as cube
-            sceneInfo.rotate = glm::vec3(0.0f); // No rotation
-            sceneInfos[sceneName] = sceneInfo;
+        // the old scene may still be in use by frames in flight
+        vkDeviceWaitIdle(_device);
 
-            spdlog::info("Successfully loaded scene: {}", sceneName);
+        // Destroy cube pipeline since we're loading a scene
+        if (cubePipeline.isInitialized()) {
+            cubePipeline.destroy();
+        }
 
-            // Update ray tracing structures
-            traverseScenes();
+        // Clear existing scenes and ray tracing texture references
+        loadedScenes.clear();
+        sceneInfos.clear();
+
+        // Clear main draw context from previous scene
+        mainDrawContext.OpaqueSurfaces.clear();
+        mainDrawContext.TransparentSurfaces.clear();
+
+        // Clear ray tracing texture references
+        raytracerPipeline.loadedTextures.clear();
+        raytracerPipeline.loadedNormTextures.clear();
+        raytracerPipeline.loadedMetalRoughTextures.clear();
+        raytracerPipeline.loadedEmissiveTextures.clear();
+        raytracerPipeline.loadedMaterials.clear();
+
+        // Add to loaded scenes
+        loadedScenes[sceneName] = scene;
+
+        // Create a scene info with same position as cube
+        SceneDesc::SceneInfo sceneInfo;
+        sceneInfo.name = sceneName;
+        sceneInfo.filePath = filePath;
+        sceneInfo.hasTransform = true;
+        sceneInfo.scale = glm::vec3(1.0f); // Keep original scale
+        sceneInfo.translate = glm::vec3(0.0f, -0.5f, 0.0f); // Same Y offset as cube
+        sceneInfo.rotate = glm::vec3(0.0f); // No rotation
+        sceneInfos[sceneName] = sceneInfo;
+
+        spdlog::info("Successfully loaded scene: {}", sceneName);
+
+        // Update ray tracing structures
+        const auto rtStart = std::chrono::high_resolution_clock::now();
+        traverseScenes();
+        {
+            ScopedLoadPhase phase(scene->loadProfile, "blas_build");
             raytracerPipeline.createBottomLevelAS(this);
+        }
+        {
+            ScopedLoadPhase phase(scene->loadProfile, "tlas_build");
             raytracerPipeline.createTopLevelAS(this);
+        }
+        {
+            ScopedLoadPhase phase(scene->loadProfile, "rt_pipeline");
             raytracerPipeline.createRtDescriptorSet(this);
             raytracerPipeline.createRtPipeline(this);
             raytracerPipeline.createRtShaderBindingTable(this);
-
+        }
+        const double rtMs =
+            std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - rtStart).count();
+        writeLoadReport(scene->loadProfile, filePath, loaderSettings, scene->loadStats.totalTime + rtMs);
+
+        // a scene loaded without content hashes has nothing a reload could diff against
+        watchedScene = scene;
+        watchedScenePath = filePath;
+        if (scene->sourceFiles.empty()) {
+            sceneWatcher.clear();
         } else {
-            spdlog::error("Failed to load GLTF file: {}", filePath);
+            sceneWatcher.watch(scene->sourceFiles);
         }
     } catch (const std::exception &e) {
         spdlog::error("Error loading scene: {}", e.what());
@@ -158,6 +249,9 @@ void VulkanEngine::init_scenes(const std::string &jsonPath) {
             const auto sceneFile = loadGltf(this, sceneInfo.filePath);
 
             if (sceneFile.has_value()) {
+                stats.scene_load = (*sceneFile)->loadStats;
+                writeLoadReport((*sceneFile)->loadProfile, sceneInfo.filePath, loaderSettings,
+                                (*sceneFile)->loadStats.totalTime);
                 // Add to loaded scenes (using your existing map type)
                 loadedScenes[sceneInfo.name] = *sceneFile;
                 // Store the scene info separately
@@ -167,6 +261,7 @@ void VulkanEngine::init_scenes(const std::string &jsonPath) {
                 spdlog::error("Failed to load scene: {}", sceneInfo.name);
             }
         }
+        drawListsDirty = true;
     } catch (const std::exception &e) {
         std::cerr << "Error loading scenes: " << e.what() << std::endl;
     }
@@ -202,6 +297,9 @@ void VulkanEngine::init_default_data() {
     // Add resource manager cleanup to deletion queue
     _mainDeletionQueue.push_function([=, this] { _resourceManager.cleanup(); });
 
+    geometryArena.init(this);
+    _mainDeletionQueue.push_function([this] { geometryArena.cleanup(); });
+
     // Shadow light map
     _shadowMap.init_lightSpaceMatrix(this);
 
@@ -227,6 +325,9 @@ void VulkanEngine::init_default_data() {
         sceneUniformData->colorFactors = glm::vec4{1, 1, 1, 1};
         sceneUniformData->metal_rough_factors = glm::vec4{1, 0.5, 0, 0};
         sceneUniformData->hasMetalRoughTex = 0;
+        sceneUniformData->colorFeedbackSlot = -1;
+        sceneUniformData->metalRoughFeedbackSlot = -1;
+        sceneUniformData->normalFeedbackSlot = -1;
     });
 
     _mainDeletionQueue.push_function([=, this]() { vkutil::destroy_buffer(this, materialConstants); });
@@ -259,64 +360,311 @@ void VulkanEngine::init_default_data() {
 }
 
 
-// Global function to check if an object is visible in the current view
-bool is_visible(const RenderObject &obj, const glm::mat4 &viewproj) {
-    constexpr std::array corners{
-        glm::vec3{1, 1, 1},  glm::vec3{1, 1, -1},  glm::vec3{1, -1, 1},  glm::vec3{1, -1, -1},
-        glm::vec3{-1, 1, 1}, glm::vec3{-1, 1, -1}, glm::vec3{-1, -1, 1}, glm::vec3{-1, -1, -1},
-    };
+glm::mat4 VulkanEngine::scene_matrix(const std::string &sceneName) const {
+    glm::mat4 modelMatrix(1.0f);
 
-    const glm::mat4 matrix = viewproj * obj.transform;
+    // Check if we have scene info with transformations
+    auto infoIt = sceneInfos.find(sceneName);
+    if (infoIt != sceneInfos.end() && infoIt->second.hasTransform) {
+        const auto &transform = infoIt->second;
 
-    glm::vec3 min = {1.5, 1.5, 1.5};
-    glm::vec3 max = {-1.5, -1.5, -1.5};
+        // Apply transformations in order: scale, rotate, translate
+        // Scale
+        modelMatrix = glm::scale(modelMatrix, transform.scale);
 
-    for (int c = 0; c < 8; c++) {
-        // project each corner into clip space
-        glm::vec4 v = matrix * glm::vec4(obj.bounds.origin + (corners[c] * obj.bounds.extents), 1.f);
+        // Rotate (converting Euler angles from degrees to radians)
+        glm::vec3 rotationRad = glm::radians(transform.rotate);
+        modelMatrix = glm::rotate(modelMatrix, rotationRad.x, glm::vec3(1.0f, 0.0f, 0.0f));
+        modelMatrix = glm::rotate(modelMatrix, rotationRad.y, glm::vec3(0.0f, 1.0f, 0.0f));
+        modelMatrix = glm::rotate(modelMatrix, rotationRad.z, glm::vec3(0.0f, 0.0f, 1.0f));
 
-        // perspective correction
-        v.x = v.x / v.w;
-        v.y = v.y / v.w;
-        v.z = v.z / v.w;
+        // Translate
+        modelMatrix = glm::translate(modelMatrix, transform.translate);
+    }
+    return modelMatrix;
+}
+
+void VulkanEngine::traverseScenes() {
+    mainDrawContext.OpaqueSurfaces.clear();
+    mainDrawContext.TransparentSurfaces.clear();
+    sceneSurfaces.clear();
 
-        min = glm::min(glm::vec3{v.x, v.y, v.z}, min);
-        max = glm::max(glm::vec3{v.x, v.y, v.z}, max);
+    for (const auto &[sceneName, scenePtr]: loadedScenes) {
+        const glm::mat4 modelMatrix = scene_matrix(sceneName);
+
+        // only the nodes under a changed transform are recomputed, Draw then reads their world matrices
+        scenePtr->transforms.set_root(modelMatrix);
+        stats.transform_update_count += static_cast<int>(scenePtr->transforms.update());
+
+        // Draw the scene with the calculated model matrix
+        SceneSurfaces range{};
+        range.scene = scenePtr.get();
+        range.name = sceneName;
+        range.opaqueBegin = static_cast<uint32_t>(mainDrawContext.OpaqueSurfaces.size());
+        range.transparentBegin = static_cast<uint32_t>(mainDrawContext.TransparentSurfaces.size());
+        scenePtr->Draw(modelMatrix, mainDrawContext);
+        range.opaqueEnd = static_cast<uint32_t>(mainDrawContext.OpaqueSurfaces.size());
+        range.transparentEnd = static_cast<uint32_t>(mainDrawContext.TransparentSurfaces.size());
+        sceneSurfaces.push_back(range);
     }
 
-    // check the clip space box is within the view
-    if (min.z > 1.f || max.z < 0.f || min.x > 1.f || max.x < -1.f || min.y > 1.f || max.y < -1.f) {
-        return false;
+    // culling bounds follow the lists, opaque surfaces first
+    const auto &opaque = mainDrawContext.OpaqueSurfaces;
+    const auto &transparent = mainDrawContext.TransparentSurfaces;
+    cullBounds.resize(opaque.size() + transparent.size());
+    for (size_t i = 0; i < opaque.size(); i++) {
+        cullBounds.set(i, opaque[i].bounds, opaque[i].transform);
+    }
+    for (size_t i = 0; i < transparent.size(); i++) {
+        cullBounds.set(opaque.size() + i, transparent[i].bounds, transparent[i].transform);
+    }
+
+    // dense ids in order of first use, the draw order then does not depend on where things were allocated
+    std::unordered_map<MaterialPipeline *, uint32_t> pipelineIds;
+    std::unordered_map<MaterialInstance *, uint32_t> materialIds;
+    // many meshes share one arena block, and its surfaces mix 16 and 32 bit indices: the pair is what
+    // draw_geometry binds
+    std::map<std::pair<VkBuffer, VkIndexType>, uint32_t> indexBindingIds;
+    auto id = [](auto &ids, auto key) {
+        return ids.try_emplace(key, static_cast<uint32_t>(ids.size())).first->second;
+    };
+    for (RenderObject &r: mainDrawContext.OpaqueSurfaces) {
+        r.stateKey = drawsort::state_key(static_cast<uint32_t>(r.material->passType),
+                                         id(pipelineIds, r.material->pipeline), id(materialIds, r.material),
+                                         id(indexBindingIds, std::pair(r.indexBuffer, r.indexType)));
     }
-    return true;
+
+    drawListsDirty = false;
+    drawListRebuilds++;
 }
 
-void VulkanEngine::traverseScenes() {
-    for (const auto &[sceneName, scenePtr]: loadedScenes) {
-        glm::mat4 modelMatrix(1.0f);
+void VulkanEngine::update_draw_lists() {
+    stats.transform_update_count = 0;
+    stats.patched_surface_count = 0;
+    if (drawListsDirty) {
+        traverseScenes();
+        return;
+    }
 
-        // Check if we have scene info with transformations
-        auto infoIt = sceneInfos.find(sceneName);
-        if (infoIt != sceneInfos.end() && infoIt->second.hasTransform) {
-            const auto &transform = infoIt->second;
+    // the lists stay, only the surfaces under nodes whose world transform changed are rewritten. a scene's
+    // surfaces are contiguous in each list and sorted by node, so every recomputed range is a binary search away
+    const auto cullOffset = static_cast<uint32_t>(mainDrawContext.OpaqueSurfaces.size());
+    for (const SceneSurfaces &range: sceneSurfaces) {
+        TransformHierarchy &transforms = range.scene->transforms;
+        transforms.set_root(scene_matrix(range.name));
+        if (!transforms.dirty()) {
+            continue;
+        }
+        stats.transform_update_count += static_cast<int>(transforms.update());
+
+        auto patch = [&](std::vector<RenderObject> &list, uint32_t first, uint32_t last, uint32_t boundsOffset,
+                         uint32_t beginNode, uint32_t endNode) {
+            auto it = std::lower_bound(list.begin() + first, list.begin() + last, beginNode,
+                                       [](const RenderObject &r, uint32_t node) { return r.node < node; });
+            for (; it != list.begin() + last && it->node < endNode; ++it) {
+                it->transform = transforms.world(it->node);
+                cullBounds.set(boundsOffset + static_cast<uint32_t>(it - list.begin()), it->bounds, it->transform);
+                stats.patched_surface_count++;
+            }
+        };
+        for (const auto &[beginNode, endNode]: transforms.updated_ranges()) {
+            patch(mainDrawContext.OpaqueSurfaces, range.opaqueBegin, range.opaqueEnd, 0, beginNode, endNode);
+            patch(mainDrawContext.TransparentSurfaces, range.transparentBegin, range.transparentEnd, cullOffset,
+                  beginNode, endNode);
+        }
+    }
+}
 
-            // Apply transformations in order: scale, rotate, translate
-            // Scale
-            modelMatrix = glm::scale(modelMatrix, transform.scale);
+void VulkanEngine::select_lods() {
+    // pixels covered by one world unit at distance 1, proj[1][1] is 1 / tan(fov / 2) with the Y flip
+    const float pixelsPerUnit = 0.5f * static_cast<float>(_windowExtent.height) * std::abs(sceneData.proj[1][1]);
+
+    stats.full_detail_triangle_count = 0;
+    stats.lod_surface_count.fill(0);
+
+    // runs before the gbuffer, shadow and main passes so all of them rasterize the same triangles
+    auto select = [&](RenderObject &r) {
+        stats.full_detail_triangle_count += static_cast<int>(r.fullIndexCount) / 3;
+
+        uint32_t lod = 0;
+        if (useLods && r.lodCount > 0) {
+            const float scale = std::max({glm::length(glm::vec3(r.transform[0])),
+                                          glm::length(glm::vec3(r.transform[1])),
+                                          glm::length(glm::vec3(r.transform[2]))});
+            const glm::vec3 center = glm::vec3(r.transform * glm::vec4(r.bounds.origin, 1.f));
+            // nearest point of the bounding sphere, so a surface the camera is inside stays at full detail
+            const float distance = std::max(glm::length(center - sceneData.cameraPosition) -
+                                                r.bounds.sphereRadius * scale,
+                                            NEAR_PLANE);
+            const float pixelsPerMeshUnit = pixelsPerUnit * scale / distance;
+
+            while (lod < r.lodCount && r.lods[lod].error * pixelsPerMeshUnit <= lodErrorPixels) {
+                lod++;
+            }
+        }
 
-            // Rotate (converting Euler angles from degrees to radians)
-            glm::vec3 rotationRad = glm::radians(transform.rotate);
-            modelMatrix = glm::rotate(modelMatrix, rotationRad.x, glm::vec3(1.0f, 0.0f, 0.0f));
-            modelMatrix = glm::rotate(modelMatrix, rotationRad.y, glm::vec3(0.0f, 1.0f, 0.0f));
-            modelMatrix = glm::rotate(modelMatrix, rotationRad.z, glm::vec3(0.0f, 0.0f, 1.0f));
+        r.lod = lod;
+        stats.lod_surface_count[lod]++;
+        // the surfaces outlive the frame, a surface that comes closer again goes back to its full range
+        if (lod > 0) {
+            r.firstIndex = r.lods[lod - 1].startIndex;
+            r.indexCount = r.lods[lod - 1].count;
+            // meshlets only cover the full detail range
+            r.meshletCount = 0;
+        } else {
+            r.firstIndex = r.fullFirstIndex;
+            r.indexCount = r.fullIndexCount;
+            r.meshletCount = r.fullMeshletCount;
+        }
+    };
+
+    for (RenderObject &r: mainDrawContext.OpaqueSurfaces) {
+        select(r);
+    }
+    for (RenderObject &r: mainDrawContext.TransparentSurfaces) {
+        select(r);
+    }
+}
+
+void VulkanEngine::cull_surfaces() {
+    const auto start = std::chrono::system_clock::now();
+
+    const auto &opaque = mainDrawContext.OpaqueSurfaces;
+    const auto &transparent = mainDrawContext.TransparentSurfaces;
+    const size_t count = opaque.size() + transparent.size();
+
+    for (VisibleSurfaces *visible: {&cameraVisible, &shadowVisible}) {
+        visible->opaque.clear();
+        visible->transparent.clear();
+    }
+
+    if (frustumCulling) {
+        // cullBounds is kept in step with the draw lists by update_draw_lists, only the planes change per frame
+        cullMask.resize(frustumcull::mask_words(count));
 
-            // Translate
-            modelMatrix = glm::translate(modelMatrix, transform.translate);
+        auto cull = [&](const glm::mat4 &viewproj, VisibleSurfaces &visible) {
+            frustumcull::cull(cullBounds, frustumcull::extract_frustum(viewproj), cullMask);
+            frustumcull::append_visible(cullMask, 0, opaque.size(), visible.opaque);
+            frustumcull::append_visible(cullMask, opaque.size(), transparent.size(), visible.transparent);
+        };
+        cull(sceneData.viewproj, cameraVisible);
+        // the shadow map keeps casters outside the camera's view, it culls against the light's own box instead
+        cull(sceneData.lightSpaceMatrix, shadowVisible);
+    } else {
+        for (VisibleSurfaces *visible: {&cameraVisible, &shadowVisible}) {
+            visible->opaque.resize(opaque.size());
+            visible->transparent.resize(transparent.size());
+            std::iota(visible->opaque.begin(), visible->opaque.end(), 0u);
+            std::iota(visible->transparent.begin(), visible->transparent.end(), 0u);
         }
+    }
 
-        // Draw the scene with the calculated model matrix
-        scenePtr->Draw(modelMatrix, mainDrawContext);
+    stats.surface_count = static_cast<int>(count);
+    stats.visible_surface_count = static_cast<int>(cameraVisible.opaque.size() + cameraVisible.transparent.size());
+    stats.shadow_visible_surface_count =
+        static_cast<int>(shadowVisible.opaque.size() + shadowVisible.transparent.size());
+    const auto elapsed =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - start);
+    stats.cull_time = static_cast<float>(elapsed.count()) / 1000.f;
+}
+
+void VulkanEngine::occlusion_cull() {
+    const auto start = std::chrono::system_clock::now();
+
+    const size_t tested = cameraVisible.opaque.size() + cameraVisible.transparent.size();
+    stats.occluder_count = 0;
+    stats.occluder_triangle_count = 0;
+    stats.occluded_surface_count = 0;
+
+    if (occlusionCulling) {
+        const auto &opaque = mainDrawContext.OpaqueSurfaces;
+
+        // the visible opaque surfaces covering the most of the screen occlude, their triangles are already known
+        occluderCandidates.clear();
+        for (const uint32_t r: cameraVisible.opaque) {
+            if (!opaque[r].occluder) {
+                continue;
+            }
+            const glm::vec3 center(cullBounds.centerX[r], cullBounds.centerY[r], cullBounds.centerZ[r]);
+            const float distance = std::max(glm::length(center - mainCamera.position), NEAR_PLANE);
+            if (const float size = cullBounds.radius[r] / distance; size >= minOccluderSize) {
+                occluderCandidates.emplace_back(size, r);
+            }
+        }
+        const size_t count = std::min(occluderCandidates.size(), static_cast<size_t>(std::max(maxOccluders, 0)));
+        std::partial_sort(occluderCandidates.begin(), occluderCandidates.begin() + static_cast<ptrdiff_t>(count),
+                          occluderCandidates.end(), std::greater<>());
+        occluders.clear();
+        for (size_t i = 0; i < count; i++) {
+            const RenderObject &r = opaque[occluderCandidates[i].second];
+            occluders.push_back({r.occluder, sceneData.viewproj * r.transform});
+        }
+
+        // a loading scene keeps the pool busy with long jobs the frame would end up helping with
+        JobSystem *jobs = sceneLoad ? nullptr : &jobSystem;
+        stats.occluder_count = static_cast<int>(count);
+        stats.occluder_triangle_count = static_cast<int>(occlusion::rasterize(occlusionBuffer, occluders, jobs));
+
+        // the world boxes of the culling bounds, opaque surfaces first. an occluder never hides itself, its box
+        // reaches at least as near as every pixel it wrote
+        auto test = [&](std::vector<uint32_t> &visible, size_t boundsOffset) {
+            occludedFlags.assign(visible.size(), 0);
+            auto test_range = [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    const size_t b = boundsOffset + visible[i];
+                    occludedFlags[i] = occlusion::occluded(
+                        occlusionBuffer, {cullBounds.centerX[b], cullBounds.centerY[b], cullBounds.centerZ[b]},
+                        {cullBounds.extentX[b], cullBounds.extentY[b], cullBounds.extentZ[b]}, sceneData.viewproj);
+                }
+            };
+            if (jobs) {
+                jobs->parallel_for(visible.size(), 512, test_range);
+            } else {
+                test_range(0, visible.size());
+            }
+
+            size_t kept = 0;
+            for (size_t i = 0; i < visible.size(); i++) {
+                if (!occludedFlags[i]) {
+                    visible[kept++] = visible[i];
+                }
+            }
+            stats.occluded_surface_count += static_cast<int>(visible.size() - kept);
+            visible.resize(kept);
+        };
+        test(cameraVisible.opaque, 0);
+        test(cameraVisible.transparent, opaque.size());
     }
+
+    stats.occluded_fraction =
+        tested > 0 ? static_cast<float>(stats.occluded_surface_count) / static_cast<float>(tested) : 0.f;
+    const auto elapsed =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - start);
+    stats.occlusion_time = static_cast<float>(elapsed.count()) / 1000.f;
+}
+
+void VulkanEngine::sort_draws() {
+    const auto start = std::chrono::system_clock::now();
+
+    const auto &opaque = mainDrawContext.OpaqueSurfaces;
+    auto sort = [&](const glm::mat4 &viewproj, bool perspective, std::vector<uint32_t> &draws) {
+        drawKeys.resize(draws.size());
+        for (size_t i = 0; i < draws.size(); i++) {
+            const uint32_t r = draws[i];
+            const glm::vec4 clip =
+                viewproj * glm::vec4(cullBounds.centerX[r], cullBounds.centerY[r], cullBounds.centerZ[r], 1.f);
+            // view distance for the camera, the light's orthographic depth is reversed like the camera's
+            const float depth = perspective ? clip.w / FAR_PLANE : 1.f - clip.z;
+            drawKeys[i] = opaque[r].stateKey | drawsort::depth_key(depth);
+        }
+        drawsort::radix_sort(drawKeys, draws, drawKeyScratch, drawIndexScratch);
+    };
+    sort(sceneData.viewproj, true, cameraVisible.opaque);
+    sort(sceneData.lightSpaceMatrix, false, shadowVisible.opaque);
+
+    const auto elapsed =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - start);
+    stats.sort_time = static_cast<float>(elapsed.count()) / 1000.f;
 }
 
 void VulkanEngine::cleanup() {
@@ -325,6 +673,13 @@ void VulkanEngine::cleanup() {
         // make sure the GPU has stopped doing its things
         vkDeviceWaitIdle(_device);
 
+        // a load still preparing on the job system must finish before its task goes away
+        if (sceneLoad) {
+            jobSystem.wait_idle();
+            sceneLoad.reset();
+        }
+        sceneWatcher.clear();
+
         loadedScenes.clear();
 
         // Free command buffers first
@@ -369,6 +724,22 @@ void VulkanEngine::draw() {
     get_current_frame()._deletionQueue.flush();
     get_current_frame()._frameDescriptors.clear_pools(_device);
 
+    // the fence also covers the feedback this frame slot recorded last time. the ray tracer samples material
+    // images without feedback, streaming holds still while it renders
+    const bool rayTracing = postProcessor._compositorData.useRayTracer == 1;
+    textureStreamer.update(rayTracing);
+    if (rayTracing && raytracerPipeline.textureGeneration != textureStreamer.generation()) {
+        // its texture set still points at images the streamer replaced
+        vkDeviceWaitIdle(_device);
+        raytracerPipeline.updateRtTextureDescriptors(this);
+    }
+    const VkDeviceAddress feedback = textureStreamer.feedback_address();
+    sceneData.textureFeedback = glm::uvec2(static_cast<uint32_t>(feedback), static_cast<uint32_t>(feedback >> 32));
+    sceneData.textureFeedbackFrame = static_cast<uint32_t>(_frameNumber);
+
+    // uploads recorded since the last frame go to the queue ahead of it
+    uploadBatcher.flush();
+
     VK_CHECK(vkResetFences(_device, 1, &get_current_frame()._renderFence));
 
 
@@ -485,6 +856,9 @@ void VulkanEngine::draw() {
         vkutil::transition_image(cmd, _depthImage.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
                                  VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, VK_IMAGE_ASPECT_DEPTH_BIT);
 
+        // compacts the visible meshlets of the camera's opaque surfaces into indirect draws for draw_geometry
+        meshletCuller.cull(this, cmd, mainDrawContext.OpaqueSurfaces, cameraVisible.opaque);
+
         hdrImage.draw_hdriMap(this, cmd);
         draw_geometry(cmd);
 
@@ -543,6 +917,8 @@ void VulkanEngine::draw() {
     vkutil::transition_image(cmd, _swapchainImages[swapchainImageIndex], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                              VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_IMAGE_ASPECT_COLOR_BIT);
 
+    textureStreamer.finish_frame(cmd);
+
     // Finalize command buffer
     VK_CHECK(vkEndCommandBuffer(cmd));
 
@@ -588,8 +964,7 @@ void VulkanEngine::draw() {
 }
 
 void VulkanEngine::update_scene() {
-
-    mainDrawContext.OpaqueSurfaces.clear();
+    const auto start = std::chrono::system_clock::now();
 
     mainCamera.update();
 
@@ -616,11 +991,25 @@ void VulkanEngine::update_scene() {
     // shadows
     _shadowMap.update_lightSpaceMatrix(this);
 
-    // Process all loaded scenes
-    traverseScenes();
+    // Process all loaded scenes, the draw lists are only rebuilt when the set of scenes changed
+    update_draw_lists();
+    const auto now = std::chrono::steady_clock::now();
+    if (const float window = std::chrono::duration<float>(now - rebuildWindowStart).count(); window >= 1.f) {
+        stats.draw_list_rebuilds_per_second = static_cast<float>(drawListRebuilds - rebuildWindowCount) / window;
+        rebuildWindowStart = now;
+        rebuildWindowCount = drawListRebuilds;
+    }
+    select_lods();
+    cull_surfaces();
+    occlusion_cull();
+    sort_draws();
 
     // RT updates
     raytracerPipeline.rtSampleUpdates(this);
+
+    const auto elapsed =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - start);
+    stats.scene_update_time = static_cast<float>(elapsed.count()) / 1000.f;
 }
 
 void VulkanEngine::run() {
@@ -700,6 +1089,9 @@ void VulkanEngine::run() {
             resize_swapchain();
         }
 
+        update_scene_watch();
+        update_scene_load();
+
         ui::setup_imgui_panel(this);
 
         // our draw function
@@ -747,10 +1139,14 @@ void VulkanEngine::init_vulkan() {
     features12.bufferDeviceAddress = true;
     features12.descriptorIndexing = true;
     features12.runtimeDescriptorArray = true;
+    features12.timelineSemaphore = true;
+    features12.drawIndirectCount = true;
 
     VkPhysicalDeviceFeatures deviceFeatures{};
     deviceFeatures.shaderInt64 = true;
     deviceFeatures.samplerAnisotropy = VK_TRUE;
+    // mesh.frag writes texture streaming feedback
+    deviceFeatures.fragmentStoresAndAtomics = VK_TRUE;
 
     // Custom GPU selection - find all GPUs first
     uint32_t deviceCount = 0;
@@ -872,6 +1268,12 @@ void VulkanEngine::init_vulkan() {
         raytracerPipeline.m_is_raytracing_supported = false;
     }
 
+    // block compressed textures when the GPU samples BC formats, the loader falls back to RGBA8 otherwise
+    VkPhysicalDeviceFeatures bcFeatures{};
+    bcFeatures.textureCompressionBC = VK_TRUE;
+    _textureCompressionBC = physicalDevice.enable_features_if_present(bcFeatures);
+    spdlog::info("BC texture compression {}", _textureCompressionBC ? "supported" : "not supported");
+
     // create the final vulkan device
     vkb::DeviceBuilder deviceBuilder{physicalDevice};
     vkb::Device vkbDevice = deviceBuilder.build().value();
@@ -1136,25 +1538,8 @@ void VulkanEngine::draw_geometry(VkCommandBuffer cmd) {
     // begin clock
     auto start = std::chrono::system_clock::now();
 
-    std::vector<uint32_t> opaque_draws;
-    opaque_draws.reserve(mainDrawContext.OpaqueSurfaces.size());
-
-    for (int i = 0; i < static_cast<int>(mainDrawContext.OpaqueSurfaces.size()); i++) {
-        /*if (is_visible(mainDrawContext.OpaqueSurfaces[i], sceneData.viewproj)) {*/
-        opaque_draws.push_back(i);
-        /*}*/
-    }
-
-    // sort the opaque surfaces by material and mesh
-    auto &surfaces = mainDrawContext.OpaqueSurfaces;
-    std::ranges::sort(opaque_draws, [&](const auto &iA, const auto &iB) {
-        const RenderObject &A = surfaces[iA];
-        const RenderObject &B = surfaces[iB];
-        if (A.material == B.material) {
-            return A.indexBuffer < B.indexBuffer;
-        }
-        return A.material < B.material;
-    });
+    // already sorted by material and mesh, see sort_draws
+    const std::vector<uint32_t> &opaque_draws = cameraVisible.opaque;
 
     // allocate a new uniform buffer for the scene data
     AllocatedBuffer gpuSceneDataBuffer =
@@ -1183,8 +1568,10 @@ void VulkanEngine::draw_geometry(VkCommandBuffer cmd) {
     MaterialPipeline *lastPipeline = nullptr;
     MaterialInstance *lastMaterial = nullptr;
     VkBuffer lastIndexBuffer = VK_NULL_HANDLE;
+    VkIndexType lastIndexType = VK_INDEX_TYPE_UINT32;
 
-    auto draw = [&](const RenderObject &r) {
+    // surfaceIndex into mainDrawContext.OpaqueSurfaces for surfaces the meshlet culler may have handled, -1 otherwise
+    auto draw = [&](const RenderObject &r, int surfaceIndex) {
         if (r.material != lastMaterial) {
             lastMaterial = r.material;
             if (r.material->pipeline != lastPipeline) {
@@ -1219,14 +1606,14 @@ void VulkanEngine::draw_geometry(VkCommandBuffer cmd) {
             vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, r.material->pipeline->layout, 2, 1,
                                     gbuffer.getInputDescriptorSet(), 0, nullptr);
         }
-        if (r.indexBuffer != lastIndexBuffer) {
+        // the arena block and the surface's index type together, surfaces of one block mix 16 and 32 bit
+        if (r.indexBuffer != lastIndexBuffer || r.indexType != lastIndexType) {
             lastIndexBuffer = r.indexBuffer;
-            vkCmdBindIndexBuffer(cmd, r.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+            lastIndexType = r.indexType;
+            vkCmdBindIndexBuffer(cmd, r.indexBuffer, 0, r.indexType);
         }
         // calculate final mesh matrix
-        GPUDrawPushConstants push_constants{};
-        push_constants.worldMatrix = r.transform;
-        push_constants.vertexBuffer = r.vertexBufferAddress;
+        const GPUDrawPushConstants push_constants = draw_push_constants(r);
 
         vkCmdPushConstants(cmd, r.material->pipeline->layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
                            0, sizeof(GPUDrawPushConstants), &push_constants);
@@ -1240,7 +1627,9 @@ void VulkanEngine::draw_geometry(VkCommandBuffer cmd) {
         insertGPUMarker(cmd, drawMarker);
 #endif
 
-        vkCmdDrawIndexed(cmd, r.indexCount, 1, r.firstIndex, 0, 0);
+        if (surfaceIndex < 0 || !meshletCuller.draw(cmd, static_cast<size_t>(surfaceIndex))) {
+            vkCmdDrawIndexed(cmd, r.indexCount, 1, r.firstIndex, r.vertexOffset, 0);
+        }
     };
 
     stats.drawcall_count = 0;
@@ -1251,25 +1640,21 @@ void VulkanEngine::draw_geometry(VkCommandBuffer cmd) {
 #endif
 
     for (auto &r: opaque_draws) {
-        draw(mainDrawContext.OpaqueSurfaces[r]);
+        draw(mainDrawContext.OpaqueSurfaces[r], static_cast<int>(r));
     }
 
 #ifdef NSIGHT_AFTERMATH_ENABLED
     insertGPUMarker(cmd, "Drawing Transparent Surfaces");
 #endif
 
-    for (auto &r: mainDrawContext.TransparentSurfaces) {
-        draw(r);
+    for (const uint32_t r: cameraVisible.transparent) {
+        draw(mainDrawContext.TransparentSurfaces[r], -1);
     }
 
 #ifdef NSIGHT_AFTERMATH_ENABLED
     insertGPUMarker(cmd, "End Geometry Drawing");
 #endif
 
-    // we delete the draw commands now that we processed them
-    mainDrawContext.OpaqueSurfaces.clear();
-    mainDrawContext.TransparentSurfaces.clear();
-
     vkCmdEndRendering(cmd);
 
     auto end = std::chrono::system_clock::now();
@@ -1358,6 +1743,9 @@ void VulkanEngine::init_pipelines() {
     _ssao.init_ssao(this);
     _ssao.init_ssao_blur(this);
 
+    // MESHLET CULLING PIPELINE
+    meshletCuller.init(this);
+
     // FULLSCREEN PIPELINE
     postProcessor.init(this);
 
@@ -1389,61 +1777,40 @@ void VulkanEngine::immediate_submit(std::function<void(VkCommandBuffer cmd)> &&f
     VK_CHECK(vkWaitForFences(_device, 1, &_immFence, true, 9999999999));
 }
 
-GPUMeshBuffers VulkanEngine::uploadMesh(const std::span<uint32_t> indices, const std::span<Vertex> vertices) const {
-    const size_t vertexBufferSize = vertices.size() * sizeof(Vertex);
-    const size_t indexBufferSize = indices.size() * sizeof(uint32_t);
-
-    GPUMeshBuffers newSurface{};
-
-    // create vertex buffer
-    newSurface.vertexBuffer =
-        vkutil::create_buffer(this, vertexBufferSize,
-                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
-                                  VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
-                                  VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-                              VMA_MEMORY_USAGE_GPU_ONLY, "Vertex Buffer");
-
-    // find the address of the vertex buffer
-    const VkBufferDeviceAddressInfo deviceAdressInfo{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-                                                     .buffer = newSurface.vertexBuffer.buffer};
-    newSurface.vertexBufferAddress = vkGetBufferDeviceAddress(_device, &deviceAdressInfo);
-
-    // create index buffer
-    newSurface.indexBuffer =
-        vkutil::create_buffer(this, indexBufferSize,
-                              VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT |
-                                  VK_BUFFER_USAGE_ACCELERATION_STRUCTURE_BUILD_INPUT_READ_ONLY_BIT_KHR |
-                                  VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
-                              VMA_MEMORY_USAGE_GPU_ONLY, "Index Buffer");
-
-    const VkBufferDeviceAddressInfo deviceAdressInfo2{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
-                                                      .buffer = newSurface.indexBuffer.buffer};
-    newSurface.indexBufferAddress = vkGetBufferDeviceAddress(_device, &deviceAdressInfo2);
-
-    const AllocatedBuffer staging =
-        vkutil::create_buffer(this, vertexBufferSize + indexBufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                              VMA_MEMORY_USAGE_CPU_ONLY, "Staging Buffer");
-
-    vkutil::upload_to_buffer(this, vertices.data(), vertexBufferSize, staging);
-    vkutil::upload_to_buffer(this, indices.data(), indexBufferSize, staging, vertexBufferSize);
-
-    immediate_submit([&](VkCommandBuffer cmd) {
-        VkBufferCopy vertexCopy{};
-        vertexCopy.dstOffset = 0;
-        vertexCopy.srcOffset = 0;
-        vertexCopy.size = vertexBufferSize;
-
-        vkCmdCopyBuffer(cmd, staging.buffer, newSurface.vertexBuffer.buffer, 1, &vertexCopy);
-
-        VkBufferCopy indexCopy{0};
-        indexCopy.dstOffset = 0;
-        indexCopy.srcOffset = vertexBufferSize;
-        indexCopy.size = indexBufferSize;
-
-        vkCmdCopyBuffer(cmd, staging.buffer, newSurface.indexBuffer.buffer, 1, &indexCopy);
-    });
+GPUMeshBuffers VulkanEngine::uploadMesh(const std::span<const uint32_t> indices,
+                                        const std::span<const std::byte> vertexData,
+                                        const std::span<const Meshlet> meshlets) {
+    return uploadMesh(
+        indices.size_bytes(),
+        [&](std::span<std::byte> staging) { memcpy(staging.data(), indices.data(), indices.size_bytes()); },
+        vertexData.size(),
+        [&](std::span<std::byte> staging) { memcpy(staging.data(), vertexData.data(), vertexData.size()); },
+        meshlets);
+}
 
-    vkutil::destroy_buffer(this, staging);
+GPUMeshBuffers VulkanEngine::uploadMesh(const size_t indexBytes,
+                                        const std::function<void(std::span<std::byte>)> &write_indices,
+                                        const size_t vertexBytes,
+                                        const std::function<void(std::span<std::byte>)> &write_vertices,
+                                        const std::span<const Meshlet> meshlets) {
+    // suballocate the mesh from the shared vertex/index/meshlet megabuffers
+    GPUMeshBuffers newSurface = geometryArena.allocate(vertexBytes, indexBytes, meshlets.size_bytes());
+
+    // the copies join the current upload batch, nothing waits on the GPU here
+    if (vertexBytes > 0) {
+        const UploadBatcher::Staging staging = uploadBatcher.stage(vertexBytes);
+        write_vertices(std::span<std::byte>(staging.data, vertexBytes));
+        uploadBatcher.copy_to_buffer(newSurface.vertexBuffer, newSurface.vertices.offset, staging);
+    }
+    if (indexBytes > 0) {
+        const UploadBatcher::Staging staging = uploadBatcher.stage(indexBytes);
+        write_indices(std::span<std::byte>(staging.data, indexBytes));
+        uploadBatcher.copy_to_buffer(newSurface.indexBuffer, newSurface.indices.offset, staging);
+    }
+    if (!meshlets.empty()) {
+        uploadBatcher.upload_buffer(newSurface.meshletBuffer, newSurface.meshlets.offset, meshlets.data(),
+                                    meshlets.size_bytes());
+    }
 
     return newSurface;
 }
@@ -1556,6 +1923,12 @@ void GLTFMetallic_Roughness::build_pipelines(VulkanEngine *engine) {
 MaterialInstance GLTFMetallic_Roughness::write_material(VulkanEngine *engine, VkDevice device, MaterialPass pass,
                                                         const MaterialResources &resources,
                                                         DescriptorAllocatorGrowable &descriptorAllocator) {
+    return write_material(engine, device, pass, resources, descriptorAllocator.allocate(device, materialLayout));
+}
+
+MaterialInstance GLTFMetallic_Roughness::write_material(VulkanEngine *engine, VkDevice device, MaterialPass pass,
+                                                        const MaterialResources &resources,
+                                                        VkDescriptorSet materialSet) {
     MaterialInstance matData{};
     matData.passType = pass;
     if (pass == MaterialPass::Transparent) {
@@ -1564,8 +1937,7 @@ MaterialInstance GLTFMetallic_Roughness::write_material(VulkanEngine *engine, Vk
         matData.pipeline = &opaquePipeline;
     }
 
-    matData.materialSet = descriptorAllocator.allocate(device, materialLayout);
-
+    matData.materialSet = materialSet;
 
     writer.clear();
     writer.write_buffer(0, resources.dataBuffer, sizeof(MaterialConstants), resources.dataBufferOffset,
@@ -1606,20 +1978,41 @@ MaterialInstance GLTFMetallic_Roughness::write_material(VulkanEngine *engine, Vk
     return matData;
 }
 
-void MeshNode::Draw(const glm::mat4 &topMatrix, DrawContext &ctx) {
-    const glm::mat4 nodeMatrix = topMatrix * worldTransform;
-
-    for (auto &s: mesh->surfaces) {
+void add_mesh_surfaces(const MeshAsset &mesh, const glm::mat4 &transform, DrawContext &ctx, uint32_t node) {
+    for (auto &s: mesh.surfaces) {
         RenderObject def{};
         def.indexCount = s.count;
-        def.firstIndex = s.startIndex;
-        def.indexBuffer = mesh->meshBuffers.indexBuffer.buffer;
+        // the surface's ranges count from the mesh's first index byte, the arena keeps it 4 byte aligned
+        const uint32_t meshFirstIndex = static_cast<uint32_t>(
+            mesh.meshBuffers.indices.offset / (s.indexType == VK_INDEX_TYPE_UINT16 ? 2 : 4));
+        def.firstIndex = meshFirstIndex + s.startIndex;
+        def.indexBuffer = mesh.meshBuffers.indexBuffer;
+        def.indexType = s.indexType;
+        def.vertexOffset = s.vertexOffset;
         def.material = &s.material->data;
         def.bounds = s.bounds;
-        def.transform = nodeMatrix;
-        def.vertexBufferAddress = mesh->meshBuffers.vertexBufferAddress;
-        def.indexBufferAddress = mesh->meshBuffers.indexBufferAddress;
-        def.vertexCount = mesh->nbVertices;
+        def.transform = transform;
+        def.vertexBufferAddress = mesh.meshBuffers.vertexBufferAddress;
+        def.indexBufferAddress = mesh.meshBuffers.indexBufferAddress;
+        if (mesh.meshBuffers.meshletBufferAddress != 0) {
+            def.meshletBufferAddress = mesh.meshBuffers.meshletBufferAddress + s.firstMeshlet * sizeof(Meshlet);
+            def.meshletCount = s.meshletCount;
+            def.meshletCullFlags =
+                meshlets::cull_flags(s.material->doubleSided, def.material->pipeline->cullsBackFaces);
+        }
+        def.lodCount = s.lodCount;
+        for (uint32_t l = 0; l < s.lodCount; l++) {
+            def.lods[l] = s.lods[l];
+            def.lods[l].startIndex += meshFirstIndex;
+        }
+        def.fullFirstIndex = def.firstIndex;
+        def.fullIndexCount = def.indexCount;
+        def.fullMeshletCount = def.meshletCount;
+        def.node = node;
+        def.occluder = s.occluder.get();
+        def.vertexCount = mesh.nbVertices;
+        def.vertexFormat = mesh.vertexFormat;
+        def.quantization = mesh.quantization;
 
         if (s.material->data.passType == MaterialPass::Transparent) {
             ctx.TransparentSurfaces.push_back(def);
@@ -1627,6 +2020,10 @@ void MeshNode::Draw(const glm::mat4 &topMatrix, DrawContext &ctx) {
             ctx.OpaqueSurfaces.push_back(def);
         }
     }
+}
+
+void MeshNode::Draw(const glm::mat4 &topMatrix, DrawContext &ctx) {
+    add_mesh_surfaces(*mesh, topMatrix * worldTransform, ctx);
 
     // recurse down
     Node::Draw(topMatrix, ctx);
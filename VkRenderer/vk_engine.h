@@ -11,9 +11,19 @@
 #include <ui.h>
 #include <vk_descriptors.h>
 #include <vk_types.h>
+#include "DrawSort.h"
+#include "FileWatcher.h"
+#include "FrustumCull.h"
+#include "GeometryArena.h"
 #include "Hdri.h"
+#include "JobSystem.h"
+#include "MeshletCuller.h"
+#include "OcclusionCull.h"
 #include "Scene/SceneDesc.h"
 #include "Scene/camera.h"
+#include "TextureCache.h"
+#include "TextureStreamer.h"
+#include "UploadBatcher.h"
 #include "cube.h"
 #include "gbuffer.h"
 
@@ -51,10 +61,14 @@ struct GLTFMetallic_Roughness {
         int hasTransmissionTex;
         float ior;
         int hasEmissiveTex;
+        // TextureStreamer feedback slots of the sampled textures, -1 when not streamed
+        int colorFeedbackSlot;
+        int metalRoughFeedbackSlot;
+        int normalFeedbackSlot;
         glm::vec4 emissiveFactor;
 
         // padding, we need it anyway for uniform buffers - align to 64 bytes
-        uint8_t padding[60];
+        uint8_t padding[48];
     };
 
     struct MaterialResources {
@@ -90,16 +104,47 @@ struct GLTFMetallic_Roughness {
     MaterialInstance write_material(VulkanEngine *engine, VkDevice device, MaterialPass pass,
                                     const MaterialResources &resources,
                                     DescriptorAllocatorGrowable &descriptorAllocator);
+    // rewrites a set the material already owns, a hot reload patches materials in place
+    MaterialInstance write_material(VulkanEngine *engine, VkDevice device, MaterialPass pass,
+                                    const MaterialResources &resources, VkDescriptorSet materialSet);
 };
 
 struct EngineStats {
     float frametime;
     int triangle_count;
+    // what the same draws would have cost at full detail, see select_lods
+    int full_detail_triangle_count;
+    // surfaces drawn at each level this frame, 0 is full detail
+    std::array<int, simplify::MAX_LODS + 1> lod_surface_count;
     int drawcall_count;
+    // surfaces left after frustum culling against the camera and the shadow map's light, out of surface_count
+    int surface_count;
+    int visible_surface_count;
+    int shadow_visible_surface_count;
+    float cull_time;
+    // software occlusion culling of the camera's surfaces: occluders drawn, surfaces culled and their share of
+    // what survived frustum culling
+    int occluder_count;
+    int occluder_triangle_count;
+    int occluded_surface_count;
+    float occluded_fraction;
+    float occlusion_time;
+    // building and radix sorting the opaque draw keys of the camera and the shadow map
+    float sort_time;
+    // whole of update_scene, and the node world transforms it had to recompute
     float scene_update_time;
+    int transform_update_count;
+    // surfaces whose transform was rewritten in the retained draw lists, and how often the lists were rebuilt
+    int patched_surface_count;
+    float draw_list_rebuilds_per_second;
     float mesh_draw_time;
+    GLTFLoadStats scene_load;
 };
 
+// appends the surfaces of a mesh placed at `transform` to the context's opaque or transparent list, `node` is
+// recorded in them so a retained draw list can patch their transform
+void add_mesh_surfaces(const MeshAsset &mesh, const glm::mat4 &transform, DrawContext &ctx, uint32_t node = 0);
+
 struct MeshNode final : Node {
 
     std::shared_ptr<MeshAsset> mesh;
@@ -114,6 +159,7 @@ public:
     VkDebugUtilsMessengerEXT _debug_messenger; // Vulkan debug output handle
     VkPhysicalDevice _chosenGPU; // GPU chosen as the default device
     VkDevice _device; // Vulkan device for commands
+    bool _textureCompressionBC{false}; // textureCompressionBC was enabled on _device
     VkSurfaceKHR _surface; // Vulkan window surface
 
     VkSwapchainKHR _swapchain; // Swapchain handle
@@ -140,6 +186,20 @@ public:
     bool stop_rendering{false};
     bool useRaytracer{false};
 
+    // LOD selection, a surface drops to the coarsest level whose error projects to at most lodErrorPixels
+    bool useLods{true};
+    float lodErrorPixels{1.f};
+
+    // surfaces every pass draws this frame, indices into mainDrawContext's lists, see cull_surfaces
+    bool frustumCulling{true};
+    // the camera's surfaces are then tested against the largest occluders on screen, see occlusion_cull. An
+    // occluder has to cover at least minOccluderSize, its bounding sphere's radius over its distance
+    bool occlusionCulling{true};
+    int maxOccluders{32};
+    float minOccluderSize{0.05f};
+    VisibleSurfaces cameraVisible;
+    VisibleSurfaces shadowVisible;
+
     // Ray tracing
     Raytracer raytracerPipeline;
 
@@ -196,6 +256,9 @@ public:
     // SSAO resources
     ssao _ssao;
 
+    // GPU meshlet culling of the opaque pass
+    MeshletCuller meshletCuller;
+
     // Full screen quad resources
     PostProcessor postProcessor;
     VkDescriptorSet _viewportTextureDescriptorSet = VK_NULL_HANDLE;
@@ -209,6 +272,21 @@ public:
     // Resource management
     VulkanResourceManager _resourceManager;
 
+    // shared vertex/index megabuffers all meshes live in
+    GeometryArena geometryArena;
+
+    // batched staging uploads for meshes and textures
+    UploadBatcher uploadBatcher;
+
+    // textures shared by every loaded scene, deduplicated by content hash
+    TextureCache textureCache;
+    // mip residency of the cached textures the raster passes sample, driven by GPU feedback
+    TextureStreamer textureStreamer;
+
+    // worker threads for asset loading
+    JobSystem jobSystem;
+    LoaderSettings loaderSettings;
+
 #ifdef NSIGHT_AFTERMATH_ENABLED
     // Nsight Aftermath marker support
     PFN_vkCmdSetCheckpointNV vkCmdSetCheckpointNV;
@@ -221,7 +299,21 @@ public:
     std::unordered_map<std::string, std::shared_ptr<LoadedGLTF>> loadedScenes;
     std::unordered_map<std::string, SceneDesc::SceneInfo> sceneInfos;
 
-    GPUMeshBuffers uploadMesh(std::span<uint32_t> indices, std::span<Vertex> vertices) const;
+    // scene streaming in from a file drop, the current one keeps rendering until it is swapped in
+    std::unique_ptr<GltfLoadTask> sceneLoad;
+    // the dropped scene and the files it was loaded from, patched in place when they change on disk
+    FileWatcher sceneWatcher;
+    std::weak_ptr<LoadedGLTF> watchedScene;
+    std::string watchedScenePath;
+
+    // vertexData holds the vertices in whatever VertexFormat the caller packed them
+    GPUMeshBuffers uploadMesh(std::span<const uint32_t> indices, std::span<const std::byte> vertexData,
+                              std::span<const Meshlet> meshlets = {});
+    // same, but the writers fill `indexBytes` and `vertexBytes` of staging memory themselves, so packing skips
+    // the CPU copy. the index block is bound at offset 0, so its first byte is 4 byte aligned for either index type
+    GPUMeshBuffers uploadMesh(size_t indexBytes, const std::function<void(std::span<std::byte>)> &write_indices,
+                              size_t vertexBytes, const std::function<void(std::span<std::byte>)> &write_vertices,
+                              std::span<const Meshlet> meshlets = {});
 
     // initializes everything in the engine
     void init();
@@ -235,7 +327,7 @@ public:
     // run main loop
     void run();
 
-    // dynamic scene loading
+    // dynamic scene loading, parses and decodes on the job system and uploads over the following frames
     void load_scene_from_file(const std::string &filePath);
 
     bool resize_requested{false};
@@ -243,7 +335,55 @@ public:
 
 private:
     void draw_geometry(VkCommandBuffer cmd);
+    // where a scene is placed, from its scene info
+    glm::mat4 scene_matrix(const std::string &sceneName) const;
+    // rebuilds mainDrawContext and cullBounds from every loaded scene
     void traverseScenes();
+    // keeps mainDrawContext across frames: rebuilds it when drawListsDirty, otherwise only rewrites the surfaces
+    // under nodes whose world transform changed
+    void update_draw_lists();
+
+    // the surfaces of one scene in the draw lists, [begin, end) and sorted by node
+    struct SceneSurfaces {
+        LoadedGLTF *scene;
+        std::string name;
+        uint32_t opaqueBegin;
+        uint32_t opaqueEnd;
+        uint32_t transparentBegin;
+        uint32_t transparentEnd;
+    };
+    std::vector<SceneSurfaces> sceneSurfaces;
+    bool drawListsDirty{true};
+    int drawListRebuilds{0};
+    std::chrono::steady_clock::time_point rebuildWindowStart{};
+    int rebuildWindowCount{0};
+
+    // picks the LOD of every surface in mainDrawContext from the camera, before any pass records a draw
+    void select_lods();
+    // culls mainDrawContext against the camera and the light into cameraVisible and shadowVisible
+    void cull_surfaces();
+    frustumcull::BoundsSoA cullBounds;
+    std::vector<uint64_t> cullMask;
+    // rasterizes the largest visible occluders and drops the camera's surfaces hidden behind them. The shadow
+    // map keeps its list, a caster hidden from the camera can still throw a visible shadow
+    void occlusion_cull();
+    occlusion::DepthBuffer occlusionBuffer;
+    std::vector<occlusion::Occluder> occluders;
+    std::vector<std::pair<float, uint32_t>> occluderCandidates;
+    std::vector<uint8_t> occludedFlags;
+    // orders cameraVisible.opaque and shadowVisible.opaque by drawsort key, the gbuffer and the main pass share
+    // the camera's order instead of each sorting their own copy
+    void sort_draws();
+    std::vector<uint64_t> drawKeys;
+    std::vector<uint64_t> drawKeyScratch;
+    std::vector<uint32_t> drawIndexScratch;
+
+    // starts a hot reload of the watched scene once a change to its files settled
+    void update_scene_watch();
+    // advances sceneLoad by one budgeted upload slice and swaps the scene in once it is complete, or hands a
+    // patched one to the ray tracer
+    void update_scene_load();
+    void activate_scene(const std::shared_ptr<LoadedGLTF> &scene, const std::string &filePath);
 
     void init_pipelines();
 
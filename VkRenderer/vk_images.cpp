@@ -1,4 +1,5 @@
 ﻿#define STB_IMAGE_IMPLEMENTATION
+#include <cassert>
 #include <glm/gtc/packing.hpp>
 #include <stb_image.h>
 
@@ -46,51 +47,34 @@ AllocatedImage vkutil::create_image(const VulkanEngine *engine, VkExtent3D size,
     return newImage;
 }
 
-AllocatedImage vkutil::create_image(const VulkanEngine *engine, void *data, VkExtent3D size, VkFormat format,
+AllocatedImage vkutil::create_image(VulkanEngine *engine, void *data, VkExtent3D size, VkFormat format,
                                     VkImageUsageFlags usage, bool mipmapped, const char *name) {
     const size_t pixel_size = format == VK_FORMAT_R32G32B32A32_SFLOAT ? 16 : 4;
     size_t data_size = size.depth * size.width * size.height * pixel_size;
-    AllocatedBuffer uploadbuffer = vkutil::create_buffer(engine, data_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                                         VMA_MEMORY_USAGE_CPU_TO_GPU, "Image Upload Buffer");
-
-    memcpy(uploadbuffer.info.pMappedData, data, data_size);
 
     AllocatedImage new_image =
         create_image(engine, size, format, usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
                      mipmapped, name);
 
-    engine->immediate_submit([&](VkCommandBuffer cmd) {
-        vkutil::transition_image(cmd, new_image.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                 VK_IMAGE_ASPECT_COLOR_BIT);
-
-        VkBufferImageCopy copyRegion = {};
-        copyRegion.bufferOffset = 0;
-        copyRegion.bufferRowLength = 0;
-        copyRegion.bufferImageHeight = 0;
-
-        copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        copyRegion.imageSubresource.mipLevel = 0;
-        copyRegion.imageSubresource.baseArrayLayer = 0;
-        copyRegion.imageSubresource.layerCount = 1;
-        copyRegion.imageExtent = size;
-
-        // copy the buffer into the image
-        vkCmdCopyBufferToImage(cmd, uploadbuffer.buffer, new_image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
-                               &copyRegion);
-
-        if (mipmapped) {
-            vkutil::generate_mipmaps(cmd, new_image.image,
-                                     VkExtent2D{new_image.imageExtent.width, new_image.imageExtent.height});
-        } else {
-            vkutil::transition_image(cmd, new_image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_ASPECT_COLOR_BIT);
-        }
-    });
-    vkutil::destroy_buffer(engine, uploadbuffer);
+    // staged and recorded into the current upload batch, no wait on the GPU here
+    engine->uploadBatcher.upload_image(new_image, data, data_size, mipmapped);
     return new_image;
 }
 
-AllocatedImage vkutil::create_hdri_image(const VulkanEngine *engine, float *data, int width, int height,
+AllocatedImage vkutil::create_image(VulkanEngine *engine, const MipChainView &chain, VkImageUsageFlags usage,
+                                    const char *name) {
+    const VkExtent3D size{chain.levels[0].width, chain.levels[0].height, 1};
+    const bool mipmapped = chain.levels.size() > 1;
+    assert(!mipmapped || chain.levels.size() == blockcompress::mip_count(size.width, size.height));
+
+    AllocatedImage new_image =
+        create_image(engine, size, chain.format, usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT, mipmapped, name);
+
+    engine->uploadBatcher.upload_mip_chain(new_image, chain);
+    return new_image;
+}
+
+AllocatedImage vkutil::create_hdri_image(VulkanEngine *engine, float *data, int width, int height,
                                          int nrComponents, const char *name) {
     VkFormat format = VK_FORMAT_R16G16B16A16_SFLOAT;
 
@@ -118,22 +102,13 @@ AllocatedImage vkutil::create_hdri_image(const VulkanEngine *engine, float *data
     newImage.imageExtent = imageSize;
     newImage.imageFormat = format;
 
-    // Create a staging buffer
-    AllocatedBuffer uploadBuffer = vkutil::create_buffer(engine, dstSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                                                         VMA_MEMORY_USAGE_CPU_TO_GPU, "HDRI Upload Buffer");
-
-    // Verify buffer is mapped
-    if (uploadBuffer.info.pMappedData == nullptr) {
-        // Map it explicitly if not mapped
-        void *mappedData = nullptr;
-        VK_CHECK(vmaMapMemory(engine->_allocator, uploadBuffer.allocation, &mappedData));
-        uploadBuffer.info.pMappedData = mappedData;
-    }
+    // Convert straight into staging memory of the upload batcher
+    const UploadBatcher::Staging staging = engine->uploadBatcher.stage(dstSize);
 
     // Initialize the buffer to zeros for safety
-    memset(uploadBuffer.info.pMappedData, 0, dstSize);
+    memset(staging.data, 0, dstSize);
 
-    unsigned char *dstPtr = static_cast<unsigned char *>(uploadBuffer.info.pMappedData);
+    unsigned char *dstPtr = reinterpret_cast<unsigned char *>(staging.data);
 
     // Process all pixels
     for (int y = 0; y < height; y++) {
@@ -165,18 +140,6 @@ AllocatedImage vkutil::create_hdri_image(const VulkanEngine *engine, float *data
     // Free source data after conversion
     stbi_image_free(data);
 
-    // Setup copy region
-    VkBufferImageCopy copyRegion = {};
-    copyRegion.bufferOffset = 0;
-    copyRegion.bufferRowLength = 0; // Tightly packed
-    copyRegion.bufferImageHeight = 0; // Tightly packed
-    copyRegion.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    copyRegion.imageSubresource.mipLevel = 0;
-    copyRegion.imageSubresource.baseArrayLayer = 0;
-    copyRegion.imageSubresource.layerCount = 1;
-    copyRegion.imageExtent = imageSize;
-    copyRegion.imageOffset = {0, 0, 0};
-
     // Always allocate images on dedicated GPU memory
     VmaAllocationCreateInfo allocInfo = {};
     allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
@@ -203,42 +166,8 @@ AllocatedImage vkutil::create_hdri_image(const VulkanEngine *engine, float *data
 
     VK_CHECK(vkCreateImageView(engine->_device, &viewInfo, nullptr, &newImage.imageView));
 
-    // Upload the image data and transition layout
-    engine->immediate_submit([&](VkCommandBuffer cmd) {
-        // Transition image to transfer destination layout
-        VkImageMemoryBarrier barrier = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER};
-        barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = newImage.image;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = 1;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
-                             nullptr, 1, &barrier);
-
-        // Copy the buffer to the image
-        vkCmdCopyBufferToImage(cmd, uploadBuffer.buffer, newImage.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
-                               &copyRegion);
-
-        // Transition to shader read layout
-        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr,
-                             0, nullptr, 1, &barrier);
-    });
-
-    // Clean up the staging buffer
-    vkutil::destroy_buffer(engine, uploadBuffer);
+    // Record the copy and layout transitions into the current upload batch
+    engine->uploadBatcher.copy_to_image(newImage, staging, false);
 
     return newImage;
 }
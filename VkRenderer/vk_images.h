@@ -1,5 +1,6 @@
 #pragma once
 
+#include <BlockCompression.h>
 #include <vk_engine.h>
 #include <vulkan/vulkan.h>
 
@@ -12,9 +13,14 @@ namespace vkutil {
     void generate_mipmaps(VkCommandBuffer cmd, VkImage image, VkExtent2D imageSize);
     AllocatedImage create_image(const VulkanEngine *engine, VkExtent3D size, VkFormat format, VkImageUsageFlags usage,
                                 bool mipmapped = false, const char *name = nullptr);
-    AllocatedImage create_image(const VulkanEngine *engine, void *data, VkExtent3D size, VkFormat format,
+    // the upload is recorded into the engine's upload batcher, the image is ready for any GPU work submitted later
+    AllocatedImage create_image(VulkanEngine *engine, void *data, VkExtent3D size, VkFormat format,
                                 VkImageUsageFlags usage, bool mipmapped = false, const char *name = nullptr);
-    AllocatedImage create_hdri_image(const VulkanEngine *engine, float *data, int width, int height, int nrComponents,
+    // every level comes pre-built, e.g. block compressed on the CPU, and is copied as-is. the chain is either a
+    // single level or complete down to 1x1
+    AllocatedImage create_image(VulkanEngine *engine, const MipChainView &chain, VkImageUsageFlags usage,
+                                const char *name = nullptr);
+    AllocatedImage create_hdri_image(VulkanEngine *engine, float *data, int width, int height, int nrComponents,
                                      const char *name = nullptr);
     void destroy_image(const VulkanEngine *engine, const AllocatedImage &image);
 } // namespace vkutil
\ No newline at end of file
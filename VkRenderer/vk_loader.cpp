@@ -1,5 +1,10 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
 #include <filesystem>
 #include <iostream>
+#include <limits>
 #include <variant>
 #include <vk_loader.h>
 
@@ -9,6 +14,25 @@
 #include <glm/gtx/quaternion.hpp>
 #include <vk_buffers.h>
 #include <vk_images.h>
+#include "BlockCompression.h"
+#include "CompressedTextureCache.h"
+#include "ContentHash.h"
+#include "IndexPacking.h"
+#include "JobSystem.h"
+#include "LoadProfile.h"
+#include "MappedFile.h"
+#include "MeshCache.h"
+#include "MeshOptimize.h"
+#include "MeshoptDecode.h"
+#include "Meshlets.h"
+#include "MipGenerator.h"
+#include "Simplify.h"
+#include "StreamingPolicy.h"
+#include "TangentSpace.h"
+#include "TextureCache.h"
+#include "TextureStreamer.h"
+#include "VertexPacking.h"
+#include "VertexWeld.h"
 #include "stb_image.h"
 #include "vk_engine.h"
 #include "vk_types.h"
@@ -19,13 +43,198 @@
 #include <fastgltf/types.hpp>
 #include <spdlog/spdlog.h>
 
-//> loadimg
-std::optional<AllocatedImage> load_image(VulkanEngine *engine, fastgltf::Asset &asset, fastgltf::Image &image,
-                                         std::string baseDir) {
-    AllocatedImage newImage{};
+// format and mips every glTF texture is uploaded with unless it is block compressed, part of its texture cache key
+constexpr VkFormat TEXTURE_FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+constexpr bool TEXTURE_MIPMAPPED = true;
+
+// pixels produced by a decode job, handed to the upload stage on the loading thread
+struct DecodedImage {
+    size_t index{0};
+    stbi_uc *pixels{nullptr};
+    VkExtent3D extent{};
+    std::string name;
+    // TextureCache key of the encoded image, 0 when its bytes could not be read
+    uint64_t cacheKey{0};
+    // the texture cache already held it when the job ran, so it was not decoded
+    bool cached{false};
+    VkFormat format{TEXTURE_FORMAT};
+    // mips built on the CPU, block compressed or RGBA8. compressed chains may instead come mapped from the
+    // compressed texture cache
+    MipChain chain;
+    CompressedTextureCache diskCache;
+    float decodeTime{0.f};
+    float mipTime{0.f};
+    float encodeTime{0.f};
+
+    [[nodiscard]] std::optional<MipChainView> mip_chain() const {
+        if (diskCache.is_open()) {
+            return diskCache.view();
+        }
+        if (!chain.levels.empty()) {
+            return chain.view();
+        }
+        return {};
+    }
+};
+
+// how decode_image turns one glTF image into upload ready data
+struct ImageDecodeOptions {
+    VkFormat format{TEXTURE_FORMAT};
+    // images this cache already holds are only hashed, null to always decode
+    const TextureCache *residentCache{nullptr};
+    // compressed mip chains are read from and written to this directory, empty to always encode
+    std::filesystem::path compressedCacheDirectory;
+    // build the mip chain on the CPU, otherwise the upload blits it. block compressed formats need it
+    std::optional<mipgen::MipSettings> mips;
+    // the mip filter and block encoder spread their rows over it
+    JobSystem *jobs{nullptr};
+};
+
+// BC format of every image from how the materials sample it. images sampled in more than one role, or only
+// as transmission, keep all four channels in BC7. without compression everything stays RGBA8
+std::vector<VkFormat> texture_formats(const fastgltf::Asset &gltf, bool compress) {
+    if (!compress) {
+        return std::vector<VkFormat>(gltf.images.size(), TEXTURE_FORMAT);
+    }
+
+    std::vector<uint32_t> usages(gltf.images.size(), 0);
+    auto mark = [&](const auto &textureInfo, blockcompress::TextureUsage usage) {
+        if (!textureInfo.has_value()) {
+            return;
+        }
+        const fastgltf::Texture &texture = gltf.textures[textureInfo->textureIndex];
+        if (texture.imageIndex.has_value()) {
+            usages[texture.imageIndex.value()] |= 1u << static_cast<uint32_t>(usage);
+        }
+    };
+
+    for (const fastgltf::Material &mat: gltf.materials) {
+        mark(mat.pbrData.baseColorTexture, blockcompress::TextureUsage::Color);
+        mark(mat.emissiveTexture, blockcompress::TextureUsage::Color);
+        mark(mat.pbrData.metallicRoughnessTexture, blockcompress::TextureUsage::MetalRough);
+        mark(mat.normalTexture, blockcompress::TextureUsage::Normal);
+        if (mat.transmission) {
+            mark(mat.transmission->transmissionTexture, blockcompress::TextureUsage::Color);
+        }
+    }
+
+    std::vector<VkFormat> formats(gltf.images.size());
+    for (size_t i = 0; i < formats.size(); i++) {
+        blockcompress::TextureUsage usage = blockcompress::TextureUsage::Color;
+        if (usages[i] == 1u << static_cast<uint32_t>(blockcompress::TextureUsage::Normal)) {
+            usage = blockcompress::TextureUsage::Normal;
+        } else if (usages[i] == 1u << static_cast<uint32_t>(blockcompress::TextureUsage::MetalRough)) {
+            usage = blockcompress::TextureUsage::MetalRough;
+        }
+        formats[i] = blockcompress::format_for(usage);
+    }
+    return formats;
+}
+
+// how the CPU mip chain of every image is filtered. base color and emissive hold sRGB colors unless another
+// slot samples the same image as data, base color textures of alpha tested materials keep their coverage
+std::vector<mipgen::MipSettings> texture_mip_settings(const fastgltf::Asset &gltf, mipgen::MipFilter filter) {
+    std::vector<bool> colorUse(gltf.images.size(), false);
+    std::vector<bool> dataUse(gltf.images.size(), false);
+    std::vector<mipgen::MipSettings> settings(gltf.images.size());
+
+    auto image_of = [&](const auto &textureInfo) -> std::optional<size_t> {
+        if (!textureInfo.has_value()) {
+            return {};
+        }
+        const fastgltf::Texture &texture = gltf.textures[textureInfo->textureIndex];
+        if (!texture.imageIndex.has_value()) {
+            return {};
+        }
+        return texture.imageIndex.value();
+    };
+
+    for (const fastgltf::Material &mat: gltf.materials) {
+        if (const std::optional<size_t> image = image_of(mat.pbrData.baseColorTexture)) {
+            colorUse[*image] = true;
+            if (mat.alphaMode == fastgltf::AlphaMode::Mask) {
+                const float cutoff = static_cast<float>(mat.alphaCutoff);
+                settings[*image].alphaCutoff = std::max(settings[*image].alphaCutoff, cutoff);
+            }
+        }
+        if (const std::optional<size_t> image = image_of(mat.emissiveTexture)) {
+            colorUse[*image] = true;
+        }
+        for (const std::optional<size_t> image:
+             {image_of(mat.pbrData.metallicRoughnessTexture), image_of(mat.normalTexture)}) {
+            if (image.has_value()) {
+                dataUse[*image] = true;
+            }
+        }
+        if (mat.transmission) {
+            if (const std::optional<size_t> image = image_of(mat.transmission->transmissionTexture)) {
+                dataUse[*image] = true;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < settings.size(); i++) {
+        settings[i].filter = filter;
+        settings[i].srgb = colorUse[i] && !dataUse[i];
+    }
+    return settings;
+}
+
+// images mesh.frag samples as base color, metal rough or normal map. only those report the level they need, the
+// rest would never leave their streaming floor
+std::vector<bool> streamed_images(const fastgltf::Asset &gltf) {
+    std::vector<bool> streamed(gltf.images.size(), false);
+    auto mark = [&](const auto &textureInfo) {
+        if (!textureInfo.has_value()) {
+            return;
+        }
+        const fastgltf::Texture &texture = gltf.textures[textureInfo->textureIndex];
+        if (texture.imageIndex.has_value()) {
+            streamed[texture.imageIndex.value()] = true;
+        }
+    };
+
+    for (const fastgltf::Material &mat: gltf.materials) {
+        mark(mat.pbrData.baseColorTexture);
+        mark(mat.pbrData.metallicRoughnessTexture);
+        mark(mat.normalTexture);
+    }
+    return streamed;
+}
 
+// bytes of a buffer the parser loaded into memory or map_gltf_buffers mapped, empty for anything else
+std::span<const uint8_t> buffer_bytes(const fastgltf::Buffer &buffer) {
+    return std::visit(
+        [](const auto &data) -> std::span<const uint8_t> {
+            if constexpr (requires {
+                              data.bytes.data();
+                              data.bytes.size();
+                          }) {
+                return {reinterpret_cast<const uint8_t *>(data.bytes.data()),
+                        data.bytes.size() * sizeof(*data.bytes.data())};
+            } else {
+                return {};
+            }
+        },
+        buffer.data);
+}
+
+//> loadimg
+// cpu only half of the image load, runs on the job system so it must not touch the engine. textures the
+// texture cache already holds are only hashed, not decoded, compressed textures come from the disk cache when
+// an earlier load encoded them
+DecodedImage decode_image(fastgltf::Asset &asset, fastgltf::Image &image, const std::string &baseDir,
+                          const ImageDecodeOptions &options) {
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    DecodedImage decoded{};
+    decoded.format = options.format;
     int width, height, nrChannels;
 
+    // the encoded bytes, mapped from disk for external images
+    MappedFile file;
+    std::span<const uint8_t> encoded;
+
     std::visit(
         fastgltf::visitor{
             [](auto &) {},
@@ -40,73 +249,100 @@ std::optional<AllocatedImage> load_image(VulkanEngine *engine, fastgltf::Asset &
                 std::filesystem::path fullPath = std::filesystem::path(baseDir) / filePath.uri.path();
                 fullPath = fullPath.lexically_normal(); // Normalize path separators
 
-                unsigned char *data = stbi_load(fullPath.string().c_str(), &width, &height, &nrChannels, 4);
-                if (data) {
-                    VkExtent3D imagesize;
-                    imagesize.width = width;
-                    imagesize.height = height;
-                    imagesize.depth = 1;
-
-                    newImage = vkutil::create_image(engine, data, imagesize, VK_FORMAT_R8G8B8A8_UNORM,
-                                                    VK_IMAGE_USAGE_SAMPLED_BIT, true, path.c_str());
-
-                    stbi_image_free(data);
+                if (file.open(fullPath)) {
+                    encoded = file.bytes();
                 }
+                decoded.name = path;
             },
             [&](fastgltf::sources::Vector &vector) {
-                unsigned char *data = stbi_load_from_memory(vector.bytes.data(), static_cast<int>(vector.bytes.size()),
-                                                            &width, &height, &nrChannels, 4);
-                if (data) {
-                    VkExtent3D imagesize;
-                    imagesize.width = width;
-                    imagesize.height = height;
-                    imagesize.depth = 1;
-
-                    newImage = vkutil::create_image(engine, data, imagesize, VK_FORMAT_R8G8B8A8_UNORM,
-                                                    VK_IMAGE_USAGE_SAMPLED_BIT, true, "Loader Img alloc for Vector");
-
-                    stbi_image_free(data);
-                }
+                encoded = std::span<const uint8_t>(vector.bytes.data(), vector.bytes.size());
+                decoded.name = "Loader Img alloc for Vector";
             },
             [&](fastgltf::sources::BufferView &view) {
                 auto &bufferView = asset.bufferViews[view.bufferViewIndex];
-                auto &buffer = asset.buffers[bufferView.bufferIndex];
-
-                std::visit(fastgltf::visitor{// We only care about VectorWithMime here, because we
-                                             // specify LoadExternalBuffers, meaning all buffers
-                                             // are already loaded into a vector.
-                                             [](auto &) {},
-                                             [&](fastgltf::sources::Array &array) {
-                                                 unsigned char *data =
-                                                     stbi_load_from_memory(array.bytes.data() + bufferView.byteOffset,
-                                                                           static_cast<int>(bufferView.byteLength),
-                                                                           &width, &height, &nrChannels, 4);
-                                                 if (data) {
-                                                     VkExtent3D imagesize;
-                                                     imagesize.width = width;
-                                                     imagesize.height = height;
-                                                     imagesize.depth = 1;
-
-                                                     newImage = vkutil::create_image(
-                                                         engine, data, imagesize, VK_FORMAT_R8G8B8A8_UNORM,
-                                                         VK_IMAGE_USAGE_SAMPLED_BIT, true,
-                                                         "Loader Image Allocation from Buffer view");
-
-                                                     stbi_image_free(data);
-                                                 }
-                                             }},
-                           buffer.data);
+                // loaded by the parser or mapped from disk, see map_gltf_buffers
+                const std::span<const uint8_t> bytes = buffer_bytes(asset.buffers[bufferView.bufferIndex]);
+                if (bufferView.byteOffset + bufferView.byteLength <= bytes.size()) {
+                    encoded = bytes.subspan(bufferView.byteOffset, bufferView.byteLength);
+                    decoded.name = "Loader Image Allocation from Buffer view";
+                }
             },
         },
         image.data);
 
-    // if any of the attempts to load the data failed, we haven't written the image
-    // so handle is null
+    const bool blockCompressed = blockcompress::is_block_compressed(options.format);
+    const bool useDiskCache = blockCompressed && !options.compressedCacheDirectory.empty();
+    std::filesystem::path diskCachePath;
+
+    if (!encoded.empty()) {
+        decoded.cacheKey = TextureCache::key(encoded, options.format, TEXTURE_MIPMAPPED);
+        if (options.mips.has_value()) {
+            decoded.cacheKey = hash_combine(decoded.cacheKey, mipgen::settings_key(*options.mips));
+        }
+        decoded.cached = options.residentCache && options.residentCache->contains(decoded.cacheKey);
+        if (!decoded.cached && useDiskCache) {
+            diskCachePath = CompressedTextureCache::path_for(options.compressedCacheDirectory, decoded.cacheKey);
+            decoded.diskCache.open(diskCachePath, decoded.cacheKey, options.format);
+        }
+        if (!decoded.cached && !decoded.diskCache.is_open()) {
+            decoded.pixels = stbi_load_from_memory(encoded.data(), static_cast<int>(encoded.size()), &width,
+                                                   &height, &nrChannels, 4);
+        }
+    }
+
+    if (decoded.diskCache.is_open()) {
+        const MipLevel &base = decoded.diskCache.view().levels[0];
+        decoded.extent = VkExtent3D{base.width, base.height, 1};
+    } else if (decoded.pixels) {
+        decoded.extent = VkExtent3D{static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1};
+
+        if (options.mips.has_value()) {
+            const auto mipStart = std::chrono::high_resolution_clock::now();
+            decoded.chain = mipgen::generate(decoded.pixels, decoded.extent.width, decoded.extent.height,
+                                             *options.mips, options.jobs);
+            stbi_image_free(decoded.pixels);
+            decoded.pixels = nullptr;
+            decoded.mipTime =
+                std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - mipStart)
+                    .count();
+        }
+
+        if (blockCompressed) {
+            const auto encodeStart = std::chrono::high_resolution_clock::now();
+            decoded.chain = blockcompress::compress(decoded.chain.view(), options.format, options.jobs);
+
+            if (useDiskCache) {
+                CompressedTextureCache::write(diskCachePath, decoded.cacheKey, decoded.chain.view());
+            }
+            decoded.encodeTime =
+                std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - encodeStart)
+                    .count();
+        }
+    }
+
+    decoded.decodeTime =
+        std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    return decoded;
+}
+
+// gpu half of the image load, must run on the thread that owns the upload batcher. streamed textures start out
+// with only the levels from `firstLevel` down
+std::optional<AllocatedImage> upload_image(VulkanEngine *engine, const DecodedImage &decoded, uint32_t firstLevel = 0) {
+    if (const std::optional<MipChainView> chain = decoded.mip_chain()) {
+        return vkutil::create_image(engine, streaming::tail(*chain, firstLevel), VK_IMAGE_USAGE_SAMPLED_BIT,
+                                    decoded.name.c_str());
+    }
+    if (!decoded.pixels) {
+        // if the decode failed there is nothing to upload, the caller falls back to a default image
+        return {};
+    }
+
+    AllocatedImage newImage = vkutil::create_image(engine, decoded.pixels, decoded.extent, TEXTURE_FORMAT,
+                                                   VK_IMAGE_USAGE_SAMPLED_BIT, TEXTURE_MIPMAPPED, decoded.name.c_str());
     if (newImage.image == VK_NULL_HANDLE) {
         return {};
-    } else {
-        return newImage;
     }
+    return newImage;
 }
 
 
@@ -140,466 +376,1824 @@ VkSamplerMipmapMode extract_mipmap_mode(fastgltf::Filter filter) {
     }
 }
 
-std::optional<std::shared_ptr<LoadedGLTF>> loadGltf(VulkanEngine *engine, std::string_view filePath) {
-    spdlog::info("Loading GLTF: {}", filePath);
+// maps every external buffer the parser left on disk and points the asset at the mapping, so accessors and
+// embedded images are read in place instead of from a heap copy of each .bin. the maps must outlive the asset
+bool map_gltf_buffers(fastgltf::Asset &gltf, const std::filesystem::path &directory,
+                      std::vector<MappedFile> &mappedBuffers) {
+    for (fastgltf::Buffer &buffer: gltf.buffers) {
+        auto *uri = std::get_if<fastgltf::sources::URI>(&buffer.data);
+        if (!uri) {
+            // data URIs and the GLB chunk are read by the parser
+            continue;
+        }
+        if (!uri->uri.isLocalPath()) {
+            std::cerr << "glTF buffer is not a local file: " << uri->uri.string() << std::endl;
+            return false;
+        }
 
+        MappedFile &file = mappedBuffers.emplace_back();
+        const std::filesystem::path path = (directory / uri->uri.path()).lexically_normal();
+        if (!file.open(path) || uri->fileByteOffset + buffer.byteLength > file.size()) {
+            std::cerr << "Failed to map glTF buffer " << path << std::endl;
+            return false;
+        }
 
-    std::shared_ptr<LoadedGLTF> scene = std::make_shared<LoadedGLTF>();
-    scene->creator = engine;
-    LoadedGLTF &file = *scene;
+        fastgltf::sources::ByteView view;
+        view.bytes = fastgltf::span<const std::byte>(
+            reinterpret_cast<const std::byte *>(file.data() + uri->fileByteOffset), buffer.byteLength);
+        view.mimeType = uri->mimeType;
+        buffer.data = view;
+    }
+    return true;
+}
+
+// the file plus the external buffers and images it references, what a hot reload watches. buffers the parser
+// already read in (LoadExternalBuffers) no longer know their file and are left out
+std::vector<std::filesystem::path> gltf_source_files(const std::filesystem::path &path, const fastgltf::Asset &gltf) {
+    std::vector<std::filesystem::path> files = {path};
+    auto add = [&](const auto &data) {
+        const auto *uri = std::get_if<fastgltf::sources::URI>(&data);
+        if (uri && uri->uri.isLocalPath()) {
+            std::filesystem::path file = (path.parent_path() / uri->uri.path()).lexically_normal();
+            if (std::ranges::find(files, file) == files.end()) {
+                files.push_back(std::move(file));
+            }
+        }
+    };
+    for (const fastgltf::Buffer &buffer: gltf.buffers) {
+        add(buffer.data);
+    }
+    for (const fastgltf::Image &image: gltf.images) {
+        add(image.data);
+    }
+    return files;
+}
 
+// opens and parses a glTF/GLB file with the extensions and options the loader relies on. with `mappedBuffers`
+// external buffers are mapped into it, otherwise the parser reads each of them into memory
+std::optional<fastgltf::Asset> parse_gltf(const std::filesystem::path &path,
+                                          std::vector<MappedFile> *mappedBuffers = nullptr,
+                                          std::vector<std::filesystem::path> *sourceFiles = nullptr) {
     // Enable required extensions
     fastgltf::Parser parser{fastgltf::Extensions::KHR_materials_transmission |
-                            fastgltf::Extensions::KHR_lights_punctual | fastgltf::Extensions::KHR_materials_ior};
+                            fastgltf::Extensions::KHR_lights_punctual | fastgltf::Extensions::KHR_materials_ior |
+                            fastgltf::Extensions::KHR_mesh_quantization | fastgltf::Extensions::KHR_texture_transform |
+                            fastgltf::Extensions::EXT_meshopt_compression};
 
-    constexpr auto gltfOptions = fastgltf::Options::DontRequireValidAssetMember | fastgltf::Options::AllowDouble |
-                                 fastgltf::Options::LoadExternalBuffers;
+    const auto gltfOptions = fastgltf::Options::DontRequireValidAssetMember | fastgltf::Options::AllowDouble |
+                             (mappedBuffers ? fastgltf::Options::None : fastgltf::Options::LoadExternalBuffers);
     // fastgltf::Options::LoadExternalImages;
 
-    auto gltfFile = fastgltf::MappedGltfFile::FromPath(filePath);
+    auto finish = [&](fastgltf::Asset &&asset) -> std::optional<fastgltf::Asset> {
+        if (sourceFiles) {
+            *sourceFiles = gltf_source_files(path, asset);
+        }
+        if (mappedBuffers && !map_gltf_buffers(asset, path.parent_path(), *mappedBuffers)) {
+            return {};
+        }
+        return std::move(asset);
+    };
+
+    auto gltfFile = fastgltf::MappedGltfFile::FromPath(path);
     if (!bool(gltfFile)) {
         std::cerr << "Failed to open glTF file: " << fastgltf::getErrorMessage(gltfFile.error()) << '\n';
         throw std::runtime_error("Failed to open glTF file");
     }
 
-    fastgltf::Asset gltf;
-
-    std::filesystem::path path = filePath;
-
     auto type = fastgltf::determineGltfFileType(gltfFile.get());
     if (type == fastgltf::GltfType::glTF) {
         auto load = parser.loadGltf(gltfFile.get(), path.parent_path(), gltfOptions);
         if (load) {
-            gltf = std::move(load.get());
-        } else {
-            std::cerr << "Failed to load glTF: " << fastgltf::to_underlying(load.error()) << std::endl;
-            return {};
+            return finish(std::move(load.get()));
         }
-    } else if (type == fastgltf::GltfType::GLB) {
+        std::cerr << "Failed to load glTF: " << fastgltf::to_underlying(load.error()) << std::endl;
+        return {};
+    }
+    if (type == fastgltf::GltfType::GLB) {
         auto load = parser.loadGltfBinary(gltfFile.get(), path.parent_path(), gltfOptions);
         if (load) {
-            gltf = std::move(load.get());
-        } else {
-            std::cerr << "Failed to load glTF: " << fastgltf::to_underlying(load.error()) << std::endl;
-            throw std::runtime_error("Failed to load glTF");
+            return finish(std::move(load.get()));
         }
-    } else {
-        std::cerr << "Failed to determine glTF container" << std::endl;
+        std::cerr << "Failed to load glTF: " << fastgltf::to_underlying(load.error()) << std::endl;
         throw std::runtime_error("Failed to load glTF");
     }
 
-    // we can stimate the descriptors we will need accurately
-    std::vector<DescriptorAllocatorGrowable::PoolSizeRatio> sizes = {{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 5},
-                                                                     {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 3},
-                                                                     {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1}};
+    std::cerr << "Failed to determine glTF container" << std::endl;
+    throw std::runtime_error("Failed to load glTF");
+}
 
-    file.descriptorPool.init(engine->_device, static_cast<uint32_t>(gltf.materials.size()), sizes);
+// hash of the file itself plus every buffer it pulled in, so edits to external .bin files invalidate caches too
+uint64_t hash_gltf_content(const std::filesystem::path &path, const fastgltf::Asset &gltf) {
+    uint64_t hash = 0;
 
-    // load samplers
-    for (fastgltf::Sampler &sampler: gltf.samplers) {
+    MappedFile source;
+    if (source.open(path)) {
+        hash = hash_bytes(source.data(), source.size());
+    }
 
-        VkSamplerCreateInfo sampl = {.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO, .pNext = nullptr};
-        sampl.maxLod = VK_LOD_CLAMP_NONE;
-        sampl.minLod = 0;
-        sampl.mipLodBias = 0.0f;
+    for (const fastgltf::Buffer &buffer: gltf.buffers) {
+        if (const std::span<const uint8_t> bytes = buffer_bytes(buffer); !bytes.empty()) {
+            hash = hash_combine(hash, hash_bytes(bytes.data(), bytes.size()));
+        }
+    }
+    return hash;
+}
 
-        sampl.magFilter = extract_filter(sampler.magFilter.value_or(fastgltf::Filter::Linear));
-        sampl.minFilter = extract_filter(sampler.minFilter.value_or(fastgltf::Filter::LinearMipMapLinear));
+// hash of `length` bytes at `offset` into a buffer view. EXT_meshopt_compression views hash their whole
+// compressed stream, they cannot be read in parts
+uint64_t hash_view_range(const fastgltf::Asset &gltf, size_t viewIndex, size_t offset, size_t length) {
+    const fastgltf::BufferView &view = gltf.bufferViews[viewIndex];
+    if (const auto &compression = view.meshoptCompression) {
+        const std::span<const uint8_t> bytes = buffer_bytes(gltf.buffers[compression->bufferIndex]);
+        if (compression->byteOffset + compression->byteLength > bytes.size()) {
+            return 0;
+        }
+        return hash_combine(hash_bytes(bytes.data() + compression->byteOffset, compression->byteLength), offset);
+    }
+    const std::span<const uint8_t> bytes = buffer_bytes(gltf.buffers[view.bufferIndex]);
+    const size_t begin = view.byteOffset + offset;
+    if (begin > bytes.size()) {
+        return 0;
+    }
+    return hash_bytes(bytes.data() + begin, std::min(length, bytes.size() - begin));
+}
 
-        sampl.mipmapMode = extract_mipmap_mode(sampler.minFilter.value_or(fastgltf::Filter::LinearMipMapLinear));
+// content hash of every material, mesh and node of the asset plus its structure, see scenediff::SceneHashes. the
+// images are hashed by their texture cache key once decoded. meshes hash only the bytes their accessors read, so
+// one edited mesh in a shared .bin leaves the others alone. must run before decode_meshopt_views
+scenediff::SceneHashes hash_gltf_assets(const fastgltf::Asset &gltf) {
+    auto add = [](uint64_t &hash, auto value) { hash = hash_combine(hash, hash_bytes(&value, sizeof(value))); };
+    auto add_texture = [&](uint64_t &hash, const auto &texture) {
+        add(hash, texture.has_value());
+        if (texture.has_value()) {
+            add(hash, texture->textureIndex);
+            add(hash, texture->texCoordIndex);
+        }
+    };
+    auto hash_accessor = [&](size_t index) {
+        const fastgltf::Accessor &accessor = gltf.accessors[index];
+        uint64_t hash = 0;
+        add(hash, accessor.count);
+        add(hash, accessor.type);
+        add(hash, accessor.componentType);
+        add(hash, accessor.normalized);
+        add(hash, accessor.byteOffset);
+        if (accessor.bufferViewIndex.has_value() && accessor.count > 0) {
+            const size_t elementSize = fastgltf::getElementByteSize(accessor.type, accessor.componentType);
+            const size_t stride = gltf.bufferViews[*accessor.bufferViewIndex].byteStride.value_or(elementSize);
+            add(hash, hash_view_range(gltf, *accessor.bufferViewIndex, accessor.byteOffset,
+                                      (accessor.count - 1) * stride + elementSize));
+        }
+        if (accessor.sparse.has_value()) {
+            const fastgltf::SparseAccessor &sparse = *accessor.sparse;
+            add(hash, sparse.count);
+            add(hash, hash_view_range(gltf, sparse.indicesBufferView, sparse.indicesByteOffset,
+                                      std::numeric_limits<size_t>::max()));
+            add(hash, hash_view_range(gltf, sparse.valuesBufferView, sparse.valuesByteOffset,
+                                      std::numeric_limits<size_t>::max()));
+        }
+        return hash;
+    };
+
+    scenediff::SceneHashes hashes;
+    hashes.images.resize(gltf.images.size(), 0);
+
+    // what cannot be patched: the asset counts, which image and sampler every texture uses, the samplers and the
+    // node hierarchy
+    add(hashes.structure, gltf.images.size());
+    add(hashes.structure, gltf.textures.size());
+    add(hashes.structure, gltf.samplers.size());
+    add(hashes.structure, gltf.materials.size());
+    add(hashes.structure, gltf.meshes.size());
+    add(hashes.structure, gltf.nodes.size());
+    for (const fastgltf::Texture &texture: gltf.textures) {
+        add(hashes.structure, texture.imageIndex.value_or(~size_t{0}));
+        add(hashes.structure, texture.samplerIndex.value_or(~size_t{0}));
+    }
+    for (const fastgltf::Sampler &sampler: gltf.samplers) {
+        add(hashes.structure, sampler.magFilter.value_or(fastgltf::Filter::Linear));
+        add(hashes.structure, sampler.minFilter.value_or(fastgltf::Filter::LinearMipMapLinear));
+        add(hashes.structure, sampler.wrapS);
+        add(hashes.structure, sampler.wrapT);
+    }
+    for (const fastgltf::Node &node: gltf.nodes) {
+        add(hashes.structure, node.meshIndex.value_or(~size_t{0}));
+        add(hashes.structure, node.children.size());
+        for (const size_t child: node.children) {
+            add(hashes.structure, child);
+        }
+    }
 
-        // Enable anisotropic filtering for better texture quality
-        sampl.anisotropyEnable = VK_TRUE;
-        sampl.maxAnisotropy = 16.0f;
+    // everything upload_material reads
+    for (const fastgltf::Material &mat: gltf.materials) {
+        uint64_t hash = 0;
+        for (int c = 0; c < 4; c++) {
+            add(hash, mat.pbrData.baseColorFactor[c]);
+        }
+        add(hash, mat.pbrData.metallicFactor);
+        add(hash, mat.pbrData.roughnessFactor);
+        add_texture(hash, mat.pbrData.baseColorTexture);
+        add_texture(hash, mat.pbrData.metallicRoughnessTexture);
+        add_texture(hash, mat.normalTexture);
+        add_texture(hash, mat.emissiveTexture);
+        for (int c = 0; c < 3; c++) {
+            add(hash, mat.emissiveFactor[c]);
+        }
+        add(hash, mat.alphaMode);
+        // the cutoff also filters the coverage of the base color mips, the image hashes carry that part
+        add(hash, mat.alphaCutoff);
+        // drives the meshlet cull flags of the surfaces using the material
+        add(hash, mat.doubleSided);
+        add(hash, mat.ior);
+        add(hash, mat.transmission != nullptr);
+        if (mat.transmission) {
+            add(hash, mat.transmission->transmissionFactor);
+            add_texture(hash, mat.transmission->transmissionTexture);
+        }
+        hashes.materials.push_back(hash);
 
-        VkSampler newSampler;
-        vkCreateSampler(engine->_device, &sampl, nullptr, &newSampler);
+        // images the material samples, a changed one means rewriting its set
+        std::vector<uint32_t> &images = hashes.materialImages.emplace_back();
+        auto add_image = [&](const auto &texture) {
+            if (texture.has_value() && gltf.textures[texture->textureIndex].imageIndex.has_value()) {
+                images.push_back(static_cast<uint32_t>(*gltf.textures[texture->textureIndex].imageIndex));
+            }
+        };
+        add_image(mat.pbrData.baseColorTexture);
+        add_image(mat.pbrData.metallicRoughnessTexture);
+        add_image(mat.normalTexture);
+        add_image(mat.emissiveTexture);
+        if (mat.transmission) {
+            add_image(mat.transmission->transmissionTexture);
+        }
+    }
 
-        file.samplers.push_back(newSampler);
+    // everything process_mesh_geometry reads, including the base color transform it bakes into the uvs
+    for (const fastgltf::Mesh &mesh: gltf.meshes) {
+        uint64_t hash = hash_bytes(mesh.name.data(), mesh.name.size());
+        for (const fastgltf::Primitive &p: mesh.primitives) {
+            add(hash, p.type);
+            add(hash, p.materialIndex.value_or(~size_t{0}));
+            if (p.indicesAccessor.has_value()) {
+                add(hash, hash_accessor(*p.indicesAccessor));
+            }
+            for (const auto &[name, accessor]: p.attributes) {
+                add(hash, hash_bytes(name.data(), name.size()));
+                add(hash, hash_accessor(accessor));
+            }
+            if (p.materialIndex.has_value()) {
+                const auto &baseColor = gltf.materials[*p.materialIndex].pbrData.baseColorTexture;
+                if (baseColor.has_value() && baseColor->transform) {
+                    add(hash, baseColor->transform->rotation);
+                    for (int c = 0; c < 2; c++) {
+                        add(hash, baseColor->transform->uvScale[c]);
+                        add(hash, baseColor->transform->uvOffset[c]);
+                    }
+                }
+            }
+        }
+        hashes.meshes.push_back(hash);
     }
 
-    // temporal arrays for all the objects to use while creating the GLTF data
-    std::vector<std::shared_ptr<MeshAsset>> meshes;
-    std::vector<std::shared_ptr<Node>> nodes;
-    std::vector<AllocatedImage> images;
-    std::vector<std::shared_ptr<GLTFMaterial>> materials;
+    for (const fastgltf::Node &node: gltf.nodes) {
+        uint64_t hash = 0;
+        std::visit(fastgltf::visitor{[&](const fastgltf::math::fmat4x4 &matrix) {
+                                         add(hash, hash_bytes(matrix.data(), 16 * sizeof(*matrix.data())));
+                                     },
+                                     [&](const fastgltf::TRS &transform) {
+                                         for (int c = 0; c < 3; c++) {
+                                             add(hash, transform.translation[c]);
+                                             add(hash, transform.scale[c]);
+                                         }
+                                         for (int c = 0; c < 4; c++) {
+                                             add(hash, transform.rotation[c]);
+                                         }
+                                     }},
+                   node.transform);
+        hashes.nodes.push_back(hash);
+    }
+    return hashes;
+}
 
-    // load all textures
-    for (fastgltf::Image &image: gltf.images) {
-        std::string baseDir = (path.parent_path() / "").string();
-        std::optional<AllocatedImage> img = load_image(engine, gltf, image, baseDir);
+// the node's matrix, or its translation, rotation and scale combined into one
+glm::mat4 node_local_transform(const fastgltf::Node &node) {
+    glm::mat4 local{1.f};
+    std::visit(fastgltf::visitor{
+                   [&](const fastgltf::math::fmat4x4 &matrix) { local = glm::make_mat4(matrix.data()); },
+                   [&](const fastgltf::TRS &transform) {
+                       glm::vec3 tl(transform.translation[0], transform.translation[1], transform.translation[2]);
+                       glm::quat rot(transform.rotation[3], transform.rotation[0], transform.rotation[1],
+                                     transform.rotation[2]);
+                       glm::vec3 sc(transform.scale[0], transform.scale[1], transform.scale[2]);
+
+                       glm::mat4 tm = glm::translate(glm::mat4(1.f), tl);
+                       glm::mat4 rm = glm::toMat4(rot);
+                       glm::mat4 sm = glm::scale(glm::mat4(1.f), sc);
+
+                       local = tm * rm * sm;
+                   }},
+               node.transform);
+    return local;
+}
 
-        if (img.has_value()) {
-            images.push_back(*img);
-            image.name = std::to_string(images.size() - 1);
-            file.images[image.name.c_str()] = *img;
+// drops a scene's reference to a cached texture, the last scene using it destroys it
+void release_texture(VulkanEngine *engine, uint64_t key) {
+    if (std::optional<AllocatedImage> image = engine->textureCache.release(key)) {
+        engine->textureStreamer.remove(key);
+        vkutil::destroy_image(engine, *image);
+    }
+}
 
-        } else {
-            // we failed to load, so lets give the slot a default white texture to not
-            // completely break loading
-            images.push_back(engine->_resourceManager.getErrorCheckerboardImage());
-            std::cout << "gltf failed to load texture " << image.name << std::endl;
-        }
+// hands a material's streamed textures to the streamer, which swaps between its set and a spare one
+void bind_streamed_textures(VulkanEngine *engine, MaterialInstance &material,
+                            std::span<const std::pair<uint32_t, uint64_t>> bindings,
+                            DescriptorAllocatorGrowable &descriptorPool) {
+    if (bindings.empty()) {
+        return;
+    }
+    if (material.spareSet == VK_NULL_HANDLE) {
+        material.spareSet = descriptorPool.allocate(engine->_device, engine->metalRoughMaterial.materialLayout);
     }
+    for (const auto &[binding, key]: bindings) {
+        engine->textureStreamer.bind(&material, binding, key);
+    }
+}
 
+std::optional<meshoptdecode::Mode> meshopt_mode(fastgltf::MeshoptCompressionMode mode) {
+    switch (mode) {
+        case fastgltf::MeshoptCompressionMode::Attributes:
+            return meshoptdecode::Mode::Attributes;
+        case fastgltf::MeshoptCompressionMode::Triangles:
+            return meshoptdecode::Mode::Triangles;
+        case fastgltf::MeshoptCompressionMode::Indices:
+            return meshoptdecode::Mode::Indices;
+        default:
+            return {};
+    }
+}
 
-    // create buffer to hold the material data
-    file.materialDataBuffer = vkutil::create_buffer(
-        engine, sizeof(GLTFMetallic_Roughness::MaterialConstants) * gltf.materials.size(),
-        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU, "GLTF Material Data Buffer");
-    int data_index = 0;
-    auto *sceneMaterialConstants =
-        static_cast<GLTFMetallic_Roughness::MaterialConstants *>(file.materialDataBuffer.info.pMappedData);
+meshoptdecode::Filter meshopt_filter(fastgltf::MeshoptCompressionFilter filter) {
+    switch (filter) {
+        case fastgltf::MeshoptCompressionFilter::Octahedral:
+            return meshoptdecode::Filter::Octahedral;
+        case fastgltf::MeshoptCompressionFilter::Quaternion:
+            return meshoptdecode::Filter::Quaternion;
+        case fastgltf::MeshoptCompressionFilter::Exponential:
+            return meshoptdecode::Filter::Exponential;
+        default:
+            return meshoptdecode::Filter::None;
+    }
+}
 
-    for (fastgltf::Material &mat: gltf.materials) {
-        std::shared_ptr<GLTFMaterial> newMat = std::make_shared<GLTFMaterial>();
-        materials.push_back(newMat);
-        file.materials[mat.name.c_str()] = newMat;
-
-        GLTFMetallic_Roughness::MaterialConstants constants{};
-        constants.colorFactors.x = mat.pbrData.baseColorFactor[0];
-        constants.colorFactors.y = mat.pbrData.baseColorFactor[1];
-        constants.colorFactors.z = mat.pbrData.baseColorFactor[2];
-        constants.colorFactors.w = mat.pbrData.baseColorFactor[3];
-
-        constants.metal_rough_factors.x = mat.pbrData.metallicFactor;
-        constants.metal_rough_factors.y = mat.pbrData.roughnessFactor;
-
-        constants.hasMetalRoughTex = mat.pbrData.metallicRoughnessTexture.has_value();
-
-        // Handle transmission properties
-        constants.transmissionFactor = mat.transmission ? mat.transmission->transmissionFactor : 0.0f;
-        constants.hasTransmissionTex = mat.transmission && mat.transmission->transmissionTexture.has_value();
-
-        // Handle IOR (Index of Refraction)
-        constants.ior = mat.ior;
-
-        // Handle emissive properties
-        constants.emissiveFactor = glm::vec4(mat.emissiveFactor[0], mat.emissiveFactor[1], mat.emissiveFactor[2], 1.0f);
-        constants.hasEmissiveTex = false; // Will be set to true only if texture is successfully loaded
-
-        // Material constants will be written after texture loading
-
-        MaterialPass passType = MaterialPass::MainColor;
-        if (mat.alphaMode == fastgltf::AlphaMode::Blend || constants.transmissionFactor > 0.0f) {
-            passType = MaterialPass::Transparent;
-        }
-
-        GLTFMetallic_Roughness::MaterialResources materialResources{};
-        // default the material textures
-        materialResources.colorImage = engine->_resourceManager.getWhiteImage();
-        materialResources.colorSampler = engine->_resourceManager.getLinearSampler();
-        materialResources.metalRoughImage = engine->_resourceManager.getWhiteImage();
-        materialResources.metalRoughSampler = engine->_resourceManager.getLinearSampler();
-        materialResources.normalImage = engine->_resourceManager.getGreyImage();
-        materialResources.normalSampler = engine->_resourceManager.getLinearSampler();
-        materialResources.transmissionImage = engine->_resourceManager.getWhiteImage();
-        materialResources.transmissionSampler = engine->_resourceManager.getLinearSampler();
-        materialResources.emissiveImage = engine->_resourceManager.getBlackImage();
-        materialResources.emissiveSampler = engine->_resourceManager.getLinearSampler();
-
-        // For RT
-        materialResources.albedo = glm::vec4(mat.pbrData.baseColorFactor[0], mat.pbrData.baseColorFactor[1],
-                                             mat.pbrData.baseColorFactor[2], mat.pbrData.baseColorFactor[3]);
-        materialResources.albedoTexIndex = data_index;
-        materialResources.metalRoughFactors = constants.metal_rough_factors;
-        materialResources.transmissionFactor = constants.transmissionFactor;
-        materialResources.ior = constants.ior;
-        materialResources.emissiveFactor = constants.emissiveFactor;
-        materialResources.emissiveTexIndex = data_index;
-
-        // set the uniform buffer for the material data
-        materialResources.dataBuffer = file.materialDataBuffer.buffer;
-        materialResources.dataBufferOffset = data_index * sizeof(GLTFMetallic_Roughness::MaterialConstants);
-        // grab textures from gltf file
-        // albedo
-        if (mat.pbrData.baseColorTexture.has_value()) {
-            const auto &baseColorTexture = gltf.textures[mat.pbrData.baseColorTexture.value().textureIndex];
-            if (baseColorTexture.imageIndex.has_value()) {
-                size_t img = baseColorTexture.imageIndex.value();
-                materialResources.colorImage = images[img];
-                materialResources.colorTexIndex = static_cast<uint32_t>(img);
-
-                if (baseColorTexture.samplerIndex.has_value()) {
-                    size_t sampler = baseColorTexture.samplerIndex.value();
-                    materialResources.colorSampler = file.samplers[sampler];
-                } else {
-                    materialResources.colorSampler = engine->_resourceManager.getLinearSampler();
-                }
+// decodes every EXT_meshopt_compression buffer view on the job system into `storage` and repoints the views at
+// it, so the accessor walk reads them like any other view. the fallback buffers the extension declares for
+// readers without it are never loaded. `storage` must outlive the asset
+bool decode_meshopt_views(fastgltf::Asset &gltf, JobSystem *jobs, std::vector<std::byte> &storage,
+                          GLTFLoadStats &stats) {
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    struct CompressedView {
+        size_t view;
+        size_t offset;
+        size_t size;
+    };
+    std::vector<CompressedView> views;
+    size_t decodedSize = 0;
+    for (size_t i = 0; i < gltf.bufferViews.size(); i++) {
+        if (const auto &compression = gltf.bufferViews[i].meshoptCompression) {
+            const size_t size = compression->count * compression->byteStride;
+            views.push_back({i, decodedSize, size});
+            // keeps every view 4 byte aligned for the accessors
+            decodedSize += (size + 3) & ~size_t{3};
+        }
+    }
+    if (views.empty()) {
+        return true;
+    }
+    storage.resize(decodedSize);
+
+    std::atomic<bool> failed{false};
+    auto decode = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const fastgltf::CompressedBufferView &compression = *gltf.bufferViews[views[i].view].meshoptCompression;
+            const std::span<const uint8_t> buffer = buffer_bytes(gltf.buffers[compression.bufferIndex]);
+            const std::optional<meshoptdecode::Mode> mode = meshopt_mode(compression.mode);
+            if (!mode || compression.byteOffset + compression.byteLength > buffer.size()) {
+                failed.store(true);
+                continue;
+            }
+            const std::span<const std::byte> in =
+                std::as_bytes(buffer.subspan(compression.byteOffset, compression.byteLength));
+            const std::span<std::byte> out(storage.data() + views[i].offset, views[i].size);
+            if (!meshoptdecode::decode(*mode, meshopt_filter(compression.filter), out, compression.count,
+                                       compression.byteStride, in)) {
+                failed.store(true);
             }
         }
-        // metallic roughness
-        if (mat.pbrData.metallicRoughnessTexture.has_value()) {
-            const auto &metallicRoughnessTexture =
-                gltf.textures[mat.pbrData.metallicRoughnessTexture.value().textureIndex];
-            if (metallicRoughnessTexture.imageIndex.has_value()) {
-                size_t img = metallicRoughnessTexture.imageIndex.value();
-                materialResources.metalRoughImage = images[img];
+    };
+    if (jobs) {
+        jobs->parallel_for(views.size(), 1, decode);
+    } else {
+        decode(0, views.size());
+    }
+    if (failed.load()) {
+        std::cerr << "Failed to decode EXT_meshopt_compression buffer views" << std::endl;
+        return false;
+    }
 
-                if (metallicRoughnessTexture.samplerIndex.has_value()) {
-                    size_t sampler = metallicRoughnessTexture.samplerIndex.value();
-                    materialResources.metalRoughSampler = file.samplers[sampler];
-                } else {
-                    materialResources.metalRoughSampler = engine->_resourceManager.getLinearSampler();
-                }
+    fastgltf::sources::ByteView bytes;
+    bytes.bytes = fastgltf::span<const std::byte>(storage.data(), storage.size());
+    bytes.mimeType = fastgltf::MimeType::GltfBuffer;
+    fastgltf::Buffer &decoded = gltf.buffers.emplace_back();
+    decoded.byteLength = storage.size();
+    decoded.data = bytes;
+
+    for (const CompressedView &view: views) {
+        fastgltf::BufferView &bufferView = gltf.bufferViews[view.view];
+        stats.compressedViewBytes += bufferView.meshoptCompression->byteLength;
+        stats.decodedViewBytes += view.size;
+        bufferView.bufferIndex = gltf.buffers.size() - 1;
+        bufferView.byteOffset = view.offset;
+        bufferView.byteLength = view.size;
+        bufferView.meshoptCompression.reset();
+    }
+    stats.compressedViews += static_cast<uint32_t>(views.size());
+    stats.meshoptDecodeTime +=
+        std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    return true;
+}
+
+// vertex/index range one primitive occupies inside its mesh, the tangent stage works on these
+struct PrimitiveRange {
+    size_t firstVertex;
+    size_t vertexCount;
+    size_t firstIndex;
+    size_t indexCount;
+    bool hasTangents;
+};
+
+// cpu side of the mesh load: walks the accessors of every primitive and builds the final vertex/index
+// streams, surface ranges and bounds. touches no gpu state so the result can go straight into the mesh cache
+MeshGeometry process_mesh_geometry(fastgltf::Asset &gltf, fastgltf::Mesh &mesh, JobSystem *jobs, bool optimize,
+                                   bool generateLods, bool weld, float weldEpsilon) {
+    MeshGeometry geometry;
+    geometry.name = mesh.name;
+
+    std::vector<uint32_t> &indices = geometry.indices;
+    std::vector<Vertex> &vertices = geometry.vertices;
+
+    // tangent.w of every vertex, only needed until the bitangents are built
+    std::vector<float> handedness;
+    std::vector<PrimitiveRange> ranges;
+    ranges.reserve(mesh.primitives.size());
+
+    for (auto &&p: mesh.primitives) {
+        SurfaceGeometry newSurface;
+        newSurface.startIndex = (uint32_t) indices.size();
+
+        size_t initial_vtx = vertices.size();
+
+        // load indexes, unindexed primitives draw their vertices in order and the weld stage shares them
+        if (p.indicesAccessor.has_value()) {
+            fastgltf::Accessor &indexaccessor = gltf.accessors[p.indicesAccessor.value()];
+            indices.reserve(indices.size() + indexaccessor.count);
+
+            fastgltf::iterateAccessor<std::uint32_t>(gltf, indexaccessor, [&](std::uint32_t idx) {
+                indices.push_back(idx + static_cast<uint32_t>(initial_vtx));
+            });
+        } else {
+            const size_t vertexCount = gltf.accessors[p.findAttribute("POSITION")->second].count;
+            for (size_t v = 0; v < vertexCount; v++) {
+                indices.push_back(static_cast<uint32_t>(initial_vtx + v));
             }
         }
-        // normal
-        if (mat.normalTexture.has_value()) {
-            const auto &normalTexture = gltf.textures[mat.normalTexture.value().textureIndex];
-            if (normalTexture.imageIndex.has_value()) {
-                size_t img = normalTexture.imageIndex.value();
-                materialResources.normalImage = images[img];
+        newSurface.count = static_cast<uint32_t>(indices.size() - newSurface.startIndex);
+
+        // load vertex positions, the bounds are gathered in the same pass
+        glm::vec3 minpos{std::numeric_limits<float>::max()};
+        glm::vec3 maxpos{std::numeric_limits<float>::lowest()};
+        {
+            fastgltf::Accessor &posAccessor = gltf.accessors[p.findAttribute("POSITION")->second];
+            vertices.resize(vertices.size() + posAccessor.count);
+            handedness.resize(vertices.size(), 1.f);
+
+            fastgltf::iterateAccessorWithIndex<glm::vec3>(gltf, posAccessor, [&](glm::vec3 v, size_t index) {
+                Vertex newvtx{};
+                newvtx.position = v;
+                newvtx.normal = {1, 0, 0};
+                newvtx.color = glm::vec4{1.f};
+                newvtx.uv_x = 0;
+                newvtx.uv_y = 0;
+                vertices[initial_vtx + index] = newvtx;
+                minpos = glm::min(minpos, v);
+                maxpos = glm::max(maxpos, v);
+            });
+        }
 
-                if (normalTexture.samplerIndex.has_value()) {
-                    size_t sampler = normalTexture.samplerIndex.value();
-                    materialResources.normalSampler = file.samplers[sampler];
-                } else {
-                    materialResources.normalSampler = engine->_resourceManager.getLinearSampler();
+        // load tangents
+        auto tangents = p.findAttribute("TANGENT");
+        if (tangents != p.attributes.end()) {
+            fastgltf::iterateAccessorWithIndex<glm::vec4>(gltf, gltf.accessors[(*tangents).second],
+                                                          [&](glm::vec4 v, size_t index) {
+                                                              vertices[initial_vtx + index].tangent = glm::vec3(v);
+                                                              handedness[initial_vtx + index] = v.w < 0.f ? -1.f : 1.f;
+                                                          });
+        }
+
+        // load vertex normals
+        auto normals = p.findAttribute("NORMAL");
+        if (normals != p.attributes.end()) {
+
+            fastgltf::iterateAccessorWithIndex<glm::vec3>(
+                gltf, gltf.accessors[(*normals).second],
+                [&](glm::vec3 v, size_t index) { vertices[initial_vtx + index].normal = v; });
+        }
+
+        // load UVs
+        auto uv = p.findAttribute("TEXCOORD_0");
+        if (uv != p.attributes.end()) {
+
+            fastgltf::iterateAccessorWithIndex<glm::vec2>(gltf, gltf.accessors[(*uv).second],
+                                                          [&](glm::vec2 v, size_t index) {
+                                                              vertices[initial_vtx + index].uv_x = v.x;
+                                                              vertices[initial_vtx + index].uv_y = v.y;
+                                                          });
+
+            // quantized texcoords come with a KHR_texture_transform that maps them back onto the texture. the
+            // shaders apply none, so the base color transform is baked into the uvs, quantizers give every
+            // texture of a material the same one
+            if (p.materialIndex.has_value()) {
+                const auto &baseColor = gltf.materials[p.materialIndex.value()].pbrData.baseColorTexture;
+                if (baseColor.has_value() && baseColor->transform) {
+                    const fastgltf::TextureTransform &transform = *baseColor->transform;
+                    const float c = std::cos(static_cast<float>(transform.rotation));
+                    const float s = std::sin(static_cast<float>(transform.rotation));
+                    const float scaleU = static_cast<float>(transform.uvScale[0]);
+                    const float scaleV = static_cast<float>(transform.uvScale[1]);
+                    for (size_t v = initial_vtx; v < vertices.size(); v++) {
+                        const float u0 = vertices[v].uv_x * scaleU;
+                        const float v0 = vertices[v].uv_y * scaleV;
+                        vertices[v].uv_x = c * u0 + s * v0 + static_cast<float>(transform.uvOffset[0]);
+                        vertices[v].uv_y = -s * u0 + c * v0 + static_cast<float>(transform.uvOffset[1]);
+                    }
                 }
             }
         }
-        // transmission
-        if (mat.transmission && mat.transmission->transmissionTexture.has_value()) {
-            const auto &transmissionTexture = gltf.textures[mat.transmission->transmissionTexture.value().textureIndex];
-            if (transmissionTexture.imageIndex.has_value()) {
-                size_t img = transmissionTexture.imageIndex.value();
-                materialResources.transmissionImage = images[img];
 
-                if (transmissionTexture.samplerIndex.has_value()) {
-                    size_t sampler = transmissionTexture.samplerIndex.value();
-                    materialResources.transmissionSampler = file.samplers[sampler];
-                } else {
-                    materialResources.transmissionSampler = engine->_resourceManager.getLinearSampler();
-                }
+        // load vertex colors
+        if (auto colors = p.findAttribute("COLOR_0"); colors != p.attributes.end()) {
+
+            fastgltf::iterateAccessorWithIndex<glm::vec4>(
+                gltf, gltf.accessors[(*colors).second],
+                [&](glm::vec4 v, size_t index) { vertices[initial_vtx + index].color = v; });
+        }
+
+        if (p.materialIndex.has_value()) {
+            newSurface.materialIndex = static_cast<uint32_t>(p.materialIndex.value());
+        } else {
+            newSurface.materialIndex = 0;
+        }
+
+        // calculate origin and extents from the min/max, use extent length for radius
+        newSurface.bounds.origin = (maxpos + minpos) / 2.f;
+        newSurface.bounds.extents = (maxpos - minpos) / 2.f;
+        newSurface.bounds.sphereRadius = glm::length(newSurface.bounds.extents);
+
+        geometry.surfaces.push_back(newSurface);
+        ranges.push_back(PrimitiveRange{initial_vtx, vertices.size() - initial_vtx, newSurface.startIndex,
+                                        newSurface.count, tangents != p.attributes.end()});
+    }
+
+    // exact (or within weldEpsilon) duplicates of every primitive merged in parallel, then the ranges are
+    // compacted so the mesh's vertices stay contiguous
+    geometry.sourceVertexCount = static_cast<uint32_t>(vertices.size());
+    if (weld) {
+        std::vector<size_t> weldedCounts(ranges.size());
+        auto weld_stage = [&](size_t begin, size_t end) {
+            for (size_t r = begin; r < end; r++) {
+                const PrimitiveRange &range = ranges[r];
+                weldedCounts[r] = vertexweld::weld(
+                    std::span<Vertex>(vertices.data() + range.firstVertex, range.vertexCount),
+                    std::span<float>(handedness.data() + range.firstVertex, range.vertexCount),
+                    std::span<uint32_t>(indices.data() + range.firstIndex, range.indexCount),
+                    static_cast<uint32_t>(range.firstVertex), weldEpsilon);
             }
+        };
+        if (jobs) {
+            jobs->parallel_for(ranges.size(), 1, weld_stage);
+        } else {
+            weld_stage(0, ranges.size());
         }
-        // emissive
-        if (mat.emissiveTexture.has_value()) {
-            const auto &emissiveTexture = gltf.textures[mat.emissiveTexture.value().textureIndex];
-            if (emissiveTexture.imageIndex.has_value()) {
-                size_t img = emissiveTexture.imageIndex.value();
-                materialResources.emissiveImage = images[img];
-                constants.hasEmissiveTex = true; // Set flag only when texture is successfully loaded
 
-                if (emissiveTexture.samplerIndex.has_value()) {
-                    size_t sampler = emissiveTexture.samplerIndex.value();
-                    materialResources.emissiveSampler = file.samplers[sampler];
-                } else {
-                    // Use default linear sampler if no sampler specified
-                    materialResources.emissiveSampler = engine->_resourceManager.getLinearSampler();
+        size_t kept = 0;
+        for (size_t r = 0; r < ranges.size(); r++) {
+            PrimitiveRange &range = ranges[r];
+            if (kept != range.firstVertex) {
+                std::copy_n(vertices.begin() + range.firstVertex, weldedCounts[r], vertices.begin() + kept);
+                std::copy_n(handedness.begin() + range.firstVertex, weldedCounts[r], handedness.begin() + kept);
+                const auto shift = static_cast<uint32_t>(range.firstVertex - kept);
+                for (uint32_t &index: std::span(indices.data() + range.firstIndex, range.indexCount)) {
+                    index -= shift;
                 }
             }
+            range.firstVertex = kept;
+            range.vertexCount = weldedCounts[r];
+            kept += weldedCounts[r];
         }
+        vertices.resize(kept);
+        handedness.resize(kept);
+    }
+
+    // tangent frames, once per primitive over its own vertex range. ranges don't overlap so primitives
+    // run in parallel, generating tangents from the UVs where the asset has none. the vertex cache / overdraw
+    // pass reorders the same ranges afterwards, once the handedness no longer has to line up with the vertices,
+    // and the final order is split into meshlets and simplified into the LOD chain
+    std::vector<std::vector<Meshlet>> rangeMeshlets(ranges.size());
+    std::vector<std::vector<simplify::LodLevel>> rangeLods(ranges.size());
+    auto tangent_stage = [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; r++) {
+            const PrimitiveRange &range = ranges[r];
+            const std::span<Vertex> rangeVertices(vertices.data() + range.firstVertex, range.vertexCount);
+            const std::span<float> rangeHandedness(handedness.data() + range.firstVertex, range.vertexCount);
+
+            if (!range.hasTangents) {
+                const std::span<const uint32_t> rangeIndices(indices.data() + range.firstIndex, range.indexCount);
+                tangentspace::generate_tangents(rangeVertices, rangeIndices, static_cast<uint32_t>(range.firstVertex),
+                                                rangeHandedness);
+            }
+            tangentspace::orthonormalize_frames(rangeVertices, rangeHandedness);
 
-        // Update the constants after texture loading
-        sceneMaterialConstants[data_index] = constants;
+            if (optimize) {
+                const std::span<uint32_t> rangeIndices(indices.data() + range.firstIndex, range.indexCount);
+                meshoptimize::optimize_surface(rangeIndices, rangeVertices, static_cast<uint32_t>(range.firstVertex));
+            }
 
-        // build material
-        newMat->data = engine->metalRoughMaterial.write_material(engine, engine->_device, passType, materialResources,
-                                                                 file.descriptorPool);
+            const std::span<const uint32_t> rangeIndices(indices.data() + range.firstIndex, range.indexCount);
+            meshlets::build_meshlets(rangeIndices, rangeVertices, static_cast<uint32_t>(range.firstVertex),
+                                     rangeMeshlets[r]);
+            if (generateLods) {
+                rangeLods[r] =
+                    simplify::build_lods(rangeIndices, rangeVertices, static_cast<uint32_t>(range.firstVertex));
+            }
+        }
+    };
 
-        data_index++;
+    if (jobs) {
+        jobs->parallel_for(ranges.size(), 1, tangent_stage);
+    } else {
+        tangent_stage(0, ranges.size());
     }
 
-    // use the same vectors for all meshes so that the memory doesnt reallocate as
-    // often
-    std::vector<uint32_t> indices;
-    std::vector<Vertex> vertices;
+    // surfaces and ranges were pushed together, so they line up. LOD indices go after every full detail range
+    for (size_t r = 0; r < ranges.size(); r++) {
+        SurfaceGeometry &surface = geometry.surfaces[r];
+        surface.firstMeshlet = static_cast<uint32_t>(geometry.meshlets.size());
+        surface.meshletCount = static_cast<uint32_t>(rangeMeshlets[r].size());
+        geometry.meshlets.insert(geometry.meshlets.end(), rangeMeshlets[r].begin(), rangeMeshlets[r].end());
+
+        surface.lodCount = static_cast<uint32_t>(rangeLods[r].size());
+        surface.lods = {};
+        for (size_t l = 0; l < rangeLods[r].size(); l++) {
+            const simplify::LodLevel &level = rangeLods[r][l];
+            surface.lods[l] = SurfaceLod{static_cast<uint32_t>(indices.size()),
+                                         static_cast<uint32_t>(level.indices.size()), level.error};
+            indices.insert(indices.end(), level.indices.begin(), level.indices.end());
+        }
+    }
 
-    for (fastgltf::Mesh &mesh: gltf.meshes) {
-        std::shared_ptr<MeshAsset> newmesh = std::make_shared<MeshAsset>();
-        meshes.push_back(newmesh);
-        file.meshes[mesh.name.c_str()] = newmesh;
-        newmesh->name = mesh.name;
+    return geometry;
+}
 
-        // clear the mesh arrays each mesh, we dont want to merge them by error
-        indices.clear();
-        vertices.clear();
+// processes every mesh of the asset, meshes and their primitives spread over the job system when given.
+// compressed buffer views have to be decoded first, see decode_meshopt_views
+std::vector<MeshGeometry> process_gltf_geometry(fastgltf::Asset &gltf, JobSystem *jobs, bool optimize,
+                                                bool generateLods, bool weld, float weldEpsilon) {
+    std::vector<MeshGeometry> meshes(gltf.meshes.size());
 
-        for (auto &&p: mesh.primitives) {
-            GeoSurface newSurface;
-            newSurface.startIndex = (uint32_t) indices.size();
-            newSurface.count = (uint32_t) gltf.accessors[p.indicesAccessor.value()].count;
+    auto process = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            meshes[i] = process_mesh_geometry(gltf, gltf.meshes[i], jobs, optimize, generateLods, weld, weldEpsilon);
+        }
+    };
 
-            size_t initial_vtx = vertices.size();
+    if (jobs) {
+        jobs->parallel_for(meshes.size(), 1, process);
+    } else {
+        process(0, meshes.size());
+    }
+    return meshes;
+}
 
-            // load indexes
-            {
-                fastgltf::Accessor &indexaccessor = gltf.accessors[p.indicesAccessor.value()];
-                indices.reserve(indices.size() + indexaccessor.count);
+// uploads one mesh in the requested vertex format and hooks its surfaces up to the scene materials. the spans
+// either come from a fresh accessor walk or straight from the mapped mesh cache
+std::shared_ptr<MeshAsset> create_mesh_asset(VulkanEngine *engine, std::string_view name, uint32_t meshIndex,
+                                             std::span<const SurfaceGeometry> surfaces,
+                                             std::span<const Vertex> vertices, std::span<const uint32_t> indices,
+                                             std::span<const Meshlet> meshlets,
+                                             const std::vector<std::shared_ptr<GLTFMaterial>> &materials,
+                                             VertexFormat vertexFormat, bool narrowIndices) {
+    std::shared_ptr<MeshAsset> newmesh = std::make_shared<MeshAsset>();
+    newmesh->name = name;
+
+    // every surface gets its own index block with its LODs, as narrow as its vertex range allows
+    std::vector<std::array<indexpacking::Range, simplify::MAX_LODS + 1>> surfaceRanges(surfaces.size());
+    std::vector<indexpacking::SurfaceLayout> layouts(surfaces.size());
+    uint64_t indexBytes = 0;
+    for (size_t i = 0; i < surfaces.size(); i++) {
+        const SurfaceGeometry &surface = surfaces[i];
+        surfaceRanges[i][0] = {surface.startIndex, surface.count};
+        for (uint32_t l = 0; l < surface.lodCount; l++) {
+            surfaceRanges[i][l + 1] = {surface.lods[l].startIndex, surface.lods[l].count};
+        }
+        const std::span<const indexpacking::Range> ranges(surfaceRanges[i].data(), surface.lodCount + 1);
+        layouts[i] = indexpacking::layout_surface(indices, ranges, indexBytes, narrowIndices);
+        indexBytes += layouts[i].byteSize;
+
+        GeoSurface newSurface;
+        newSurface.startIndex = indexpacking::first_index(layouts[i], ranges, 0);
+        newSurface.count = surface.count;
+        newSurface.indexType = layouts[i].indexSize == 2 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+        newSurface.vertexOffset = static_cast<int32_t>(layouts[i].baseVertex);
+        newSurface.bounds = surface.bounds;
+        newSurface.firstMeshlet = surface.firstMeshlet;
+        newSurface.meshletCount = surface.meshletCount;
+        newSurface.lodCount = surface.lodCount;
+        newSurface.lods = surface.lods;
+        for (uint32_t l = 0; l < surface.lodCount; l++) {
+            newSurface.lods[l].startIndex = indexpacking::first_index(layouts[i], ranges, l + 1);
+        }
+        newSurface.material = materials[surface.materialIndex];
+        // large, simple and solid surfaces keep their triangles on the CPU for the occlusion rasterizer
+        if (occlusion::keeps_occluder(surface.count / 3, surface.bounds.sphereRadius,
+                                      newSurface.material->alphaMasked)) {
+            auto occluder = std::make_shared<occlusion::OccluderMesh>();
+            occluder->corners.reserve(surface.count);
+            for (const uint32_t index: indices.subspan(surface.startIndex, surface.count)) {
+                occluder->corners.push_back(vertices[index].position);
+            }
+            newSurface.occluder = std::move(occluder);
+        }
+        newmesh->surfaces.push_back(newSurface);
+    }
 
-                fastgltf::iterateAccessor<std::uint32_t>(gltf, indexaccessor, [&](std::uint32_t idx) {
-                    indices.push_back(idx + static_cast<uint32_t>(initial_vtx));
-                });
+    newmesh->nbIndices = static_cast<uint32_t>(indices.size());
+    newmesh->nbVertices = static_cast<uint32_t>(vertices.size());
+    newmesh->meshIndex = meshIndex;
+
+    // packed straight into staging memory, no intermediate vector per mesh
+    newmesh->vertexFormat = vertexpacking::select_format(vertices, vertexFormat);
+    const size_t vertexBytes = vertices.size() * vertexpacking::stride(newmesh->vertexFormat);
+    newmesh->meshBuffers = engine->uploadMesh(
+        indexBytes,
+        [&](std::span<std::byte> staging) {
+            for (size_t i = 0; i < surfaces.size(); i++) {
+                indexpacking::pack_surface(indices, {surfaceRanges[i].data(), surfaces[i].lodCount + 1}, layouts[i],
+                                           staging);
             }
+        },
+        vertexBytes,
+        [&](std::span<std::byte> staging) {
+            newmesh->quantization = vertexpacking::pack_vertices(vertices, newmesh->vertexFormat, staging);
+        },
+        meshlets);
+    return newmesh;
+}
 
-            // load vertex positions
-            {
-                fastgltf::Accessor &posAccessor = gltf.accessors[p.findAttribute("POSITION")->second];
-                vertices.resize(vertices.size() + posAccessor.count);
+std::optional<uint64_t> hashGltfContent(std::string_view filePath) {
+    const std::filesystem::path path = filePath;
+    std::vector<MappedFile> mappedBuffers;
+    std::optional<fastgltf::Asset> gltf = parse_gltf(path, &mappedBuffers);
+    if (!gltf.has_value()) {
+        return {};
+    }
+    return hash_gltf_content(path, *gltf);
+}
 
-                fastgltf::iterateAccessorWithIndex<glm::vec3>(gltf, posAccessor, [&](glm::vec3 v, size_t index) {
-                    Vertex newvtx{};
-                    newvtx.position = v;
-                    newvtx.normal = {1, 0, 0};
-                    newvtx.color = glm::vec4{1.f};
-                    newvtx.uv_x = 0;
-                    newvtx.uv_y = 0;
-                    vertices[initial_vtx + index] = newvtx;
-                });
-            }
+std::optional<std::vector<MeshGeometry>> loadGltfGeometry(std::string_view filePath, JobSystem *jobs,
+                                                          bool optimize, bool generateLods, bool mapBuffers,
+                                                          bool weld, float weldEpsilon, GLTFLoadStats *stats) {
+    std::vector<MappedFile> mappedBuffers;
+    std::vector<std::byte> meshoptViews;
+    std::optional<fastgltf::Asset> gltf = parse_gltf(filePath, mapBuffers ? &mappedBuffers : nullptr);
+    GLTFLoadStats localStats;
+    if (!gltf.has_value() || !decode_meshopt_views(*gltf, jobs, meshoptViews, stats ? *stats : localStats)) {
+        return {};
+    }
+    return process_gltf_geometry(*gltf, jobs, optimize, generateLods, weld, weldEpsilon);
+}
+
+// everything a GltfLoadTask carries from the worker thread over to the render thread
+struct GltfLoadTask::State {
+    // order the render thread creates the scene's GPU objects in
+    enum class UploadStep { Setup, Images, Materials, Meshes, Nodes };
+
+    std::filesystem::path path;
+    // taken when the load was requested, the worker never reads the live settings
+    LoaderSettings settings;
+    std::chrono::high_resolution_clock::time_point start;
+
+    // external buffers the asset reads in place and its decoded EXT_meshopt_compression views, declared first
+    // so they outlive it
+    std::vector<MappedFile> mappedBuffers;
+    std::vector<std::byte> meshoptViews;
+    std::optional<fastgltf::Asset> gltf;
+    // what every image is uploaded as, RGBA8 or the BC format its material usage asks for
+    std::vector<VkFormat> imageFormats;
+    // how their CPU mip chains are filtered
+    std::vector<mipgen::MipSettings> imageMips;
+    // which of them the texture streamer may keep partly resident
+    std::vector<bool> imageStreamed;
+    std::vector<DecodedImage> decodedImages;
+
+    // geometry comes mapped from the mesh cache on a hit, freshly processed otherwise. a reload processes only the
+    // meshes that changed and leaves the other entries empty
+    MeshCache meshCache;
+    std::vector<MeshGeometry> geometry;
+
+    // content hashes of the file when LoaderSettings::hotReload is on, and for a reload what changed
+    scenediff::SceneHashes hashes;
+    scenediff::SceneDiff diff;
+
+    UploadStep step{UploadStep::Setup};
+    size_t cursor{0};
+    std::vector<AllocatedImage> images;
+    std::vector<std::shared_ptr<GLTFMaterial>> materials;
+    std::vector<std::shared_ptr<MeshAsset>> meshes;
+    GLTFMetallic_Roughness::MaterialConstants *materialConstants{nullptr};
+    uint64_t uploadBatchesBefore{0};
+
+    [[nodiscard]] ImageDecodeOptions decode_options(size_t index, const TextureCache *residentCache,
+                                                    JobSystem *jobs) const {
+        ImageDecodeOptions options;
+        options.format = imageFormats[index];
+        if (settings.cpuMipmaps) {
+            options.mips = imageMips[index];
+        } else if (blockcompress::is_block_compressed(options.format)) {
+            // the encoder needs the levels on the CPU, a plain box filter stands in for the blit
+            options.mips = mipgen::MipSettings{mipgen::MipFilter::Box, false, 0.f};
+        }
+        options.residentCache = residentCache;
+        options.compressedCacheDirectory = settings.textureCacheDirectory;
+        options.jobs = jobs;
+        return options;
+    }
 
-            // load tangents
-            auto tangents = p.findAttribute("TANGENT");
-            if (tangents != p.attributes.end()) {
-                fastgltf::iterateAccessorWithIndex<glm::vec4>(
-                    gltf, gltf.accessors[(*tangents).second],
-                    [&](glm::vec4 v, size_t index) { vertices[initial_vtx + index].tangent = v; });
+    ~State() {
+        // textures that never reached the GPU because the load failed or was abandoned
+        for (DecodedImage &decoded: decodedImages) {
+            if (decoded.pixels) {
+                stbi_image_free(decoded.pixels);
             }
+        }
+    }
+};
+
+GltfLoadTask::GltfLoadTask(VulkanEngine *engine, std::string filePath, std::shared_ptr<LoadedGLTF> reloadTarget) :
+    _engine(engine), _path(std::move(filePath)), _scene(std::make_shared<LoadedGLTF>()),
+    _target(std::move(reloadTarget)), _state(std::make_unique<State>()) {
+    _scene->creator = engine;
+    _state->path = _path;
+    _state->settings = engine->loaderSettings;
+    _scene->loadProfile.track_memory(_state->settings.writeLoadReports);
+    _state->start = std::chrono::high_resolution_clock::now();
+}
+
+GltfLoadTask::~GltfLoadTask() = default;
+
+const char *GltfLoadTask::stage_name(Stage stage) {
+    switch (stage) {
+        case Stage::Queued:
+            return "Queued";
+        case Stage::Parsing:
+            return "Parsing";
+        case Stage::Decoding:
+            return "Decoding textures";
+        case Stage::Geometry:
+            return "Processing geometry";
+        case Stage::Uploading:
+            return "Uploading";
+        case Stage::Done:
+            return "Done";
+        case Stage::Failed:
+        default:
+            return "Failed";
+    }
+}
+
+std::shared_ptr<LoadedGLTF> GltfLoadTask::scene() const {
+    return _stage.load() == Stage::Done && !_target ? _scene : nullptr;
+}
 
-            // load vertex normals
-            auto normals = p.findAttribute("NORMAL");
-            if (normals != p.attributes.end()) {
+std::shared_ptr<LoadedGLTF> GltfLoadTask::patched_scene() const {
+    return _stage.load() == Stage::Done ? _target : nullptr;
+}
+
+void GltfLoadTask::set_stage(Stage stage, size_t total) {
+    _done.store(0);
+    _total.store(static_cast<uint32_t>(total));
+    _stage.store(stage);
+}
 
-                fastgltf::iterateAccessorWithIndex<glm::vec3>(
-                    gltf, gltf.accessors[(*normals).second],
-                    [&](glm::vec3 v, size_t index) { vertices[initial_vtx + index].normal = v; });
+void GltfLoadTask::prepare() {
+    State &state = *_state;
+    GLTFLoadStats &stats = _scene->loadStats;
+    LoadProfile &profile = _scene->loadProfile;
+
+    try {
+        set_stage(Stage::Parsing, 1);
+        {
+            ScopedLoadPhase phase(profile, "parse");
+            state.gltf = parse_gltf(state.path, state.settings.mapBuffers ? &state.mappedBuffers : nullptr,
+                                    state.settings.hotReload ? &_scene->sourceFiles : nullptr);
+        }
+        if (!state.gltf.has_value()) {
+            set_stage(Stage::Failed, 0);
+            return;
+        }
+        fastgltf::Asset &gltf = *state.gltf;
+        // the file plus every buffer it references, embedded or external
+        std::error_code fileError;
+        const uintmax_t fileBytes = std::filesystem::file_size(state.path, fileError);
+        profile.add_bytes("parse", fileError ? 0 : fileBytes);
+        for (const fastgltf::Buffer &buffer: gltf.buffers) {
+            profile.add_bytes("parse", buffer.byteLength);
+        }
+        profile.set_counter("parse", "buffers", gltf.buffers.size());
+        profile.set_counter("parse", "images", gltf.images.size());
+        profile.set_counter("parse", "materials", gltf.materials.size());
+        profile.set_counter("parse", "meshes", gltf.meshes.size());
+        profile.set_counter("parse", "nodes", gltf.nodes.size());
+
+        // hashed before any compressed view is decoded, the same way on every load
+        if (state.settings.hotReload) {
+            ScopedLoadPhase phase(profile, "content_hash");
+            state.hashes = hash_gltf_assets(gltf);
+        }
+        if (_target && scenediff::diff(_target->contentHashes, state.hashes).structural) {
+            spdlog::info("{} changed its structure, loading it from scratch", _path);
+            _target.reset();
+        }
+
+        // decode all textures, spread over the job system. the pixels wait in memory for the upload stage
+        {
+            ScopedLoadPhase phase(profile, "image_decode");
+            const auto imagesStart = std::chrono::high_resolution_clock::now();
+            const std::string baseDir = (state.path.parent_path() / "").string();
+
+            set_stage(Stage::Decoding, gltf.images.size());
+            state.decodedImages.resize(gltf.images.size());
+            state.imageFormats =
+                texture_formats(gltf, state.settings.compressTextures && _engine->_textureCompressionBC);
+            state.imageMips = texture_mip_settings(gltf, state.settings.mipFilter);
+            state.imageStreamed = streamed_images(gltf);
+
+            auto decode = [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    DecodedImage decoded = decode_image(
+                        gltf, gltf.images[i], baseDir,
+                        state.decode_options(i, &_engine->textureCache, &_engine->jobSystem));
+                    decoded.index = i;
+                    // decoded RGBA8 size of the top level, whatever the texture is uploaded as
+                    const std::string_view name = gltf.images[i].name;
+                    profile.add_item("image_decode", name.empty() ? "image " + std::to_string(i) : std::string(name),
+                                     decoded.decodeTime + decoded.mipTime + decoded.encodeTime,
+                                     uint64_t{decoded.extent.width} * decoded.extent.height * 4);
+                    state.decodedImages[i] = std::move(decoded);
+                    _done.fetch_add(1);
+                }
+            };
+
+            if (state.settings.parallelImageDecode && gltf.images.size() > 1) {
+                _engine->jobSystem.parallel_for(gltf.images.size(), 1, decode);
+                stats.decodeThreads = _engine->jobSystem.thread_count();
+            } else {
+                decode(0, gltf.images.size());
+                stats.decodeThreads = 1;
+            }
+
+            for (const DecodedImage &decoded: state.decodedImages) {
+                stats.imageDecodeCpuTime += decoded.decodeTime;
+                stats.imageMipTime += decoded.mipTime;
+                stats.imageEncodeTime += decoded.encodeTime;
+                stats.textureDiskCacheHits += decoded.diskCache.is_open() ? 1 : 0;
+            }
+            stats.imageCount = static_cast<uint32_t>(gltf.images.size());
+            // images unchanged since the scene was loaded are still resident, they were only hashed. the mip
+            // settings hold the alpha cutoff of the materials sampling an image, folded in so a changed cutoff
+            // marks the image as changed even when the GPU blit builds its mips and the cache key leaves them out
+            if (state.settings.hotReload) {
+                for (size_t i = 0; i < state.decodedImages.size(); i++) {
+                    state.hashes.images[i] =
+                        hash_combine(state.decodedImages[i].cacheKey, mipgen::settings_key(state.imageMips[i]));
+                }
             }
+            if (_target) {
+                state.diff = scenediff::diff(_target->contentHashes, state.hashes);
+                spdlog::info("Reloading {}: {} images, {} materials, {} meshes and {} nodes changed", _path,
+                             state.diff.images.size(), state.diff.materials.size(), state.diff.meshes.size(),
+                             state.diff.nodes.size());
+            }
+            profile.set_counter("image_decode", "threads", stats.decodeThreads);
+            profile.set_counter("image_decode", "diskCacheHits", stats.textureDiskCacheHits);
+            stats.imageTotalTime = std::chrono::duration<float, std::milli>(
+                                       std::chrono::high_resolution_clock::now() - imagesStart)
+                                       .count();
+        }
 
-            // calculate bi-tangents from normals and tangents
-            for (auto &v: vertices) {
-                v.bitangent = glm::cross(v.normal, v.tangent);
+        // geometry, either straight from the mapped mesh cache or by walking the accessors and then
+        // writing the cache for the next load
+        {
+            ScopedLoadPhase phase(profile, "geometry");
+            const auto geometryStart = std::chrono::high_resolution_clock::now();
+            set_stage(Stage::Geometry, gltf.meshes.size());
+
+            uint64_t contentHash = 0;
+            std::filesystem::path cachePath;
+            if (state.settings.useMeshCache) {
+                // geometry processed with different settings of the same file goes into different caches
+                contentHash = hash_combine(hash_gltf_content(state.path, gltf),
+                                           (state.settings.optimizeMeshes ? 1 : 0) |
+                                               (state.settings.generateLods ? 2 : 0) |
+                                               (state.settings.weldVertices ? 4 : 0));
+                if (state.settings.weldVertices) {
+                    contentHash = hash_combine(contentHash, std::bit_cast<uint32_t>(state.settings.weldEpsilon));
+                }
+                cachePath = MeshCache::path_for(state.settings.meshCacheDirectory, contentHash);
+                stats.meshCacheHit = state.meshCache.open(cachePath, contentHash) &&
+                                     state.meshCache.mesh_count() == gltf.meshes.size();
             }
 
-            // load UVs
-            auto uv = p.findAttribute("TEXCOORD_0");
-            if (uv != p.attributes.end()) {
+            // a reload without changed meshes has no accessors to walk
+            if (!stats.meshCacheHit && (!_target || !state.diff.meshes.empty())) {
+                // compressed views are only needed by the accessor walk, a cache hit never decodes them
+                if (!decode_meshopt_views(gltf, &_engine->jobSystem, state.meshoptViews, stats)) {
+                    set_stage(Stage::Failed, 0);
+                    return;
+                }
+                if (stats.compressedViews > 0) {
+                    spdlog::info("Decoded {} meshopt compressed buffer views, {:.2f} MB to {:.2f} MB in {:.2f} ms",
+                                 stats.compressedViews,
+                                 static_cast<double>(stats.compressedViewBytes) / (1024.0 * 1024.0),
+                                 static_cast<double>(stats.decodedViewBytes) / (1024.0 * 1024.0),
+                                 stats.meshoptDecodeTime);
+                }
+                if (_target) {
+                    // only the meshes that changed, too few to write the mesh cache with
+                    const std::vector<uint32_t> &changed = state.diff.meshes;
+                    state.geometry.resize(gltf.meshes.size());
+                    _engine->jobSystem.parallel_for(changed.size(), 1, [&](size_t begin, size_t end) {
+                        for (size_t i = begin; i < end; i++) {
+                            state.geometry[changed[i]] = process_mesh_geometry(
+                                gltf, gltf.meshes[changed[i]], &_engine->jobSystem, state.settings.optimizeMeshes,
+                                state.settings.generateLods, state.settings.weldVertices,
+                                state.settings.weldEpsilon);
+                        }
+                    });
+                } else {
+                    state.geometry = process_gltf_geometry(gltf, &_engine->jobSystem, state.settings.optimizeMeshes,
+                                                           state.settings.generateLods, state.settings.weldVertices,
+                                                           state.settings.weldEpsilon);
+                }
+                for (const MeshGeometry &mesh: state.geometry) {
+                    stats.sourceVertices += mesh.sourceVertexCount;
+                    stats.weldedVertices += mesh.vertices.size();
+                }
+                if (state.settings.weldVertices) {
+                    spdlog::info("Welded {} vertices down to {}", stats.sourceVertices, stats.weldedVertices);
+                }
 
-                fastgltf::iterateAccessorWithIndex<glm::vec2>(gltf, gltf.accessors[(*uv).second],
-                                                              [&](glm::vec2 v, size_t index) {
-                                                                  vertices[initial_vtx + index].uv_x = v.x;
-                                                                  vertices[initial_vtx + index].uv_y = v.y;
-                                                              });
+                if (!_target && state.settings.useMeshCache &&
+                    MeshCache::write(cachePath, contentHash, state.geometry)) {
+                    spdlog::info("Wrote mesh cache {}", cachePath.string());
+                }
             }
+            _done.store(static_cast<uint32_t>(gltf.meshes.size()));
+            profile.set_counter("geometry", "meshCacheHit", stats.meshCacheHit ? 1 : 0);
+            profile.set_counter("geometry", "sourceVertices", stats.sourceVertices);
+            profile.set_counter("geometry", "weldedVertices", stats.weldedVertices);
+            profile.set_counter("geometry", "compressedViews", stats.compressedViews);
+            profile.add_bytes("geometry", stats.decodedViewBytes);
+
+            stats.geometryTime = std::chrono::duration<float, std::milli>(
+                                     std::chrono::high_resolution_clock::now() - geometryStart)
+                                     .count();
+        }
+
+        spdlog::info("Prepared {}: {} images decoded in {:.2f} ms ({:.2f} ms cpu on {} thread(s), {:.2f} ms mips, "
+                     "{:.2f} ms encoding, {} from the compressed texture cache), {} meshes in {:.2f} ms ({})",
+                     _path, stats.imageCount, stats.imageTotalTime, stats.imageDecodeCpuTime, stats.decodeThreads,
+                     stats.imageMipTime, stats.imageEncodeTime, stats.textureDiskCacheHits, gltf.meshes.size(),
+                     stats.geometryTime, stats.meshCacheHit ? "mesh cache hit" : "processed");
+
+        // one item per texture, material and mesh plus the node hierarchy. a reload uploads the changed textures
+        // and meshes and patches everything in one go
+        if (_target) {
+            set_stage(Stage::Uploading, state.diff.images.size() + state.diff.meshes.size() + 1);
+        } else {
+            set_stage(Stage::Uploading, gltf.images.size() + gltf.materials.size() + gltf.meshes.size() + 1);
+        }
+    } catch (const std::exception &e) {
+        spdlog::error("Error loading {}: {}", _path, e.what());
+        set_stage(Stage::Failed, 0);
+    }
+}
+
+bool GltfLoadTask::upload(float budgetMs) {
+    const Stage stage = _stage.load();
+    if (stage == Stage::Done || stage == Stage::Failed) {
+        return true;
+    }
+    if (stage != Stage::Uploading) {
+        return false;
+    }
+
+    using UploadStep = State::UploadStep;
+    const auto sliceStart = std::chrono::high_resolution_clock::now();
+    State &state = *_state;
+    fastgltf::Asset &gltf = *state.gltf;
+    _scene->loadStats.uploadFrames++;
+
+    auto next_step = [&](UploadStep step) {
+        state.step = step;
+        state.cursor = 0;
+    };
+
+    // a reload walks only the changed images and meshes, its materials and nodes are patched into the target
+    const bool reload = _target != nullptr;
+    const size_t imageCount = reload ? state.diff.images.size() : gltf.images.size();
+    const size_t meshCount = reload ? state.diff.meshes.size() : gltf.meshes.size();
+
+    // one item per iteration, so even a budget smaller than a single upload makes progress
+    do {
+        switch (state.step) {
+            case UploadStep::Setup:
+                if (reload) {
+                    setup_reload();
+                } else {
+                    setup();
+                }
+                next_step(UploadStep::Images);
+                break;
+            case UploadStep::Images:
+                if (state.cursor < imageCount) {
+                    const size_t index = state.cursor++;
+                    upload_texture(reload ? state.diff.images[index] : index);
+                    _done.fetch_add(1);
+                } else {
+                    next_step(reload ? UploadStep::Meshes : UploadStep::Materials);
+                }
+                break;
+            case UploadStep::Materials:
+                if (state.cursor < gltf.materials.size()) {
+                    upload_material(state.cursor++);
+                    _done.fetch_add(1);
+                } else {
+                    next_step(UploadStep::Meshes);
+                }
+                break;
+            case UploadStep::Meshes:
+                if (state.cursor < meshCount) {
+                    const size_t index = state.cursor++;
+                    upload_mesh(reload ? state.diff.meshes[index] : index);
+                    _done.fetch_add(1);
+                } else {
+                    next_step(UploadStep::Nodes);
+                }
+                break;
+            case UploadStep::Nodes:
+                if (reload) {
+                    patch_scene();
+                } else {
+                    finish_nodes();
+                }
+                _done.fetch_add(1);
+                _stage.store(Stage::Done);
+                return true;
+        }
+    } while (std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - sliceStart)
+                 .count() < budgetMs);
+
+    return false;
+}
 
-            // load vertex colors
-            if (auto colors = p.findAttribute("COLOR_0"); colors != p.attributes.end()) {
+void GltfLoadTask::setup() {
+    VulkanEngine *engine = _engine;
+    LoadedGLTF &file = *_scene;
+    State &state = *_state;
+    fastgltf::Asset &gltf = *state.gltf;
+    // descriptor pool, samplers and the material buffer, the materials themselves add to the same phase
+    ScopedLoadPhase phase(file.loadProfile, "material_setup");
 
-                fastgltf::iterateAccessorWithIndex<glm::vec4>(
-                    gltf, gltf.accessors[(*colors).second],
-                    [&](glm::vec4 v, size_t index) { vertices[initial_vtx + index].color = v; });
+    state.uploadBatchesBefore = engine->uploadBatcher.stats().batches;
+
+    // we can stimate the descriptors we will need accurately
+    std::vector<DescriptorAllocatorGrowable::PoolSizeRatio> sizes = {{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 5},
+                                                                     {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 3},
+                                                                     {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1}};
+
+    file.descriptorPool.init(engine->_device, static_cast<uint32_t>(gltf.materials.size()), sizes);
+
+    // load samplers
+    for (fastgltf::Sampler &sampler: gltf.samplers) {
+
+        VkSamplerCreateInfo sampl = {.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO, .pNext = nullptr};
+        sampl.maxLod = VK_LOD_CLAMP_NONE;
+        sampl.minLod = 0;
+        sampl.mipLodBias = 0.0f;
+
+        sampl.magFilter = extract_filter(sampler.magFilter.value_or(fastgltf::Filter::Linear));
+        sampl.minFilter = extract_filter(sampler.minFilter.value_or(fastgltf::Filter::LinearMipMapLinear));
+
+        sampl.mipmapMode = extract_mipmap_mode(sampler.minFilter.value_or(fastgltf::Filter::LinearMipMapLinear));
+
+        // Enable anisotropic filtering for better texture quality
+        sampl.anisotropyEnable = VK_TRUE;
+        sampl.maxAnisotropy = 16.0f;
+
+        VkSampler newSampler;
+        vkCreateSampler(engine->_device, &sampl, nullptr, &newSampler);
+
+        file.samplers.push_back(newSampler);
+    }
+
+    // failed slots keep the checkerboard so loading doesn't completely break
+    state.images.resize(gltf.images.size(), engine->_resourceManager.getErrorCheckerboardImage());
+    state.meshes.resize(gltf.meshes.size());
+
+    // create buffer to hold the material data
+    file.materialDataBuffer = vkutil::create_buffer(
+        engine, sizeof(GLTFMetallic_Roughness::MaterialConstants) * gltf.materials.size(),
+        VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU, "GLTF Material Data Buffer");
+    state.materialConstants =
+        static_cast<GLTFMetallic_Roughness::MaterialConstants *>(file.materialDataBuffer.info.pMappedData);
+}
+
+void GltfLoadTask::setup_reload() {
+    State &state = *_state;
+    const LoadedGLTF &target = *_target;
+    fastgltf::Asset &gltf = *state.gltf;
+
+    state.uploadBatchesBefore = _engine->uploadBatcher.stats().batches;
+
+    // the unchanged textures are the target's, keyed by image index since its load
+    state.images.resize(gltf.images.size(), _engine->_resourceManager.getErrorCheckerboardImage());
+    for (size_t i = 0; i < gltf.images.size(); i++) {
+        if (auto it = target.images.find(std::to_string(i)); it != target.images.end()) {
+            state.images[i] = it->second;
+        }
+    }
+    // changed meshes hook their surfaces up to the target's materials, which are rewritten in place
+    state.materials = target.indexedMaterials;
+    state.meshes.resize(gltf.meshes.size());
+}
+
+void GltfLoadTask::upload_texture(size_t index) {
+    const auto uploadStart = std::chrono::high_resolution_clock::now();
+    LoadedGLTF &file = *_scene;
+    ScopedLoadPhase phase(file.loadProfile, "texture_upload");
+    State &state = *_state;
+    DecodedImage &decoded = state.decodedImages[index];
+    fastgltf::Image &image = state.gltf->images[index];
+
+    // another scene, or an earlier image of this one, may have uploaded the same texture already
+    std::optional<AllocatedImage> img = _engine->textureCache.acquire(decoded.cacheKey);
+    if (img.has_value()) {
+        file.loadStats.textureCacheHits++;
+    } else {
+        if (decoded.cached) {
+            // released between the decode job's check and now, decode it after all
+            const std::string baseDir = (state.path.parent_path() / "").string();
+            decoded = decode_image(*state.gltf, image, baseDir,
+                                   state.decode_options(index, nullptr, &_engine->jobSystem));
+            decoded.index = index;
+        }
+        // streamed textures go up with their coarse levels only, the streamer uploads the rest once it is seen
+        uint32_t top = 0;
+        const std::optional<MipChainView> chain = decoded.mip_chain();
+        if (state.settings.streamTextures && state.imageStreamed[index] && chain.has_value()) {
+            top = _engine->textureStreamer.initial_top(*chain);
+        }
+        img = upload_image(_engine, decoded, top);
+        if (img.has_value()) {
+            _engine->textureCache.insert(decoded.cacheKey, *img,
+                                         blockcompress::image_bytes(img->imageFormat, img->imageExtent.width,
+                                                                    img->imageExtent.height, TEXTURE_MIPMAPPED));
+            if (top > 0) {
+                _engine->textureStreamer.add(
+                    decoded.cacheKey, *img,
+                    TextureStreamer::Source{std::move(decoded.chain), std::move(decoded.diskCache)}, top,
+                    decoded.name);
             }
+        }
+    }
 
-            if (p.materialIndex.has_value()) {
-                newSurface.material = materials[p.materialIndex.value()];
+    if (img.has_value()) {
+        const VkExtent3D &extent = img->imageExtent;
+        file.loadStats.textureBytes +=
+            blockcompress::image_bytes(img->imageFormat, extent.width, extent.height, TEXTURE_MIPMAPPED);
+        file.loadStats.uncompressedTextureBytes +=
+            blockcompress::image_bytes(TEXTURE_FORMAT, extent.width, extent.height, TEXTURE_MIPMAPPED);
+        file.loadStats.compressedTextures += blockcompress::is_block_compressed(img->imageFormat) ? 1 : 0;
+        file.loadProfile.add_bytes("texture_upload", blockcompress::image_bytes(img->imageFormat, extent.width,
+                                                                                extent.height, TEXTURE_MIPMAPPED));
+
+        state.images[index] = *img;
+        image.name = std::to_string(index);
+        file.images[image.name.c_str()] = *img;
+        file.textureKeys.push_back(decoded.cacheKey);
+    } else {
+        std::cout << "gltf failed to load texture " << image.name << std::endl;
+    }
+
+    if (decoded.pixels) {
+        stbi_image_free(decoded.pixels);
+        decoded.pixels = nullptr;
+    }
+    decoded.chain = {};
+    decoded.diskCache.close();
+
+    file.loadStats.imageUploadTime +=
+        std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - uploadStart).count();
+}
+
+// everything one glTF material is written as, shared by a fresh load and a hot reload patching it in place
+struct GltfLoadTask::MaterialDesc {
+    MaterialPass pass{MaterialPass::MainColor};
+    bool alphaMasked{false};
+    bool doubleSided{false};
+    GLTFMetallic_Roughness::MaterialConstants constants{};
+    GLTFMetallic_Roughness::MaterialResources resources{};
+    // streamed textures are bound at what is resident right now, the streamer follows them from then on
+    std::vector<std::pair<uint32_t, uint64_t>> streamedBindings;
+};
+
+GltfLoadTask::MaterialDesc GltfLoadTask::describe_material(size_t index, const LoadedGLTF &file) const {
+    VulkanEngine *engine = _engine;
+    const fastgltf::Asset &gltf = *_state->gltf;
+    const std::vector<AllocatedImage> &images = _state->images;
+    const auto data_index = static_cast<uint32_t>(index);
+
+    const fastgltf::Material &mat = gltf.materials[index];
+    MaterialDesc desc;
+    GLTFMetallic_Roughness::MaterialConstants &constants = desc.constants;
+    constants.colorFactors.x = mat.pbrData.baseColorFactor[0];
+    constants.colorFactors.y = mat.pbrData.baseColorFactor[1];
+    constants.colorFactors.z = mat.pbrData.baseColorFactor[2];
+    constants.colorFactors.w = mat.pbrData.baseColorFactor[3];
+
+    constants.metal_rough_factors.x = mat.pbrData.metallicFactor;
+    constants.metal_rough_factors.y = mat.pbrData.roughnessFactor;
+
+    constants.hasMetalRoughTex = mat.pbrData.metallicRoughnessTexture.has_value();
+
+    // Handle transmission properties
+    constants.transmissionFactor = mat.transmission ? mat.transmission->transmissionFactor : 0.0f;
+    constants.hasTransmissionTex = mat.transmission && mat.transmission->transmissionTexture.has_value();
+
+    // Handle IOR (Index of Refraction)
+    constants.ior = mat.ior;
+
+    // Handle emissive properties
+    constants.emissiveFactor = glm::vec4(mat.emissiveFactor[0], mat.emissiveFactor[1], mat.emissiveFactor[2], 1.0f);
+    constants.hasEmissiveTex = false; // Will be set to true only if texture is successfully loaded
+    constants.colorFeedbackSlot = -1;
+    constants.metalRoughFeedbackSlot = -1;
+    constants.normalFeedbackSlot = -1;
+
+    // Material constants will be written after texture loading
+
+    if (mat.alphaMode == fastgltf::AlphaMode::Blend || constants.transmissionFactor > 0.0f) {
+        desc.pass = MaterialPass::Transparent;
+    }
+    desc.alphaMasked = mat.alphaMode == fastgltf::AlphaMode::Mask;
+    desc.doubleSided = mat.doubleSided;
+
+    GLTFMetallic_Roughness::MaterialResources &materialResources = desc.resources;
+    // default the material textures
+    materialResources.colorImage = engine->_resourceManager.getWhiteImage();
+    materialResources.colorSampler = engine->_resourceManager.getLinearSampler();
+    materialResources.metalRoughImage = engine->_resourceManager.getWhiteImage();
+    materialResources.metalRoughSampler = engine->_resourceManager.getLinearSampler();
+    materialResources.normalImage = engine->_resourceManager.getGreyImage();
+    materialResources.normalSampler = engine->_resourceManager.getLinearSampler();
+    materialResources.transmissionImage = engine->_resourceManager.getWhiteImage();
+    materialResources.transmissionSampler = engine->_resourceManager.getLinearSampler();
+    materialResources.emissiveImage = engine->_resourceManager.getBlackImage();
+    materialResources.emissiveSampler = engine->_resourceManager.getLinearSampler();
+
+    // For RT
+    materialResources.albedo = glm::vec4(mat.pbrData.baseColorFactor[0], mat.pbrData.baseColorFactor[1],
+                                         mat.pbrData.baseColorFactor[2], mat.pbrData.baseColorFactor[3]);
+    materialResources.albedoTexIndex = data_index;
+    materialResources.metalRoughFactors = constants.metal_rough_factors;
+    materialResources.transmissionFactor = constants.transmissionFactor;
+    materialResources.ior = constants.ior;
+    materialResources.emissiveFactor = constants.emissiveFactor;
+    materialResources.emissiveTexIndex = data_index;
+
+    // set the uniform buffer for the material data
+    materialResources.dataBuffer = file.materialDataBuffer.buffer;
+    materialResources.dataBufferOffset = data_index * sizeof(GLTFMetallic_Roughness::MaterialConstants);
+
+    // streamed textures may also have been streamed by another scene sharing them through the texture cache
+    TextureStreamer &streamer = engine->textureStreamer;
+    std::vector<std::pair<uint32_t, uint64_t>> &streamedBindings = desc.streamedBindings;
+    auto texture_image = [&](size_t img, uint32_t binding, int *feedbackSlot) {
+        const uint64_t key = _state->decodedImages[img].cacheKey;
+        const std::optional<AllocatedImage> streamed = streamer.image(key);
+        if (!streamed.has_value()) {
+            return images[img];
+        }
+        streamedBindings.emplace_back(binding, key);
+        if (feedbackSlot) {
+            *feedbackSlot = streamer.feedback_slot(key);
+        }
+        return *streamed;
+    };
+
+    // grab textures from gltf file
+    // albedo
+    if (mat.pbrData.baseColorTexture.has_value()) {
+        const auto &baseColorTexture = gltf.textures[mat.pbrData.baseColorTexture.value().textureIndex];
+        if (baseColorTexture.imageIndex.has_value()) {
+            size_t img = baseColorTexture.imageIndex.value();
+            materialResources.colorImage = texture_image(img, 1, &constants.colorFeedbackSlot);
+            materialResources.colorTexIndex = static_cast<uint32_t>(img);
+
+            if (baseColorTexture.samplerIndex.has_value()) {
+                size_t sampler = baseColorTexture.samplerIndex.value();
+                materialResources.colorSampler = file.samplers[sampler];
             } else {
-                newSurface.material = materials[0];
+                materialResources.colorSampler = engine->_resourceManager.getLinearSampler();
             }
-
-            // loop the vertices of this surface, find min/max bounds
-            glm::vec3 minpos = vertices[initial_vtx].position;
-            glm::vec3 maxpos = vertices[initial_vtx].position;
-            for (int i = static_cast<int>(initial_vtx); i < static_cast<int>(vertices.size()); i++) {
-                minpos = glm::min(minpos, vertices[i].position);
-                maxpos = glm::max(maxpos, vertices[i].position);
+        }
+    }
+    // metallic roughness
+    if (mat.pbrData.metallicRoughnessTexture.has_value()) {
+        const auto &metallicRoughnessTexture =
+            gltf.textures[mat.pbrData.metallicRoughnessTexture.value().textureIndex];
+        if (metallicRoughnessTexture.imageIndex.has_value()) {
+            size_t img = metallicRoughnessTexture.imageIndex.value();
+            materialResources.metalRoughImage = texture_image(img, 2, &constants.metalRoughFeedbackSlot);
+
+            if (metallicRoughnessTexture.samplerIndex.has_value()) {
+                size_t sampler = metallicRoughnessTexture.samplerIndex.value();
+                materialResources.metalRoughSampler = file.samplers[sampler];
+            } else {
+                materialResources.metalRoughSampler = engine->_resourceManager.getLinearSampler();
             }
-            // calculate origin and extents from the min/max, use extent length for radius
-            newSurface.bounds.origin = (maxpos + minpos) / 2.f;
-            newSurface.bounds.extents = (maxpos - minpos) / 2.f;
-            newSurface.bounds.sphereRadius = glm::length(newSurface.bounds.extents);
-
-            newmesh->surfaces.push_back(newSurface);
         }
-        newmesh->nbIndices = static_cast<uint32_t>(indices.size());
-        newmesh->nbVertices = static_cast<uint32_t>(vertices.size());
-        newmesh->meshIndex = static_cast<uint32_t>(meshes.size()) - 1;
+    }
+    // normal
+    if (mat.normalTexture.has_value()) {
+        const auto &normalTexture = gltf.textures[mat.normalTexture.value().textureIndex];
+        if (normalTexture.imageIndex.has_value()) {
+            size_t img = normalTexture.imageIndex.value();
+            materialResources.normalImage = texture_image(img, 3, &constants.normalFeedbackSlot);
+
+            if (normalTexture.samplerIndex.has_value()) {
+                size_t sampler = normalTexture.samplerIndex.value();
+                materialResources.normalSampler = file.samplers[sampler];
+            } else {
+                materialResources.normalSampler = engine->_resourceManager.getLinearSampler();
+            }
+        }
+    }
+    // transmission
+    if (mat.transmission && mat.transmission->transmissionTexture.has_value()) {
+        const auto &transmissionTexture = gltf.textures[mat.transmission->transmissionTexture.value().textureIndex];
+        if (transmissionTexture.imageIndex.has_value()) {
+            size_t img = transmissionTexture.imageIndex.value();
+            materialResources.transmissionImage = images[img];
+
+            if (transmissionTexture.samplerIndex.has_value()) {
+                size_t sampler = transmissionTexture.samplerIndex.value();
+                materialResources.transmissionSampler = file.samplers[sampler];
+            } else {
+                materialResources.transmissionSampler = engine->_resourceManager.getLinearSampler();
+            }
+        }
+    }
+    // emissive
+    if (mat.emissiveTexture.has_value()) {
+        const auto &emissiveTexture = gltf.textures[mat.emissiveTexture.value().textureIndex];
+        if (emissiveTexture.imageIndex.has_value()) {
+            size_t img = emissiveTexture.imageIndex.value();
+            materialResources.emissiveImage = texture_image(img, TextureStreamer::EMISSIVE_IMAGE, nullptr);
+            constants.hasEmissiveTex = true; // Set flag only when texture is successfully loaded
+
+            if (emissiveTexture.samplerIndex.has_value()) {
+                size_t sampler = emissiveTexture.samplerIndex.value();
+                materialResources.emissiveSampler = file.samplers[sampler];
+            } else {
+                // Use default linear sampler if no sampler specified
+                materialResources.emissiveSampler = engine->_resourceManager.getLinearSampler();
+            }
+        }
+    }
+
+    return desc;
+}
+
+void GltfLoadTask::upload_material(size_t index) {
+    VulkanEngine *engine = _engine;
+    LoadedGLTF &file = *_scene;
+    ScopedLoadPhase phase(file.loadProfile, "material_setup");
+
+    const fastgltf::Material &mat = _state->gltf->materials[index];
+    std::shared_ptr<GLTFMaterial> newMat = std::make_shared<GLTFMaterial>();
+    _state->materials.push_back(newMat);
+    file.materials[mat.name.c_str()] = newMat;
+
+    const MaterialDesc desc = describe_material(index, file);
+    _state->materialConstants[index] = desc.constants;
+    newMat->alphaMasked = desc.alphaMasked;
+    newMat->doubleSided = desc.doubleSided;
+
+    // build material
+    newMat->data = engine->metalRoughMaterial.write_material(engine, engine->_device, desc.pass, desc.resources,
+                                                             file.descriptorPool);
+    bind_streamed_textures(engine, newMat->data, desc.streamedBindings, file.descriptorPool);
+}
 
-        newmesh->meshBuffers = engine->uploadMesh(indices, vertices);
+void GltfLoadTask::upload_mesh(size_t index) {
+    const auto uploadStart = std::chrono::high_resolution_clock::now();
+    LoadedGLTF &file = *_scene;
+    State &state = *_state;
+    ScopedLoadPhase phase(file.loadProfile, "mesh_upload");
+
+    std::string_view name;
+    std::span<const SurfaceGeometry> surfaces;
+    std::span<const Vertex> vertices;
+    std::span<const uint32_t> indices;
+    std::span<const Meshlet> meshlets;
+    if (file.loadStats.meshCacheHit) {
+        const MeshCacheView cached = state.meshCache.mesh(index);
+        name = cached.name;
+        surfaces = cached.surfaces;
+        vertices = cached.vertices;
+        indices = cached.indices;
+        meshlets = cached.meshlets;
+    } else {
+        const MeshGeometry &mesh = state.geometry[index];
+        name = mesh.name;
+        surfaces = mesh.surfaces;
+        vertices = mesh.vertices;
+        indices = mesh.indices;
+        meshlets = mesh.meshlets;
     }
 
-    // load all nodes and their meshes
-    for (fastgltf::Node &node: gltf.nodes) {
-        std::shared_ptr<Node> newNode;
+    std::shared_ptr<MeshAsset> newmesh =
+        create_mesh_asset(_engine, name, static_cast<uint32_t>(index), surfaces, vertices, indices, meshlets,
+                          state.materials, state.settings.vertexFormat, state.settings.narrowIndices);
+    file.loadStats.vertexBytes += vertices.size() * vertexpacking::stride(newmesh->vertexFormat);
+    file.loadStats.fullVertexBytes += vertices.size_bytes();
+    file.loadStats.indexBytes += newmesh->meshBuffers.indices.size;
+    file.loadStats.fullIndexBytes += indices.size_bytes();
+    file.loadProfile.add_bytes("mesh_upload", vertices.size() * vertexpacking::stride(newmesh->vertexFormat) +
+                                                  newmesh->meshBuffers.indices.size);
+    state.meshes[index] = newmesh;
+    // a reload swaps the new buffers into the target's mesh instead
+    if (!_target) {
+        file.meshes[newmesh->name.c_str()] = newmesh;
+    }
+
+    file.loadStats.meshUploadTime +=
+        std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - uploadStart).count();
+}
 
-        // find if the node has a mesh, and if it does hook it to the mesh pointer and allocate it with the meshnode
-        // class
+void GltfLoadTask::finish_nodes() {
+    LoadedGLTF &file = *_scene;
+    State &state = *_state;
+    fastgltf::Asset &gltf = *state.gltf;
+    std::optional<ScopedLoadPhase> phase(std::in_place, file.loadProfile, "nodes");
+
+    std::vector<glm::mat4> localTransforms;
+    std::vector<std::vector<uint32_t>> children;
+    localTransforms.reserve(gltf.nodes.size());
+    children.reserve(gltf.nodes.size());
+    for (const fastgltf::Node &node: gltf.nodes) {
+        localTransforms.push_back(node_local_transform(node));
+        children.emplace_back(node.children.begin(), node.children.end());
+    }
+
+    // flatten the tree once, the frames then only sweep the arrays
+    file.transforms.build(localTransforms, children);
+    for (uint32_t i = 0; i < file.transforms.size(); i++) {
+        const fastgltf::Node &node = gltf.nodes[file.transforms.source_index(i)];
         if (node.meshIndex.has_value()) {
-            newNode = std::make_shared<MeshNode>();
-            dynamic_cast<MeshNode *>(newNode.get())->mesh = meshes[*node.meshIndex];
-        } else {
-            newNode = std::make_shared<Node>();
+            file.meshInstances.push_back({i, state.meshes[*node.meshIndex]});
         }
+    }
+    file.transforms.update();
 
-        nodes.push_back(newNode);
-        file.nodes[node.name.c_str()];
+    phase.reset();
+    file.loadProfile.set_counter("nodes", "nodes", gltf.nodes.size());
+    file.loadProfile.set_counter("nodes", "topNodes", file.transforms.root_count());
 
-        std::visit(fastgltf::visitor{
-                       [&](fastgltf::math::fmat4x4 matrix) { newNode->localTransform = glm::make_mat4(matrix.data()); },
-                       [&](fastgltf::TRS transform) {
-                           glm::vec3 tl(transform.translation[0], transform.translation[1], transform.translation[2]);
-                           glm::quat rot(transform.rotation[3], transform.rotation[0], transform.rotation[1],
-                                         transform.rotation[2]);
-                           glm::vec3 sc(transform.scale[0], transform.scale[1], transform.scale[2]);
+    // what a hot reload of the file diffs against and patches
+    if (state.settings.hotReload) {
+        file.indexedMeshes = state.meshes;
+        file.indexedMaterials = state.materials;
+        file.contentHashes = std::move(state.hashes);
+    }
 
-                           glm::mat4 tm = glm::translate(glm::mat4(1.f), tl);
-                           glm::mat4 rm = glm::toMat4(rot);
-                           glm::mat4 sm = glm::scale(glm::mat4(1.f), sc);
+    // hand the last textures and meshes to the GPU now rather than with the next frame
+    {
+        ScopedLoadPhase flush(file.loadProfile, "upload_flush");
+        _engine->uploadBatcher.flush();
+    }
 
-                           newNode->localTransform = tm * rm * sm;
-                       }},
-                   node.transform);
+    GLTFLoadStats &stats = file.loadStats;
+    stats.uploadBatches = _engine->uploadBatcher.stats().batches - state.uploadBatchesBefore;
+    file.loadProfile.set_counter("upload_flush", "batches", stats.uploadBatches);
+    file.loadProfile.set_counter("upload_flush", "frames", stats.uploadFrames);
+    stats.totalTime =
+        std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - state.start).count();
+
+    spdlog::info("Uploaded {} over {} frame(s): images {:.2f} ms, meshes {:.2f} ms, {} upload batch(es)", _path,
+                 stats.uploadFrames, stats.imageUploadTime, stats.meshUploadTime, stats.uploadBatches);
+    spdlog::info("Vertex memory {:.2f} MB as {}, {:.2f} MB at full precision",
+                 static_cast<double>(stats.vertexBytes) / (1024.0 * 1024.0),
+                 vertexpacking::name(state.settings.vertexFormat),
+                 static_cast<double>(stats.fullVertexBytes) / (1024.0 * 1024.0));
+    spdlog::info("Index memory {:.2f} MB, {:.2f} MB as 32 bit",
+                 static_cast<double>(stats.indexBytes) / (1024.0 * 1024.0),
+                 static_cast<double>(stats.fullIndexBytes) / (1024.0 * 1024.0));
+    spdlog::info("Loaded GLTF {} in {:.2f} ms", _path, stats.totalTime);
+
+    // the cpu side copies are not needed anymore, the mesh cache stays mapped only as long as the task lives
+    state.decodedImages.clear();
+    state.geometry.clear();
+}
+
+void GltfLoadTask::patch_scene() {
+    VulkanEngine *engine = _engine;
+    LoadedGLTF &file = *_scene;
+    LoadedGLTF &target = *_target;
+    State &state = *_state;
+    fastgltf::Asset &gltf = *state.gltf;
+    const scenediff::SceneDiff &diff = state.diff;
+    std::optional<ScopedLoadPhase> phase(std::in_place, file.loadProfile, "reload_patch");
+
+    // the sets, buffers and images patched below may still be read by frames in flight
+    engine->uploadBatcher.flush();
+    vkDeviceWaitIdle(engine->_device);
+
+    // materials are rewritten into the sets and constant slots they already own, the streamer lets go of a
+    // material while its set changes and follows the textures it samples now
+    auto *constants =
+        static_cast<GLTFMetallic_Roughness::MaterialConstants *>(target.materialDataBuffer.info.pMappedData);
+    for (const uint32_t index: diff.materials) {
+        MaterialInstance &material = target.indexedMaterials[index]->data;
+        const MaterialDesc desc = describe_material(index, target);
+        constants[index] = desc.constants;
+        target.indexedMaterials[index]->alphaMasked = desc.alphaMasked;
+        target.indexedMaterials[index]->doubleSided = desc.doubleSided;
+
+        engine->textureStreamer.unbind(&material);
+        const VkDescriptorSet spareSet = material.spareSet;
+        material = engine->metalRoughMaterial.write_material(engine, engine->_device, desc.pass, desc.resources,
+                                                             material.materialSet);
+        material.spareSet = spareSet;
+        bind_streamed_textures(engine, material, desc.streamedBindings, target.descriptorPool);
     }
 
-    // run loop again to setup transform hierarchy
-    for (int i = 0; i < static_cast<int>(gltf.nodes.size()); i++) {
-        fastgltf::Node &node = gltf.nodes[i];
-        std::shared_ptr<Node> &sceneNode = nodes[i];
+    // no material samples the replaced textures anymore, the target drops them and takes over the new ones
+    for (const uint32_t index: diff.images) {
+        if (auto it = std::ranges::find(target.textureKeys, target.contentHashes.images[index]);
+            it != target.textureKeys.end()) {
+            release_texture(engine, *it);
+            target.textureKeys.erase(it);
+        }
+        const std::string name = std::to_string(index);
+        if (auto it = file.images.find(name); it != file.images.end()) {
+            target.images[name] = it->second;
+        } else {
+            target.images.erase(name);
+        }
+    }
+    target.textureKeys.insert(target.textureKeys.end(), file.textureKeys.begin(), file.textureKeys.end());
+    file.textureKeys.clear();
+    file.images.clear();
+
+    // the nodes keep pointing at the same mesh objects, only their buffers and surfaces are exchanged
+    for (const uint32_t index: diff.meshes) {
+        std::swap(*target.indexedMeshes[index], *state.meshes[index]);
+        engine->geometryArena.free(state.meshes[index]->meshBuffers);
+    }
 
-        for (auto &c: node.children) {
-            sceneNode->children.push_back(nodes[c]);
-            nodes[c]->parent = sceneNode;
+    // the meshes were built before their materials were patched, a material that became alpha tested drops the
+    // occluders of its surfaces. one that stopped being so gets none until its meshes are rebuilt
+    if (!diff.materials.empty()) {
+        for (const std::shared_ptr<MeshAsset> &mesh: target.indexedMeshes) {
+            for (GeoSurface &surface: mesh->surfaces) {
+                if (surface.material->alphaMasked) {
+                    surface.occluder.reset();
+                }
+            }
         }
     }
 
-    // find the top nodes, with no parents
-    for (auto &node: nodes) {
-        if (node->parent.lock() == nullptr) {
-            file.topNodes.push_back(node);
-            node->refreshTransform(glm::mat4{1.f});
+    // only the subtrees under the changed nodes are recomputed, with the next Draw
+    for (const uint32_t index: diff.nodes) {
+        const uint32_t node = target.transforms.flat_index(index);
+        if (node != TransformHierarchy::NO_PARENT) {
+            target.transforms.set_local(node, node_local_transform(gltf.nodes[index]));
         }
     }
-    return scene;
+
+    target.contentHashes = std::move(state.hashes);
+    target.sourceFiles = file.sourceFiles;
+
+    phase.reset();
+    file.loadProfile.set_counter("reload_patch", "images", diff.images.size());
+    file.loadProfile.set_counter("reload_patch", "materials", diff.materials.size());
+    file.loadProfile.set_counter("reload_patch", "meshes", diff.meshes.size());
+    file.loadProfile.set_counter("reload_patch", "nodes", diff.nodes.size());
+
+    GLTFLoadStats &stats = file.loadStats;
+    stats.hotReload = true;
+    stats.reloadedImages = static_cast<uint32_t>(diff.images.size());
+    stats.reloadedMaterials = static_cast<uint32_t>(diff.materials.size());
+    stats.reloadedMeshes = static_cast<uint32_t>(diff.meshes.size());
+    stats.reloadedNodes = static_cast<uint32_t>(diff.nodes.size());
+    stats.uploadBatches = engine->uploadBatcher.stats().batches - state.uploadBatchesBefore;
+    stats.totalTime =
+        std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - state.start).count();
+    spdlog::info("Hot reloaded {} in {:.2f} ms: {} images, {} materials, {} meshes and {} nodes patched", _path,
+                 stats.totalTime, stats.reloadedImages, stats.reloadedMaterials, stats.reloadedMeshes,
+                 stats.reloadedNodes);
+
+    state.decodedImages.clear();
+    state.geometry.clear();
+}
+
+std::optional<std::shared_ptr<LoadedGLTF>> loadGltf(VulkanEngine *engine, std::string_view filePath) {
+    spdlog::info("Loading GLTF: {}", filePath);
+
+    // both stages back to back on the calling thread, with no budget on the uploads
+    GltfLoadTask task(engine, std::string(filePath));
+    task.prepare();
+    while (!task.upload(std::numeric_limits<float>::infinity())) {
+    }
+
+    if (task.stage() != GltfLoadTask::Stage::Done) {
+        return {};
+    }
+    return task.scene();
+}
+
+void writeLoadReport(const LoadProfile &profile, std::string_view filePath, const LoaderSettings &settings,
+                     double totalMs) {
+    if (!settings.writeLoadReports) {
+        return;
+    }
+    const std::filesystem::path path = LoadProfile::report_path(filePath, settings.loadReportDirectory);
+    if (profile.write_json(path, filePath, totalMs)) {
+        spdlog::info("Wrote load report {}", path.string());
+    } else {
+        spdlog::warn("Failed to write load report {}", path.string());
+    }
 }
 
 void LoadedGLTF::Draw(const glm::mat4 &topMatrix, DrawContext &ctx) {
-    // create renderables from the scenenodes
-    for (const auto &n: topNodes) {
-        n->Draw(topMatrix, ctx);
+    transforms.set_root(topMatrix);
+    transforms.update();
+
+    // create renderables from the mesh nodes, in the tree order the node walk used to produce
+    for (const MeshInstance &instance: meshInstances) {
+        add_mesh_surfaces(*instance.mesh, transforms.world(instance.node), ctx, instance.node);
     }
 }
 
 void LoadedGLTF::clearAll() {
     VkDevice dv = creator->_device;
 
+    // the streamer must not rewrite the sets of this file's materials anymore. materials sharing a name are only
+    // reachable through the surfaces
+    for (auto &[k, v]: materials) {
+        creator->textureStreamer.unbind(&v->data);
+    }
+    for (auto &[k, v]: meshes) {
+        for (const GeoSurface &surface: v->surfaces) {
+            creator->textureStreamer.unbind(&surface.material->data);
+        }
+    }
     descriptorPool.destroy_pools(dv);
     vkutil::destroy_buffer(creator, materialDataBuffer);
 
+    // hand the mesh ranges back to the geometry arena
     for (auto &[k, v]: meshes) {
-
-        vkutil::destroy_buffer(creator, v->meshBuffers.indexBuffer);
-        vkutil::destroy_buffer(creator, v->meshBuffers.vertexBuffer);
+        creator->geometryArena.free(v->meshBuffers);
     }
 
-    for (auto &[k, v]: images) {
-        VmaAllocationInfo info;
-        vmaGetAllocationInfo(creator->_allocator, v.allocation, &info);
-        if (v.image == creator->_resourceManager.getErrorCheckerboardImage().image) {
-            // dont destroy the default images
-            continue;
-        }
-        vkutil::destroy_image(creator, v);
+    // textures are shared through the texture cache, only the last scene using one destroys it
+    for (const uint64_t key: textureKeys) {
+        release_texture(creator, key);
     }
+    textureKeys.clear();
+    images.clear();
 
     for (const auto &sampler: samplers) {
         vkDestroySampler(dv, sampler, nullptr);
@@ -608,6 +2202,6 @@ void LoadedGLTF::clearAll() {
     samplers.clear();
 
     // clear all the nodes
-    topNodes.clear();
-    nodes.clear();
+    meshInstances.clear();
+    transforms.clear();
 }
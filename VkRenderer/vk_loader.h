@@ -1,6 +1,15 @@
 #pragma once
 
+#include <LoadProfile.h>
+#include <MeshGeometry.h>
+#include <MipGenerator.h>
+#include <OcclusionCull.h>
+#include <SceneDiff.h>
+#include <TransformHierarchy.h>
+#include <atomic>
+#include <memory>
 #include <optional>
+#include <string>
 #include <vk_descriptors.h>
 #include <vk_types.h>
 
@@ -10,19 +19,29 @@
 
 struct GLTFMaterial {
     MaterialInstance data;
-};
-
-struct Bounds {
-    glm::vec3 origin;
-    float sphereRadius;
-    glm::vec3 extents;
+    // alpha tested, its surfaces have holes and never occlude anything
+    bool alphaMasked{false};
+    // glTF doubleSided, its back faces are visible so the meshlet culler keeps back facing meshlets
+    bool doubleSided{false};
 };
 
 struct GeoSurface {
+    // startIndex and the LODs' count in indexType units from the mesh's first index byte (meshBuffers.indices).
+    // indices are rebased on the surface's smallest vertex, draws add vertexOffset back
     uint32_t startIndex;
     uint32_t count;
+    VkIndexType indexType;
+    int32_t vertexOffset;
     Bounds bounds;
+    // range of the mesh's meshlet buffer, see GPUMeshBuffers::meshletBufferAddress
+    uint32_t firstMeshlet;
+    uint32_t meshletCount;
+    // coarser index ranges of the same surface, finest first
+    uint32_t lodCount;
+    std::array<SurfaceLod, simplify::MAX_LODS> lods;
     std::shared_ptr<GLTFMaterial> material;
+    // full detail triangles of a surface with at most occlusion::MAX_OCCLUDER_TRIANGLES, null for bigger ones
+    std::shared_ptr<const occlusion::OccluderMesh> occluder;
 };
 
 struct MeshAsset {
@@ -33,22 +52,114 @@ struct MeshAsset {
     glm::mat4 transform;
     std::vector<GeoSurface> surfaces;
     GPUMeshBuffers meshBuffers;
+    VertexFormat vertexFormat{VertexFormat::Full};
+    VertexQuantization quantization;
+};
+
+
+// loader knobs, owned by the engine and exposed in the settings panel
+struct LoaderSettings {
+    // decode textures on the job system instead of one after another on the loading thread
+    bool parallelImageDecode{true};
+    // memory map external .bin buffers and read accessors in place instead of loading a heap copy of each
+    bool mapBuffers{true};
+    // reuse processed geometry from <meshCacheDirectory>/<content hash>.meshcache when present
+    bool useMeshCache{true};
+    std::filesystem::path meshCacheDirectory{"cache"};
+    // layout newly loaded meshes are uploaded in, Full keeps the 80 byte full precision vertices
+    VertexFormat vertexFormat{VertexFormat::Packed};
+    // merge duplicate vertices of every primitive, exact ones or, with an epsilon > 0, ones that round together
+    bool weldVertices{true};
+    float weldEpsilon{0.f};
+    // reorder every primitive for the post-transform vertex cache, overdraw and vertex fetch
+    bool optimizeMeshes{true};
+    // build quadric simplified LOD chains for every surface, picked per draw by their projected error
+    bool generateLods{true};
+    // upload a surface's indices as 16 bit whenever its vertex range fits, rebased on its first vertex
+    bool narrowIndices{true};
+    // BC7/BC5/BC1 compress textures on the CPU, only where the GPU supports BC formats
+    bool compressTextures{true};
+    // compressed mip chains are cached here by content hash, so only the first load runs the encoder
+    std::filesystem::path textureCacheDirectory{"cache/textures"};
+    // build mips on the CPU, filtering sRGB colors in linear light and keeping the alpha coverage of cutout
+    // materials, instead of blitting them on the GPU. compressed textures always build their mips on the CPU
+    bool cpuMipmaps{true};
+    mipgen::MipFilter mipFilter{mipgen::MipFilter::Kaiser};
+    // upload textures with their coarse mips only and let the TextureStreamer add finer ones as the screen needs
+    // them. needs the CPU mip chain
+    bool streamTextures{true};
+    // time per frame the render thread may spend creating GPU resources for a scene that streams in
+    float uploadBudgetMs{4.f};
+    // write a JSON report of the per phase load timings to <loadReportDirectory>/<scene>.load.json, next to the
+    // scene when the directory is empty. --load-report [directory] turns it on from the command line
+    bool writeLoadReports{false};
+    std::filesystem::path loadReportDirectory;
+    // watch the dropped scene and the buffers and images it references, and when they change patch only the
+    // images, materials, meshes and nodes whose content hash moved into the loaded scene
+    bool hotReload{true};
 };
 
+// timings of a single glTF load in milliseconds, plus the vertex memory it ended up using
+struct GLTFLoadStats {
+    uint32_t imageCount{0};
+    uint32_t decodeThreads{0};
+    float imageDecodeCpuTime{0.f}; // summed over all decode threads
+    float imageUploadTime{0.f};
+    float imageTotalTime{0.f}; // wall time of decoding every texture
+    uint32_t textureCacheHits{0}; // images another loaded scene (or this one) had already uploaded
+    uint32_t compressedTextures{0};
+    uint32_t textureDiskCacheHits{0}; // compressed mip chains read from disk instead of encoded
+    float imageEncodeTime{0.f}; // summed over all textures, the encoder itself runs on the job system
+    float imageMipTime{0.f}; // CPU mip generation summed over all textures, 0 when the GPU blits them
+    uint64_t textureBytes{0}; // gpu memory of all textures including their mips
+    uint64_t uncompressedTextureBytes{0}; // what they would take as RGBA8
+    bool meshCacheHit{false};
+    float geometryTime{0.f}; // accessor walk on a cold load, mapping the mesh cache on a warm one
+    uint64_t sourceVertices{0}; // vertices the accessors held, 0 on a mesh cache hit
+    uint64_t weldedVertices{0}; // what was left of them after welding
+    uint32_t compressedViews{0}; // EXT_meshopt_compression buffer views decoded, 0 on a mesh cache hit
+    uint64_t compressedViewBytes{0}; // what they take in the file
+    uint64_t decodedViewBytes{0}; // and what they take uncompressed
+    float meshoptDecodeTime{0.f}; // wall time of decoding them on the job system
+    float meshUploadTime{0.f};
+    float totalTime{0.f}; // request to finished scene, including the frames rendered while it streamed in
+    uint32_t uploadFrames{0}; // frames the GPU stage was spread over
+    uint64_t vertexBytes{0}; // gpu vertex memory of all meshes
+    uint64_t fullVertexBytes{0}; // what they would take as full precision Vertex
+    uint64_t indexBytes{0}; // gpu index memory of all meshes
+    uint64_t fullIndexBytes{0}; // what it would take with 32 bit indices only
+    uint64_t uploadBatches{0}; // staging submissions for all textures and meshes
+    // a hot reload patched the assets that changed into the loaded scene, the counters above cover only those
+    bool hotReload{false};
+    uint32_t reloadedImages{0};
+    uint32_t reloadedMaterials{0};
+    uint32_t reloadedMeshes{0};
+    uint32_t reloadedNodes{0};
+    uint32_t rebuiltBlas{0}; // of the ray tracer, set by the engine once the patched scene is traced again
+    bool rebuiltTlas{false};
+};
 
 // forward declaration
 class VulkanEngine;
+class JobSystem;
 
 struct LoadedGLTF : public IRenderable {
 
     // storage for all the data on a given glTF file
     std::unordered_map<std::string, std::shared_ptr<MeshAsset>> meshes;
-    std::unordered_map<std::string, std::shared_ptr<Node>> nodes;
     std::unordered_map<std::string, AllocatedImage> images;
+    // references this file holds in the engine's TextureCache, one per uploaded image
+    std::vector<uint64_t> textureKeys;
     std::unordered_map<std::string, std::shared_ptr<GLTFMaterial>> materials;
 
-    // nodes that dont have a parent, for iterating through the file in tree order
-    std::vector<std::shared_ptr<Node>> topNodes;
+    // the node hierarchy flattened in depth first order, and the meshes placed on its nodes in that order.
+    // Draw recomputes only the world transforms that changed and emits the meshes in one pass over them
+    TransformHierarchy transforms;
+    struct MeshInstance {
+        uint32_t node; // flat index into transforms
+        std::shared_ptr<MeshAsset> mesh;
+    };
+    std::vector<MeshInstance> meshInstances;
 
     std::vector<VkSampler> samplers;
 
@@ -58,6 +169,19 @@ struct LoadedGLTF : public IRenderable {
 
     VulkanEngine *creator;
 
+    // the meshes and materials again in glTF index order with the content hash of every asset, what a hot reload
+    // diffs a changed file against and patches in place. only filled when LoaderSettings::hotReload was on.
+    // nodes are patched through transforms, which maps glTF node indices to its own
+    std::vector<std::shared_ptr<MeshAsset>> indexedMeshes;
+    std::vector<std::shared_ptr<GLTFMaterial>> indexedMaterials;
+    scenediff::SceneHashes contentHashes;
+    // the file and the external buffers and images it references
+    std::vector<std::filesystem::path> sourceFiles;
+
+    GLTFLoadStats loadStats;
+    // per phase timers of the load, written as a JSON report when LoaderSettings::writeLoadReports is on
+    LoadProfile loadProfile;
+
     ~LoadedGLTF() override { clearAll(); };
 
     void Draw(const glm::mat4 &topMatrix, DrawContext &ctx) override;
@@ -69,4 +193,83 @@ private:
 std::optional<std::vector<std::shared_ptr<MeshAsset>>> loadGltfMeshes(VulkanEngine *engine,
                                                                       std::filesystem::path filePath);
 
-std::optional<std::shared_ptr<LoadedGLTF>> loadGltf(VulkanEngine *engine, std::string_view filePath);
\ No newline at end of file
+// A glTF load split in two so the render loop never stalls on it. prepare() parses the file, decodes the textures
+// and builds (or maps) the geometry without touching GPU state, so it can run on a worker thread. upload() then
+// creates the Vulkan resources on the render thread a slice at a time and stops once its budget is spent.
+//
+// Given a loaded scene of the same file the task is a hot reload instead: it diffs the file against the scene's
+// content hashes, decodes and processes only what changed and patches it into the scene in place. A file whose
+// structure changed loads from scratch like any other.
+class GltfLoadTask {
+public:
+    enum class Stage : uint32_t { Queued, Parsing, Decoding, Geometry, Uploading, Done, Failed };
+
+    GltfLoadTask(VulkanEngine *engine, std::string filePath, std::shared_ptr<LoadedGLTF> reloadTarget = nullptr);
+    ~GltfLoadTask();
+
+    GltfLoadTask(const GltfLoadTask &) = delete;
+    GltfLoadTask &operator=(const GltfLoadTask &) = delete;
+
+    // cpu stage, any thread
+    void prepare();
+    // gpu stage, render thread only. does nothing until prepare() is done, true once the scene is complete or
+    // the load failed
+    bool upload(float budgetMs);
+
+    [[nodiscard]] Stage stage() const { return _stage.load(); }
+    // finished and total items of the current stage, for the progress display
+    [[nodiscard]] uint32_t stage_done() const { return _done.load(); }
+    [[nodiscard]] uint32_t stage_total() const { return _total.load(); }
+    [[nodiscard]] const std::string &path() const { return _path; }
+    // the finished scene, null unless stage() is Done or when the task patched an existing one
+    [[nodiscard]] std::shared_ptr<LoadedGLTF> scene() const;
+    // the scene a hot reload patched, null unless stage() is Done and the file could be patched
+    [[nodiscard]] std::shared_ptr<LoadedGLTF> patched_scene() const;
+    // timings of this load or reload, the patched scene keeps those of its first load
+    [[nodiscard]] const GLTFLoadStats &load_stats() const { return _scene->loadStats; }
+    [[nodiscard]] const LoadProfile &load_profile() const { return _scene->loadProfile; }
+
+    static const char *stage_name(Stage stage);
+
+private:
+    struct State;
+    struct MaterialDesc;
+
+    void set_stage(Stage stage, size_t total);
+    void setup();
+    void setup_reload();
+    void upload_texture(size_t index);
+    [[nodiscard]] MaterialDesc describe_material(size_t index, const LoadedGLTF &file) const;
+    void upload_material(size_t index);
+    void upload_mesh(size_t index);
+    void finish_nodes();
+    void patch_scene();
+
+    VulkanEngine *_engine;
+    std::string _path;
+    // the scene being loaded. a hot reload only gathers its stats and the textures and meshes it uploaded here
+    // until patch_scene moves them over to _target
+    std::shared_ptr<LoadedGLTF> _scene;
+    std::shared_ptr<LoadedGLTF> _target;
+    std::unique_ptr<State> _state;
+
+    std::atomic<Stage> _stage{Stage::Queued};
+    std::atomic<uint32_t> _done{0};
+    std::atomic<uint32_t> _total{0};
+};
+
+// loads a whole scene on the calling thread, blocking until it is ready
+std::optional<std::shared_ptr<LoadedGLTF>> loadGltf(VulkanEngine *engine, std::string_view filePath);
+
+// writes a load profile as a JSON report when the settings ask for one. `totalMs` covers whatever the caller did
+// with the scene after the loader finished, e.g. building its acceleration structures
+void writeLoadReport(const LoadProfile &profile, std::string_view filePath, const LoaderSettings &settings,
+                     double totalMs);
+
+// cpu only halves of loadGltf, the content hash keys the mesh cache. used by the loader benchmarks, which read
+// the compressed view counters of `stats`
+std::optional<uint64_t> hashGltfContent(std::string_view filePath);
+std::optional<std::vector<MeshGeometry>> loadGltfGeometry(std::string_view filePath, JobSystem *jobs = nullptr,
+                                                          bool optimize = true, bool generateLods = true,
+                                                          bool mapBuffers = true, bool weld = true,
+                                                          float weldEpsilon = 0.f, GLTFLoadStats *stats = nullptr);
\ No newline at end of file
@@ -9,19 +9,59 @@
 #include <AllocatedBuffer.h>
 #include <AllocatedImage.h>
 
-// holds the resources needed for a mesh
+// a range inside one block (megabuffer) of the geometry arena
+struct ArenaRange {
+    uint32_t block{~0u};
+    VkDeviceSize offset{0};
+    VkDeviceSize size{0};
+};
+
+// where a mesh lives inside the geometry arena, the buffers are shared with every other mesh of the block
 struct GPUMeshBuffers {
 
-    AllocatedBuffer indexBuffer;
-    AllocatedBuffer vertexBuffer;
-    VkDeviceAddress vertexBufferAddress;
-    VkDeviceAddress indexBufferAddress;
+    ArenaRange vertices;
+    ArenaRange indices;
+    ArenaRange meshlets;
+    VkBuffer vertexBuffer{VK_NULL_HANDLE};
+    VkBuffer indexBuffer{VK_NULL_HANDLE};
+    VkBuffer meshletBuffer{VK_NULL_HANDLE};
+    VkDeviceAddress vertexBufferAddress{0}; // first vertex of the mesh, shaders index from here
+    VkDeviceAddress indexBufferAddress{0}; // start of the shared index block, indices.offset is the mesh's
+    VkDeviceAddress meshletBufferAddress{0}; // first Meshlet of the mesh, 0 when it has none
 };
 
 // push constants for our mesh object draws
 struct GPUDrawPushConstants {
     glm::mat4 worldMatrix;
     VkDeviceAddress vertexBuffer;
+    uint32_t vertexFormat; // VertexFormat of the buffer
+    alignas(16) glm::vec4 positionScale; // dequantization of quantized positions, xyz
+    glm::vec4 positionOffset;
+};
+
+// one surface for MeshletCull.comp, laid out like its std430 CullJob
+struct GPUMeshletCullJob {
+    glm::mat4 transform;
+    glm::vec4 cameraLocal; // camera position in mesh space, w = largest axis scale of transform
+    VkDeviceAddress meshlets; // first Meshlet of the surface
+    uint32_t meshletCount;
+    uint32_t drawOffset; // first VkDrawIndexedIndirectCommand of the surface's slice
+    uint32_t firstIndex; // first index of the surface inside the shared index buffer
+    int32_t vertexOffset; // added to every index, see GeoSurface::vertexOffset
+    uint32_t flags; // meshlets::CULL_CONE when back facing meshlets may be dropped
+    uint32_t padding;
+};
+static_assert(sizeof(GPUMeshletCullJob) == 112);
+
+// header of the per frame cull buffer, followed by the GPUMeshletCullJob array
+struct GPUMeshletCullFrame {
+    glm::vec4 frustum[6];
+};
+
+struct GPUMeshletCullPushConstants {
+    VkDeviceAddress frame;
+    VkDeviceAddress drawBuffer;
+    VkDeviceAddress countBuffer;
 };
 
 struct GPUSceneData {
@@ -38,6 +78,9 @@ struct GPUSceneData {
     int enableShadows;
     int enableSSAO;
     int enablePBR;
+    // device address of this frame's texture streaming feedback buffer as two uints, 0 when nothing records it
+    glm::uvec2 textureFeedback;
+    uint32_t textureFeedbackFrame;
 };
 
 struct SSAOSceneData {
@@ -54,8 +97,10 @@ struct SSAOSceneData {
 struct alignas(8) ObjDesc {
     uint64_t vertexAddress; // Address of the Vertex buffer
     uint64_t indexAddress; // Address of the index buffer
-    uint32_t firstIndex; // First index of the mesh
-    uint32_t padding;
+    uint32_t firstIndex; // First index of the mesh, in units of its index type
+    uint32_t vertexFormat; // VertexFormat of the vertex buffer
+    uint32_t indexType; // 0 for 32 bit indices, 1 for 16 bit
+    int32_t vertexOffset; // added to every index
 };
 
 
@@ -63,11 +108,16 @@ enum class MaterialPass : uint8_t { MainColor, Transparent, Other };
 struct MaterialPipeline {
     VkPipeline pipeline;
     VkPipelineLayout layout;
+    // built with VK_CULL_MODE_BACK_BIT, only then may the meshlet culler drop back facing meshlets
+    bool cullsBackFaces{false};
 };
 
 struct MaterialInstance {
     MaterialPipeline *pipeline;
     VkDescriptorSet materialSet;
+    // materials sampling streamed textures get a second set, the TextureStreamer rewrites it and swaps the two
+    // when a texture changes residency, so frames in flight keep a valid materialSet
+    VkDescriptorSet spareSet;
     MaterialPass passType;
 
     AllocatedImage colImage;
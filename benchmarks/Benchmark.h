@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// Minimal benchmark harness: every bench_*.cpp registers named cases, bench_main.cpp runs them.
+// Usage: RendererBenchmarks <case> [args...], no arguments lists the registered cases.
+
+using BenchmarkArgs = std::vector<std::string>;
+using BenchmarkFn = std::function<int(const BenchmarkArgs &args)>;
+
+struct BenchmarkCase {
+    std::string usage;
+    BenchmarkFn run;
+};
+
+inline std::map<std::string, BenchmarkCase> &benchmark_registry() {
+    static std::map<std::string, BenchmarkCase> registry;
+    return registry;
+}
+
+struct BenchmarkRegistrar {
+    BenchmarkRegistrar(const char *name, const char *usage, BenchmarkFn fn) {
+        benchmark_registry()[name] = BenchmarkCase{usage, std::move(fn)};
+    }
+};
+
+#define REGISTER_BENCHMARK(name, usage, fn) static BenchmarkRegistrar name##_registrar(#name, usage, fn)
+
+namespace bench {
+
+    struct Timing {
+        double min;
+        double median;
+        double mean;
+    };
+
+    // runs fn `iterations` times and reports wall time in milliseconds
+    template<typename Fn>
+    Timing measure(int iterations, Fn &&fn) {
+        std::vector<double> samples;
+        samples.reserve(iterations);
+        for (int i = 0; i < iterations; i++) {
+            const auto start = std::chrono::high_resolution_clock::now();
+            fn();
+            samples.push_back(
+                std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+        }
+
+        std::sort(samples.begin(), samples.end());
+        double sum = 0.0;
+        for (double s: samples) {
+            sum += s;
+        }
+        return Timing{samples.front(), samples[samples.size() / 2], sum / static_cast<double>(samples.size())};
+    }
+
+    inline void print_timing(const char *label, const Timing &t) {
+        printf("  %-40s min %10.3f ms   median %10.3f ms   mean %10.3f ms\n", label, t.min, t.median, t.mean);
+    }
+
+    // keeps the optimizer from dropping work whose result is otherwise unused
+    template<typename T>
+    void do_not_optimize(const T &value) {
+#if defined(_MSC_VER)
+        static const void *volatile sink;
+        sink = &value;
+#else
+        asm volatile("" : : "r,m"(value) : "memory");
+#endif
+    }
+
+} // namespace bench
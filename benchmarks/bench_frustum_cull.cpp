@@ -0,0 +1,116 @@
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE 1
+
+#include "Benchmark.h"
+
+#include <FrustumCull.h>
+#include <Simd.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+
+namespace {
+
+    struct Surface {
+        Bounds bounds;
+        glm::mat4 transform;
+    };
+
+    // surfaces scattered around a camera at the origin, about a third of them in view
+    std::vector<Surface> make_surfaces(size_t count) {
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> position(-500.f, 500.f);
+        std::uniform_real_distribution<float> size(0.2f, 4.f);
+        std::uniform_real_distribution<float> angle(0.f, 6.28f);
+
+        std::vector<Surface> surfaces(count);
+        for (Surface &s: surfaces) {
+            const glm::vec3 extents(size(rng), size(rng), size(rng));
+            s.bounds = Bounds{glm::vec3(0.f), glm::length(extents), extents};
+            s.transform = glm::translate(glm::mat4(1.f), glm::vec3(position(rng), position(rng) * 0.1f, position(rng)));
+            s.transform = glm::rotate(s.transform, angle(rng), glm::vec3(0.f, 1.f, 0.f));
+        }
+        return surfaces;
+    }
+
+    // what draw_geometry's is_visible did: project the 8 box corners with perspective divides, one surface at a time
+    bool corners_visible(const Surface &s, const glm::mat4 &viewproj) {
+        const glm::mat4 matrix = viewproj * s.transform;
+        glm::vec3 min(1.5f);
+        glm::vec3 max(-1.5f);
+        for (int c = 0; c < 8; c++) {
+            const glm::vec3 corner((c & 1) ? 1.f : -1.f, (c & 2) ? 1.f : -1.f, (c & 4) ? 1.f : -1.f);
+            const glm::vec4 v = matrix * glm::vec4(s.bounds.origin + corner * s.bounds.extents, 1.f);
+            const glm::vec3 ndc(v.x / v.w, v.y / v.w, v.z / v.w);
+            min = glm::min(ndc, min);
+            max = glm::max(ndc, max);
+        }
+        return !(min.z > 1.f || max.z < 0.f || min.x > 1.f || max.x < -1.f || min.y > 1.f || max.y < -1.f);
+    }
+
+    int run_frustum_cull(const BenchmarkArgs &args) {
+        const std::vector<size_t> counts = args.size() > 0 ? std::vector<size_t>{std::stoul(args[0])}
+                                                           : std::vector<size_t>{10'000, 100'000, 1'000'000};
+        const int iterations = args.size() > 1 ? std::stoi(args[1]) : 20;
+
+        glm::mat4 projection = glm::perspective(glm::radians(70.f), 16.f / 9.f, 10000.f, 0.1f);
+        projection[1][1] *= -1;
+        const glm::mat4 viewproj =
+            projection * glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+        const frustumcull::Frustum frustum = frustumcull::extract_frustum(viewproj);
+
+        for (const size_t count: counts) {
+            const std::vector<Surface> surfaces = make_surfaces(count);
+            printf("  %zu surfaces, simd %s\n", count, simd::NAME);
+
+            std::vector<uint32_t> indices;
+            indices.reserve(count);
+            const bench::Timing corners = bench::measure(iterations, [&] {
+                indices.clear();
+                for (size_t i = 0; i < count; i++) {
+                    if (corners_visible(surfaces[i], viewproj)) {
+                        indices.push_back(static_cast<uint32_t>(i));
+                    }
+                }
+                bench::do_not_optimize(indices.data());
+            });
+            const size_t cornersVisible = indices.size();
+
+            frustumcull::BoundsSoA bounds;
+            const bench::Timing gather = bench::measure(iterations, [&] {
+                bounds.resize(count);
+                for (size_t i = 0; i < count; i++) {
+                    bounds.set(i, surfaces[i].bounds, surfaces[i].transform);
+                }
+                bench::do_not_optimize(bounds.radius.data());
+            });
+
+            std::vector<uint64_t> visible(frustumcull::mask_words(count));
+            const bench::Timing scalar = bench::measure(iterations, [&] {
+                frustumcull::cull_scalar(bounds, frustum, visible);
+                bench::do_not_optimize(visible.data());
+            });
+            const bench::Timing vectorized = bench::measure(iterations, [&] {
+                frustumcull::cull(bounds, frustum, visible);
+                bench::do_not_optimize(visible.data());
+            });
+            const bench::Timing expand = bench::measure(iterations, [&] {
+                indices.clear();
+                frustumcull::append_visible(visible, 0, count, indices);
+                bench::do_not_optimize(indices.data());
+            });
+
+            bench::print_timing("8 corner projection per surface", corners);
+            bench::print_timing("world space bounds to SoA", gather);
+            bench::print_timing("plane test, scalar", scalar);
+            bench::print_timing("plane test, simd", vectorized);
+            bench::print_timing("bitmask to index list", expand);
+            printf("  visible: %zu planes, %zu corners, simd vs scalar: %.2fx, simd vs corners: %.1fx\n",
+                   indices.size(), cornersVisible, scalar.median / vectorized.median,
+                   corners.median / vectorized.median);
+        }
+        return 0;
+    }
+
+} // namespace
+
+REGISTER_BENCHMARK(frustum_cull, "[surfaces] [iterations]  SoA frustum culling at 10k/100k/1M surfaces",
+                   run_frustum_cull);
@@ -0,0 +1,51 @@
+#include "Benchmark.h"
+
+#include <LoadProfile.h>
+#include <vk_loader.h>
+
+namespace {
+
+    int run_gltf_buffers(const BenchmarkArgs &args) {
+        if (args.empty()) {
+            printf("missing glTF path\n");
+            return 1;
+        }
+        const std::string &gltfPath = args[0];
+        const int iterations = args.size() > 1 ? std::stoi(args[1]) : 3;
+
+        struct Mode {
+            const char *name;
+            bool mapBuffers;
+        };
+        const Mode modes[] = {{"mapped buffers", true}, {"loaded buffers (LoadExternalBuffers)", false}};
+
+        const double mb = 1024.0 * 1024.0;
+        printf("  baseline peak RSS: %.1f MB\n", static_cast<double>(LoadProfile::peak_rss()) / mb);
+        for (const Mode &mode: modes) {
+            // on Linux the peak can be reset between runs, elsewhere it only grows, so the cheaper mode runs first
+            const bool reset = LoadProfile::reset_peak_rss();
+            size_t vertexCount = 0;
+            const bench::Timing timing = bench::measure(iterations, [&] {
+                // accessor walk only, no optimization passes, so the parse and buffer reads dominate
+                const std::optional<std::vector<MeshGeometry>> geometry =
+                    loadGltfGeometry(gltfPath, nullptr, false, false, mode.mapBuffers);
+                vertexCount = 0;
+                if (geometry.has_value()) {
+                    for (const MeshGeometry &mesh: *geometry) {
+                        vertexCount += mesh.vertices.size();
+                    }
+                }
+            });
+
+            printf("\n  %s\n", mode.name);
+            bench::print_timing("parse + accessor walk", timing);
+            printf("  peak RSS%s: %.1f MB, %zu vertices\n", reset ? "" : " (since start)",
+                   static_cast<double>(LoadProfile::peak_rss()) / mb, vertexCount);
+        }
+        return 0;
+    }
+
+} // namespace
+
+REGISTER_BENCHMARK(gltf_buffers, "<file.gltf|glb> [iterations]  load time and peak RSS of mapped vs loaded .bin buffers",
+                   run_gltf_buffers);
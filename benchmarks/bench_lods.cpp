@@ -0,0 +1,108 @@
+#include "Benchmark.h"
+
+#include <Simplify.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vk_loader.h>
+
+namespace {
+
+    // `count` dome shaped grids of side x side vertices, curved everywhere so every collapse costs something
+    std::vector<MeshGeometry> make_domes(size_t count, uint32_t side) {
+        std::vector<MeshGeometry> meshes(count);
+        for (MeshGeometry &mesh: meshes) {
+            for (uint32_t y = 0; y < side; y++) {
+                for (uint32_t x = 0; x < side; x++) {
+                    const float fx = static_cast<float>(x) / static_cast<float>(side - 1);
+                    const float fy = static_cast<float>(y) / static_cast<float>(side - 1);
+                    Vertex v{};
+                    v.position = glm::vec3(fx, 0.3f * std::sin(fx * 3.14159265f) * std::sin(fy * 3.14159265f), fy);
+                    mesh.vertices.push_back(v);
+                }
+            }
+            for (uint32_t y = 0; y + 1 < side; y++) {
+                for (uint32_t x = 0; x + 1 < side; x++) {
+                    const uint32_t i0 = y * side + x;
+                    mesh.indices.insert(mesh.indices.end(), {i0, i0 + side, i0 + 1, i0 + 1, i0 + side, i0 + side + 1});
+                }
+            }
+
+            SurfaceGeometry surface{};
+            surface.count = static_cast<uint32_t>(mesh.indices.size());
+            mesh.surfaces.push_back(surface);
+        }
+        return meshes;
+    }
+
+    int run_lods(const BenchmarkArgs &args) {
+        const int iterations = args.size() > 1 ? std::stoi(args[1]) : 3;
+
+        std::vector<MeshGeometry> meshes;
+        if (!args.empty()) {
+            // optimized like the loader would, but without its own LOD pass
+            std::optional<std::vector<MeshGeometry>> geometry = loadGltfGeometry(args[0], nullptr, true, false);
+            if (!geometry.has_value()) {
+                printf("failed to parse %s\n", args[0].c_str());
+                return 1;
+            }
+            meshes = std::move(*geometry);
+        } else {
+            meshes = make_domes(16, 200);
+        }
+
+        std::array<size_t, simplify::MAX_LODS + 1> levelTriangles{};
+        std::array<double, simplify::MAX_LODS + 1> levelError{};
+        std::array<size_t, simplify::MAX_LODS + 1> levelSurfaces{};
+        size_t surfaceCount = 0;
+
+        const bench::Timing timing = bench::measure(iterations, [&] {
+            levelTriangles = {};
+            levelError = {};
+            levelSurfaces = {};
+            surfaceCount = 0;
+            for (const MeshGeometry &mesh: meshes) {
+                for (const SurfaceGeometry &surface: mesh.surfaces) {
+                    if (surface.count == 0) {
+                        continue;
+                    }
+                    const std::span<const uint32_t> indices(mesh.indices.data() + surface.startIndex, surface.count);
+                    const auto [lo, hi] = std::minmax_element(indices.begin(), indices.end());
+                    const std::span<const Vertex> vertices(mesh.vertices.data() + *lo, *hi - *lo + 1);
+
+                    const std::vector<simplify::LodLevel> levels = simplify::build_lods(indices, vertices, *lo);
+                    surfaceCount++;
+                    levelTriangles[0] += surface.count / 3;
+                    levelSurfaces[0]++;
+                    for (size_t l = 0; l < levels.size(); l++) {
+                        levelTriangles[l + 1] += levels[l].indices.size() / 3;
+                        levelError[l + 1] += levels[l].error;
+                        levelSurfaces[l + 1]++;
+                    }
+                    bench::do_not_optimize(levels.data());
+                }
+            }
+        });
+
+        printf("  %s: %zu surfaces, %zu triangles\n", args.empty() ? "synthetic domes" : args[0].c_str(),
+               surfaceCount, levelTriangles[0]);
+        bench::print_timing("build LOD chains", timing);
+        for (size_t l = 1; l < levelTriangles.size(); l++) {
+            if (levelSurfaces[l] == 0) {
+                break;
+            }
+            printf("  LOD %zu: %zu surfaces, %zu triangles (%.1f%% of full detail), mean error %.5f\n", l,
+                   levelSurfaces[l], levelTriangles[l],
+                   100.0 * static_cast<double>(levelTriangles[l]) / static_cast<double>(levelTriangles[0]),
+                   levelError[l] / static_cast<double>(levelSurfaces[l]));
+        }
+        printf("  %.1f M source triangles/s\n",
+               static_cast<double>(levelTriangles[0]) / (timing.median * 1000.0));
+        return 0;
+    }
+
+} // namespace
+
+REGISTER_BENCHMARK(lods,
+                   "[file.gltf|glb] [iterations]  quadric simplification LOD chains, synthetic domes without a file",
+                   run_lods);
@@ -0,0 +1,17 @@
+#include "Benchmark.h"
+
+int main(int argc, char **argv) {
+    auto &registry = benchmark_registry();
+
+    if (argc < 2 || registry.find(argv[1]) == registry.end()) {
+        printf("usage: %s <benchmark> [args...]\n\navailable benchmarks:\n", argv[0]);
+        for (const auto &[name, benchmark]: registry) {
+            printf("  %-28s %s\n", name.c_str(), benchmark.usage.c_str());
+        }
+        return argc < 2 ? 0 : 1;
+    }
+
+    const BenchmarkArgs args(argv + 2, argv + argc);
+    printf("== %s ==\n", argv[1]);
+    return registry[argv[1]].run(args);
+}
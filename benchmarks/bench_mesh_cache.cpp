@@ -0,0 +1,99 @@
+#include "Benchmark.h"
+
+#include <MeshCache.h>
+#include <cstring>
+#include <filesystem>
+#include <vk_loader.h>
+
+namespace {
+
+    // stand-in for the staging buffer uploadMesh fills, both paths end with every stream copied once
+    struct StagingSink {
+        std::vector<uint8_t> bytes;
+
+        void copy(std::span<const Vertex> vertices, std::span<const uint32_t> indices) {
+            const size_t vertexBytes = vertices.size_bytes();
+            const size_t indexBytes = indices.size_bytes();
+            if (bytes.size() < vertexBytes + indexBytes) {
+                bytes.resize(vertexBytes + indexBytes);
+            }
+            memcpy(bytes.data(), vertices.data(), vertexBytes);
+            memcpy(bytes.data() + vertexBytes, indices.data(), indexBytes);
+            bench::do_not_optimize(bytes.data());
+        }
+    };
+
+    int run_mesh_cache(const BenchmarkArgs &args) {
+        if (args.empty()) {
+            printf("missing glTF path\n");
+            return 1;
+        }
+
+        const std::string &gltfPath = args[0];
+        const int iterations = args.size() > 1 ? std::stoi(args[1]) : 5;
+        const std::filesystem::path cacheDirectory =
+            std::filesystem::temp_directory_path() / "experirender_bench_meshcache";
+
+        const std::optional<uint64_t> contentHash = hashGltfContent(gltfPath);
+        if (!contentHash.has_value()) {
+            printf("failed to parse %s\n", gltfPath.c_str());
+            return 1;
+        }
+        const std::filesystem::path cachePath = MeshCache::path_for(cacheDirectory, *contentHash);
+
+        StagingSink staging;
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
+
+        // cold: parse, accessor walk, write the cache, copy into staging
+        const bench::Timing cold = bench::measure(iterations, [&] {
+            std::optional<std::vector<MeshGeometry>> geometry = loadGltfGeometry(gltfPath);
+            MeshCache::write(cachePath, *contentHash, *geometry);
+
+            vertexCount = 0;
+            indexCount = 0;
+            for (const MeshGeometry &mesh: *geometry) {
+                staging.copy(mesh.vertices, mesh.indices);
+                vertexCount += mesh.vertices.size();
+                indexCount += mesh.indices.size();
+            }
+        });
+
+        // what a warm load pays on top of the parse before it can map the cache
+        const bench::Timing hashOnly = bench::measure(iterations, [&] {
+            bench::do_not_optimize(hashGltfContent(gltfPath));
+        });
+
+        // warm: parse and hash to find the cache, map it and copy the streams into staging
+        size_t cacheBytes = 0;
+        const bench::Timing warm = bench::measure(iterations, [&] {
+            const std::optional<uint64_t> hash = hashGltfContent(gltfPath);
+
+            MeshCache cache;
+            if (!cache.open(MeshCache::path_for(cacheDirectory, *hash), *hash)) {
+                printf("mesh cache miss on warm run\n");
+                return;
+            }
+            cacheBytes = cache.size_bytes();
+            for (size_t i = 0; i < cache.mesh_count(); i++) {
+                const MeshCacheView mesh = cache.mesh(i);
+                staging.copy(mesh.vertices, mesh.indices);
+            }
+        });
+
+        printf("  %s: %zu vertices, %zu indices, cache file %.2f MB\n", gltfPath.c_str(), vertexCount, indexCount,
+               static_cast<double>(cacheBytes) / (1024.0 * 1024.0));
+        bench::print_timing("cold (parse + process + write)", cold);
+        bench::print_timing("parse + content hash", hashOnly);
+        bench::print_timing("warm (parse + hash + map + copy)", warm);
+        printf("  warm speedup (median): %.2fx\n", cold.median / warm.median);
+
+        std::error_code ec;
+        std::filesystem::remove(cachePath, ec);
+        return 0;
+    }
+
+} // namespace
+
+REGISTER_BENCHMARK(mesh_cache, "<file.gltf|glb> [iterations]  cold vs warm geometry load via the mesh cache",
+                   run_mesh_cache);
@@ -0,0 +1,79 @@
+#include "Benchmark.h"
+
+#include <JobSystem.h>
+#include <filesystem>
+#include <vk_loader.h>
+
+namespace {
+
+    // what a load reads from disk: the glTF or GLB plus the <name>.bin next to it that gltfpack and most
+    // exporters write
+    uint64_t file_bytes(const std::filesystem::path &path) {
+        std::error_code error;
+        uint64_t bytes = std::filesystem::file_size(path, error);
+        std::filesystem::path bin = path;
+        bin.replace_extension(".bin");
+        if (path.extension() != ".glb" && std::filesystem::exists(bin, error)) {
+            bytes += std::filesystem::file_size(bin, error);
+        }
+        return error ? 0 : bytes;
+    }
+
+    int run_meshopt_compression(const BenchmarkArgs &args) {
+        if (args.empty()) {
+            printf("missing glTF path\n");
+            return 1;
+        }
+        std::vector<std::string> paths = {args[0]};
+        int iterations = 3;
+        if (args.size() > 1) {
+            // the optional second file is the same scene without compression
+            if (std::filesystem::exists(args[1])) {
+                paths.push_back(args[1]);
+                iterations = args.size() > 2 ? std::stoi(args[2]) : iterations;
+            } else {
+                iterations = std::stoi(args[1]);
+            }
+        }
+
+        // decoding runs on the loader's job system like the accessor walk after it
+        JobSystem jobs;
+        const double mb = 1024.0 * 1024.0;
+        for (const std::string &path: paths) {
+            GLTFLoadStats stats;
+            size_t vertexCount = 0;
+            const bench::Timing timing = bench::measure(iterations, [&] {
+                stats = GLTFLoadStats{};
+                const std::optional<std::vector<MeshGeometry>> geometry =
+                    loadGltfGeometry(path, &jobs, false, false, true, false, 0.f, &stats);
+                vertexCount = 0;
+                if (geometry.has_value()) {
+                    for (const MeshGeometry &mesh: *geometry) {
+                        vertexCount += mesh.vertices.size();
+                    }
+                }
+            });
+
+            printf("\n  %s\n", path.c_str());
+            bench::print_timing("parse + decode + accessor walk", timing);
+            printf("  %.2f MB on disk, %zu vertices\n", static_cast<double>(file_bytes(path)) / mb, vertexCount);
+            if (stats.compressedViews > 0) {
+                printf("  %u compressed views: %.2f MB, %.2f MB decoded (%.1f%%) in %.3f ms\n", stats.compressedViews,
+                       static_cast<double>(stats.compressedViewBytes) / mb,
+                       static_cast<double>(stats.decodedViewBytes) / mb,
+                       100.0 * static_cast<double>(stats.compressedViewBytes) /
+                           static_cast<double>(stats.decodedViewBytes),
+                       static_cast<double>(stats.meshoptDecodeTime));
+            } else {
+                printf("  no EXT_meshopt_compression views\n");
+            }
+        }
+        return 0;
+    }
+
+} // namespace
+
+REGISTER_BENCHMARK(meshopt_compression,
+                   "<file.gltf|glb> [uncompressed.gltf|glb] [iterations]  disk bytes and load time of meshopt "
+                   "compressed geometry",
+                   run_meshopt_compression);
@@ -0,0 +1,120 @@
+#include "Benchmark.h"
+
+#include <JobSystem.h>
+#include <MipGenerator.h>
+#include <Simd.h>
+#include <cmath>
+
+namespace {
+
+    // high contrast albedo with a cutout alpha, the kind of texture where UNORM filtering darkens the mips and
+    // leaves shrink with distance
+    std::vector<uint8_t> synthetic_texture(uint32_t size, uint32_t seed) {
+        std::vector<uint8_t> rgba(size_t(size) * size * 4);
+        uint32_t state = 0x9e3779b9u ^ seed;
+        for (uint32_t y = 0; y < size; y++) {
+            for (uint32_t x = 0; x < size; x++) {
+                state = state * 1664525u + 1013904223u;
+                const bool bright = ((x / 3) + (y / 5) + seed) % 2 == 0;
+                const float leaf = std::sin(float(x) * 0.11f) * std::sin(float(y) * 0.07f + float(seed));
+                uint8_t *texel = rgba.data() + (size_t(y) * size + x) * 4;
+                texel[0] = static_cast<uint8_t>((bright ? 230 : 20) + (state >> 29));
+                texel[1] = static_cast<uint8_t>((bright ? 210 : 30) + (state >> 29));
+                texel[2] = static_cast<uint8_t>((bright ? 180 : 10) + (state >> 29));
+                texel[3] = static_cast<uint8_t>(std::clamp((leaf - 0.2f) * 4.f, 0.f, 1.f) * 255.f);
+            }
+        }
+        return rgba;
+    }
+
+    float srgb_to_linear(uint8_t v) {
+        const float s = static_cast<float>(v) / 255.f;
+        return s <= 0.04045f ? s / 12.92f : std::pow((s + 0.055f) / 1.055f, 2.4f);
+    }
+
+    // average light of one level's color channels, the mean the mips of an sRGB texture should keep
+    double mean_light(const MipChain &chain, size_t level) {
+        const MipLevel &mip = chain.levels[level];
+        const uint8_t *texels = chain.data.data() + mip.offset;
+        double sum = 0.0;
+        for (size_t i = 0; i < size_t(mip.width) * mip.height * 4; i += 4) {
+            sum += srgb_to_linear(texels[i]) + srgb_to_linear(texels[i + 1]) + srgb_to_linear(texels[i + 2]);
+        }
+        return sum / (3.0 * mip.width * mip.height);
+    }
+
+    int run_mipmaps(const BenchmarkArgs &args) {
+        const uint32_t textureCount = args.size() > 0 ? static_cast<uint32_t>(std::stoul(args[0])) : 4;
+        const int iterations = args.size() > 1 ? std::stoi(args[1]) : 3;
+        constexpr uint32_t size = 4096;
+        constexpr float cutoff = 0.5f;
+        constexpr size_t probeLevel = 5;
+
+        std::vector<std::vector<uint8_t>> textures;
+        for (uint32_t i = 0; i < textureCount; i++) {
+            textures.push_back(synthetic_texture(size, i));
+        }
+
+        JobSystem jobs;
+        printf("  %u textures of %ux%u, %s, %u worker threads\n", textureCount, size, size, simd::NAME,
+               jobs.thread_count());
+
+        // what vkCmdBlitImage computes on the UNORM image: a linear 2x2 average of the encoded values
+        mipgen::MipSettings blit;
+        blit.filter = mipgen::MipFilter::Box;
+
+        mipgen::MipSettings box = blit;
+        box.srgb = true;
+        box.alphaCutoff = cutoff;
+
+        mipgen::MipSettings kaiser = box;
+        kaiser.filter = mipgen::MipFilter::Kaiser;
+
+        struct Case {
+            const char *name;
+            mipgen::MipSettings settings;
+        };
+        const Case cases[] = {
+            {"blit equivalent (UNORM box)", blit},
+            {"sRGB box + coverage", box},
+            {"sRGB Kaiser + coverage", kaiser},
+        };
+
+        const float baseCoverage = mipgen::alpha_coverage(textures[0].data(), size, size, cutoff);
+        for (const Case &c: cases) {
+            MipChain chain;
+
+            // one texture at a time, rows of every level spread over the pool
+            const bench::Timing rows = bench::measure(iterations, [&] {
+                for (const std::vector<uint8_t> &texture: textures) {
+                    chain = mipgen::generate(texture.data(), size, size, c.settings, &jobs);
+                    bench::do_not_optimize(chain.data.data());
+                }
+            });
+
+            // the loader's shape: decode jobs per texture, each spreading its rows over the same pool
+            const bench::Timing set = bench::measure(iterations, [&] {
+                jobs.parallel_for(textures.size(), 1, [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; i++) {
+                        bench::do_not_optimize(mipgen::generate(textures[i].data(), size, size, c.settings, &jobs));
+                    }
+                });
+            });
+
+            chain = mipgen::generate(textures[0].data(), size, size, c.settings, &jobs);
+            const MipLevel &probe = chain.levels[probeLevel];
+            const uint8_t *probeTexels = chain.data.data() + probe.offset;
+            printf("\n  %s: level %zu keeps %.1f%% of the light and %.1f%% of the alpha coverage\n", c.name,
+                   probeLevel, 100.0 * mean_light(chain, probeLevel) / mean_light(chain, 0),
+                   100.0 * mipgen::alpha_coverage(probeTexels, probe.width, probe.height, cutoff) / baseCoverage);
+            bench::print_timing("textures one after another", rows);
+            bench::print_timing("textures in parallel", set);
+            printf("  per texture (median, parallel): %.2f ms\n", set.median / textureCount);
+        }
+        return 0;
+    }
+
+} // namespace
+
+REGISTER_BENCHMARK(mipmaps, "[textures] [iterations]  CPU mip chains of a 4K texture set against the blit filter",
+                   run_mipmaps);
@@ -0,0 +1,100 @@
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE 1
+
+#include "Benchmark.h"
+
+#include <JobSystem.h>
+#include <OcclusionCull.h>
+#include <Simd.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+
+namespace {
+
+    // a row of walls across the view, one behind the other, every one with a doorway at a different spot
+    std::vector<occlusion::OccluderMesh> make_walls(uint32_t count) {
+        constexpr int columns = 16;
+        constexpr int rows = 8;
+        std::vector<occlusion::OccluderMesh> walls(count);
+        for (uint32_t w = 0; w < count; w++) {
+            const float z = -10.f * static_cast<float>(w + 1);
+            const int door = static_cast<int>(w * 5 % columns);
+            for (int column = 0; column < columns; column++) {
+                for (int row = 0; row < rows; row++) {
+                    if (column == door && row < rows / 2) {
+                        continue;
+                    }
+                    const float x0 = -40.f + 80.f * static_cast<float>(column) / columns;
+                    const float x1 = -40.f + 80.f * static_cast<float>(column + 1) / columns;
+                    const float y0 = -5.f + 10.f * static_cast<float>(row) / rows;
+                    const float y1 = -5.f + 10.f * static_cast<float>(row + 1) / rows;
+                    walls[w].corners.insert(walls[w].corners.end(), {{x0, y0, z}, {x1, y0, z}, {x1, y1, z},
+                                                                     {x0, y0, z}, {x1, y1, z}, {x0, y1, z}});
+                }
+            }
+        }
+        return walls;
+    }
+
+    int run_occlusion_cull(const BenchmarkArgs &args) {
+        const size_t count = args.size() > 0 ? std::stoul(args[0]) : 20'000;
+        const int iterations = args.size() > 1 ? std::stoi(args[1]) : 20;
+
+        glm::mat4 projection = glm::perspective(glm::radians(70.f), 16.f / 9.f, 10000.f, 0.1f);
+        projection[1][1] *= -1;
+        const glm::mat4 viewproj =
+            projection * glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+
+        const std::vector<occlusion::OccluderMesh> walls = make_walls(8);
+        std::vector<occlusion::Occluder> occluders;
+        for (const occlusion::OccluderMesh &wall: walls) {
+            occluders.push_back({&wall, viewproj});
+        }
+
+        // boxes between and behind the walls, like props in the rooms of an interior
+        std::mt19937 rng(4);
+        std::uniform_real_distribution<float> x(-40.f, 40.f);
+        std::uniform_real_distribution<float> y(-4.f, 4.f);
+        std::uniform_real_distribution<float> z(-90.f, -2.f);
+        std::uniform_real_distribution<float> size(0.2f, 1.f);
+        std::vector<glm::vec3> centers(count);
+        std::vector<glm::vec3> extents(count);
+        for (size_t i = 0; i < count; i++) {
+            centers[i] = {x(rng), y(rng), z(rng)};
+            extents[i] = glm::vec3(size(rng));
+        }
+
+        occlusion::DepthBuffer buffer;
+        uint32_t triangles = 0;
+        const bench::Timing serial = bench::measure(iterations, [&] {
+            triangles = occlusion::rasterize(buffer, occluders);
+            bench::do_not_optimize(buffer.depth.data());
+        });
+        JobSystem jobs;
+        const bench::Timing parallel = bench::measure(iterations, [&] {
+            occlusion::rasterize(buffer, occluders, &jobs);
+            bench::do_not_optimize(buffer.depth.data());
+        });
+
+        size_t hidden = 0;
+        const bench::Timing test = bench::measure(iterations, [&] {
+            hidden = 0;
+            for (size_t i = 0; i < count; i++) {
+                hidden += occlusion::occluded(buffer, centers[i], extents[i], viewproj);
+            }
+            bench::do_not_optimize(hidden);
+        });
+
+        printf("  %ux%u depth buffer, %u occluder triangles, %zu boxes, simd %s, %u workers\n", occlusion::WIDTH,
+               occlusion::HEIGHT, triangles, count, simd::NAME, jobs.thread_count());
+        bench::print_timing("rasterize, one thread", serial);
+        bench::print_timing("rasterize, tiles on the job system", parallel);
+        bench::print_timing("box tests", test);
+        printf("  occluded: %zu of %zu (%.1f%%)\n", hidden, count,
+               100.0 * static_cast<double>(hidden) / static_cast<double>(count));
+        return 0;
+    }
+
+} // namespace
+
+REGISTER_BENCHMARK(occlusion_cull, "[boxes] [iterations]  software occlusion culling behind a row of walls",
+                   run_occlusion_cull);
@@ -0,0 +1,150 @@
+#include "Benchmark.h"
+
+#include <JobSystem.h>
+#include <Simd.h>
+#include <TangentSpace.h>
+#include <cmath>
+#include <glm/glm.hpp>
+
+namespace {
+
+    struct PrimitiveRange {
+        size_t firstVertex;
+        size_t vertexCount;
+        size_t firstIndex;
+        size_t indexCount;
+    };
+
+    struct SyntheticMesh {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<float> handedness;
+        std::vector<PrimitiveRange> ranges;
+    };
+
+    // `primitives` wavy grids of side x side vertices, laid out like the loader lays out a multi primitive mesh
+    SyntheticMesh make_mesh(size_t primitives, uint32_t side) {
+        SyntheticMesh mesh;
+        mesh.vertices.reserve(primitives * side * side);
+        mesh.indices.reserve(primitives * (side - 1) * (side - 1) * 6);
+
+        for (size_t p = 0; p < primitives; p++) {
+            const size_t firstVertex = mesh.vertices.size();
+            const size_t firstIndex = mesh.indices.size();
+
+            for (uint32_t y = 0; y < side; y++) {
+                for (uint32_t x = 0; x < side; x++) {
+                    const float fx = static_cast<float>(x) / static_cast<float>(side - 1);
+                    const float fy = static_cast<float>(y) / static_cast<float>(side - 1);
+                    const float height = 0.1f * std::sin(fx * 6.f + static_cast<float>(p)) * std::cos(fy * 4.f);
+
+                    Vertex v{};
+                    v.position = glm::vec3(fx, height, fy);
+                    v.normal = glm::normalize(glm::vec3(-0.6f * std::cos(fx * 6.f), 1.f, 0.4f * std::sin(fy * 4.f)));
+                    v.tangent = glm::vec3(1.f, 0.f, 0.f);
+                    v.uv_x = fx;
+                    v.uv_y = fy;
+                    v.color = glm::vec4(1.f);
+                    mesh.vertices.push_back(v);
+                }
+            }
+
+            for (uint32_t y = 0; y + 1 < side; y++) {
+                for (uint32_t x = 0; x + 1 < side; x++) {
+                    const auto i0 = static_cast<uint32_t>(firstVertex + y * side + x);
+                    const uint32_t i1 = i0 + 1;
+                    const uint32_t i2 = i0 + side;
+                    const uint32_t i3 = i2 + 1;
+                    mesh.indices.insert(mesh.indices.end(), {i0, i2, i1, i1, i2, i3});
+                }
+            }
+
+            mesh.ranges.push_back(PrimitiveRange{firstVertex, mesh.vertices.size() - firstVertex, firstIndex,
+                                                 mesh.indices.size() - firstIndex});
+        }
+
+        mesh.handedness.assign(mesh.vertices.size(), 1.f);
+        return mesh;
+    }
+
+    int run_tangents(const BenchmarkArgs &args) {
+        const size_t primitives = args.size() > 0 ? std::stoul(args[0]) : 500;
+        const int iterations = args.size() > 1 ? std::stoi(args[1]) : 5;
+
+        // 45x45 = 2025 vertices per primitive, ~1M vertices at the default 500 primitives
+        SyntheticMesh mesh = make_mesh(primitives, 45);
+        const std::vector<Vertex> pristine = mesh.vertices;
+        printf("  %zu primitives, %zu vertices, %zu triangles, simd %s\n", mesh.ranges.size(), mesh.vertices.size(),
+               mesh.indices.size() / 3, simd::NAME);
+
+        // what the loader used to do: rebuild the bitangents of every vertex so far after each primitive
+        const bench::Timing legacy = bench::measure(iterations, [&] {
+            for (const PrimitiveRange &range: mesh.ranges) {
+                const size_t end = range.firstVertex + range.vertexCount;
+                for (size_t i = 0; i < end; i++) {
+                    Vertex &v = mesh.vertices[i];
+                    v.bitangent = glm::cross(v.normal, v.tangent);
+                }
+            }
+            bench::do_not_optimize(mesh.vertices.data());
+        });
+
+        const bench::Timing scalar = bench::measure(iterations, [&] {
+            for (const PrimitiveRange &range: mesh.ranges) {
+                tangentspace::orthonormalize_frames_scalar(
+                    std::span(mesh.vertices).subspan(range.firstVertex, range.vertexCount),
+                    std::span<const float>(mesh.handedness).subspan(range.firstVertex, range.vertexCount));
+            }
+            bench::do_not_optimize(mesh.vertices.data());
+        });
+
+        const bench::Timing vectorized = bench::measure(iterations, [&] {
+            for (const PrimitiveRange &range: mesh.ranges) {
+                tangentspace::orthonormalize_frames(
+                    std::span(mesh.vertices).subspan(range.firstVertex, range.vertexCount),
+                    std::span<const float>(mesh.handedness).subspan(range.firstVertex, range.vertexCount));
+            }
+            bench::do_not_optimize(mesh.vertices.data());
+        });
+
+        auto generate = [&](size_t begin, size_t end) {
+            for (size_t r = begin; r < end; r++) {
+                const PrimitiveRange &range = mesh.ranges[r];
+                const std::span<Vertex> rangeVertices = std::span(mesh.vertices).subspan(range.firstVertex,
+                                                                                          range.vertexCount);
+                const std::span<float> rangeHandedness = std::span(mesh.handedness).subspan(range.firstVertex,
+                                                                                             range.vertexCount);
+                tangentspace::generate_tangents(
+                    rangeVertices, std::span<const uint32_t>(mesh.indices).subspan(range.firstIndex, range.indexCount),
+                    static_cast<uint32_t>(range.firstVertex), rangeHandedness);
+                tangentspace::orthonormalize_frames(rangeVertices, rangeHandedness);
+            }
+        };
+
+        const bench::Timing generateSerial = bench::measure(iterations, [&] {
+            mesh.vertices = pristine;
+            generate(0, mesh.ranges.size());
+        });
+
+        JobSystem jobs;
+        const bench::Timing generateParallel = bench::measure(iterations, [&] {
+            mesh.vertices = pristine;
+            jobs.parallel_for(mesh.ranges.size(), 1, generate);
+        });
+
+        bench::print_timing("legacy bitangent loop (O(V x P))", legacy);
+        bench::print_timing("orthonormalize per primitive, scalar", scalar);
+        bench::print_timing("orthonormalize per primitive, simd", vectorized);
+        bench::print_timing("generate + orthonormalize, serial", generateSerial);
+        bench::print_timing("generate + orthonormalize, job system", generateParallel);
+        printf("  job system workers: %u\n", jobs.thread_count());
+        printf("  per primitive vs legacy (median): %.1fx, simd vs scalar: %.2fx, parallel generation: %.2fx\n",
+               legacy.median / vectorized.median, scalar.median / vectorized.median,
+               generateSerial.median / generateParallel.median);
+        return 0;
+    }
+
+} // namespace
+
+REGISTER_BENCHMARK(tangents, "[primitives] [iterations]  tangent frame stage on a synthetic ~1M vertex mesh",
+                   run_tangents);
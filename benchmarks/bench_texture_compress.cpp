@@ -0,0 +1,136 @@
+#include "Benchmark.h"
+
+#include <BlockCompression.h>
+#include <CompressedTextureCache.h>
+#include <JobSystem.h>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <stb_image.h>
+
+namespace {
+
+    // photo-like stand-in when no image is given: gradients, a few hard edges and some noise
+    std::vector<uint8_t> synthetic_image(uint32_t width, uint32_t height) {
+        std::vector<uint8_t> rgba(size_t(width) * height * 4);
+        uint32_t state = 0x9e3779b9u;
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                state = state * 1664525u + 1013904223u;
+                const int noise = static_cast<int>(state >> 28) - 8;
+                const bool stripe = ((x / 37) + (y / 53)) % 2 == 0;
+                uint8_t *texel = rgba.data() + (size_t(y) * width + x) * 4;
+                texel[0] = static_cast<uint8_t>(std::clamp(int(255 * x / width) + noise, 0, 255));
+                texel[1] = static_cast<uint8_t>(std::clamp(int(255 * y / height) + noise, 0, 255));
+                texel[2] = static_cast<uint8_t>(std::clamp((stripe ? 200 : 60) + noise, 0, 255));
+                texel[3] = 255;
+            }
+        }
+        return rgba;
+    }
+
+    // peak signal to noise ratio of the first level over the channels the format keeps
+    double level_psnr(const uint8_t *rgba, uint32_t width, uint32_t height, const MipChainView &chain,
+                      uint32_t channels) {
+        const uint32_t blocksX = (width + 3) / 4;
+        const uint32_t blockSize = blockcompress::block_bytes(chain.format);
+        double sum = 0.0;
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                uint8_t decoded[64];
+                blockcompress::decode_block(chain.format, chain.data.data() + ((y / 4) * blocksX + x / 4) * blockSize,
+                                            decoded);
+                const uint8_t *texel = decoded + ((y % 4) * 4 + x % 4) * 4;
+                for (uint32_t c = 0; c < channels; c++) {
+                    const double d = double(texel[c]) - double(rgba[(size_t(y) * width + x) * 4 + c]);
+                    sum += d * d;
+                }
+            }
+        }
+        const double mse = sum / (double(width) * height * channels);
+        return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : INFINITY;
+    }
+
+    int run_texture_compress(const BenchmarkArgs &args) {
+        const int iterations = args.size() > 1 ? std::stoi(args[1]) : 5;
+        const std::filesystem::path cacheDirectory =
+            std::filesystem::temp_directory_path() / "experirender_bench_texcache";
+
+        uint32_t width = 2048;
+        uint32_t height = 2048;
+        std::vector<uint8_t> rgba;
+        if (!args.empty()) {
+            int w, h, channels;
+            stbi_uc *pixels = stbi_load(args[0].c_str(), &w, &h, &channels, 4);
+            if (!pixels) {
+                printf("failed to load %s\n", args[0].c_str());
+                return 1;
+            }
+            width = static_cast<uint32_t>(w);
+            height = static_cast<uint32_t>(h);
+            rgba.assign(pixels, pixels + size_t(width) * height * 4);
+            stbi_image_free(pixels);
+        } else {
+            rgba = synthetic_image(width, height);
+        }
+
+        JobSystem jobs;
+        std::vector<uint8_t> staging;
+        const uint64_t rgbaBytes = blockcompress::image_bytes(VK_FORMAT_R8G8B8A8_UNORM, width, height, true);
+        printf("  %s: %ux%u, %u worker threads, RGBA8 mip chain %.2f MB\n",
+               args.empty() ? "synthetic" : args[0].c_str(), width, height, jobs.thread_count(),
+               static_cast<double>(rgbaBytes) / (1024.0 * 1024.0));
+
+        struct Case {
+            const char *name;
+            VkFormat format;
+            uint32_t channels;
+        };
+        const Case cases[] = {
+            {"BC7 (color)", VK_FORMAT_BC7_UNORM_BLOCK, 4},
+            {"BC5 (normal)", VK_FORMAT_BC5_UNORM_BLOCK, 2},
+            {"BC1 (metal-rough)", VK_FORMAT_BC1_RGB_UNORM_BLOCK, 3},
+        };
+
+        for (const Case &c: cases) {
+            const uint64_t key = static_cast<uint64_t>(c.format);
+            const std::filesystem::path cachePath = CompressedTextureCache::path_for(cacheDirectory, key);
+
+            // cold: encode every level and write the cache
+            MipChain chain;
+            const bench::Timing cold = bench::measure(iterations, [&] {
+                chain = blockcompress::compress(rgba.data(), width, height, c.format, true, &jobs);
+                CompressedTextureCache::write(cachePath, key, chain.view());
+            });
+
+            // warm: map the cache and copy every level into staging memory
+            const bench::Timing warm = bench::measure(iterations, [&] {
+                CompressedTextureCache cache;
+                if (!cache.open(cachePath, key, c.format)) {
+                    printf("texture cache miss on warm run\n");
+                    return;
+                }
+                const MipChainView view = cache.view();
+                staging.resize(view.data.size());
+                memcpy(staging.data(), view.data.data(), view.data.size());
+                bench::do_not_optimize(staging.data());
+            });
+
+            printf("\n  %s: %.2f MB (%.2f MB saved), PSNR %.2f dB\n", c.name,
+                   static_cast<double>(chain.data.size()) / (1024.0 * 1024.0),
+                   static_cast<double>(rgbaBytes - chain.data.size()) / (1024.0 * 1024.0),
+                   level_psnr(rgba.data(), width, height, chain.view(), c.channels));
+            bench::print_timing("cold (encode + write)", cold);
+            bench::print_timing("warm (map + copy)", warm);
+            printf("  warm speedup (median): %.2fx\n", cold.median / warm.median);
+
+            std::error_code ec;
+            std::filesystem::remove(cachePath, ec);
+        }
+        return 0;
+    }
+
+} // namespace
+
+REGISTER_BENCHMARK(texture_compress, "[image] [iterations]  block compression cost, quality and cold vs warm cache load",
+                   run_texture_compress);
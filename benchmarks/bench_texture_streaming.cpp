@@ -0,0 +1,109 @@
+#include "Benchmark.h"
+
+#include <StreamingPolicy.h>
+
+namespace {
+
+    // BC7 layout of a square texture, 1 byte per texel with 4x4 blocks, levels back to back
+    std::vector<MipLevel> bc7_levels(uint32_t size) {
+        std::vector<MipLevel> levels;
+        uint64_t offset = 0;
+        for (uint32_t s = size;; s /= 2) {
+            const uint64_t blocks = uint64_t(std::max(1u, (s + 3) / 4));
+            levels.push_back({s, s, offset, blocks * blocks * 16});
+            offset += blocks * blocks * 16;
+            if (s == 1) {
+                break;
+            }
+        }
+        return levels;
+    }
+
+    int run_texture_streaming(const BenchmarkArgs &args) {
+        const uint32_t textureCount = args.size() > 0 ? static_cast<uint32_t>(std::stoul(args[0])) : 2000;
+        const uint32_t frames = args.size() > 1 ? static_cast<uint32_t>(std::stoul(args[1])) : 600;
+        constexpr uint32_t floorSize = 128;
+        constexpr uint32_t retainFrames = 120;
+        const streaming::Budget budget{512ull * 1024 * 1024, 16ull * 1024 * 1024};
+
+        // a scene of 2K, 1K and 4K textures, the camera walks through it and sees a window of them at a time
+        const uint32_t sizes[] = {2048, 1024, 1024, 4096};
+        std::vector<std::vector<MipLevel>> chains;
+        for (uint32_t i = 0; i < textureCount; i++) {
+            chains.push_back(bc7_levels(sizes[i % 4]));
+        }
+
+        std::vector<uint32_t> resident(textureCount);
+        std::vector<uint32_t> floors(textureCount);
+        std::vector<streaming::Demand> demand(textureCount);
+        uint64_t fullBytes = 0;
+        for (uint32_t i = 0; i < textureCount; i++) {
+            floors[i] = streaming::floor_level(chains[i], floorSize);
+            resident[i] = floors[i];
+            demand[i] = {floors[i], 0};
+            fullBytes += streaming::tail_bytes(chains[i], 0);
+        }
+
+        std::vector<double> planTimes;
+        uint64_t uploaded = 0;
+        uint64_t peakResident = 0;
+        uint32_t changes = 0;
+        std::vector<streaming::Residency> residency(textureCount);
+        for (uint32_t frame = 1; frame <= frames; frame++) {
+            const uint32_t visibleBegin = (frame * 3) % textureCount;
+            const uint32_t visibleCount = std::min(textureCount, 150u);
+
+            const auto start = std::chrono::high_resolution_clock::now();
+            for (uint32_t i = 0; i < textureCount; i++) {
+                const uint32_t distance = (i + textureCount - visibleBegin) % textureCount;
+                std::optional<uint32_t> requested;
+                if (distance < visibleCount) {
+                    // the nearest textures want level 0, further ones a level coarser per 30 textures
+                    requested = distance / 30;
+                }
+                streaming::update_demand(demand[i], requested, frame, floors[i], retainFrames);
+                residency[i] = {chains[i], resident[i], demand[i].top, floors[i]};
+            }
+            const std::vector<streaming::Change> planned = streaming::plan(residency, budget);
+            planTimes.push_back(
+                std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+
+            uint64_t residentBytes = 0;
+            for (const streaming::Change &change: planned) {
+                if (change.top < resident[change.texture]) {
+                    uploaded += streaming::tail_bytes(chains[change.texture], change.top);
+                }
+                resident[change.texture] = change.top;
+            }
+            for (uint32_t i = 0; i < textureCount; i++) {
+                residentBytes += streaming::tail_bytes(chains[i], resident[i]);
+            }
+            peakResident = std::max(peakResident, residentBytes);
+            changes += static_cast<uint32_t>(planned.size());
+        }
+
+        std::sort(planTimes.begin(), planTimes.end());
+        double sum = 0.0;
+        for (const double t: planTimes) {
+            sum += t;
+        }
+        const bench::Timing timing{planTimes.front(), planTimes[planTimes.size() / 2],
+                                   sum / static_cast<double>(planTimes.size())};
+
+        printf("  %u textures, %u frames, floor %u px, budget %.0f MB, upload %.0f MB/frame\n", textureCount, frames,
+               floorSize, static_cast<double>(budget.residentBytes) / (1024.0 * 1024.0),
+               static_cast<double>(budget.uploadBytes) / (1024.0 * 1024.0));
+        bench::print_timing("demand + plan per frame", timing);
+        printf("  fully resident: %.2f MB, peak streamed: %.2f MB\n", static_cast<double>(fullBytes) / (1024.0 * 1024.0),
+               static_cast<double>(peakResident) / (1024.0 * 1024.0));
+        printf("  residency changes: %u, staged: %.2f MB (%.2f MB/frame)\n", changes,
+               static_cast<double>(uploaded) / (1024.0 * 1024.0),
+               static_cast<double>(uploaded) / (1024.0 * 1024.0) / frames);
+        return 0;
+    }
+
+} // namespace
+
+REGISTER_BENCHMARK(texture_streaming,
+                   "[textures] [frames]  cost of the mip streaming policy and the memory it keeps for a moving camera",
+                   run_texture_streaming);
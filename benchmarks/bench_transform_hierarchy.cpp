@@ -0,0 +1,183 @@
+#include "Benchmark.h"
+
+#include <TransformHierarchy.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <memory>
+#include <random>
+
+namespace {
+
+    // the shared_ptr tree with virtual Draw the glTF scenes used to be drawn through, see Node in vk_types.h
+    struct LegacyNode {
+        virtual ~LegacyNode() = default;
+
+        std::weak_ptr<LegacyNode> parent;
+        std::vector<std::shared_ptr<LegacyNode>> children;
+        glm::mat4 localTransform;
+        glm::mat4 worldTransform;
+
+        void refreshTransform(const glm::mat4 &parentMatrix) {
+            worldTransform = parentMatrix * localTransform;
+            for (auto &child: children) {
+                child->refreshTransform(worldTransform);
+            }
+        }
+
+        virtual void Draw(const glm::mat4 &topMatrix, std::vector<glm::mat4> &out) {
+            for (auto &child: children) {
+                child->Draw(topMatrix, out);
+            }
+        }
+    };
+
+    struct LegacyMeshNode final : LegacyNode {
+        void Draw(const glm::mat4 &topMatrix, std::vector<glm::mat4> &out) override {
+            out.push_back(topMatrix * worldTransform);
+            LegacyNode::Draw(topMatrix, out);
+        }
+    };
+
+    struct SyntheticScene {
+        std::vector<glm::mat4> locals;
+        std::vector<std::vector<uint32_t>> children;
+        std::vector<uint8_t> hasMesh;
+    };
+
+    // random recursive tree, a few roots, about a dozen levels deep at 100k nodes, every other node has a mesh
+    SyntheticScene make_scene(uint32_t count) {
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<float> offset(-2.f, 2.f);
+        std::uniform_real_distribution<float> angle(0.f, 6.28f);
+
+        SyntheticScene scene;
+        scene.locals.resize(count);
+        scene.children.resize(count);
+        scene.hasMesh.resize(count);
+        for (uint32_t i = 0; i < count; i++) {
+            glm::mat4 local = glm::translate(glm::mat4(1.f), glm::vec3(offset(rng), offset(rng), offset(rng)));
+            scene.locals[i] = glm::rotate(local, angle(rng), glm::vec3(0.f, 1.f, 0.f));
+            scene.hasMesh[i] = i % 2;
+            if (i >= 8) {
+                scene.children[rng() % i].push_back(i);
+            }
+        }
+        return scene;
+    }
+
+    int run_transform_hierarchy(const BenchmarkArgs &args) {
+        const uint32_t count = args.size() > 0 ? static_cast<uint32_t>(std::stoul(args[0])) : 100'000;
+        const int iterations = args.size() > 1 ? std::stoi(args[1]) : 20;
+        const SyntheticScene scene = make_scene(count);
+        // 1% of the nodes change their local transform every frame in the animated runs. they are taken from the
+        // later half of the tree, where nodes sit near the leaves like animated props do, a node near a root
+        // would drag most of the scene along
+        std::vector<uint32_t> animated;
+        for (uint32_t i = count / 2; i < count; i += 50) {
+            animated.push_back(i);
+        }
+
+        const glm::mat4 placement = glm::translate(glm::mat4(1.f), glm::vec3(1.f, 2.f, 3.f));
+        std::vector<glm::mat4> out;
+        out.reserve(count);
+
+        // legacy tree, built like the loader built it
+        std::vector<std::shared_ptr<LegacyNode>> nodes(count);
+        for (uint32_t i = 0; i < count; i++) {
+            nodes[i] = scene.hasMesh[i] ? std::make_shared<LegacyMeshNode>() : std::make_shared<LegacyNode>();
+            nodes[i]->localTransform = scene.locals[i];
+        }
+        std::vector<std::shared_ptr<LegacyNode>> topNodes;
+        for (uint32_t i = 0; i < count; i++) {
+            for (const uint32_t c: scene.children[i]) {
+                nodes[i]->children.push_back(nodes[c]);
+                nodes[c]->parent = nodes[i];
+            }
+        }
+        for (auto &node: nodes) {
+            if (node->parent.expired()) {
+                topNodes.push_back(node);
+                node->refreshTransform(glm::mat4{1.f});
+            }
+        }
+
+        TransformHierarchy hierarchy;
+        const bench::Timing build = bench::measure(iterations, [&] {
+            hierarchy.build(scene.locals, scene.children);
+            bench::do_not_optimize(hierarchy.size());
+        });
+        std::vector<uint32_t> meshNodes;
+        for (uint32_t i = 0; i < hierarchy.size(); i++) {
+            if (scene.hasMesh[hierarchy.source_index(i)]) {
+                meshNodes.push_back(i);
+            }
+        }
+        hierarchy.update();
+        printf("  %u nodes, %u roots, %zu meshes\n", hierarchy.size(), hierarchy.root_count(), meshNodes.size());
+
+        auto legacyDraw = [&] {
+            out.clear();
+            for (auto &node: topNodes) {
+                node->Draw(placement, out);
+            }
+            bench::do_not_optimize(out.data());
+        };
+        auto flatDraw = [&](const glm::mat4 &root) {
+            hierarchy.set_root(root);
+            hierarchy.update();
+            out.clear();
+            for (const uint32_t node: meshNodes) {
+                out.push_back(hierarchy.world(node));
+            }
+            bench::do_not_optimize(out.data());
+        };
+
+        const bench::Timing legacyStatic = bench::measure(iterations, legacyDraw);
+        const bench::Timing flatStatic = bench::measure(iterations, [&] { flatDraw(placement); });
+
+        int frame = 0;
+        const bench::Timing legacyAnimated = bench::measure(iterations, [&] {
+            frame++;
+            for (const uint32_t i: animated) {
+                nodes[i]->localTransform[3].x = static_cast<float>(frame);
+            }
+            for (auto &node: topNodes) {
+                node->refreshTransform(glm::mat4{1.f});
+            }
+            legacyDraw();
+        });
+        const bench::Timing flatAnimated = bench::measure(iterations, [&] {
+            frame++;
+            for (const uint32_t i: animated) {
+                glm::mat4 local = hierarchy.local(hierarchy.flat_index(i));
+                local[3].x = static_cast<float>(frame);
+                hierarchy.set_local(hierarchy.flat_index(i), local);
+            }
+            flatDraw(placement);
+        });
+        // what one animated frame recomputed
+        for (const uint32_t i: animated) {
+            hierarchy.set_local(hierarchy.flat_index(i), hierarchy.local(hierarchy.flat_index(i)));
+        }
+        const uint32_t updated = hierarchy.update();
+
+        const bench::Timing flatMoved = bench::measure(iterations, [&] {
+            frame++;
+            flatDraw(glm::translate(placement, glm::vec3(static_cast<float>(frame), 0.f, 0.f)));
+        });
+
+        bench::print_timing("flatten (load time)", build);
+        bench::print_timing("static, node tree Draw", legacyStatic);
+        bench::print_timing("static, flat sweep", flatStatic);
+        bench::print_timing("1% animated, refresh + node tree Draw", legacyAnimated);
+        bench::print_timing("1% animated, dirty subtrees + sweep", flatAnimated);
+        bench::print_timing("scene moved, every node + sweep", flatMoved);
+        printf("  animated frame recomputes %u of %u nodes, static speedup %.1fx, animated speedup %.1fx\n", updated,
+               hierarchy.size(), legacyStatic.median / flatStatic.median,
+               legacyAnimated.median / flatAnimated.median);
+        return 0;
+    }
+
+} // namespace
+
+REGISTER_BENCHMARK(transform_hierarchy, "[nodes] [iterations]  per frame scene update on a 100k node hierarchy",
+                   run_transform_hierarchy);
@@ -0,0 +1,156 @@
+#include "Benchmark.h"
+
+#include <MeshOptimize.h>
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vk_loader.h>
+
+namespace {
+
+    // vertex/index range of one surface, the loader lays primitives out back to back inside their mesh
+    struct SurfaceRange {
+        MeshGeometry *mesh;
+        uint32_t firstVertex;
+        uint32_t vertexCount;
+        uint32_t firstIndex;
+        uint32_t indexCount;
+    };
+
+    // `count` grids of side x side vertices with their triangles shuffled, roughly what an exporter that
+    // ignores the vertex cache produces
+    std::vector<MeshGeometry> make_shuffled_grids(size_t count, uint32_t side) {
+        std::vector<MeshGeometry> meshes(count);
+        std::mt19937 rng(11);
+
+        for (MeshGeometry &mesh: meshes) {
+            for (uint32_t y = 0; y < side; y++) {
+                for (uint32_t x = 0; x < side; x++) {
+                    Vertex v{};
+                    v.position = glm::vec3(static_cast<float>(x), 0.f, static_cast<float>(y));
+                    v.normal = glm::vec3(0.f, 1.f, 0.f);
+                    mesh.vertices.push_back(v);
+                }
+            }
+
+            std::vector<std::array<uint32_t, 3>> triangles;
+            for (uint32_t y = 0; y + 1 < side; y++) {
+                for (uint32_t x = 0; x + 1 < side; x++) {
+                    const uint32_t i0 = y * side + x;
+                    triangles.push_back({i0, i0 + side, i0 + 1});
+                    triangles.push_back({i0 + 1, i0 + side, i0 + side + 1});
+                }
+            }
+            std::shuffle(triangles.begin(), triangles.end(), rng);
+            for (const auto &t: triangles) {
+                mesh.indices.insert(mesh.indices.end(), t.begin(), t.end());
+            }
+
+            SurfaceGeometry surface{};
+            surface.count = static_cast<uint32_t>(mesh.indices.size());
+            mesh.surfaces.push_back(surface);
+        }
+        return meshes;
+    }
+
+    std::vector<SurfaceRange> collect_ranges(std::vector<MeshGeometry> &meshes) {
+        std::vector<SurfaceRange> ranges;
+        for (MeshGeometry &mesh: meshes) {
+            for (const SurfaceGeometry &surface: mesh.surfaces) {
+                if (surface.count == 0) {
+                    continue;
+                }
+                const auto first = mesh.indices.begin() + surface.startIndex;
+                const auto [lo, hi] = std::minmax_element(first, first + surface.count);
+                ranges.push_back(SurfaceRange{&mesh, *lo, *hi - *lo + 1, surface.startIndex, surface.count});
+            }
+        }
+        return ranges;
+    }
+
+    meshoptimize::VertexCacheStats analyze(const std::vector<SurfaceRange> &ranges) {
+        // triangle and vertex weighted over every surface
+        double transformed = 0.0;
+        double triangles = 0.0;
+        double vertices = 0.0;
+        for (const SurfaceRange &range: ranges) {
+            const std::span<const uint32_t> indices(range.mesh->indices.data() + range.firstIndex, range.indexCount);
+            const meshoptimize::VertexCacheStats stats =
+                meshoptimize::analyze_vertex_cache(indices, range.vertexCount, range.firstVertex);
+            const double surfaceTransformed = static_cast<double>(stats.acmr) * (range.indexCount / 3);
+            transformed += surfaceTransformed;
+            triangles += range.indexCount / 3;
+            vertices += stats.atvr > 0.f ? surfaceTransformed / stats.atvr : 0.0;
+        }
+        return {static_cast<float>(transformed / std::max(triangles, 1.0)),
+                static_cast<float>(transformed / std::max(vertices, 1.0))};
+    }
+
+    int run_vertex_cache(const BenchmarkArgs &args) {
+        const int iterations = args.size() > 1 ? std::stoi(args[1]) : 5;
+
+        std::vector<MeshGeometry> source;
+        if (!args.empty()) {
+            // the loader's own pass is what we are measuring, so take the geometry without it
+            std::optional<std::vector<MeshGeometry>> geometry = loadGltfGeometry(args[0], nullptr, false, false);
+            if (!geometry.has_value()) {
+                printf("failed to parse %s\n", args[0].c_str());
+                return 1;
+            }
+            source = std::move(*geometry);
+        } else {
+            source = make_shuffled_grids(64, 128);
+        }
+
+        std::vector<MeshGeometry> meshes = source;
+        std::vector<SurfaceRange> ranges = collect_ranges(meshes);
+        size_t triangleCount = 0;
+        for (const SurfaceRange &range: ranges) {
+            triangleCount += range.indexCount / 3;
+        }
+        printf("  %s: %zu surfaces, %zu triangles\n", args.empty() ? "synthetic shuffled grids" : args[0].c_str(),
+               ranges.size(), triangleCount);
+
+        const meshoptimize::VertexCacheStats before = analyze(ranges);
+
+        // timings include restoring the source geometry before every iteration
+        auto run_pass = [&](auto &&pass) {
+            return bench::measure(iterations, [&] {
+                meshes = source;
+                for (const SurfaceRange &range: ranges) {
+                    const std::span<uint32_t> indices(range.mesh->indices.data() + range.firstIndex,
+                                                      range.indexCount);
+                    const std::span<Vertex> vertices(range.mesh->vertices.data() + range.firstVertex,
+                                                     range.vertexCount);
+                    pass(indices, vertices, range.firstVertex);
+                }
+                bench::do_not_optimize(meshes.data());
+            });
+        };
+
+        const bench::Timing cacheTiming = run_pass([](std::span<uint32_t> indices, std::span<Vertex> vertices,
+                                                      uint32_t baseVertex) {
+            meshoptimize::optimize_vertex_cache(indices, vertices.size(), baseVertex);
+        });
+        const meshoptimize::VertexCacheStats cacheOnly = analyze(ranges);
+
+        const bench::Timing fullTiming = run_pass(meshoptimize::optimize_surface);
+        const meshoptimize::VertexCacheStats full = analyze(ranges);
+
+        bench::print_timing("vertex cache (tipsify)", cacheTiming);
+        bench::print_timing("cache + overdraw + fetch", fullTiming);
+        printf("  FIFO %u:   ACMR %.3f -> %.3f (cache only %.3f)   ATVR %.3f -> %.3f (cache only %.3f)\n",
+               meshoptimize::CACHE_SIZE, before.acmr, full.acmr, cacheOnly.acmr, before.atvr, full.atvr,
+               cacheOnly.atvr);
+        printf("  %.3f us per surface, %.1f M triangles/s\n",
+               fullTiming.median * 1000.0 / static_cast<double>(std::max<size_t>(ranges.size(), 1)),
+               static_cast<double>(triangleCount) / (fullTiming.median * 1000.0));
+        return 0;
+    }
+
+} // namespace
+
+REGISTER_BENCHMARK(vertex_cache,
+                   "[file.gltf|glb] [iterations]  ACMR/ATVR before and after the loader's mesh optimizer, "
+                   "shuffled grids without a file",
+                   run_vertex_cache);
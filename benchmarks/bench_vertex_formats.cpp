@@ -0,0 +1,59 @@
+#include "Benchmark.h"
+
+#include <VertexPacking.h>
+#include <vk_loader.h>
+
+namespace {
+
+    int run_vertex_formats(const BenchmarkArgs &args) {
+        if (args.empty()) {
+            printf("missing glTF path\n");
+            return 1;
+        }
+
+        const std::string &gltfPath = args[0];
+        const int iterations = args.size() > 1 ? std::stoi(args[1]) : 5;
+
+        const std::optional<std::vector<MeshGeometry>> geometry = loadGltfGeometry(gltfPath);
+        if (!geometry.has_value()) {
+            printf("failed to parse %s\n", gltfPath.c_str());
+            return 1;
+        }
+
+        size_t vertexCount = 0;
+        for (const MeshGeometry &mesh: *geometry) {
+            vertexCount += mesh.vertices.size();
+        }
+        printf("  %s: %zu meshes, %zu vertices\n", gltfPath.c_str(), geometry->size(), vertexCount);
+
+        const double fullBytes = static_cast<double>(vertexCount * sizeof(Vertex));
+        const VertexFormat formats[] = {VertexFormat::Full, VertexFormat::Packed, VertexFormat::PackedQuantized};
+        for (const VertexFormat format: formats) {
+            // same per mesh choice the loader makes, tiled UVs keep full precision
+            size_t bytes = 0;
+            size_t fallbacks = 0;
+            std::vector<std::byte> packed;
+            const bench::Timing timing = bench::measure(iterations, [&] {
+                bytes = 0;
+                fallbacks = 0;
+                for (const MeshGeometry &mesh: *geometry) {
+                    const VertexFormat meshFormat = vertexpacking::select_format(mesh.vertices, format);
+                    fallbacks += meshFormat != format ? 1 : 0;
+                    vertexpacking::pack_vertices(mesh.vertices, meshFormat, packed);
+                    bytes += packed.size();
+                    bench::do_not_optimize(packed.data());
+                }
+            });
+
+            printf("  %-40s %8.2f MB  (%5.1f%% of full, %zu meshes kept full precision)\n",
+                   vertexpacking::name(format), static_cast<double>(bytes) / (1024.0 * 1024.0),
+                   100.0 * static_cast<double>(bytes) / fullBytes, fallbacks);
+            bench::print_timing("pack", timing);
+        }
+        return 0;
+    }
+
+} // namespace
+
+REGISTER_BENCHMARK(vertex_formats, "<file.gltf|glb> [iterations]  vertex memory and packing time per vertex format",
+                   run_vertex_formats);
@@ -0,0 +1,56 @@
+#include "Benchmark.h"
+
+#include <JobSystem.h>
+#include <vk_loader.h>
+
+namespace {
+
+    int run_vertex_weld(const BenchmarkArgs &args) {
+        if (args.empty()) {
+            printf("missing glTF path\n");
+            return 1;
+        }
+        const std::string &gltfPath = args[0];
+        const float epsilon = args.size() > 1 ? std::stof(args[1]) : 1e-4f;
+        const int iterations = args.size() > 2 ? std::stoi(args[2]) : 3;
+
+        struct Mode {
+            const char *name;
+            bool weld;
+            float epsilon;
+        };
+        const Mode modes[] = {{"no welding", false, 0.f}, {"exact", true, 0.f}, {"within epsilon", true, epsilon}};
+
+        // the loader's job system, so the weld stage runs across primitives like it does in a real load
+        JobSystem jobs;
+        printf("  %s, epsilon %g\n", gltfPath.c_str(), static_cast<double>(epsilon));
+        for (const Mode &mode: modes) {
+            size_t sourceVertices = 0;
+            size_t vertices = 0;
+            const bench::Timing timing = bench::measure(iterations, [&] {
+                // no reordering or LODs, so welding is the only pass on top of the accessor walk
+                const std::optional<std::vector<MeshGeometry>> geometry =
+                    loadGltfGeometry(gltfPath, &jobs, false, false, true, mode.weld, mode.epsilon);
+                sourceVertices = 0;
+                vertices = 0;
+                if (geometry.has_value()) {
+                    for (const MeshGeometry &mesh: *geometry) {
+                        sourceVertices += mesh.sourceVertexCount;
+                        vertices += mesh.vertices.size();
+                    }
+                }
+            });
+
+            printf("\n  %s\n", mode.name);
+            bench::print_timing("parse + accessor walk + weld", timing);
+            printf("  %zu of %zu vertices (%.1f%%)\n", vertices, sourceVertices,
+                   sourceVertices > 0 ? 100.0 * static_cast<double>(vertices) / static_cast<double>(sourceVertices)
+                                      : 0.0);
+        }
+        return 0;
+    }
+
+} // namespace
+
+REGISTER_BENCHMARK(vertex_weld, "<file.gltf|glb> [epsilon] [iterations]  vertices left and load time with welding",
+                   run_vertex_weld);
@@ -4,32 +4,22 @@
 #extension GL_EXT_buffer_reference : require
 
 #include "input_structures.glsl"
-
-struct Vertex {
-
-	vec3 position;
-	float uv_x;
-	vec3 normal;
-	float uv_y;
-	vec4 color;
-	vec3 tangent;
-	vec3 bitangent;
-}; 
-
-layout(buffer_reference, std430) readonly buffer VertexBuffer{ 
-	Vertex vertices[];
-};
+#include "vertex_fetch.glsl"
 
 //push constants block
 layout( push_constant ) uniform constants
 {
 	mat4 render_matrix;
 	VertexBuffer vertexBuffer;
+	uint vertexFormat;
+	vec4 positionScale;
+	vec4 positionOffset;
 } PushConstants;
 
 void main() 
 {
-    Vertex v = PushConstants.vertexBuffer.vertices[gl_VertexIndex];
+    VertexData v = fetch_vertex(PushConstants.vertexBuffer, PushConstants.vertexFormat, PushConstants.positionScale.xyz,
+                                PushConstants.positionOffset.xyz, uint(gl_VertexIndex));
 
 	vec4 position = vec4(v.position, 1.0f);
 
@@ -0,0 +1,26 @@
+// Triangle indices for the hit shaders. A surface stores them as 16 or 32 bit (ObjDesc::indexType) and rebased on
+// its first vertex, see IndexPacking.h. Needs GL_EXT_buffer_reference and 64 bit integers.
+
+#define INDEX_TYPE_UINT32 0
+#define INDEX_TYPE_UINT16 1
+
+// 16 bit indices are read as halves of the words holding them, index blocks start 4 byte aligned
+layout(buffer_reference, std430, buffer_reference_align = 4) readonly buffer IndexWords {
+	uint words[];
+};
+
+// vertices of triangle `primitive` of a surface whose indices start `firstIndex` indices past `indexAddress`
+uvec3 fetch_triangle(uint64_t indexAddress, uint firstIndex, uint indexType, int vertexOffset, uint primitive) {
+	IndexWords indices = IndexWords(indexAddress);
+	uint first = firstIndex + primitive * 3u;
+	uvec3 ind;
+	if (indexType == INDEX_TYPE_UINT16) {
+		for (uint c = 0u; c < 3u; c++) {
+			uint i = first + c;
+			ind[c] = (indices.words[i >> 1u] >> ((i & 1u) * 16u)) & 0xFFFFu;
+		}
+	} else {
+		ind = uvec3(indices.words[first], indices.words[first + 1u], indices.words[first + 2u]);
+	}
+	return ind + uvec3(vertexOffset);
+}
@@ -13,6 +13,8 @@ layout(set = 0, binding = 0) uniform  SceneData{
 	int enableShadows;
 	int enableSSAO;
 	int enablePBR;
+	uvec2 textureFeedback; // TextureStreamer feedback buffer address, 0 when nothing records it
+	uint textureFeedbackFrame;
 } sceneData;
 
 layout(set = 1, binding = 0) uniform GLTFMaterialData{   
@@ -20,6 +22,14 @@ layout(set = 1, binding = 0) uniform GLTFMaterialData{
 	vec4 colorFactors;
 	vec4 metal_rough_factors;
 	int hasMetalRoughTex;
+	float transmissionFactor;
+	int hasTransmissionTex;
+	float ior;
+	int hasEmissiveTex;
+	// feedback slots of the streamed textures, -1 when not streamed
+	int colorFeedbackSlot;
+	int metalRoughFeedbackSlot;
+	int normalFeedbackSlot;
 	
 } materialData;
 
@@ -1,6 +1,8 @@
 #version 450
 
 #extension GL_GOOGLE_include_directive : require
+#extension GL_EXT_buffer_reference : require
+#extension GL_EXT_buffer_reference_uvec2 : require
 #include "input_structures.glsl"
 #include "PBRMetallicRoughness.glsl"
 
@@ -26,6 +28,13 @@ layout (location = 0) out vec4 outFragColor;
 
 struct Empty{ float e; };
 
+// level every streamed texture was sampled at, one uint per TextureStreamer slot. levels are stored plus
+// FEEDBACK_BIAS so levels finer than the bound mip tail still fit an unsigned atomicMin (streaming::FEEDBACK_BIAS)
+layout(buffer_reference, std430) buffer TextureFeedback {
+	uint requestedLevel[];
+};
+const float FEEDBACK_BIAS = 16.0f;
+
 const float shadowFactor = 1.0f;
 
 layout( push_constant ) uniform constants
@@ -116,8 +125,10 @@ vec3 pbr() {
 	vec4 normalFromTex = texture(normalTex, inUV);
 	// Check if this is the default grey texture (0.66, 0.66, 0.66)
 	if (length(normalFromTex.rgb - vec3(0.66)) > 0.1) {
-		vec3 normFromTex = normalFromTex.xyz;
-		normFromTex = normFromTex * 2.0f - 1.0f;
+		// BC5 normal maps only store xy, rebuild z from the unit length
+		vec3 normFromTex;
+		normFromTex.xy = normalFromTex.xy * 2.0f - 1.0f;
+		normFromTex.z = sqrt(max(1.0f - dot(normFromTex.xy, normFromTex.xy), 0.0f));
 
 		vec3 tangent = normalize(inTangent);
 		vec3 bitangent = normalize(inBitangent);
@@ -211,8 +222,10 @@ vec3 blinnPhong() {
 	vec4 normalFromTex = texture(normalTex, inUV);
 	// Check if this is the default grey texture (0.66, 0.66, 0.66)
 	if (length(normalFromTex.rgb - vec3(0.66)) > 0.1) {
-		vec3 normFromTex = normalFromTex.xyz;
-		normFromTex = normFromTex * 2.0f - 1.0f;
+		// BC5 normal maps only store xy, rebuild z from the unit length
+		vec3 normFromTex;
+		normFromTex.xy = normalFromTex.xy * 2.0f - 1.0f;
+		normFromTex.z = sqrt(max(1.0f - dot(normFromTex.xy, normFromTex.xy), 0.0f));
 
 		vec3 tangent = normalize(inTangent);
 		vec3 bitangent = normalize(inBitangent);
@@ -252,6 +265,30 @@ vec3 blinnPhong() {
 	return lighting;
 }
 
+void write_feedback(TextureFeedback feedback, int slot, float lod) {
+	if (slot >= 0) {
+		atomicMin(feedback.requestedLevel[slot], uint(clamp(floor(lod) + FEEDBACK_BIAS, 0.0f, 31.0f)));
+	}
+}
+
+// one pixel of every 4x4 block reports, a different one each frame
+void texture_feedback() {
+	// implicit derivatives need the whole quad, so the levels are queried before the per pixel branch. x is the
+	// unclamped lod, y would stop at the bound tail's level 0 and never ask for finer levels
+	float colorLod = textureQueryLod(colorTex, inUV).x;
+	float metalRoughLod = textureQueryLod(metalRoughTex, inUV).x;
+	float normalLod = textureQueryLod(normalTex, inUV).x;
+
+	uvec2 pixel = uvec2(gl_FragCoord.xy) & 3u;
+	if (sceneData.textureFeedback == uvec2(0) || (pixel.x | (pixel.y << 2)) != (sceneData.textureFeedbackFrame & 15u)) {
+		return;
+	}
+	TextureFeedback feedback = TextureFeedback(sceneData.textureFeedback);
+	write_feedback(feedback, materialData.colorFeedbackSlot, colorLod);
+	write_feedback(feedback, materialData.metalRoughFeedbackSlot, metalRoughLod);
+	write_feedback(feedback, materialData.normalFeedbackSlot, normalLod);
+}
+
 void crashMethod2() {
     vec3 color = texture(colorTex, inUV).rgb;
     
@@ -270,6 +307,8 @@ void main() {
 
 	//crashMethod2(); // Uncomment to test infinite loop crash
 
+	texture_feedback();
+
 	vec3 color = vec3(0.0f, 0.0f, 0.0f);
 	float alpha = texture(colorTex, inUV).a;
     
@@ -5,6 +5,7 @@
 
 
 #include "input_structures.glsl"
+#include "vertex_fetch.glsl"
 
 layout (location = 0) out vec3 outNormal;
 layout (location = 1) out vec3 outColor;
@@ -14,30 +15,19 @@ layout (location = 4) out vec3 outTangent;
 layout (location = 5) out vec3 outBitangent;
 layout (location = 6) out vec4 outFragPosLightSpace;
 
-struct Vertex {
-
-	vec3 position;
-	float uv_x;
-	vec3 normal;
-	float uv_y;
-	vec4 color;
-	vec3 tangent;
-	vec3 bitangent;
-}; 
-
-layout(buffer_reference, std430) readonly buffer VertexBuffer{ 
-	Vertex vertices[];
-};
-
 layout( push_constant ) uniform constants
 {
 	mat4 render_matrix;
 	VertexBuffer vertexBuffer;
+	uint vertexFormat;
+	vec4 positionScale;
+	vec4 positionOffset;
 } PushConstants;
 
 void main() 
 {
-	Vertex v = PushConstants.vertexBuffer.vertices[gl_VertexIndex];
+	VertexData v = fetch_vertex(PushConstants.vertexBuffer, PushConstants.vertexFormat, PushConstants.positionScale.xyz,
+							  PushConstants.positionOffset.xyz, uint(gl_VertexIndex));
 	
 	vec4 position = vec4(v.position, 1.0f);
 
@@ -51,8 +41,7 @@ void main()
 
 	outNormal = (invTransposeRenderMatrix * vec4(v.normal, 0.f)).xyz;
 	outColor = v.color.xyz * materialData.colorFactors.xyz;	
-	outUV.x = v.uv_x;
-	outUV.y = v.uv_y;
+	outUV = v.uv;
 	outTangent = (invTransposeRenderMatrix * vec4(v.tangent, 0.f)).xyz;
 	outBitangent = (invTransposeRenderMatrix * vec4(v.bitangent, 0.f)).xyz;
 
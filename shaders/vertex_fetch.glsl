@@ -0,0 +1,109 @@
+// Vertex layouts the loader can upload (VertexFormat in Vertex.h) and their decoding into one struct.
+// Needs GL_EXT_buffer_reference.
+
+#define VERTEX_FORMAT_FULL 0
+#define VERTEX_FORMAT_PACKED 1
+#define VERTEX_FORMAT_PACKED_QUANTIZED 2
+
+// 80 bytes, full precision
+struct Vertex {
+
+	vec3 position;
+	float uv_x;
+	vec3 normal;
+	float uv_y;
+	vec4 color;
+	vec3 tangent;
+	vec3 bitangent;
+};
+
+// 32 bytes: octahedral normal/tangent as 2x snorm16, bit 0 of tangent is the bitangent sign,
+// half float uv, rgba8 color
+struct PackedVertex {
+
+	vec3 position;
+	uint normal;
+	uint tangent;
+	uint uv;
+	uint color;
+	uint padding;
+};
+
+// 24 bytes: PackedVertex with the position as snorm16x4 inside the mesh bounds
+struct QuantizedVertex {
+
+	uint positionXY;
+	uint positionZW;
+	uint normal;
+	uint tangent;
+	uint uv;
+	uint color;
+};
+
+layout(buffer_reference, std430) readonly buffer VertexBuffer{
+	Vertex vertices[];
+};
+
+layout(buffer_reference, std430) readonly buffer PackedVertexBuffer{
+	PackedVertex vertices[];
+};
+
+layout(buffer_reference, std430) readonly buffer QuantizedVertexBuffer{
+	QuantizedVertex vertices[];
+};
+
+struct VertexData {
+	vec3 position;
+	vec3 normal;
+	vec2 uv;
+	vec4 color;
+	vec3 tangent;
+	vec3 bitangent;
+};
+
+vec3 oct_decode(vec2 e)
+{
+	vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-v.z, 0.0);
+	v.x += v.x >= 0.0 ? -t : t;
+	v.y += v.y >= 0.0 ? -t : t;
+	return normalize(v);
+}
+
+void decode_frame(uint normal, uint tangent, inout VertexData v)
+{
+	v.normal = oct_decode(unpackSnorm2x16(normal));
+	v.tangent = oct_decode(unpackSnorm2x16(tangent & ~1u));
+	v.bitangent = cross(v.normal, v.tangent) * ((tangent & 1u) != 0u ? -1.0 : 1.0);
+}
+
+// positionScale/positionOffset only matter for VERTEX_FORMAT_PACKED_QUANTIZED
+VertexData fetch_vertex(VertexBuffer buffer, uint format, vec3 positionScale, vec3 positionOffset, uint index)
+{
+	VertexData v;
+
+	if (format == VERTEX_FORMAT_PACKED) {
+		PackedVertex p = PackedVertexBuffer(buffer).vertices[index];
+		v.position = p.position;
+		decode_frame(p.normal, p.tangent, v);
+		v.uv = unpackHalf2x16(p.uv);
+		v.color = unpackUnorm4x8(p.color);
+	} else if (format == VERTEX_FORMAT_PACKED_QUANTIZED) {
+		QuantizedVertex q = QuantizedVertexBuffer(buffer).vertices[index];
+		vec3 snorm = vec3(unpackSnorm2x16(q.positionXY), unpackSnorm2x16(q.positionZW).x);
+		v.position = positionOffset + snorm * positionScale;
+		decode_frame(q.normal, q.tangent, v);
+		v.uv = unpackHalf2x16(q.uv);
+		v.color = unpackUnorm4x8(q.color);
+	} else {
+		Vertex f = buffer.vertices[index];
+		v.position = f.position;
+		v.normal = f.normal;
+		v.uv = vec2(f.uv_x, f.uv_y);
+		v.color = f.color;
+		v.tangent = f.tangent;
+		v.bitangent = f.bitangent;
+	}
+
+	return v;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Vertex.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Procedural geometry shared by the mesh processing tests. Indices are mesh relative like the loader's: the
+// grid's vertices start at mesh vertex `baseVertex`.
+namespace testmesh {
+
+    struct Grid {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+    };
+
+    // side x side vertex grid in the XY plane facing +Z, `spacing` apart and bulged towards +Z by `bend`
+    inline Grid make_grid(uint32_t side, uint32_t baseVertex, float spacing = 1.f, float bend = 0.f) {
+        Grid grid;
+        for (uint32_t y = 0; y < side; y++) {
+            for (uint32_t x = 0; x < side; x++) {
+                const float fx = static_cast<float>(x) / static_cast<float>(side - 1);
+                const float fy = static_cast<float>(y) / static_cast<float>(side - 1);
+                Vertex v{};
+                v.position = glm::vec3(static_cast<float>(x) * spacing, static_cast<float>(y) * spacing,
+                                       bend * std::sin(fx * 3.14159265f) * std::sin(fy * 3.14159265f));
+                grid.vertices.push_back(v);
+            }
+        }
+        for (uint32_t y = 0; y + 1 < side; y++) {
+            for (uint32_t x = 0; x + 1 < side; x++) {
+                const uint32_t i0 = baseVertex + y * side + x;
+                grid.indices.insert(grid.indices.end(), {i0, i0 + 1, i0 + side, i0 + 1, i0 + side + 1, i0 + side});
+            }
+        }
+        return grid;
+    }
+
+    // the same grid spanning the unit square
+    inline Grid make_unit_grid(uint32_t side, uint32_t baseVertex, float bend = 0.f) {
+        return make_grid(side, baseVertex, 1.f / static_cast<float>(side - 1), bend);
+    }
+
+    // reorders the triangles like a badly exported mesh, each keeps its winding
+    inline void shuffle_triangles(Grid &grid, uint32_t seed) {
+        std::vector<std::array<uint32_t, 3>> triangles;
+        for (size_t i = 0; i + 2 < grid.indices.size(); i += 3) {
+            triangles.push_back({grid.indices[i], grid.indices[i + 1], grid.indices[i + 2]});
+        }
+        std::shuffle(triangles.begin(), triangles.end(), std::mt19937(seed));
+        grid.indices.clear();
+        for (const auto &t: triangles) {
+            grid.indices.insert(grid.indices.end(), t.begin(), t.end());
+        }
+    }
+
+} // namespace testmesh
@@ -0,0 +1,155 @@
+#include <BlockCompression.h>
+#include <JobSystem.h>
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace {
+    // smooth gradients with a little noise, roughly what photo textures look like inside a block
+    std::vector<uint8_t> test_image(uint32_t width, uint32_t height, uint32_t seed = 7) {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> noise(-6, 6);
+        std::vector<uint8_t> rgba(size_t(width) * height * 4);
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                uint8_t *texel = rgba.data() + (size_t(y) * width + x) * 4;
+                texel[0] = static_cast<uint8_t>(std::clamp(int(255 * x / width) + noise(rng), 0, 255));
+                texel[1] = static_cast<uint8_t>(std::clamp(int(255 * y / height) + noise(rng), 0, 255));
+                texel[2] = static_cast<uint8_t>(std::clamp(128 + noise(rng), 0, 255));
+                texel[3] = static_cast<uint8_t>(255 - 255 * x / width);
+            }
+        }
+        return rgba;
+    }
+
+    // root mean square error over the given channels of the first level, decoded block by block
+    double level_rmse(const std::vector<uint8_t> &rgba, uint32_t width, uint32_t height, const MipChain &chain,
+                      uint32_t channels) {
+        const uint32_t blocksX = (width + 3) / 4;
+        const uint32_t blockSize = blockcompress::block_bytes(chain.format);
+        double sum = 0.0;
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                uint8_t decoded[64];
+                blockcompress::decode_block(chain.format, chain.data.data() + ((y / 4) * blocksX + x / 4) * blockSize,
+                                            decoded);
+                const uint8_t *texel = decoded + ((y % 4) * 4 + x % 4) * 4;
+                for (uint32_t c = 0; c < channels; c++) {
+                    const double d = double(texel[c]) - double(rgba[(size_t(y) * width + x) * 4 + c]);
+                    sum += d * d;
+                }
+            }
+        }
+        return std::sqrt(sum / (double(width) * height * channels));
+    }
+} // namespace
+
+TEST(BlockCompressionTest, FormatsFollowTheMaterialUsage) {
+    EXPECT_EQ(blockcompress::format_for(blockcompress::TextureUsage::Color), VK_FORMAT_BC7_UNORM_BLOCK);
+    EXPECT_EQ(blockcompress::format_for(blockcompress::TextureUsage::Normal), VK_FORMAT_BC5_UNORM_BLOCK);
+    EXPECT_EQ(blockcompress::format_for(blockcompress::TextureUsage::MetalRough), VK_FORMAT_BC1_RGB_UNORM_BLOCK);
+    EXPECT_FALSE(blockcompress::is_block_compressed(VK_FORMAT_R8G8B8A8_UNORM));
+}
+
+TEST(BlockCompressionTest, SizesMatchTheBlockLayout) {
+    EXPECT_EQ(blockcompress::mip_count(1024, 512), 11u);
+    EXPECT_EQ(blockcompress::mip_count(1, 1), 1u);
+
+    // partial blocks still take a whole block
+    EXPECT_EQ(blockcompress::level_bytes(VK_FORMAT_BC1_RGB_UNORM_BLOCK, 5, 5), 4u * 8u);
+    EXPECT_EQ(blockcompress::level_bytes(VK_FORMAT_BC7_UNORM_BLOCK, 1, 1), 16u);
+    EXPECT_EQ(blockcompress::level_bytes(VK_FORMAT_R8G8B8A8_UNORM, 4, 4), 64u);
+
+    // BC7 is a quarter of RGBA8, BC1 an eighth
+    const uint64_t rgba = blockcompress::image_bytes(VK_FORMAT_R8G8B8A8_UNORM, 1024, 1024, false);
+    EXPECT_EQ(blockcompress::image_bytes(VK_FORMAT_BC7_UNORM_BLOCK, 1024, 1024, false) * 4, rgba);
+    EXPECT_EQ(blockcompress::image_bytes(VK_FORMAT_BC1_RGB_UNORM_BLOCK, 1024, 1024, false) * 8, rgba);
+}
+
+TEST(BlockCompressionTest, SolidBlocksSurviveTheRoundTrip) {
+    uint8_t solid[64];
+    for (int i = 0; i < 16; i++) {
+        solid[i * 4 + 0] = 200;
+        solid[i * 4 + 1] = 100;
+        solid[i * 4 + 2] = 50;
+        solid[i * 4 + 3] = 255;
+    }
+
+    for (const VkFormat format: {VK_FORMAT_BC1_RGB_UNORM_BLOCK, VK_FORMAT_BC4_UNORM_BLOCK, VK_FORMAT_BC5_UNORM_BLOCK,
+                                 VK_FORMAT_BC7_UNORM_BLOCK}) {
+        uint8_t block[16];
+        uint8_t decoded[64];
+        blockcompress::encode_block(format, solid, block);
+        blockcompress::decode_block(format, block, decoded);
+
+        const int channels = format == VK_FORMAT_BC4_UNORM_BLOCK ? 1 : format == VK_FORMAT_BC5_UNORM_BLOCK ? 2 : 3;
+        // 565 endpoints can be off by up to half a step
+        const int tolerance = format == VK_FORMAT_BC1_RGB_UNORM_BLOCK ? 4 : 1;
+        for (int i = 0; i < 16; i++) {
+            for (int c = 0; c < channels; c++) {
+                EXPECT_NEAR(decoded[i * 4 + c], solid[i * 4 + c], tolerance) << "format " << format;
+            }
+        }
+    }
+}
+
+TEST(BlockCompressionTest, TwoColorBlocksAreExactInBc7) {
+    // every texel sits on one endpoint, mode 6 can represent both up to the p-bit rounding
+    uint8_t rgba[64];
+    for (int i = 0; i < 16; i++) {
+        const bool first = (i % 3) == 0;
+        rgba[i * 4 + 0] = first ? 10 : 240;
+        rgba[i * 4 + 1] = first ? 20 : 220;
+        rgba[i * 4 + 2] = first ? 30 : 200;
+        rgba[i * 4 + 3] = first ? 255 : 64;
+    }
+
+    uint8_t block[16];
+    uint8_t decoded[64];
+    blockcompress::encode_block(VK_FORMAT_BC7_UNORM_BLOCK, rgba, block);
+    blockcompress::decode_block(VK_FORMAT_BC7_UNORM_BLOCK, block, decoded);
+    for (int i = 0; i < 64; i++) {
+        EXPECT_NEAR(decoded[i], rgba[i], 1) << "byte " << i;
+    }
+}
+
+TEST(BlockCompressionTest, GradientsStayWithinTheFormatsTypicalError) {
+    constexpr uint32_t size = 64;
+    const std::vector<uint8_t> rgba = test_image(size, size);
+
+    const MipChain bc7 = blockcompress::compress(rgba.data(), size, size, VK_FORMAT_BC7_UNORM_BLOCK, false);
+    const MipChain bc5 = blockcompress::compress(rgba.data(), size, size, VK_FORMAT_BC5_UNORM_BLOCK, false);
+    const MipChain bc1 = blockcompress::compress(rgba.data(), size, size, VK_FORMAT_BC1_RGB_UNORM_BLOCK, false);
+    EXPECT_LT(level_rmse(rgba, size, size, bc7, 4), 5.0);
+    EXPECT_LT(level_rmse(rgba, size, size, bc5, 2), 5.0);
+    EXPECT_LT(level_rmse(rgba, size, size, bc1, 3), 8.0);
+}
+
+TEST(BlockCompressionTest, MipChainCoversEveryLevelBackToBack) {
+    const std::vector<uint8_t> rgba = test_image(40, 12);
+    const MipChain chain = blockcompress::compress(rgba.data(), 40, 12, VK_FORMAT_BC7_UNORM_BLOCK, true);
+
+    ASSERT_EQ(chain.levels.size(), blockcompress::mip_count(40, 12));
+    uint64_t offset = 0;
+    for (size_t level = 0; level < chain.levels.size(); level++) {
+        const MipLevel &mip = chain.levels[level];
+        EXPECT_EQ(mip.width, std::max(40u >> level, 1u));
+        EXPECT_EQ(mip.height, std::max(12u >> level, 1u));
+        EXPECT_EQ(mip.offset, offset);
+        EXPECT_EQ(mip.size, blockcompress::level_bytes(chain.format, mip.width, mip.height));
+        offset += mip.size;
+    }
+    EXPECT_EQ(chain.data.size(), offset);
+    EXPECT_EQ(chain.data.size(), blockcompress::image_bytes(VK_FORMAT_BC7_UNORM_BLOCK, 40, 12, true));
+}
+
+TEST(BlockCompressionTest, ParallelEncodeMatchesSerial) {
+    const std::vector<uint8_t> rgba = test_image(256, 128);
+    JobSystem jobs(3);
+
+    const MipChain serial = blockcompress::compress(rgba.data(), 256, 128, VK_FORMAT_BC7_UNORM_BLOCK, true);
+    const MipChain parallel = blockcompress::compress(rgba.data(), 256, 128, VK_FORMAT_BC7_UNORM_BLOCK, true, &jobs);
+    EXPECT_EQ(serial.data, parallel.data);
+}
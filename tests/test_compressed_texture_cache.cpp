@@ -0,0 +1,70 @@
+#include <CompressedTextureCache.h>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <vector>
+
+class CompressedTextureCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory = std::filesystem::temp_directory_path() / "experirender_test_texcache";
+        std::filesystem::create_directories(directory);
+        path = CompressedTextureCache::path_for(directory, KEY);
+
+        std::vector<uint8_t> rgba(16 * 8 * 4);
+        for (size_t i = 0; i < rgba.size(); i++) {
+            rgba[i] = static_cast<uint8_t>(i * 7);
+        }
+        chain = blockcompress::compress(rgba.data(), 16, 8, VK_FORMAT_BC7_UNORM_BLOCK, true);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(directory); }
+
+    static constexpr uint64_t KEY = 0xfeedbeefull;
+    std::filesystem::path directory;
+    std::filesystem::path path;
+    MipChain chain;
+};
+
+TEST_F(CompressedTextureCacheTest, RoundTrip) {
+    ASSERT_TRUE(CompressedTextureCache::write(path, KEY, chain.view()));
+
+    CompressedTextureCache cache;
+    ASSERT_TRUE(cache.open(path, KEY, VK_FORMAT_BC7_UNORM_BLOCK));
+
+    const MipChainView view = cache.view();
+    EXPECT_EQ(view.format, VK_FORMAT_BC7_UNORM_BLOCK);
+    ASSERT_EQ(view.levels.size(), chain.levels.size());
+    for (size_t i = 0; i < chain.levels.size(); i++) {
+        EXPECT_EQ(view.levels[i].width, chain.levels[i].width);
+        EXPECT_EQ(view.levels[i].height, chain.levels[i].height);
+        EXPECT_EQ(view.levels[i].offset, chain.levels[i].offset);
+        EXPECT_EQ(view.levels[i].size, chain.levels[i].size);
+    }
+    ASSERT_EQ(view.data.size(), chain.data.size());
+    EXPECT_TRUE(std::equal(view.data.begin(), view.data.end(), chain.data.begin()));
+
+    // the blocks are copied into staging straight from the mapping
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(view.data.data()) % 16, 0u);
+}
+
+TEST_F(CompressedTextureCacheTest, RejectsDifferentKeyOrFormat) {
+    ASSERT_TRUE(CompressedTextureCache::write(path, KEY, chain.view()));
+
+    CompressedTextureCache cache;
+    EXPECT_FALSE(cache.open(path, KEY + 1, VK_FORMAT_BC7_UNORM_BLOCK));
+    EXPECT_FALSE(cache.open(path, KEY, VK_FORMAT_BC1_RGB_UNORM_BLOCK));
+    EXPECT_FALSE(cache.is_open());
+}
+
+TEST_F(CompressedTextureCacheTest, RejectsTruncatedFile) {
+    ASSERT_TRUE(CompressedTextureCache::write(path, KEY, chain.view()));
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 16);
+
+    CompressedTextureCache cache;
+    EXPECT_FALSE(cache.open(path, KEY, VK_FORMAT_BC7_UNORM_BLOCK));
+}
+
+TEST_F(CompressedTextureCacheTest, MissingFileIsAMiss) {
+    CompressedTextureCache cache;
+    EXPECT_FALSE(cache.open(directory / "does_not_exist.texcache", KEY, VK_FORMAT_BC7_UNORM_BLOCK));
+}
@@ -0,0 +1,64 @@
+#include <DrawSort.h>
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <random>
+
+namespace {
+
+    std::vector<uint32_t> sorted_order(std::vector<uint64_t> keys) {
+        std::vector<uint32_t> values(keys.size());
+        std::iota(values.begin(), values.end(), 0u);
+        std::vector<uint64_t> keyScratch;
+        std::vector<uint32_t> valueScratch;
+        drawsort::radix_sort(keys, values, keyScratch, valueScratch);
+        EXPECT_TRUE(std::ranges::is_sorted(keys));
+        return values;
+    }
+
+    std::vector<uint32_t> stable_order(const std::vector<uint64_t> &keys) {
+        std::vector<uint32_t> values(keys.size());
+        std::iota(values.begin(), values.end(), 0u);
+        std::ranges::stable_sort(values, [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+        return values;
+    }
+
+} // namespace
+
+TEST(DrawSortTest, FieldsOrderFromPassDownToDepth) {
+    const uint64_t base = drawsort::state_key(1, 2, 3, 4) | drawsort::depth_key(0.5f);
+    EXPECT_LT(base, drawsort::state_key(1, 2, 3, 4) | drawsort::depth_key(0.6f));
+    EXPECT_LT(base, drawsort::state_key(1, 2, 3, 5) | drawsort::depth_key(0.f));
+    EXPECT_LT(base, drawsort::state_key(1, 2, 4, 0) | drawsort::depth_key(0.f));
+    EXPECT_LT(base, drawsort::state_key(1, 3, 0, 0) | drawsort::depth_key(0.f));
+    EXPECT_LT(drawsort::state_key(1, 255, 65535, 65535) | drawsort::depth_key(1.f), drawsort::state_key(2, 0, 0, 0));
+}
+
+TEST(DrawSortTest, OutOfRangeValuesAreClampedIntoTheirField) {
+    EXPECT_EQ(drawsort::state_key(0, 0, 1u << 20, 0), drawsort::state_key(0, 0, 65535, 0));
+    EXPECT_EQ(drawsort::state_key(0, 0, 0, 1u << 20), drawsort::state_key(0, 0, 0, 65535));
+    EXPECT_EQ(drawsort::depth_key(-1.f), drawsort::depth_key(0.f));
+    EXPECT_EQ(drawsort::depth_key(7.f), drawsort::depth_key(1.f));
+    EXPECT_EQ(drawsort::depth_key(std::nanf("")), drawsort::depth_key(1.f));
+    EXPECT_LT(drawsort::depth_key(1.f), uint64_t{1} << drawsort::DEPTH_BITS);
+}
+
+TEST(DrawSortTest, RadixSortIsStableLikeStdStableSort) {
+    std::mt19937_64 rng(5);
+    // few distinct states and depths so many keys tie, with an odd and an even number of scatters
+    for (const bool fullWidth: {false, true}) {
+        std::vector<uint64_t> keys(10'000);
+        for (uint64_t &key: keys) {
+            key = fullWidth ? rng() : drawsort::state_key(rng() % 3, rng() % 4, rng() % 50, rng() % 20) |
+                                          drawsort::depth_key(static_cast<float>(rng() % 8) / 8.f);
+        }
+        EXPECT_EQ(sorted_order(keys), stable_order(keys));
+    }
+}
+
+TEST(DrawSortTest, EqualAndTinyInputsAreLeftAsTheyAre) {
+    EXPECT_TRUE(sorted_order({}).empty());
+    EXPECT_EQ(sorted_order({42}), std::vector<uint32_t>({0}));
+    EXPECT_EQ(sorted_order(std::vector<uint64_t>(5, 7)), std::vector<uint32_t>({0, 1, 2, 3, 4}));
+}
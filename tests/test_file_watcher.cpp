@@ -0,0 +1,86 @@
+#include <FileWatcher.h>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+
+class FileWatcherTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory = std::filesystem::temp_directory_path() / "experirender_test_filewatcher";
+        std::filesystem::create_directories(directory);
+        scene = directory / "scene.gltf";
+        buffer = directory / "scene.bin";
+        write(scene, "{}");
+        write(buffer, "0123");
+    }
+
+    void TearDown() override { std::filesystem::remove_all(directory); }
+
+    static void write(const std::filesystem::path &path, const std::string &contents) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << contents;
+    }
+
+    // polls are driven by explicit times, one interval apart
+    FileWatcher::Clock::time_point at(int poll) const {
+        return FileWatcher::Clock::time_point{} + INTERVAL * (poll + 1);
+    }
+
+    static constexpr std::chrono::milliseconds INTERVAL{100};
+    std::filesystem::path directory;
+    std::filesystem::path scene;
+    std::filesystem::path buffer;
+};
+
+TEST_F(FileWatcherTest, UnchangedFilesReportNothing) {
+    FileWatcher watcher(INTERVAL);
+    watcher.watch({scene, buffer});
+    for (int poll = 0; poll < 4; poll++) {
+        EXPECT_FALSE(watcher.poll(at(poll)));
+    }
+}
+
+TEST_F(FileWatcherTest, ChangeIsReportedOnceAfterItSettled) {
+    FileWatcher watcher(INTERVAL);
+    watcher.watch({scene, buffer});
+
+    write(buffer, "0123456789");
+    // first seen, then unchanged for a whole interval
+    EXPECT_FALSE(watcher.poll(at(0)));
+    EXPECT_TRUE(watcher.poll(at(1)));
+    EXPECT_FALSE(watcher.poll(at(2)));
+}
+
+TEST_F(FileWatcherTest, FileStillBeingWrittenWaits) {
+    FileWatcher watcher(INTERVAL);
+    watcher.watch({scene, buffer});
+
+    write(buffer, "01234");
+    EXPECT_FALSE(watcher.poll(at(0)));
+    write(buffer, "0123456789");
+    EXPECT_FALSE(watcher.poll(at(1)));
+    EXPECT_TRUE(watcher.poll(at(2)));
+}
+
+TEST_F(FileWatcherTest, PollsWithinAnIntervalAreSkipped) {
+    FileWatcher watcher(INTERVAL);
+    watcher.watch({scene, buffer});
+
+    write(scene, "{\"asset\":{}}");
+    EXPECT_FALSE(watcher.poll(at(0)));
+    // too soon to stat again
+    EXPECT_FALSE(watcher.poll(at(0) + INTERVAL / 2));
+    EXPECT_TRUE(watcher.poll(at(1)));
+}
+
+TEST_F(FileWatcherTest, MissingFileWaitsForItsReplacement) {
+    FileWatcher watcher(INTERVAL);
+    watcher.watch({scene, buffer});
+
+    std::filesystem::remove(buffer);
+    EXPECT_FALSE(watcher.poll(at(0)));
+    EXPECT_FALSE(watcher.poll(at(1)));
+    write(buffer, "0123456789");
+    EXPECT_FALSE(watcher.poll(at(2)));
+    EXPECT_TRUE(watcher.poll(at(3)));
+}
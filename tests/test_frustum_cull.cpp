@@ -0,0 +1,143 @@
+// the engine builds its projections for Vulkan's 0..1 depth range
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE 1
+
+#include <FrustumCull.h>
+#include <bit>
+#include <glm/gtc/matrix_transform.hpp>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+    // the engine's camera: reversed Z, y flipped for Vulkan, looking down -z from the origin
+    glm::mat4 camera_viewproj() {
+        glm::mat4 projection = glm::perspective(glm::radians(70.f), 16.f / 9.f, 1000.f, 0.1f);
+        projection[1][1] *= -1;
+        return projection * glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+    }
+
+    Bounds unit_bounds() { return {glm::vec3(0.f), std::sqrt(3.f), glm::vec3(1.f)}; }
+
+    std::vector<uint64_t> cull(const frustumcull::BoundsSoA &bounds, const glm::mat4 &viewproj) {
+        std::vector<uint64_t> visible(frustumcull::mask_words(bounds.count), ~uint64_t{0});
+        frustumcull::cull(bounds, frustumcull::extract_frustum(viewproj), visible);
+        return visible;
+    }
+
+    bool bit(const std::vector<uint64_t> &visible, size_t i) { return (visible[i / 64] >> (i % 64)) & 1; }
+
+} // namespace
+
+TEST(FrustumCullTest, KnownPlacements) {
+    const std::vector<glm::vec3> positions = {
+        {0.f, 0.f, -10.f}, // in front
+        {0.f, 0.f, 10.f}, // behind the camera
+        {100.f, 0.f, -10.f}, // far to the right
+        {0.f, 0.f, -2000.f}, // past the far plane
+        {0.f, 0.f, 0.5f}, // straddles the near plane
+        {9.f, 0.f, -10.f}, // straddles the right plane
+    };
+    const std::vector<bool> expected = {true, false, false, false, true, true};
+
+    frustumcull::BoundsSoA bounds;
+    bounds.resize(positions.size());
+    for (size_t i = 0; i < positions.size(); i++) {
+        bounds.set(i, unit_bounds(), glm::translate(glm::mat4(1.f), positions[i]));
+    }
+
+    const std::vector<uint64_t> visible = cull(bounds, camera_viewproj());
+    for (size_t i = 0; i < positions.size(); i++) {
+        EXPECT_EQ(bit(visible, i), expected[i]) << "surface " << i;
+    }
+}
+
+TEST(FrustumCullTest, TransformScalesAndRotatesBounds) {
+    frustumcull::BoundsSoA bounds;
+    bounds.resize(1);
+    const Bounds local{glm::vec3(1.f, 0.f, 0.f), 2.f, glm::vec3(1.f, 2.f, 0.5f)};
+    glm::mat4 transform = glm::translate(glm::mat4(1.f), glm::vec3(0.f, 5.f, 0.f));
+    transform = glm::rotate(transform, glm::radians(90.f), glm::vec3(0.f, 0.f, 1.f));
+    transform = glm::scale(transform, glm::vec3(3.f, 1.f, 1.f));
+    bounds.set(0, local, transform);
+
+    // origin (1,0,0) scales to (3,0,0), rotates onto (0,3,0) and moves up to (0,8,0)
+    EXPECT_NEAR(bounds.centerX[0], 0.f, 1e-5f);
+    EXPECT_NEAR(bounds.centerY[0], 8.f, 1e-5f);
+    EXPECT_NEAR(bounds.centerZ[0], 0.f, 1e-5f);
+    EXPECT_NEAR(bounds.radius[0], 6.f, 1e-5f);
+    // the scaled x extent now points along y, the y extent along x
+    EXPECT_NEAR(bounds.extentX[0], 2.f, 1e-5f);
+    EXPECT_NEAR(bounds.extentY[0], 3.f, 1e-5f);
+    EXPECT_NEAR(bounds.extentZ[0], 0.5f, 1e-5f);
+}
+
+TEST(FrustumCullTest, OrthographicLightFrustum) {
+    const glm::mat4 light = glm::ortho(-20.f, 20.f, -20.f, 20.f, 500.f, 0.01f) *
+                            glm::lookAt(glm::vec3(0.f, 25.f, 0.f), glm::vec3(0.f), glm::vec3(0.f, 0.f, 1.f));
+
+    frustumcull::BoundsSoA bounds;
+    bounds.resize(3);
+    bounds.set(0, unit_bounds(), glm::translate(glm::mat4(1.f), glm::vec3(5.f, 0.f, 5.f)));
+    bounds.set(1, unit_bounds(), glm::translate(glm::mat4(1.f), glm::vec3(30.f, 0.f, 0.f)));
+    bounds.set(2, unit_bounds(), glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, -30.f)));
+
+    const std::vector<uint64_t> visible = cull(bounds, light);
+    EXPECT_TRUE(bit(visible, 0));
+    EXPECT_FALSE(bit(visible, 1));
+    EXPECT_FALSE(bit(visible, 2));
+}
+
+TEST(FrustumCullTest, SimdMatchesScalarAndMasksTheTail) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> position(-200.f, 200.f);
+    std::uniform_real_distribution<float> size(0.1f, 20.f);
+
+    // not a multiple of the lanes or of 64, the padding and the last word's spare bits must stay clear
+    constexpr size_t count = 1000 + 3;
+    frustumcull::BoundsSoA bounds;
+    bounds.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        const glm::vec3 extents(size(rng), size(rng), size(rng));
+        const Bounds local{glm::vec3(0.f), glm::length(extents), extents};
+        glm::mat4 transform = glm::translate(glm::mat4(1.f), glm::vec3(position(rng), position(rng), position(rng)));
+        transform = glm::rotate(transform, position(rng), glm::vec3(size(rng), size(rng), size(rng)));
+        bounds.set(i, local, transform);
+    }
+
+    const frustumcull::Frustum frustum = frustumcull::extract_frustum(camera_viewproj());
+    std::vector<uint64_t> simdBits(frustumcull::mask_words(count), ~uint64_t{0});
+    std::vector<uint64_t> scalarBits(frustumcull::mask_words(count), ~uint64_t{0});
+    frustumcull::cull(bounds, frustum, simdBits);
+    frustumcull::cull_scalar(bounds, frustum, scalarBits);
+
+    EXPECT_EQ(simdBits, scalarBits);
+    EXPECT_EQ(simdBits.back() >> (count % 64), 0u);
+
+    size_t visibleCount = 0;
+    for (const uint64_t word: simdBits) {
+        visibleCount += static_cast<size_t>(std::popcount(word));
+    }
+    // the camera sees a part of the cloud, not all or nothing
+    EXPECT_GT(visibleCount, 0u);
+    EXPECT_LT(visibleCount, count);
+}
+
+TEST(FrustumCullTest, AppendVisibleRebasesRanges) {
+    // bits 1, 3, 64, 70 and 130 of a mask split into an opaque range [0, 65) and a transparent one [65, 131)
+    std::vector<uint64_t> visible(3, 0);
+    for (const size_t i: {1u, 3u, 64u, 70u, 130u}) {
+        visible[i / 64] |= uint64_t{1} << (i % 64);
+    }
+
+    std::vector<uint32_t> opaque;
+    frustumcull::append_visible(visible, 0, 65, opaque);
+    EXPECT_EQ(opaque, std::vector<uint32_t>({1, 3, 64}));
+
+    std::vector<uint32_t> transparent;
+    frustumcull::append_visible(visible, 65, 66, transparent);
+    EXPECT_EQ(transparent, std::vector<uint32_t>({5, 65}));
+
+    std::vector<uint32_t> none;
+    frustumcull::append_visible(visible, 4, 60, none);
+    EXPECT_TRUE(none.empty());
+}
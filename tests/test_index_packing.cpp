@@ -0,0 +1,80 @@
+#include <IndexPacking.h>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+    // index `i` of a packed block as the GPU reads it
+    uint32_t read_index(const std::vector<std::byte> &packed, const indexpacking::SurfaceLayout &layout, uint32_t i) {
+        if (layout.indexSize == 2) {
+            uint16_t index;
+            memcpy(&index, packed.data() + size_t(i) * 2, sizeof(index));
+            return index;
+        }
+        uint32_t index;
+        memcpy(&index, packed.data() + size_t(i) * 4, sizeof(index));
+        return index;
+    }
+} // namespace
+
+TEST(IndexPackingTest, SurfacesThatFitGoNarrowAndRebased) {
+    // a surface far into the mesh's vertices, its LOD appended after every full detail range
+    const std::vector<uint32_t> indices = {70000, 70001, 70002, 70002, 70001, 70003, 70000, 70001, 70003};
+    const indexpacking::Range ranges[] = {{0, 6}, {6, 3}};
+
+    const indexpacking::SurfaceLayout layout = indexpacking::layout_surface(indices, ranges, 0);
+    EXPECT_EQ(layout.indexSize, 2u);
+    EXPECT_EQ(layout.baseVertex, 70000u);
+    // 9 16 bit indices padded to a whole word
+    EXPECT_EQ(layout.byteSize, 20u);
+
+    std::vector<std::byte> packed(layout.byteSize, std::byte{0xCD});
+    indexpacking::pack_surface(indices, ranges, layout, packed);
+    for (uint32_t range = 0; range < 2; range++) {
+        const uint32_t first = indexpacking::first_index(layout, ranges, range);
+        for (uint32_t i = 0; i < ranges[range].count; i++) {
+            EXPECT_EQ(read_index(packed, layout, first + i) + layout.baseVertex, indices[ranges[range].first + i]);
+        }
+    }
+    EXPECT_EQ(packed[18], std::byte{0});
+    EXPECT_EQ(packed[19], std::byte{0});
+}
+
+TEST(IndexPackingTest, WideVertexRangesKeep32Bits) {
+    const std::vector<uint32_t> indices = {5, 6, 70000};
+    const indexpacking::Range ranges[] = {{0, 3}};
+
+    const indexpacking::SurfaceLayout layout = indexpacking::layout_surface(indices, ranges, 0);
+    EXPECT_EQ(layout.indexSize, 4u);
+    EXPECT_EQ(layout.baseVertex, 5u);
+
+    std::vector<std::byte> packed(layout.byteSize);
+    indexpacking::pack_surface(indices, ranges, layout, packed);
+    EXPECT_EQ(read_index(packed, layout, 2), 70000u - 5u);
+
+    // exactly 65536 vertices still fit
+    const std::vector<uint32_t> edge = {100, 100 + 65535, 101};
+    EXPECT_EQ(indexpacking::layout_surface(edge, ranges, 0).indexSize, 2u);
+    // unless narrow indices are off
+    EXPECT_EQ(indexpacking::layout_surface(edge, ranges, 0, false).indexSize, 4u);
+}
+
+TEST(IndexPackingTest, BlocksOfMixedWidthShareAStream) {
+    const std::vector<uint32_t> indices = {0, 1, 2, 3, 4, 100000};
+    const indexpacking::Range narrow[] = {{0, 3}};
+    const indexpacking::Range wide[] = {{3, 3}};
+
+    const indexpacking::SurfaceLayout first = indexpacking::layout_surface(indices, narrow, 0);
+    const indexpacking::SurfaceLayout second = indexpacking::layout_surface(indices, wide, first.byteSize);
+    ASSERT_EQ(first.indexSize, 2u);
+    ASSERT_EQ(second.indexSize, 4u);
+    EXPECT_EQ(second.byteOffset % 4, 0u);
+    // first indices count in the surface's own index type from the start of the stream
+    EXPECT_EQ(indexpacking::first_index(second, wide, 0), second.byteOffset / 4);
+
+    std::vector<std::byte> packed(first.byteSize + second.byteSize);
+    indexpacking::pack_surface(indices, narrow, first, packed);
+    indexpacking::pack_surface(indices, wide, second, packed);
+    EXPECT_EQ(read_index(packed, first, 2), 2u);
+    EXPECT_EQ(read_index(packed, second, indexpacking::first_index(second, wide, 0) + 2), 100000u - 3u);
+}
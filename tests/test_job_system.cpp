@@ -0,0 +1,66 @@
+#include <JobSystem.h>
+#include <algorithm>
+#include <atomic>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <vector>
+
+TEST(JobSystemTest, RunsAllSubmittedJobs) {
+    JobSystem jobs(4);
+    std::atomic<int> counter{0};
+
+    for (int i = 0; i < 1000; i++) {
+        jobs.submit([&] { counter.fetch_add(1); });
+    }
+    jobs.wait_idle();
+
+    EXPECT_EQ(counter.load(), 1000);
+}
+
+TEST(JobSystemTest, ParallelForCoversRangeOnce) {
+    JobSystem jobs(3);
+    std::vector<int> hits(10007, 0);
+
+    jobs.parallel_for(hits.size(), 64, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            hits[i]++;
+        }
+    });
+
+    for (size_t i = 0; i < hits.size(); i++) {
+        ASSERT_EQ(hits[i], 1) << "index " << i;
+    }
+}
+
+TEST(JobSystemTest, NestedParallelForDoesNotDeadlock) {
+    JobSystem jobs(2);
+    std::atomic<int> counter{0};
+
+    // every outer range spawns its own inner parallel_for from a worker thread
+    jobs.parallel_for(16, 1, [&](size_t, size_t) {
+        jobs.parallel_for(8, 1, [&](size_t, size_t) { counter.fetch_add(1); });
+    });
+
+    EXPECT_EQ(counter.load(), 16 * 8);
+}
+
+TEST(JobSystemTest, CompletionQueueReturnsEveryResult) {
+    JobSystem jobs(4);
+    CompletionQueue<int> results;
+
+    for (int i = 0; i < 64; i++) {
+        jobs.submit([&results, i] { results.push(int(i)); });
+    }
+
+    std::vector<int> received;
+    for (int i = 0; i < 64; i++) {
+        received.push_back(results.pop());
+    }
+    jobs.wait_idle();
+
+    // completion order is arbitrary, but nothing may be lost or duplicated
+    std::sort(received.begin(), received.end());
+    std::vector<int> expected(64);
+    std::iota(expected.begin(), expected.end(), 0);
+    EXPECT_EQ(received, expected);
+}
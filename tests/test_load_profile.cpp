@@ -0,0 +1,77 @@
+#include <LoadProfile.h>
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+#include <thread>
+#include <vector>
+
+TEST(LoadProfileTest, PhasesAccumulateInFirstUseOrder) {
+    LoadProfile profile;
+    profile.add_time("parse", 2.0);
+    profile.add_time("mesh_upload", 1.0, 100);
+    profile.add_time("mesh_upload", 3.0, 50);
+    profile.add_bytes("mesh_upload", 64);
+    profile.add_bytes("mesh_upload", 32);
+    profile.set_counter("mesh_upload", "meshes", 1);
+    profile.set_counter("mesh_upload", "meshes", 2);
+
+    const std::vector<LoadProfile::Phase> phases = profile.phases();
+    ASSERT_EQ(phases.size(), 2u);
+    EXPECT_EQ(phases[0].name, "parse");
+    EXPECT_EQ(phases[1].name, "mesh_upload");
+    EXPECT_DOUBLE_EQ(phases[1].timeMs, 4.0);
+    EXPECT_EQ(phases[1].calls, 2u);
+    EXPECT_EQ(phases[1].bytes, 96u);
+    // the highest peak wins, a counter keeps its last value
+    EXPECT_EQ(phases[1].peakRssBytes, 100u);
+    ASSERT_EQ(phases[1].counters.size(), 1u);
+    EXPECT_EQ(phases[1].counters[0].second, 2u);
+}
+
+TEST(LoadProfileTest, ItemsFromManyThreads) {
+    LoadProfile profile;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&profile, t] {
+            for (int i = 0; i < 100; i++) {
+                profile.add_item("image_decode", "image " + std::to_string(t * 100 + i), 0.5, 16);
+            }
+        });
+    }
+    for (std::thread &thread: threads) {
+        thread.join();
+    }
+
+    const std::vector<LoadProfile::Phase> phases = profile.phases();
+    ASSERT_EQ(phases.size(), 1u);
+    EXPECT_EQ(phases[0].items.size(), 400u);
+}
+
+TEST(LoadProfileTest, JsonReportRoundTrips) {
+    LoadProfile profile;
+    profile.track_memory(true);
+    {
+        ScopedLoadPhase phase(profile, "parse");
+    }
+    profile.add_item("image_decode", "albedo.png", 1.5, 4096);
+    profile.set_counter("geometry", "meshes", 3);
+
+    const nlohmann::json report = nlohmann::json::parse(profile.to_json("scenes/box.gltf", 12.5));
+    EXPECT_EQ(report["scene"], "scenes/box.gltf");
+    EXPECT_DOUBLE_EQ(report["totalMs"].get<double>(), 12.5);
+    ASSERT_EQ(report["phases"].size(), 3u);
+    EXPECT_EQ(report["phases"][0]["name"], "parse");
+    EXPECT_EQ(report["phases"][0]["calls"], 1);
+#if defined(__linux__)
+    EXPECT_GT(report["phases"][0]["peakRssBytes"].get<uint64_t>(), 0u);
+#endif
+    EXPECT_EQ(report["phases"][1]["items"][0]["name"], "albedo.png");
+    EXPECT_EQ(report["phases"][1]["items"][0]["bytes"], 4096);
+    EXPECT_EQ(report["phases"][2]["counters"]["meshes"], 3);
+}
+
+TEST(LoadProfileTest, ReportGoesNextToTheSceneByDefault) {
+    EXPECT_EQ(LoadProfile::report_path("assets/sponza/Sponza.gltf"),
+              std::filesystem::path("assets/sponza/Sponza.load.json"));
+    EXPECT_EQ(LoadProfile::report_path("assets/sponza/Sponza.gltf", "reports"),
+              std::filesystem::path("reports/Sponza.load.json"));
+}
@@ -0,0 +1,105 @@
+#include <MeshCache.h>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+
+class MeshCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        directory = std::filesystem::temp_directory_path() / "experirender_test_meshcache";
+        std::filesystem::create_directories(directory);
+        path = MeshCache::path_for(directory, HASH);
+
+        MeshGeometry mesh;
+        mesh.name = "triangle";
+        for (int i = 0; i < 3; i++) {
+            Vertex v{};
+            v.position = glm::vec3(static_cast<float>(i), 1.f, 2.f);
+            v.uv_x = 0.5f * static_cast<float>(i);
+            mesh.vertices.push_back(v);
+            mesh.indices.push_back(static_cast<uint32_t>(i));
+        }
+        SurfaceGeometry surface{};
+        surface.startIndex = 0;
+        surface.count = 3;
+        surface.materialIndex = 2;
+        surface.bounds.origin = glm::vec3(1.f, 1.f, 2.f);
+        surface.bounds.extents = glm::vec3(1.f, 0.f, 0.f);
+        surface.bounds.sphereRadius = 1.f;
+        surface.firstMeshlet = 0;
+        surface.meshletCount = meshlets::build_meshlets(mesh.indices, mesh.vertices, 0, mesh.meshlets);
+        // a stand-in coarser level reusing the same triangle
+        mesh.indices.insert(mesh.indices.end(), {0, 1, 2});
+        surface.lodCount = 1;
+        surface.lods[0] = SurfaceLod{3, 3, 0.25f};
+        mesh.surfaces.push_back(surface);
+
+        MeshGeometry empty;
+        empty.name = "empty";
+
+        meshes = {mesh, empty};
+    }
+
+    void TearDown() override { std::filesystem::remove_all(directory); }
+
+    static constexpr uint64_t HASH = 0x1234abcdull;
+    std::filesystem::path directory;
+    std::filesystem::path path;
+    std::vector<MeshGeometry> meshes;
+};
+
+TEST_F(MeshCacheTest, RoundTrip) {
+    ASSERT_TRUE(MeshCache::write(path, HASH, meshes));
+
+    MeshCache cache;
+    ASSERT_TRUE(cache.open(path, HASH));
+    ASSERT_EQ(cache.mesh_count(), 2u);
+
+    const MeshCacheView mesh = cache.mesh(0);
+    EXPECT_EQ(mesh.name, "triangle");
+    ASSERT_EQ(mesh.vertices.size(), 3u);
+    ASSERT_EQ(mesh.indices.size(), 6u);
+    ASSERT_EQ(mesh.surfaces.size(), 1u);
+    EXPECT_FLOAT_EQ(mesh.vertices[2].position.x, 2.f);
+    EXPECT_FLOAT_EQ(mesh.vertices[1].uv_x, 0.5f);
+    EXPECT_EQ(mesh.indices[2], 2u);
+    EXPECT_EQ(mesh.surfaces[0].materialIndex, 2u);
+    EXPECT_FLOAT_EQ(mesh.surfaces[0].bounds.sphereRadius, 1.f);
+    ASSERT_EQ(mesh.meshlets.size(), 1u);
+    EXPECT_EQ(mesh.surfaces[0].meshletCount, 1u);
+    EXPECT_EQ(mesh.meshlets[0].indexCount, 3u);
+    EXPECT_FLOAT_EQ(mesh.meshlets[0].radius, meshes[0].meshlets[0].radius);
+    ASSERT_EQ(mesh.surfaces[0].lodCount, 1u);
+    EXPECT_EQ(mesh.surfaces[0].lods[0].startIndex, 3u);
+    EXPECT_FLOAT_EQ(mesh.surfaces[0].lods[0].error, 0.25f);
+
+    // streams are mapped in place, so they have to keep the alignment Vertex asks for
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(mesh.vertices.data()) % alignof(Vertex), 0u);
+
+    const MeshCacheView empty = cache.mesh(1);
+    EXPECT_EQ(empty.name, "empty");
+    EXPECT_TRUE(empty.vertices.empty());
+    EXPECT_TRUE(empty.indices.empty());
+    EXPECT_TRUE(empty.meshlets.empty());
+}
+
+TEST_F(MeshCacheTest, RejectsDifferentContentHash) {
+    ASSERT_TRUE(MeshCache::write(path, HASH, meshes));
+
+    MeshCache cache;
+    EXPECT_FALSE(cache.open(path, HASH + 1));
+    EXPECT_FALSE(cache.is_open());
+}
+
+TEST_F(MeshCacheTest, RejectsTruncatedFile) {
+    ASSERT_TRUE(MeshCache::write(path, HASH, meshes));
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 16);
+
+    MeshCache cache;
+    EXPECT_FALSE(cache.open(path, HASH));
+}
+
+TEST_F(MeshCacheTest, MissingFileIsAMiss) {
+    MeshCache cache;
+    EXPECT_FALSE(cache.open(directory / "does_not_exist.meshcache", HASH));
+}
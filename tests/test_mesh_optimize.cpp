@@ -0,0 +1,117 @@
+#include "TestMeshes.h"
+
+#include <MeshOptimize.h>
+#include <algorithm>
+#include <array>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+    // side x side vertex grid starting at mesh vertex baseVertex, triangles shuffled like a badly exported mesh
+    testmesh::Grid make_shuffled_grid(uint32_t side, uint32_t baseVertex) {
+        testmesh::Grid grid = testmesh::make_grid(side, baseVertex);
+        testmesh::shuffle_triangles(grid, 3);
+        return grid;
+    }
+
+    // triangles as position triples rotated to start at the smallest corner, independent of vertex numbering
+    std::vector<std::array<float, 9>> canonical_triangles(const testmesh::Grid &grid, uint32_t baseVertex) {
+        std::vector<std::array<float, 9>> triangles;
+        for (size_t i = 0; i < grid.indices.size(); i += 3) {
+            std::array<glm::vec3, 3> p{};
+            for (int c = 0; c < 3; c++) {
+                p[c] = grid.vertices[grid.indices[i + c] - baseVertex].position;
+            }
+            auto less = [](const glm::vec3 &a, const glm::vec3 &b) {
+                return a.x != b.x ? a.x < b.x : (a.y != b.y ? a.y < b.y : a.z < b.z);
+            };
+            const auto first = std::min_element(p.begin(), p.end(), less) - p.begin();
+            std::rotate(p.begin(), p.begin() + first, p.end());
+            triangles.push_back({p[0].x, p[0].y, p[0].z, p[1].x, p[1].y, p[1].z, p[2].x, p[2].y, p[2].z});
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+} // namespace
+
+TEST(MeshOptimizeTest, AnalyzeCountsFifoMisses) {
+    // two triangles sharing an edge: 4 vertices transformed once each
+    const std::vector<uint32_t> quad = {0, 1, 2, 2, 1, 3};
+    const meshoptimize::VertexCacheStats stats = meshoptimize::analyze_vertex_cache(quad, 4, 0);
+    EXPECT_FLOAT_EQ(stats.acmr, 2.f);
+    EXPECT_FLOAT_EQ(stats.atvr, 1.f);
+
+    // revisiting the first triangle hits in a cache of 6 but misses again in a cache of 3
+    const std::vector<uint32_t> revisit = {0, 1, 2, 3, 4, 5, 0, 1, 2};
+    EXPECT_FLOAT_EQ(meshoptimize::analyze_vertex_cache(revisit, 6, 0, 6).acmr, 2.f);
+    EXPECT_FLOAT_EQ(meshoptimize::analyze_vertex_cache(revisit, 6, 0, 3).acmr, 3.f);
+}
+
+TEST(MeshOptimizeTest, VertexCacheOrderLowersAcmr) {
+    testmesh::Grid grid = make_shuffled_grid(64, 0);
+    const float before = meshoptimize::analyze_vertex_cache(grid.indices, grid.vertices.size(), 0).acmr;
+
+    meshoptimize::optimize_vertex_cache(grid.indices, grid.vertices.size(), 0);
+    const float after = meshoptimize::analyze_vertex_cache(grid.indices, grid.vertices.size(), 0).acmr;
+
+    EXPECT_GT(before, 2.f);
+    EXPECT_LT(after, 0.8f);
+}
+
+TEST(MeshOptimizeTest, SurfacePassKeepsTrianglesAndWinding) {
+    // the surface lives at vertex 1000 of its mesh, indices are mesh relative
+    constexpr uint32_t baseVertex = 1000;
+    testmesh::Grid grid = make_shuffled_grid(32, baseVertex);
+    const auto before = canonical_triangles(grid, baseVertex);
+
+    meshoptimize::optimize_surface(grid.indices, grid.vertices, baseVertex);
+
+    for (const uint32_t index: grid.indices) {
+        ASSERT_GE(index, baseVertex);
+        ASSERT_LT(index, baseVertex + grid.vertices.size());
+    }
+    EXPECT_EQ(canonical_triangles(grid, baseVertex), before);
+}
+
+TEST(MeshOptimizeTest, VertexFetchFollowsFirstUse) {
+    testmesh::Grid grid = make_shuffled_grid(16, 0);
+    meshoptimize::optimize_vertex_fetch(grid.indices, grid.vertices, 0);
+
+    // every index is either already seen or exactly the next vertex
+    uint32_t next = 0;
+    for (const uint32_t index: grid.indices) {
+        ASSERT_LE(index, next);
+        if (index == next) {
+            next++;
+        }
+    }
+    EXPECT_EQ(next, grid.vertices.size());
+}
+
+TEST(MeshOptimizeTest, OverdrawStaysWithinThreshold) {
+    // a closed box: six faces of 8x8 grids, so cluster sorting has something to reorder
+    testmesh::Grid box;
+    for (int face = 0; face < 6; face++) {
+        testmesh::Grid side = make_shuffled_grid(9, static_cast<uint32_t>(box.vertices.size()));
+        const int axis = face / 2;
+        const float offset = face % 2 == 0 ? 0.f : 8.f;
+        for (Vertex &v: side.vertices) {
+            const glm::vec3 p = v.position;
+            v.position = axis == 0 ? glm::vec3(offset, p.x, p.y)
+                                   : (axis == 1 ? glm::vec3(p.x, offset, p.y) : glm::vec3(p.x, p.y, offset));
+        }
+        box.vertices.insert(box.vertices.end(), side.vertices.begin(), side.vertices.end());
+        box.indices.insert(box.indices.end(), side.indices.begin(), side.indices.end());
+    }
+
+    std::vector<uint32_t> clusterStarts;
+    meshoptimize::optimize_vertex_cache(box.indices, box.vertices.size(), 0, meshoptimize::CACHE_SIZE,
+                                        &clusterStarts);
+    const float cacheOrder = meshoptimize::analyze_vertex_cache(box.indices, box.vertices.size(), 0).acmr;
+    ASSERT_GE(clusterStarts.size(), 6u);
+    EXPECT_EQ(clusterStarts.front(), 0u);
+
+    meshoptimize::optimize_overdraw(box.indices, box.vertices, 0, clusterStarts);
+    const float overdrawOrder = meshoptimize::analyze_vertex_cache(box.indices, box.vertices.size(), 0).acmr;
+    EXPECT_LE(overdrawOrder, cacheOrder * meshoptimize::OVERDRAW_THRESHOLD);
+}
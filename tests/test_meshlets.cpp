@@ -0,0 +1,123 @@
+#include "TestMeshes.h"
+
+#include <Meshlets.h>
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <set>
+#include <vector>
+
+TEST(MeshletsTest, MeshletsTileTheSurfaceWithinLimits) {
+    constexpr uint32_t baseVertex = 500;
+    const testmesh::Grid patch = testmesh::make_grid(40, baseVertex);
+
+    std::vector<Meshlet> out;
+    const uint32_t count = meshlets::build_meshlets(patch.indices, patch.vertices, baseVertex, out);
+    ASSERT_EQ(count, out.size());
+    ASSERT_GT(count, 1u);
+
+    uint32_t next = 0;
+    for (const Meshlet &meshlet: out) {
+        // contiguous, in order, whole triangles only
+        EXPECT_EQ(meshlet.firstIndex, next);
+        EXPECT_EQ(meshlet.indexCount % 3, 0u);
+        EXPECT_LE(meshlet.indexCount / 3, meshlets::MAX_TRIANGLES);
+        next += meshlet.indexCount;
+
+        std::set<uint32_t> unique;
+        for (uint32_t i = 0; i < meshlet.indexCount; i++) {
+            const uint32_t index = patch.indices[meshlet.firstIndex + i];
+            unique.insert(index);
+
+            const glm::vec3 &p = patch.vertices[index - baseVertex].position;
+            EXPECT_LE(glm::length(p - meshlet.center), meshlet.radius + 1e-4f);
+        }
+        EXPECT_EQ(meshlet.vertexCount, unique.size());
+        EXPECT_LE(meshlet.vertexCount, meshlets::MAX_VERTICES);
+    }
+    EXPECT_EQ(next, patch.indices.size());
+}
+
+TEST(MeshletsTest, AppendsAfterExistingMeshlets) {
+    const testmesh::Grid patch = testmesh::make_grid(4, 0);
+    std::vector<Meshlet> out(3);
+
+    const uint32_t count = meshlets::build_meshlets(patch.indices, patch.vertices, 0, out);
+    EXPECT_EQ(count, 1u);
+    ASSERT_EQ(out.size(), 4u);
+    EXPECT_EQ(out[3].firstIndex, 0u);
+    EXPECT_EQ(out[3].indexCount, patch.indices.size());
+}
+
+TEST(MeshletsTest, ConeCullsOnlyFromBehind) {
+    const testmesh::Grid patch = testmesh::make_grid(4, 0);
+    std::vector<Meshlet> out;
+    meshlets::build_meshlets(patch.indices, patch.vertices, 0, out);
+    ASSERT_EQ(out.size(), 1u);
+    const Meshlet &meshlet = out[0];
+
+    EXPECT_NEAR(meshlet.coneAxis.z, 1.f, 1e-5f);
+    EXPECT_NEAR(meshlet.coneCutoff, 0.f, 1e-5f);
+
+    EXPECT_TRUE(meshlets::cone_culled(meshlet, glm::vec3(1.5f, 1.5f, -10.f)));
+    EXPECT_FALSE(meshlets::cone_culled(meshlet, glm::vec3(1.5f, 1.5f, 10.f)));
+    // just behind the plane but close enough that the bounding sphere could still be visible
+    EXPECT_FALSE(meshlets::cone_culled(meshlet, glm::vec3(1.5f, 1.5f, -0.5f)));
+}
+
+TEST(MeshletsTest, WideConeNeverCulls) {
+    // two triangles folded back to back
+    std::vector<Vertex> vertices(4);
+    vertices[0].position = glm::vec3(0.f, 0.f, 0.f);
+    vertices[1].position = glm::vec3(1.f, 0.f, 0.f);
+    vertices[2].position = glm::vec3(0.f, 1.f, 0.f);
+    vertices[3].position = glm::vec3(0.f, 1.f, 0.f);
+    const std::vector<uint32_t> indices = {0, 1, 2, 0, 3, 1};
+
+    std::vector<Meshlet> out;
+    meshlets::build_meshlets(indices, vertices, 0, out);
+    ASSERT_EQ(out.size(), 1u);
+    EXPECT_EQ(out[0].coneCutoff, 1.f);
+    EXPECT_FALSE(meshlets::cone_culled(out[0], glm::vec3(0.f, 0.f, -10.f)));
+    EXPECT_FALSE(meshlets::cone_culled(out[0], glm::vec3(0.f, 0.f, 10.f)));
+}
+
+TEST(MeshletsTest, FrustumPlanesRejectSpheresOutsideTheView) {
+    // camera at the origin looking down -Z, reversed depth like the engine's projection
+    glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(70.f), 16.f / 9.f, 1000.f, 0.1f);
+    projection[1][1] *= -1;
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+    const std::array<glm::vec4, 6> planes = meshlets::frustum_planes(projection * view);
+
+    EXPECT_FALSE(meshlets::sphere_outside(planes, glm::vec3(0.f, 0.f, -10.f), 1.f));
+    EXPECT_TRUE(meshlets::sphere_outside(planes, glm::vec3(0.f, 0.f, 10.f), 1.f));
+    EXPECT_TRUE(meshlets::sphere_outside(planes, glm::vec3(-100.f, 0.f, -10.f), 1.f));
+    EXPECT_TRUE(meshlets::sphere_outside(planes, glm::vec3(0.f, 0.f, -2000.f), 1.f));
+    // straddling the left plane
+    EXPECT_FALSE(meshlets::sphere_outside(planes, glm::vec3(-12.5f, 0.f, -10.f), 2.f));
+}
+
+TEST(MeshletsTest, DoubleSidedSurfaceKeepsItsMeshletsFromBehind) {
+    const testmesh::Grid patch = testmesh::make_grid(40, 0);
+    std::vector<Meshlet> out;
+    meshlets::build_meshlets(patch.indices, patch.vertices, 0, out);
+    ASSERT_GT(out.size(), 1u);
+
+    // looking at the patch's back from behind, the whole patch in view
+    const glm::vec3 camera(20.f, 20.f, -60.f);
+    glm::mat4 projection = glm::perspectiveRH_ZO(glm::radians(70.f), 16.f / 9.f, 1000.f, 0.1f);
+    projection[1][1] *= -1;
+    const glm::mat4 view = glm::lookAt(camera, glm::vec3(20.f, 20.f, 0.f), glm::vec3(0.f, 1.f, 0.f));
+    const std::array<glm::vec4, 6> planes = meshlets::frustum_planes(projection * view);
+    const glm::mat4 transform(1.f);
+
+    const uint32_t doubleSided = meshlets::cull_flags(true, true);
+    const uint32_t singleSided = meshlets::cull_flags(false, true);
+    // a pipeline drawing both faces keeps every meshlet whatever the material says
+    const uint32_t noBackFaceCulling = meshlets::cull_flags(false, false);
+    for (const Meshlet &meshlet: out) {
+        EXPECT_TRUE(meshlets::visible(meshlet, doubleSided, planes, transform, camera, 1.f));
+        EXPECT_TRUE(meshlets::visible(meshlet, noBackFaceCulling, planes, transform, camera, 1.f));
+        EXPECT_FALSE(meshlets::visible(meshlet, singleSided, planes, transform, camera, 1.f));
+    }
+}
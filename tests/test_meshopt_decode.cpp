@@ -0,0 +1,126 @@
+#include <MeshoptDecode.h>
+#include <cmath>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+    std::vector<std::byte> to_bytes(std::initializer_list<int> values) {
+        std::vector<std::byte> bytes;
+        for (const int v: values) {
+            bytes.push_back(static_cast<std::byte>(v));
+        }
+        return bytes;
+    }
+
+    void append(std::vector<std::byte> &bytes, std::initializer_list<int> values) {
+        const std::vector<std::byte> tail = to_bytes(values);
+        bytes.insert(bytes.end(), tail.begin(), tail.end());
+    }
+
+    template<typename T>
+    std::vector<T> as(const std::vector<std::byte> &bytes) {
+        std::vector<T> values(bytes.size() / sizeof(T));
+        std::memcpy(values.data(), bytes.data(), values.size() * sizeof(T));
+        return values;
+    }
+
+    // one block of 4 byte elements, one lane per group width: raw bytes, 2 bit deltas with an escape, zeros and
+    // 4 bit deltas with an escape. the baseline element is {10, 20, 30, 40}
+    std::vector<std::byte> make_vertex_stream() {
+        std::vector<std::byte> stream = to_bytes({0xa0});
+        // raw zigzag deltas of +1
+        append(stream, {0x03, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2});
+        // an escaped -3, then -1s
+        append(stream, {0x01, 0xd5, 0x55, 0x55, 0x55, 0x05});
+        append(stream, {0x00});
+        // an escaped -128, then zeros
+        append(stream, {0x02, 0xf0, 0, 0, 0, 0, 0, 0, 0, 0xff});
+        stream.resize(stream.size() + 28, std::byte{0});
+        append(stream, {10, 20, 30, 40});
+        return stream;
+    }
+} // namespace
+
+TEST(MeshoptDecodeTest, VertexLanesDecodeEveryGroupWidth) {
+    const std::vector<std::byte> stream = make_vertex_stream();
+    // a whole group goes through the wide prefix sum, three elements through the scalar one
+    for (const size_t count: {size_t{16}, size_t{3}}) {
+        std::vector<std::byte> out(count * 4);
+        ASSERT_TRUE(meshoptdecode::decode_vertex_buffer(out, count, 4, stream));
+        const std::vector<uint8_t> bytes = as<uint8_t>(out);
+        for (size_t i = 0; i < count; i++) {
+            EXPECT_EQ(bytes[i * 4 + 0], 11 + i);
+            EXPECT_EQ(bytes[i * 4 + 1], 17 - i);
+            EXPECT_EQ(bytes[i * 4 + 2], 30);
+            EXPECT_EQ(bytes[i * 4 + 3], 168);
+        }
+    }
+}
+
+TEST(MeshoptDecodeTest, MalformedStreamsAreRejected) {
+    std::vector<std::byte> stream = make_vertex_stream();
+    std::vector<std::byte> out(16 * 4);
+    // a wrong header, a cut off stream and trailing bytes
+    std::vector<std::byte> badHeader = stream;
+    badHeader[0] = std::byte{0xa1};
+    EXPECT_FALSE(meshoptdecode::decode_vertex_buffer(out, 16, 4, badHeader));
+    EXPECT_FALSE(meshoptdecode::decode_vertex_buffer(out, 16, 4, std::span(stream).first(40)));
+    stream.push_back(std::byte{0});
+    EXPECT_FALSE(meshoptdecode::decode_vertex_buffer(out, 16, 4, stream));
+
+    const std::vector<std::byte> indices = to_bytes({0xe1, 0xfe});
+    EXPECT_FALSE(meshoptdecode::decode_index_buffer(out, 3, 4, indices));
+}
+
+TEST(MeshoptDecodeTest, TrianglesDecodeFromEdgeAndVertexCaches) {
+    // three new vertices, a triangle on the last edge with one more, then two explicit indices around a cached one
+    std::vector<std::byte> stream = to_bytes({0xe1, 0xfe, 0x10, 0xff, 0x00, 0x1f, 20, 2});
+    stream.resize(stream.size() + 16, std::byte{0});
+
+    std::vector<std::byte> out(9 * 4);
+    ASSERT_TRUE(meshoptdecode::decode_index_buffer(out, 9, 4, stream));
+    EXPECT_EQ(as<uint32_t>(out), (std::vector<uint32_t>{0, 1, 2, 2, 1, 3, 10, 3, 11}));
+
+    std::vector<std::byte> narrow(9 * 2);
+    ASSERT_TRUE(meshoptdecode::decode(meshoptdecode::Mode::Triangles, meshoptdecode::Filter::None, narrow, 9, 2,
+                                      stream));
+    EXPECT_EQ(as<uint16_t>(narrow), (std::vector<uint16_t>{0, 1, 2, 2, 1, 3, 10, 3, 11}));
+}
+
+TEST(MeshoptDecodeTest, IndexSequenceKeepsTwoBaselines) {
+    // 5, 6, 7 against the first baseline, 1000 against the second, then 4 against the first again
+    const std::vector<std::byte> stream = to_bytes({0xd1, 20, 4, 4, 161, 31, 10, 0, 0, 0, 0});
+    std::vector<std::byte> out(5 * 4);
+    ASSERT_TRUE(meshoptdecode::decode_index_sequence(out, 5, 4, stream));
+    EXPECT_EQ(as<uint32_t>(out), (std::vector<uint32_t>{5, 6, 7, 1000, 4}));
+}
+
+TEST(MeshoptDecodeTest, FiltersRestoreAttributes) {
+    // 3 * 2^-1 and -5 * 2^2, enough words for the wide path and its scalar tail
+    std::vector<uint32_t> exponential = {0xff000003u, 0x02fffffbu, 0xff000003u, 0x02fffffbu, 0x00000007u};
+    std::vector<std::byte> data(exponential.size() * 4);
+    std::memcpy(data.data(), exponential.data(), data.size());
+    ASSERT_TRUE(meshoptdecode::apply_filter(meshoptdecode::Filter::Exponential, data, exponential.size(), 4));
+    EXPECT_EQ(as<float>(data), (std::vector<float>{1.5f, -20.f, 1.5f, -20.f, 7.f}));
+
+    // +z, +x and a direction folded below the equator, the fourth byte passes through
+    std::vector<int8_t> octahedral = {0, 0, 127, 7, 127, 0, 127, -1, 64, 64, 127, 0};
+    data.assign(octahedral.size(), std::byte{0});
+    std::memcpy(data.data(), octahedral.data(), data.size());
+    ASSERT_TRUE(meshoptdecode::apply_filter(meshoptdecode::Filter::Octahedral, data, 3, 4));
+    const std::vector<int8_t> normals = as<int8_t>(data);
+    EXPECT_EQ(std::vector<int8_t>(normals.begin(), normals.begin() + 8),
+              (std::vector<int8_t>{0, 0, 127, 7, 127, 0, 0, -1}));
+    const float length = std::sqrt(static_cast<float>(normals[8] * normals[8] + normals[9] * normals[9] +
+                                                      normals[10] * normals[10]));
+    EXPECT_NEAR(length, 127.f, 1.f);
+    EXPECT_LT(normals[10], 0);
+
+    // the identity rotation with w dropped
+    std::vector<int16_t> quaternion = {0, 0, 0, 32767};
+    data.assign(8, std::byte{0});
+    std::memcpy(data.data(), quaternion.data(), data.size());
+    ASSERT_TRUE(meshoptdecode::apply_filter(meshoptdecode::Filter::Quaternion, data, 1, 8));
+    EXPECT_EQ(as<int16_t>(data), (std::vector<int16_t>{0, 0, 0, 32767}));
+}
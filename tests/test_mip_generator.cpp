@@ -0,0 +1,149 @@
+#include <JobSystem.h>
+#include <MipGenerator.h>
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+    std::vector<uint8_t> checkerboard(uint32_t width, uint32_t height, uint8_t a, uint8_t b) {
+        std::vector<uint8_t> rgba(size_t(width) * height * 4);
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                uint8_t *texel = rgba.data() + (size_t(y) * width + x) * 4;
+                texel[0] = texel[1] = texel[2] = ((x + y) % 2 == 0) ? a : b;
+                texel[3] = 255;
+            }
+        }
+        return rgba;
+    }
+
+    // foliage like cutout: opaque leaves a few texels wide with soft edges, scattered over a transparent background
+    std::vector<uint8_t> cutout(uint32_t width, uint32_t height) {
+        std::vector<uint8_t> rgba(size_t(width) * height * 4);
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                uint8_t *texel = rgba.data() + (size_t(y) * width + x) * 4;
+                texel[0] = 40;
+                texel[1] = 160;
+                texel[2] = 30;
+                const float leaf = std::sin(float(x) * 0.45f) * std::sin(float(y) * 0.31f + float(x) * 0.05f);
+                texel[3] = static_cast<uint8_t>(std::clamp((leaf - 0.2f) * 4.f, 0.f, 1.f) * 255.f);
+            }
+        }
+        return rgba;
+    }
+
+    const uint8_t *level_data(const MipChain &chain, size_t level) {
+        return chain.data.data() + chain.levels[level].offset;
+    }
+} // namespace
+
+TEST(MipGeneratorTest, ChainCoversEveryLevelBackToBack) {
+    const std::vector<uint8_t> rgba = checkerboard(40, 12, 10, 200);
+    const MipChain chain = mipgen::generate(rgba.data(), 40, 12, {});
+
+    EXPECT_EQ(chain.format, VK_FORMAT_R8G8B8A8_UNORM);
+    ASSERT_EQ(chain.levels.size(), blockcompress::mip_count(40, 12));
+    EXPECT_EQ(chain.data.size(), blockcompress::image_bytes(VK_FORMAT_R8G8B8A8_UNORM, 40, 12, true));
+    EXPECT_TRUE(std::equal(rgba.begin(), rgba.end(), chain.data.begin()));
+    EXPECT_EQ(chain.levels.back().width, 1u);
+    EXPECT_EQ(chain.levels.back().height, 1u);
+}
+
+TEST(MipGeneratorTest, BoxFilterAveragesLinearData) {
+    const std::vector<uint8_t> rgba = checkerboard(8, 8, 0, 255);
+    mipgen::MipSettings settings;
+    settings.filter = mipgen::MipFilter::Box;
+    const MipChain chain = mipgen::generate(rgba.data(), 8, 8, settings);
+
+    for (size_t level = 1; level < chain.levels.size(); level++) {
+        EXPECT_EQ(level_data(chain, level)[0], 128) << "level " << level;
+    }
+}
+
+TEST(MipGeneratorTest, SrgbIsFilteredInLinearLight) {
+    // black and white average to half the light, which is 188 in sRGB and not the 128 a UNORM blit gives
+    const std::vector<uint8_t> rgba = checkerboard(8, 8, 0, 255);
+    mipgen::MipSettings settings;
+    settings.filter = mipgen::MipFilter::Box;
+    settings.srgb = true;
+    const MipChain chain = mipgen::generate(rgba.data(), 8, 8, settings);
+
+    const uint8_t *level1 = level_data(chain, 1);
+    EXPECT_EQ(level1[0], 188);
+    EXPECT_EQ(level1[1], 188);
+    EXPECT_EQ(level1[2], 188);
+    EXPECT_EQ(level1[3], 255); // alpha stays linear
+}
+
+TEST(MipGeneratorTest, FlatColorsStayFlatForEveryFilterAndSize) {
+    for (const mipgen::MipFilter filter: {mipgen::MipFilter::Box, mipgen::MipFilter::Kaiser}) {
+        for (const bool srgb: {false, true}) {
+            std::vector<uint8_t> rgba(size_t(37) * 11 * 4);
+            for (size_t i = 0; i < rgba.size(); i += 4) {
+                rgba[i + 0] = 90;
+                rgba[i + 1] = 180;
+                rgba[i + 2] = 30;
+                rgba[i + 3] = 200;
+            }
+            mipgen::MipSettings settings;
+            settings.filter = filter;
+            settings.srgb = srgb;
+            const MipChain chain = mipgen::generate(rgba.data(), 37, 11, settings);
+
+            for (size_t i = 0; i < chain.data.size(); i += 4) {
+                ASSERT_NEAR(chain.data[i + 0], 90, 1) << mipgen::name(filter) << " srgb " << srgb;
+                ASSERT_NEAR(chain.data[i + 1], 180, 1) << mipgen::name(filter) << " srgb " << srgb;
+                ASSERT_NEAR(chain.data[i + 2], 30, 1) << mipgen::name(filter) << " srgb " << srgb;
+                ASSERT_NEAR(chain.data[i + 3], 200, 1) << mipgen::name(filter) << " srgb " << srgb;
+            }
+        }
+    }
+}
+
+TEST(MipGeneratorTest, AlphaCoverageIsPreservedForCutouts) {
+    constexpr uint32_t size = 128;
+    constexpr float cutoff = 0.5f;
+    const std::vector<uint8_t> rgba = cutout(size, size);
+    const float base = mipgen::alpha_coverage(rgba.data(), size, size, cutoff);
+
+    mipgen::MipSettings plain;
+    mipgen::MipSettings preserved;
+    preserved.alphaCutoff = cutoff;
+    const MipChain faded = mipgen::generate(rgba.data(), size, size, plain);
+    const MipChain kept = mipgen::generate(rgba.data(), size, size, preserved);
+
+    // at 1/8 size a leaf is smaller than a texel, plain filtering averages most of them below the cutoff
+    const MipLevel &level = kept.levels[3];
+    const float fadedCoverage = mipgen::alpha_coverage(level_data(faded, 3), level.width, level.height, cutoff);
+    const float keptCoverage = mipgen::alpha_coverage(level_data(kept, 3), level.width, level.height, cutoff);
+    EXPECT_LT(fadedCoverage, base * 0.5f);
+    EXPECT_NEAR(keptCoverage, base, 0.05f);
+}
+
+TEST(MipGeneratorTest, SettingsChangeTheKey) {
+    mipgen::MipSettings a;
+    mipgen::MipSettings b = a;
+    EXPECT_EQ(mipgen::settings_key(a), mipgen::settings_key(b));
+    b.srgb = true;
+    EXPECT_NE(mipgen::settings_key(a), mipgen::settings_key(b));
+    b = a;
+    b.alphaCutoff = 0.5f;
+    EXPECT_NE(mipgen::settings_key(a), mipgen::settings_key(b));
+    b = a;
+    b.filter = mipgen::MipFilter::Box;
+    EXPECT_NE(mipgen::settings_key(a), mipgen::settings_key(b));
+}
+
+TEST(MipGeneratorTest, ParallelMatchesSerial) {
+    const std::vector<uint8_t> rgba = cutout(300, 200);
+    JobSystem jobs(3);
+    mipgen::MipSettings settings;
+    settings.srgb = true;
+    settings.alphaCutoff = 0.5f;
+
+    const MipChain serial = mipgen::generate(rgba.data(), 300, 200, settings);
+    const MipChain parallel = mipgen::generate(rgba.data(), 300, 200, settings, &jobs);
+    EXPECT_EQ(serial.data, parallel.data);
+}
@@ -0,0 +1,157 @@
+// the engine builds its projections for Vulkan's 0..1 depth range
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE 1
+
+#include <JobSystem.h>
+#include <OcclusionCull.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+
+    // the engine's camera: reversed Z, y flipped for Vulkan, looking down -z from the origin
+    glm::mat4 camera_viewproj() {
+        glm::mat4 projection = glm::perspective(glm::radians(70.f), 2.f, 1000.f, 0.1f);
+        projection[1][1] *= -1;
+        return projection * glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+    }
+
+    // two triangles spanning the corners, listed counter clockwise
+    occlusion::OccluderMesh quad(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c, const glm::vec3 &d) {
+        return occlusion::OccluderMesh{{a, b, c, a, c, d}};
+    }
+
+    // a 10 x 10 wall facing the camera 10 units ahead
+    occlusion::OccluderMesh wall() {
+        return quad({-5.f, -5.f, -10.f}, {5.f, -5.f, -10.f}, {5.f, 5.f, -10.f}, {-5.f, 5.f, -10.f});
+    }
+
+    bool hidden(const occlusion::DepthBuffer &buffer, const glm::vec3 &center, float extent) {
+        return occlusion::occluded(buffer, center, glm::vec3(extent), camera_viewproj());
+    }
+
+} // namespace
+
+TEST(OcclusionCullTest, EmptyBufferHidesNothing) {
+    occlusion::DepthBuffer buffer;
+    EXPECT_EQ(occlusion::rasterize(buffer, {}), 0u);
+    EXPECT_FALSE(hidden(buffer, {0.f, 0.f, -20.f}, 1.f));
+    EXPECT_FALSE(hidden(buffer, {0.f, 0.f, -900.f}, 1.f));
+}
+
+TEST(OcclusionCullTest, OnlyLargeSimpleSolidSurfacesKeepAnOccluder) {
+    EXPECT_TRUE(occlusion::keeps_occluder(2, 5.f, false));
+    EXPECT_TRUE(occlusion::keeps_occluder(occlusion::MAX_OCCLUDER_TRIANGLES, occlusion::MIN_OCCLUDER_RADIUS, false));
+    EXPECT_FALSE(occlusion::keeps_occluder(occlusion::MAX_OCCLUDER_TRIANGLES + 1, 5.f, false));
+    EXPECT_FALSE(occlusion::keeps_occluder(2, 0.1f, false));
+    // alpha tested, its holes let through what it seems to hide
+    EXPECT_FALSE(occlusion::keeps_occluder(2, 5.f, true));
+}
+
+TEST(OcclusionCullTest, WallHidesOnlyBoxesFullyBehindIt) {
+    const occlusion::OccluderMesh mesh = wall();
+    const occlusion::Occluder occluder{&mesh, camera_viewproj()};
+    occlusion::DepthBuffer buffer;
+    EXPECT_EQ(occlusion::rasterize(buffer, {&occluder, 1}), 2u);
+
+    // off the diagonal, the pixels straddling the edge the two triangles share stay empty
+    EXPECT_TRUE(hidden(buffer, {-2.f, 2.f, -20.f}, 1.f));
+    EXPECT_TRUE(hidden(buffer, {2.f, -2.f, -11.f}, 0.5f));
+    // in front of the wall, crossing it, reaching around it and beside it
+    EXPECT_FALSE(hidden(buffer, {0.f, 0.f, -5.f}, 1.f));
+    EXPECT_FALSE(hidden(buffer, {0.f, 0.f, -10.f}, 0.5f));
+    EXPECT_FALSE(hidden(buffer, {0.f, 0.f, -20.f}, 12.f));
+    EXPECT_FALSE(hidden(buffer, {15.f, 0.f, -20.f}, 1.f));
+    // the near plane runs through this one
+    EXPECT_FALSE(hidden(buffer, {0.f, 0.f, 0.f}, 1.f));
+}
+
+TEST(OcclusionCullTest, BoxBesideTheEdgeInAPartlyCoveredPixelIsNotHidden) {
+    // the wall's right edge lands at buffer x = 173.7, the thin box behind it spans x = 173.73 to 173.96: inside
+    // the pixel whose center the wall covers, but entirely beside the wall
+    const occlusion::OccluderMesh mesh = wall();
+    const occlusion::Occluder occluder{&mesh, camera_viewproj()};
+    occlusion::DepthBuffer buffer;
+    occlusion::rasterize(buffer, {&occluder, 1});
+
+    EXPECT_EQ(buffer.at(173, 64), 0.f);
+    EXPECT_GT(buffer.at(172, 64), 0.f);
+    EXPECT_FALSE(occlusion::occluded(buffer, {10.032f, 0.f, -20.f}, {0.02f, 0.5f, 0.01f}, camera_viewproj()));
+    // the same box moved a few pixels behind the wall
+    EXPECT_TRUE(occlusion::occluded(buffer, {9.f, 0.f, -20.f}, {0.02f, 0.5f, 0.01f}, camera_viewproj()));
+}
+
+TEST(OcclusionCullTest, OccluderCrossingTheNearPlaneIsClippedNotDropped) {
+    // a floor under the camera reaching from behind it far ahead, every triangle has a corner behind the camera
+    const occlusion::OccluderMesh floor =
+        quad({-100.f, -1.f, 10.f}, {100.f, -1.f, 10.f}, {100.f, -1.f, -100.f}, {-100.f, -1.f, -100.f});
+    const occlusion::Occluder occluder{&floor, camera_viewproj()};
+    occlusion::DepthBuffer buffer;
+    EXPECT_GT(occlusion::rasterize(buffer, {&occluder, 1}), 0u);
+
+    EXPECT_TRUE(hidden(buffer, {0.f, -5.f, -20.f}, 1.f));
+    EXPECT_FALSE(hidden(buffer, {0.f, 2.f, -20.f}, 1.f));
+}
+
+TEST(OcclusionCullTest, TilesOnTheJobSystemMatchTheSerialResult) {
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<float> position(-30.f, 30.f);
+    std::uniform_real_distribution<float> depth(-60.f, -2.f);
+    std::vector<occlusion::OccluderMesh> meshes(40);
+    for (occlusion::OccluderMesh &mesh: meshes) {
+        for (int corner = 0; corner < 30; corner++) {
+            mesh.corners.emplace_back(position(rng), position(rng), depth(rng));
+        }
+    }
+    std::vector<occlusion::Occluder> occluders;
+    for (const occlusion::OccluderMesh &mesh: meshes) {
+        occluders.push_back({&mesh, camera_viewproj()});
+    }
+
+    occlusion::DepthBuffer serial;
+    occlusion::DepthBuffer parallel;
+    JobSystem jobs(3);
+    EXPECT_EQ(occlusion::rasterize(serial, occluders), occlusion::rasterize(parallel, occluders, &jobs));
+    EXPECT_EQ(serial.depth, parallel.depth);
+    EXPECT_EQ(serial.blockMin, parallel.blockMin);
+
+    // the coarse level never claims more than the pixels under it
+    for (uint32_t y = 0; y < occlusion::HEIGHT; y++) {
+        for (uint32_t x = 0; x < occlusion::WIDTH; x++) {
+            const uint32_t block = (y / occlusion::BLOCK_SIZE) * occlusion::BLOCKS_X + x / occlusion::BLOCK_SIZE;
+            ASSERT_LE(serial.blockMin[block], serial.at(x, y));
+        }
+    }
+}
+
+TEST(OcclusionCullTest, DepthIsNeverNearerThanTheOccluder) {
+    // a wall leaning away from the camera, the stored depth at every covered pixel has to stay at or behind it
+    const occlusion::OccluderMesh leaning =
+        quad({-5.f, -5.f, -6.f}, {5.f, -5.f, -14.f}, {5.f, 5.f, -14.f}, {-5.f, 5.f, -6.f});
+    const occlusion::Occluder occluder{&leaning, camera_viewproj()};
+    occlusion::DepthBuffer buffer;
+    occlusion::rasterize(buffer, {&occluder, 1});
+
+    const glm::mat4 viewproj = camera_viewproj();
+    uint32_t covered = 0;
+    for (uint32_t y = 0; y < occlusion::HEIGHT; y++) {
+        for (uint32_t x = 0; x < occlusion::WIDTH; x++) {
+            if (buffer.at(x, y) <= 0.f) {
+                continue;
+            }
+            covered++;
+            // the wall's plane x = -1.25 * (z + 10) seen through both edges of the pixel, the farther one bounds
+            float farthest = 1.f;
+            for (const float px: {static_cast<float>(x), static_cast<float>(x + 1)}) {
+                const float ndcX = px / occlusion::WIDTH * 2.f - 1.f;
+                // the view ray x = ndcX * k * t, z = -t meets the plane where ndcX * k * t = 1.25 * (t - 10)
+                const float k = 2.f * std::tan(glm::radians(35.f));
+                const float t = 12.5f / (1.25f - ndcX * k);
+                const glm::vec4 clip = viewproj * glm::vec4(ndcX * k * t, 0.f, -t, 1.f);
+                farthest = std::min(farthest, clip.z / clip.w);
+            }
+            ASSERT_LE(buffer.at(x, y), farthest + 1e-6f) << x << ", " << y;
+        }
+    }
+    EXPECT_GT(covered, 1000u);
+}
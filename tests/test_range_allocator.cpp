@@ -0,0 +1,102 @@
+#include <RangeAllocator.h>
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+TEST(RangeAllocatorTest, AllocatesUntilFull) {
+    RangeAllocator allocator(1024, 16);
+
+    EXPECT_EQ(allocator.allocate(512), 0u);
+    EXPECT_EQ(allocator.allocate(500), 512u); // rounded up to 512
+    EXPECT_EQ(allocator.allocate(1), RangeAllocator::INVALID_OFFSET);
+    EXPECT_EQ(allocator.used(), 1024u);
+    EXPECT_EQ(allocator.allocation_count(), 2u);
+}
+
+TEST(RangeAllocatorTest, OffsetsFollowGranularity) {
+    RangeAllocator allocator(4096, 16);
+
+    for (uint64_t size: {3u, 24u, 80u, 1u, 33u}) {
+        const uint64_t offset = allocator.allocate(size);
+        ASSERT_NE(offset, RangeAllocator::INVALID_OFFSET);
+        EXPECT_EQ(offset % 16, 0u);
+    }
+}
+
+TEST(RangeAllocatorTest, FreeMergesNeighbours) {
+    RangeAllocator allocator(300, 1);
+    const uint64_t a = allocator.allocate(100);
+    const uint64_t b = allocator.allocate(100);
+    const uint64_t c = allocator.allocate(100);
+
+    allocator.free(a);
+    allocator.free(c);
+    EXPECT_EQ(allocator.free_range_count(), 2u);
+    EXPECT_EQ(allocator.largest_free_range(), 100u);
+
+    // freeing the middle joins all three back into one range
+    allocator.free(b);
+    EXPECT_EQ(allocator.free_range_count(), 1u);
+    EXPECT_EQ(allocator.largest_free_range(), 300u);
+    EXPECT_TRUE(allocator.empty());
+    EXPECT_EQ(allocator.allocate(300), 0u);
+}
+
+TEST(RangeAllocatorTest, PicksBestFit) {
+    RangeAllocator allocator(1000, 1);
+    const uint64_t a = allocator.allocate(300);
+    allocator.allocate(10);
+    const uint64_t c = allocator.allocate(100);
+    allocator.allocate(10);
+
+    allocator.free(a); // 300 byte hole at 0
+    allocator.free(c); // 100 byte hole at 310, plus 580 at the end
+
+    EXPECT_EQ(allocator.allocate(90), c);
+    EXPECT_EQ(allocator.allocate(250), a);
+}
+
+TEST(RangeAllocatorTest, RandomAllocationsNeverOverlap) {
+    RangeAllocator allocator(1 << 20, 16);
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<uint64_t> sizes(1, 8192);
+
+    struct Range {
+        uint64_t offset;
+        uint64_t size;
+    };
+    std::vector<Range> live;
+
+    for (int i = 0; i < 5000; i++) {
+        if (!live.empty() && (rng() % 3 == 0)) {
+            const size_t victim = rng() % live.size();
+            allocator.free(live[victim].offset);
+            live.erase(live.begin() + static_cast<std::ptrdiff_t>(victim));
+            continue;
+        }
+
+        const uint64_t size = sizes(rng);
+        const uint64_t offset = allocator.allocate(size);
+        if (offset != RangeAllocator::INVALID_OFFSET) {
+            live.push_back({offset, (size + 15) / 16 * 16});
+        }
+    }
+
+    std::sort(live.begin(), live.end(), [](const Range &a, const Range &b) { return a.offset < b.offset; });
+    uint64_t used = 0;
+    for (size_t i = 0; i < live.size(); i++) {
+        used += live[i].size;
+        EXPECT_LE(live[i].offset + live[i].size, allocator.capacity());
+        if (i > 0) {
+            EXPECT_LE(live[i - 1].offset + live[i - 1].size, live[i].offset);
+        }
+    }
+    EXPECT_EQ(used, allocator.used());
+
+    for (const Range &range: live) {
+        allocator.free(range.offset);
+    }
+    EXPECT_EQ(allocator.free_range_count(), 1u);
+    EXPECT_EQ(allocator.largest_free_range(), allocator.capacity());
+}
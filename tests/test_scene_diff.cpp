@@ -0,0 +1,100 @@
+#include <SceneDiff.h>
+#include <gtest/gtest.h>
+
+namespace {
+
+    scenediff::SceneHashes make_scene() {
+        scenediff::SceneHashes scene;
+        scene.structure = 42;
+        scene.images = {10, 11, 12};
+        scene.materials = {20, 21, 22};
+        scene.meshes = {30, 31};
+        scene.nodes = {40, 41, 42, 43};
+        // material 0 samples images 0 and 1, material 2 image 1, material 1 none
+        scene.materialImages = {{0, 1}, {}, {1}};
+        return scene;
+    }
+
+} // namespace
+
+TEST(SceneDiffTest, IdenticalScenesHaveNothingToDo) {
+    const scenediff::SceneDiff diff = scenediff::diff(make_scene(), make_scene());
+    EXPECT_TRUE(diff.empty());
+}
+
+TEST(SceneDiffTest, ChangedAssetsAreListedByIndex) {
+    scenediff::SceneHashes changed = make_scene();
+    changed.materials[2] = 99;
+    changed.meshes[0] = 99;
+    changed.nodes[1] = 99;
+    changed.nodes[3] = 99;
+
+    const scenediff::SceneDiff diff = scenediff::diff(make_scene(), changed);
+    EXPECT_FALSE(diff.structural);
+    EXPECT_TRUE(diff.images.empty());
+    EXPECT_EQ(diff.materials, std::vector<uint32_t>({2}));
+    EXPECT_EQ(diff.meshes, std::vector<uint32_t>({0}));
+    EXPECT_EQ(diff.nodes, std::vector<uint32_t>({1, 3}));
+}
+
+TEST(SceneDiffTest, ChangedImageRewritesTheMaterialsSamplingIt) {
+    scenediff::SceneHashes changed = make_scene();
+    changed.images[1] = 99;
+    changed.materials[2] = 98;
+
+    const scenediff::SceneDiff diff = scenediff::diff(make_scene(), changed);
+    EXPECT_EQ(diff.images, std::vector<uint32_t>({1}));
+    // material 2 changed itself and samples the image, it is listed once and the list stays sorted
+    EXPECT_EQ(diff.materials, std::vector<uint32_t>({0, 2}));
+}
+
+TEST(SceneDiffTest, StructureOrCountChangeLoadsFromScratch) {
+    scenediff::SceneHashes restructured = make_scene();
+    restructured.structure = 43;
+    EXPECT_TRUE(scenediff::diff(make_scene(), restructured).structural);
+
+    scenediff::SceneHashes grown = make_scene();
+    grown.meshes.push_back(32);
+    const scenediff::SceneDiff diff = scenediff::diff(make_scene(), grown);
+    EXPECT_TRUE(diff.structural);
+    EXPECT_FALSE(diff.empty());
+    EXPECT_TRUE(diff.meshes.empty());
+}
+
+TEST(SceneDiffTest, InstancesRebuildOnlyWhatMoved) {
+    const std::vector<scenediff::Instance> built = {{1, 100, false}, {2, 100, false}, {3, 100, true}};
+
+    std::vector<scenediff::Instance> same = built;
+    scenediff::InstanceDiff diff = scenediff::diff_instances(built, same);
+    EXPECT_FALSE(diff.rebuildAll);
+    EXPECT_TRUE(diff.blas.empty());
+    EXPECT_FALSE(diff.tlas);
+
+    std::vector<scenediff::Instance> moved = built;
+    moved[0].transform = 101;
+    diff = scenediff::diff_instances(built, moved);
+    EXPECT_TRUE(diff.blas.empty());
+    EXPECT_TRUE(diff.tlas);
+
+    std::vector<scenediff::Instance> reshaped = built;
+    reshaped[2].geometry = 4;
+    diff = scenediff::diff_instances(built, reshaped);
+    EXPECT_FALSE(diff.rebuildAll);
+    EXPECT_EQ(diff.blas, std::vector<uint32_t>({2}));
+    EXPECT_TRUE(diff.tlas);
+}
+
+TEST(SceneDiffTest, InstanceListChangingShapeRebuildsEverything) {
+    const std::vector<scenediff::Instance> built = {{1, 100, false}, {2, 100, true}};
+
+    std::vector<scenediff::Instance> blended = built;
+    blended[0].transparent = true;
+    blended[1].geometry = 5;
+    scenediff::InstanceDiff diff = scenediff::diff_instances(built, blended);
+    EXPECT_TRUE(diff.rebuildAll);
+    EXPECT_TRUE(diff.tlas);
+
+    std::vector<scenediff::Instance> fewer = {built[0]};
+    diff = scenediff::diff_instances(built, fewer);
+    EXPECT_TRUE(diff.rebuildAll);
+}
@@ -0,0 +1,116 @@
+#include "TestMeshes.h"
+
+#include <Simplify.h>
+#include <gtest/gtest.h>
+#include <set>
+#include <vector>
+
+namespace {
+    glm::vec3 face_normal(const testmesh::Grid &patch, const uint32_t *tri, uint32_t baseVertex) {
+        const glm::vec3 &p0 = patch.vertices[tri[0] - baseVertex].position;
+        const glm::vec3 &p1 = patch.vertices[tri[1] - baseVertex].position;
+        const glm::vec3 &p2 = patch.vertices[tri[2] - baseVertex].position;
+        return glm::cross(p1 - p0, p2 - p0);
+    }
+} // namespace
+
+TEST(SimplifyTest, FlatGridCollapsesWithoutError) {
+    constexpr uint32_t baseVertex = 300;
+    const testmesh::Grid patch = testmesh::make_unit_grid(33, baseVertex);
+    const size_t target = patch.indices.size() / 4;
+
+    float error = 1.f;
+    const std::vector<uint32_t> result =
+        simplify::simplify(patch.indices, patch.vertices, baseVertex, target, 1.f, &error);
+
+    EXPECT_LE(result.size(), target);
+    EXPECT_EQ(result.size() % 3, 0u);
+    EXPECT_NEAR(error, 0.f, 1e-4f);
+    for (size_t i = 0; i < result.size(); i += 3) {
+        for (uint32_t k = 0; k < 3; k++) {
+            ASSERT_GE(result[i + k], baseVertex);
+            ASSERT_LT(result[i + k], baseVertex + patch.vertices.size());
+        }
+        // nothing flipped or folded over
+        EXPECT_GT(face_normal(patch, &result[i], baseVertex).z, 0.f);
+    }
+}
+
+TEST(SimplifyTest, BorderVerticesStayPut) {
+    constexpr uint32_t side = 17;
+    const testmesh::Grid patch = testmesh::make_unit_grid(side, 0);
+
+    const std::vector<uint32_t> result = simplify::simplify(patch.indices, patch.vertices, 0, 0, 1.f);
+    const std::set<uint32_t> used(result.begin(), result.end());
+
+    for (uint32_t i = 0; i < side; i++) {
+        EXPECT_TRUE(used.contains(i));
+        EXPECT_TRUE(used.contains((side - 1) * side + i));
+        EXPECT_TRUE(used.contains(i * side));
+        EXPECT_TRUE(used.contains(i * side + side - 1));
+    }
+}
+
+TEST(SimplifyTest, SeamVerticesStayPut) {
+    testmesh::Grid patch = testmesh::make_unit_grid(17, 0);
+
+    // split the center vertex like a UV seam would: the triangles right of it use a copy at the same position
+    const uint32_t center = 8 * 17 + 8;
+    const auto copy = static_cast<uint32_t>(patch.vertices.size());
+    patch.vertices.push_back(patch.vertices[center]);
+    for (size_t i = 0; i < patch.indices.size(); i += 3) {
+        float centroidX = 0.f;
+        for (uint32_t k = 0; k < 3; k++) {
+            centroidX += patch.vertices[patch.indices[i + k]].position.x / 3.f;
+        }
+        for (uint32_t k = 0; k < 3; k++) {
+            if (patch.indices[i + k] == center && centroidX > patch.vertices[center].position.x) {
+                patch.indices[i + k] = copy;
+            }
+        }
+    }
+
+    const std::vector<uint32_t> result = simplify::simplify(patch.indices, patch.vertices, 0, 0, 1.f);
+    const std::set<uint32_t> used(result.begin(), result.end());
+    EXPECT_TRUE(used.contains(center));
+    EXPECT_TRUE(used.contains(copy));
+    EXPECT_LT(result.size(), patch.indices.size() / 2);
+}
+
+TEST(SimplifyTest, ErrorLimitStopsCollapses) {
+    const testmesh::Grid patch = testmesh::make_unit_grid(33, 0, 0.3f);
+
+    float error = 0.f;
+    const std::vector<uint32_t> loose = simplify::simplify(patch.indices, patch.vertices, 0, 0, 1.f, &error);
+    EXPECT_GT(error, 0.f);
+
+    const float limit = error * 0.1f;
+    float strictError = 0.f;
+    const std::vector<uint32_t> strict = simplify::simplify(patch.indices, patch.vertices, 0, 0, limit, &strictError);
+    EXPECT_LE(strictError, limit);
+    EXPECT_GT(strict.size(), loose.size());
+}
+
+TEST(SimplifyTest, LodChainShrinksAndErrorGrows) {
+    constexpr uint32_t baseVertex = 42;
+    const testmesh::Grid patch = testmesh::make_unit_grid(65, baseVertex, 0.2f);
+
+    const std::vector<simplify::LodLevel> levels = simplify::build_lods(patch.indices, patch.vertices, baseVertex);
+    ASSERT_GE(levels.size(), 3u);
+    ASSERT_LE(levels.size(), simplify::MAX_LODS);
+
+    size_t previousCount = patch.indices.size();
+    float previousError = 0.f;
+    for (const simplify::LodLevel &level: levels) {
+        EXPECT_LT(level.indices.size(), previousCount);
+        EXPECT_GE(level.error, previousError);
+        // diagonal of the patch is ~1.4, the budget is a tenth of half of it
+        EXPECT_LE(level.error, simplify::MAX_RELATIVE_ERROR * 0.75f);
+        previousCount = level.indices.size();
+        previousError = level.error;
+    }
+
+    // a single quad is not worth any levels
+    const testmesh::Grid quad = testmesh::make_unit_grid(2, 0);
+    EXPECT_TRUE(simplify::build_lods(quad.indices, quad.vertices, 0).empty());
+}
@@ -0,0 +1,70 @@
+#include <StagingRing.h>
+#include <gtest/gtest.h>
+
+TEST(StagingRingTest, AllocatesAlignedUntilFull) {
+    StagingRing ring(1024, 16);
+
+    EXPECT_EQ(ring.allocate(100), 0u);
+    EXPECT_EQ(ring.allocate(100), 112u); // aligned up from 100
+    EXPECT_EQ(ring.allocate(1024), StagingRing::INVALID_OFFSET);
+    EXPECT_EQ(ring.used(), 212u);
+}
+
+TEST(StagingRingTest, SpaceReturnsOnlyWhenBatchRetires) {
+    StagingRing ring(1024, 1);
+
+    ASSERT_EQ(ring.allocate(600), 0u);
+    ring.close_batch(1);
+    ASSERT_EQ(ring.allocate(300), 600u);
+    ring.close_batch(2);
+
+    // batch 1 is still on the GPU, nothing past the tail may be handed out
+    EXPECT_EQ(ring.allocate(200), StagingRing::INVALID_OFFSET);
+    EXPECT_EQ(ring.batches_in_flight(), 2u);
+    EXPECT_EQ(ring.oldest_batch(), 1u);
+
+    ring.retire(1);
+    EXPECT_EQ(ring.used(), 300u);
+    EXPECT_EQ(ring.oldest_batch(), 2u);
+}
+
+TEST(StagingRingTest, WrapsInsteadOfSplitting) {
+    StagingRing ring(1000, 1);
+
+    ASSERT_EQ(ring.allocate(700), 0u);
+    ring.close_batch(1);
+    ASSERT_EQ(ring.allocate(200), 700u);
+    ring.close_batch(2);
+    ring.retire(1);
+
+    // 100 bytes left before the end, the allocation starts over at the front
+    EXPECT_EQ(ring.allocate(400), 0u);
+    // the skipped tail counts as used until the batch retires
+    EXPECT_EQ(ring.used(), 200u + 100u + 400u);
+    EXPECT_EQ(ring.allocate(400), StagingRing::INVALID_OFFSET);
+}
+
+TEST(StagingRingTest, IdleRingStartsOverAtTheFront) {
+    StagingRing ring(1024, 1);
+
+    ring.allocate(900);
+    ring.close_batch(5);
+    ring.retire(5);
+
+    EXPECT_EQ(ring.used(), 0u);
+    EXPECT_EQ(ring.batches_in_flight(), 0u);
+    EXPECT_EQ(ring.allocate(1024), 0u);
+}
+
+TEST(StagingRingTest, EmptyBatchesAreNotTracked) {
+    StagingRing ring(1024, 1);
+
+    ring.close_batch(1);
+    EXPECT_EQ(ring.batches_in_flight(), 0u);
+
+    ring.allocate(10);
+    EXPECT_EQ(ring.open_bytes(), 10u);
+    ring.close_batch(2);
+    EXPECT_EQ(ring.open_bytes(), 0u);
+    EXPECT_EQ(ring.batches_in_flight(), 1u);
+}
@@ -0,0 +1,126 @@
+#include <StreamingPolicy.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+    // RGBA8 chain layout of a square texture, levels back to back
+    std::vector<MipLevel> chain_levels(uint32_t size) {
+        std::vector<MipLevel> levels;
+        uint64_t offset = 0;
+        for (uint32_t s = size;; s /= 2) {
+            const uint64_t bytes = uint64_t(s) * s * 4;
+            levels.push_back({s, s, offset, bytes});
+            offset += bytes;
+            if (s == 1) {
+                break;
+            }
+        }
+        return levels;
+    }
+} // namespace
+
+TEST(StreamingPolicyTest, FeedbackIsRelativeToTheBoundTail) {
+    constexpr uint32_t bias = streaming::FEEDBACK_BIAS;
+    EXPECT_FALSE(streaming::requested_level(streaming::NO_REQUEST, 3, 11).has_value());
+    // level 0 of a tail starting at level 3
+    EXPECT_EQ(streaming::requested_level(bias, 3, 11), 3u);
+    // two levels finer than what is bound
+    EXPECT_EQ(streaming::requested_level(bias - 2, 3, 11), 1u);
+    // clamped to the chain
+    EXPECT_EQ(streaming::requested_level(0, 3, 11), 0u);
+    EXPECT_EQ(streaming::requested_level(bias + 20, 3, 11), 10u);
+}
+
+TEST(StreamingPolicyTest, FloorAndTailBytes) {
+    const std::vector<MipLevel> levels = chain_levels(1024);
+    ASSERT_EQ(levels.size(), 11u);
+    EXPECT_EQ(streaming::floor_level(levels, 128), 3u);
+    EXPECT_EQ(streaming::floor_level(levels, 4096), 0u);
+    EXPECT_EQ(streaming::floor_level(levels, 0), 10u);
+
+    EXPECT_EQ(streaming::tail_bytes(levels, 0), levels.back().offset + levels.back().size);
+    EXPECT_EQ(streaming::tail_bytes(levels, 10), 4u);
+    EXPECT_EQ(streaming::tail_bytes(levels, 11), 0u);
+    EXPECT_EQ(streaming::tail_bytes(levels, 3) - streaming::tail_bytes(levels, 4), 128u * 128u * 4u);
+}
+
+TEST(StreamingPolicyTest, DemandKeepsFinerLevelsForAWhile) {
+    constexpr uint32_t floorTop = 4;
+    constexpr uint32_t retain = 10;
+    streaming::Demand demand{floorTop, 0};
+
+    EXPECT_EQ(streaming::update_demand(demand, 1u, 1, floorTop, retain), 1u);
+    // the camera moved away, the finer level stays until it is old
+    EXPECT_EQ(streaming::update_demand(demand, 3u, 5, floorTop, retain), 1u);
+    EXPECT_EQ(streaming::update_demand(demand, {}, 8, floorTop, retain), 1u);
+    EXPECT_EQ(streaming::update_demand(demand, 3u, 11, floorTop, retain), 3u);
+    // nothing sampled it for long enough, back to the floor
+    EXPECT_EQ(streaming::update_demand(demand, {}, 25, floorTop, retain), floorTop);
+    // requests never go below the floor
+    EXPECT_EQ(streaming::update_demand(demand, 9u, 40, floorTop, retain), floorTop);
+}
+
+TEST(StreamingPolicyTest, UpgradesFitTheResidentBudget) {
+    const std::vector<MipLevel> levels = chain_levels(1024);
+    const std::vector<streaming::Residency> textures = {
+        {levels, 3, 0, 3},
+        {levels, 3, 0, 3},
+    };
+
+    // room for one full chain next to the other's floor tail
+    const uint64_t budget = streaming::tail_bytes(levels, 0) + streaming::tail_bytes(levels, 3);
+    const std::vector<streaming::Change> changes = streaming::plan(textures, {budget, ~0ull});
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].top, 0u);
+}
+
+TEST(StreamingPolicyTest, MostStarvedTextureGoesFirst) {
+    const std::vector<MipLevel> levels = chain_levels(1024);
+    const std::vector<streaming::Residency> textures = {
+        {levels, 3, 2, 3},
+        {levels, 3, 0, 3},
+    };
+
+    // only one upgrade fits in the upload budget once another was made
+    const uint64_t upload = streaming::tail_bytes(levels, 0);
+    const std::vector<streaming::Change> changes = streaming::plan(textures, {~0ull, upload});
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].texture, 1u);
+    EXPECT_EQ(changes[0].top, 0u);
+}
+
+TEST(StreamingPolicyTest, UpgradesStepCoarserToFit) {
+    const std::vector<MipLevel> levels = chain_levels(1024);
+    const std::vector<streaming::Residency> textures = {{levels, 3, 0, 3}};
+
+    // level 0 does not fit, level 1 does
+    const uint64_t budget = streaming::tail_bytes(levels, 1);
+    const std::vector<streaming::Change> changes = streaming::plan(textures, {budget, ~0ull});
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].top, 1u);
+}
+
+TEST(StreamingPolicyTest, OverBudgetShrinksTheLargestFirst) {
+    const std::vector<MipLevel> large = chain_levels(2048);
+    const std::vector<MipLevel> small = chain_levels(512);
+    const std::vector<streaming::Residency> textures = {
+        {large, 0, 0, 4},
+        {small, 0, 0, 2},
+    };
+
+    const uint64_t budget = streaming::tail_bytes(large, 1) + streaming::tail_bytes(small, 0);
+    const std::vector<streaming::Change> changes = streaming::plan(textures, {budget, ~0ull});
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].texture, 0u);
+    EXPECT_EQ(changes[0].top, 1u);
+}
+
+TEST(StreamingPolicyTest, UnwantedLevelsAreDropped) {
+    const std::vector<MipLevel> levels = chain_levels(256);
+    const std::vector<streaming::Residency> textures = {{levels, 0, 2, 1}};
+
+    // never below the floor even when the demand says so
+    const std::vector<streaming::Change> changes = streaming::plan(textures, {~0ull, 0});
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].top, 1u);
+}
@@ -0,0 +1,116 @@
+#include <TangentSpace.h>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace {
+    // unit quad in the XY plane facing +Z, glTF UVs: u along +X, v top to bottom
+    std::vector<Vertex> make_quad(bool mirrorU) {
+        const glm::vec3 positions[4] = {{0.f, 0.f, 0.f}, {1.f, 0.f, 0.f}, {0.f, 1.f, 0.f}, {1.f, 1.f, 0.f}};
+        std::vector<Vertex> vertices;
+        for (const glm::vec3 &p: positions) {
+            Vertex v{};
+            v.position = p;
+            v.normal = glm::vec3(0.f, 0.f, 1.f);
+            v.uv_x = mirrorU ? 1.f - p.x : p.x;
+            v.uv_y = 1.f - p.y;
+            vertices.push_back(v);
+        }
+        return vertices;
+    }
+
+    const std::vector<uint32_t> QUAD_INDICES = {0, 1, 2, 2, 1, 3};
+
+    void expect_vec3_near(const glm::vec3 &a, const glm::vec3 &b, float tolerance) {
+        EXPECT_NEAR(a.x, b.x, tolerance);
+        EXPECT_NEAR(a.y, b.y, tolerance);
+        EXPECT_NEAR(a.z, b.z, tolerance);
+    }
+} // namespace
+
+TEST(TangentSpaceTest, GeneratesTangentAlongU) {
+    std::vector<Vertex> vertices = make_quad(false);
+    std::vector<float> handedness(vertices.size(), 0.f);
+
+    tangentspace::generate_tangents(vertices, QUAD_INDICES, 0, handedness);
+    tangentspace::orthonormalize_frames(vertices, handedness);
+
+    for (size_t i = 0; i < vertices.size(); i++) {
+        EXPECT_EQ(handedness[i], 1.f);
+        expect_vec3_near(vertices[i].tangent, glm::vec3(1.f, 0.f, 0.f), 1e-5f);
+        expect_vec3_near(vertices[i].bitangent, glm::vec3(0.f, 1.f, 0.f), 1e-5f);
+    }
+}
+
+TEST(TangentSpaceTest, MirroredUVsFlipHandedness) {
+    std::vector<Vertex> vertices = make_quad(true);
+    std::vector<float> handedness(vertices.size(), 0.f);
+
+    tangentspace::generate_tangents(vertices, QUAD_INDICES, 0, handedness);
+    tangentspace::orthonormalize_frames(vertices, handedness);
+
+    for (size_t i = 0; i < vertices.size(); i++) {
+        EXPECT_EQ(handedness[i], -1.f);
+        expect_vec3_near(vertices[i].tangent, glm::vec3(-1.f, 0.f, 0.f), 1e-5f);
+        // the bitangent still follows v, mirroring u must not flip it
+        expect_vec3_near(vertices[i].bitangent, glm::vec3(0.f, 1.f, 0.f), 1e-5f);
+    }
+}
+
+TEST(TangentSpaceTest, BaseVertexOffsetsIndices) {
+    std::vector<Vertex> vertices = make_quad(false);
+    std::vector<float> handedness(vertices.size(), 0.f);
+
+    // the primitive starts at vertex 100 of its mesh
+    std::vector<uint32_t> indices = QUAD_INDICES;
+    for (uint32_t &i: indices) {
+        i += 100;
+    }
+    tangentspace::generate_tangents(vertices, indices, 100, handedness);
+
+    for (const Vertex &v: vertices) {
+        expect_vec3_near(v.tangent, glm::vec3(1.f, 0.f, 0.f), 1e-5f);
+    }
+}
+
+TEST(TangentSpaceTest, DegenerateUVsFallBackToPerpendicular) {
+    std::vector<Vertex> vertices = make_quad(false);
+    for (Vertex &v: vertices) {
+        v.uv_x = 0.f;
+        v.uv_y = 0.f;
+    }
+    std::vector<float> handedness(vertices.size(), 0.f);
+
+    tangentspace::generate_tangents(vertices, QUAD_INDICES, 0, handedness);
+    tangentspace::orthonormalize_frames(vertices, handedness);
+
+    for (const Vertex &v: vertices) {
+        EXPECT_NEAR(glm::dot(v.tangent, v.tangent), 1.f, 1e-5f);
+        EXPECT_NEAR(glm::dot(v.tangent, v.normal), 0.f, 1e-5f);
+        EXPECT_NEAR(glm::dot(v.bitangent, v.normal), 0.f, 1e-5f);
+    }
+}
+
+TEST(TangentSpaceTest, SimdMatchesScalar) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-1.f, 1.f);
+
+    // odd count so the scalar tail runs too, a few zero tangents hit the degenerate lanes
+    std::vector<Vertex> vertices(1001);
+    std::vector<float> handedness(vertices.size());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        vertices[i].normal = glm::normalize(glm::vec3(dist(rng), dist(rng), dist(rng)) + glm::vec3(0.f, 0.f, 2.f));
+        vertices[i].tangent = i % 97 == 0 ? glm::vec3(0.f) : glm::vec3(dist(rng), dist(rng), dist(rng));
+        handedness[i] = dist(rng) < 0.f ? -1.f : 1.f;
+    }
+    std::vector<Vertex> reference = vertices;
+
+    tangentspace::orthonormalize_frames(vertices, handedness);
+    tangentspace::orthonormalize_frames_scalar(reference, handedness);
+
+    for (size_t i = 0; i < vertices.size(); i++) {
+        expect_vec3_near(vertices[i].tangent, reference[i].tangent, 1e-4f);
+        expect_vec3_near(vertices[i].bitangent, reference[i].bitangent, 1e-4f);
+    }
+}
@@ -0,0 +1,89 @@
+#include <TextureCache.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+    AllocatedImage fake_image(uintptr_t handle) {
+        AllocatedImage image{};
+        image.image = reinterpret_cast<VkImage>(handle);
+        image.imageExtent = {64, 64, 1};
+        image.imageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+        return image;
+    }
+} // namespace
+
+TEST(TextureCacheTest, KeyFollowsContentAndDecodeParameters) {
+    const std::vector<uint8_t> a = {1, 2, 3, 4};
+    const std::vector<uint8_t> b = {1, 2, 3, 5};
+
+    const uint64_t reference = TextureCache::key(a, VK_FORMAT_R8G8B8A8_UNORM, true);
+    EXPECT_EQ(TextureCache::key(a, VK_FORMAT_R8G8B8A8_UNORM, true), reference);
+    EXPECT_NE(TextureCache::key(b, VK_FORMAT_R8G8B8A8_UNORM, true), reference);
+    EXPECT_NE(TextureCache::key(a, VK_FORMAT_R8G8B8A8_SRGB, true), reference);
+    EXPECT_NE(TextureCache::key(a, VK_FORMAT_R8G8B8A8_UNORM, false), reference);
+}
+
+TEST(TextureCacheTest, HitsShareTheImageUntilTheLastRelease) {
+    TextureCache cache;
+    constexpr uint64_t key = 42;
+
+    EXPECT_FALSE(cache.acquire(key).has_value());
+    cache.insert(key, fake_image(0x1000), 4096);
+    EXPECT_TRUE(cache.contains(key));
+
+    const std::optional<AllocatedImage> shared = cache.acquire(key);
+    ASSERT_TRUE(shared.has_value());
+    EXPECT_EQ(shared->image, fake_image(0x1000).image);
+
+    // two owners now, the first release keeps the image alive
+    EXPECT_FALSE(cache.release(key).has_value());
+    const std::optional<AllocatedImage> last = cache.release(key);
+    ASSERT_TRUE(last.has_value());
+    EXPECT_EQ(last->image, fake_image(0x1000).image);
+    EXPECT_FALSE(cache.contains(key));
+
+    // unknown keys are ignored
+    EXPECT_FALSE(cache.release(key).has_value());
+}
+
+TEST(TextureCacheTest, StatsTrackHitRateAndSavedBytes) {
+    TextureCache cache;
+    cache.acquire(1);
+    cache.insert(1, fake_image(0x1000), 1000);
+    cache.acquire(2);
+    cache.insert(2, fake_image(0x2000), 500);
+    cache.acquire(1);
+    cache.acquire(1);
+
+    TextureCache::Stats stats = cache.stats();
+    EXPECT_EQ(stats.lookups, 4u);
+    EXPECT_EQ(stats.hits, 2u);
+    EXPECT_EQ(stats.bytesSaved, 2000u);
+    EXPECT_EQ(stats.textureCount, 2u);
+    EXPECT_EQ(stats.residentBytes, 1500u);
+
+    cache.release(2);
+    stats = cache.stats();
+    EXPECT_EQ(stats.textureCount, 1u);
+    EXPECT_EQ(stats.residentBytes, 1000u);
+}
+
+TEST(TextureCacheTest, ReplaceKeepsReferencesAndTracksBytes) {
+    TextureCache cache;
+    constexpr uint64_t key = 7;
+    cache.insert(key, fake_image(0x1000), 1000);
+    cache.acquire(key);
+
+    // a streamed texture moving to a finer mip tail
+    const AllocatedImage old = cache.replace(key, fake_image(0x2000), 4000);
+    EXPECT_EQ(old.image, fake_image(0x1000).image);
+    EXPECT_EQ(cache.stats().residentBytes, 4000u);
+
+    EXPECT_EQ(cache.acquire(key)->image, fake_image(0x2000).image);
+    EXPECT_FALSE(cache.release(key).has_value());
+    EXPECT_FALSE(cache.release(key).has_value());
+    const std::optional<AllocatedImage> last = cache.release(key);
+    ASSERT_TRUE(last.has_value());
+    EXPECT_EQ(last->image, fake_image(0x2000).image);
+    EXPECT_EQ(cache.stats().residentBytes, 0u);
+}
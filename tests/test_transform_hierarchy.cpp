@@ -0,0 +1,110 @@
+#include <TransformHierarchy.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <gtest/gtest.h>
+
+namespace {
+
+    glm::mat4 offset(float x) { return glm::translate(glm::mat4(1.f), glm::vec3(x, 0.f, 0.f)); }
+
+    float world_x(const TransformHierarchy &hierarchy, uint32_t source) {
+        return hierarchy.world(hierarchy.flat_index(source))[3].x;
+    }
+
+    // source nodes listed children first, like glTF allows:
+    //   4 (1) -> 0 (10) -> 2 (100)
+    //         -> 3 (1000)
+    //   1 (10000)
+    TransformHierarchy make_hierarchy() {
+        const std::vector<glm::mat4> locals = {offset(10.f), offset(10000.f), offset(100.f), offset(1000.f),
+                                               offset(1.f)};
+        const std::vector<std::vector<uint32_t>> children = {{2}, {}, {}, {}, {0, 3}};
+        TransformHierarchy hierarchy;
+        hierarchy.build(locals, children);
+        return hierarchy;
+    }
+
+} // namespace
+
+TEST(TransformHierarchyTest, FlattensDepthFirstWithParentsFirst) {
+    const TransformHierarchy hierarchy = make_hierarchy();
+    ASSERT_EQ(hierarchy.size(), 5u);
+    EXPECT_EQ(hierarchy.root_count(), 2u);
+
+    // roots in source order, children in listed order
+    std::vector<uint32_t> order;
+    for (uint32_t i = 0; i < hierarchy.size(); i++) {
+        order.push_back(hierarchy.source_index(i));
+        EXPECT_EQ(hierarchy.flat_index(hierarchy.source_index(i)), i);
+        if (hierarchy.parent(i) != TransformHierarchy::NO_PARENT) {
+            EXPECT_LT(hierarchy.parent(i), i);
+        }
+    }
+    EXPECT_EQ(order, std::vector<uint32_t>({1, 4, 0, 2, 3}));
+    EXPECT_EQ(hierarchy.subtree_end(0), 1u);
+    EXPECT_EQ(hierarchy.subtree_end(1), 5u);
+    EXPECT_EQ(hierarchy.subtree_end(2), 4u);
+}
+
+TEST(TransformHierarchyTest, WorldTransformsComposeTheParents) {
+    TransformHierarchy hierarchy = make_hierarchy();
+    EXPECT_TRUE(hierarchy.dirty());
+    EXPECT_EQ(hierarchy.update(), 5u);
+    EXPECT_FALSE(hierarchy.dirty());
+
+    EXPECT_FLOAT_EQ(world_x(hierarchy, 4), 1.f);
+    EXPECT_FLOAT_EQ(world_x(hierarchy, 0), 11.f);
+    EXPECT_FLOAT_EQ(world_x(hierarchy, 2), 111.f);
+    EXPECT_FLOAT_EQ(world_x(hierarchy, 3), 1001.f);
+    EXPECT_FLOAT_EQ(world_x(hierarchy, 1), 10000.f);
+
+    // nothing changed, nothing is recomputed
+    EXPECT_EQ(hierarchy.update(), 0u);
+}
+
+TEST(TransformHierarchyTest, ChangedNodeRecomputesOnlyItsSubtree) {
+    TransformHierarchy hierarchy = make_hierarchy();
+    hierarchy.update();
+
+    hierarchy.set_local(hierarchy.flat_index(0), offset(20.f));
+    EXPECT_EQ(hierarchy.update(), 2u);
+    using Ranges = std::vector<std::pair<uint32_t, uint32_t>>;
+    EXPECT_EQ(Ranges(hierarchy.updated_ranges().begin(), hierarchy.updated_ranges().end()), Ranges({{2, 4}}));
+    EXPECT_FLOAT_EQ(world_x(hierarchy, 0), 21.f);
+    EXPECT_FLOAT_EQ(world_x(hierarchy, 2), 121.f);
+    EXPECT_FLOAT_EQ(world_x(hierarchy, 3), 1001.f);
+
+    // a dirty node inside a dirty subtree is swept once
+    hierarchy.set_local(hierarchy.flat_index(2), offset(200.f));
+    hierarchy.set_local(hierarchy.flat_index(4), offset(2.f));
+    EXPECT_EQ(hierarchy.update(), 4u);
+    EXPECT_EQ(Ranges(hierarchy.updated_ranges().begin(), hierarchy.updated_ranges().end()), Ranges({{1, 5}}));
+    EXPECT_FLOAT_EQ(world_x(hierarchy, 2), 222.f);
+    EXPECT_FLOAT_EQ(world_x(hierarchy, 3), 1002.f);
+}
+
+TEST(TransformHierarchyTest, MovedRootMovesEverything) {
+    TransformHierarchy hierarchy = make_hierarchy();
+    hierarchy.update();
+
+    hierarchy.set_root(offset(5.f));
+    EXPECT_EQ(hierarchy.update(), 5u);
+    EXPECT_FLOAT_EQ(world_x(hierarchy, 2), 116.f);
+    EXPECT_FLOAT_EQ(world_x(hierarchy, 1), 10005.f);
+
+    // the same placement again is not a change
+    hierarchy.set_root(offset(5.f));
+    EXPECT_FALSE(hierarchy.dirty());
+}
+
+TEST(TransformHierarchyTest, CyclesAndSharedChildrenAreDroppedNotRepeated) {
+    // 0 -> 1 and 0 -> 2, 2 also lists 1; 3 <-> 4 only reference each other
+    const std::vector<glm::mat4> locals(5, glm::mat4(1.f));
+    const std::vector<std::vector<uint32_t>> children = {{1, 2}, {}, {1}, {4}, {3}};
+    TransformHierarchy hierarchy;
+    hierarchy.build(locals, children);
+
+    EXPECT_EQ(hierarchy.size(), 3u);
+    EXPECT_EQ(hierarchy.parent(hierarchy.flat_index(1)), hierarchy.flat_index(0));
+    EXPECT_EQ(hierarchy.flat_index(3), TransformHierarchy::NO_PARENT);
+    EXPECT_EQ(hierarchy.flat_index(4), TransformHierarchy::NO_PARENT);
+}
@@ -0,0 +1,118 @@
+#include <VertexPacking.h>
+#include <glm/glm.hpp>
+#include <gtest/gtest.h>
+#include <random>
+
+namespace {
+    Vertex make_vertex(std::mt19937 &rng, float handedness) {
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+        std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+        Vertex v{};
+        v.position = glm::vec3(dist(rng), dist(rng), dist(rng)) * 10.f;
+        v.normal = glm::normalize(glm::vec3(dist(rng), dist(rng), dist(rng)) + glm::vec3(0.f, 0.f, 0.01f));
+        // any direction off the normal, made perpendicular like the tangent stage does
+        const glm::vec3 t = glm::vec3(dist(rng), dist(rng), dist(rng));
+        v.tangent = glm::normalize(t - v.normal * glm::dot(v.normal, t));
+        v.bitangent = glm::cross(v.normal, v.tangent) * handedness;
+        v.uv_x = unit(rng);
+        v.uv_y = unit(rng);
+        v.color = glm::vec4(unit(rng), unit(rng), unit(rng), 1.f);
+        return v;
+    }
+
+    void expect_vec3_near(const glm::vec3 &a, const glm::vec3 &b, float tolerance) {
+        EXPECT_NEAR(a.x, b.x, tolerance);
+        EXPECT_NEAR(a.y, b.y, tolerance);
+        EXPECT_NEAR(a.z, b.z, tolerance);
+    }
+} // namespace
+
+TEST(VertexPackingTest, OctahedralRoundTrip) {
+    const glm::vec3 directions[] = {{0.f, 0.f, 1.f},  {0.f, 0.f, -1.f}, {1.f, 0.f, 0.f},
+                                    {0.f, -1.f, 0.f}, {0.6f, 0.f, -0.8f}, glm::normalize(glm::vec3(-1.f, 1.f, -1.f))};
+    for (const glm::vec3 &n: directions) {
+        expect_vec3_near(vertexpacking::oct_decode(vertexpacking::oct_encode(n)), n, 1e-5f);
+    }
+}
+
+TEST(VertexPackingTest, PackedVertexRoundTrip) {
+    std::mt19937 rng(3);
+    for (int i = 0; i < 256; i++) {
+        const Vertex v = make_vertex(rng, i % 2 == 0 ? 1.f : -1.f);
+        const Vertex unpacked = vertexpacking::unpack(vertexpacking::pack(v));
+
+        expect_vec3_near(unpacked.position, v.position, 0.f);
+        expect_vec3_near(unpacked.normal, v.normal, 1e-3f);
+        expect_vec3_near(unpacked.tangent, v.tangent, 1e-3f);
+        // the bitangent is rebuilt from the sign bit, mirrored frames must survive
+        expect_vec3_near(unpacked.bitangent, v.bitangent, 2e-3f);
+        EXPECT_NEAR(unpacked.uv_x, v.uv_x, 1e-3f);
+        EXPECT_NEAR(unpacked.uv_y, v.uv_y, 1e-3f);
+        EXPECT_NEAR(unpacked.color.x, v.color.x, 1.f / 255.f);
+        EXPECT_NEAR(unpacked.color.w, v.color.w, 1.f / 255.f);
+    }
+}
+
+TEST(VertexPackingTest, QuantizedPositionsStayInsideBounds) {
+    std::mt19937 rng(5);
+    std::vector<Vertex> vertices;
+    for (int i = 0; i < 256; i++) {
+        vertices.push_back(make_vertex(rng, 1.f));
+    }
+
+    std::vector<std::byte> bytes;
+    const VertexQuantization quantization =
+        vertexpacking::pack_vertices(vertices, VertexFormat::PackedQuantized, bytes);
+    ASSERT_EQ(bytes.size(), vertices.size() * sizeof(QuantizedVertex));
+
+    // positions span +-10, snorm16 steps are ~3e-4 of that
+    const auto *packed = reinterpret_cast<const QuantizedVertex *>(bytes.data());
+    for (size_t i = 0; i < vertices.size(); i++) {
+        expect_vec3_near(vertexpacking::unpack(packed[i], quantization).position, vertices[i].position, 1e-3f);
+    }
+}
+
+TEST(VertexPackingTest, PacksIntoCallerMemory) {
+    std::mt19937 rng(9);
+    std::vector<Vertex> vertices;
+    for (int i = 0; i < 64; i++) {
+        vertices.push_back(make_vertex(rng, i % 2 ? 1.f : -1.f));
+    }
+
+    // what uploadMesh hands over: staging memory sized for the format, written in place
+    for (const VertexFormat format: {VertexFormat::Full, VertexFormat::Packed, VertexFormat::PackedQuantized}) {
+        std::vector<std::byte> expected;
+        const VertexQuantization expectedQuantization = vertexpacking::pack_vertices(vertices, format, expected);
+
+        std::vector<std::byte> staging(vertices.size() * vertexpacking::stride(format));
+        const VertexQuantization quantization =
+            vertexpacking::pack_vertices(vertices, format, std::span<std::byte>(staging));
+        EXPECT_EQ(staging, expected);
+        expect_vec3_near(quantization.offset, expectedQuantization.offset, 0.f);
+        expect_vec3_near(quantization.scale, expectedQuantization.scale, 0.f);
+    }
+}
+
+TEST(VertexPackingTest, FlatMeshQuantizesWithoutNan) {
+    std::vector<Vertex> vertices(3);
+    vertices[0].position = glm::vec3(0.f, 2.f, 0.f);
+    vertices[1].position = glm::vec3(1.f, 2.f, 0.f);
+    vertices[2].position = glm::vec3(0.f, 2.f, 1.f);
+
+    const VertexQuantization quantization = vertexpacking::compute_quantization(vertices);
+    for (const Vertex &v: vertices) {
+        expect_vec3_near(vertexpacking::unpack(vertexpacking::quantize(v, quantization), quantization).position,
+                         v.position, 1e-4f);
+    }
+}
+
+TEST(VertexPackingTest, TiledUVsKeepFullPrecision) {
+    std::vector<Vertex> vertices(2);
+    vertices[1].uv_x = 0.5f;
+    EXPECT_EQ(vertexpacking::select_format(vertices, VertexFormat::Packed), VertexFormat::Packed);
+
+    vertices[1].uv_x = 12.f;
+    EXPECT_EQ(vertexpacking::select_format(vertices, VertexFormat::Packed), VertexFormat::Full);
+    EXPECT_EQ(vertexpacking::select_format(vertices, VertexFormat::PackedQuantized), VertexFormat::Full);
+}
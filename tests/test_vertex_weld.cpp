@@ -0,0 +1,83 @@
+#include <VertexWeld.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+    Vertex make_vertex(float x, float y, const glm::vec3 &normal) {
+        Vertex v{};
+        v.position = glm::vec3(x, y, 0.f);
+        v.normal = normal;
+        v.uv_x = x;
+        v.uv_y = y;
+        v.color = glm::vec4(1.f);
+        v.tangent = glm::vec3(1.f, 0.f, 0.f);
+        return v;
+    }
+
+    // a quad exported unindexed: two triangles, six vertices, the shared corners duplicated
+    void make_unindexed_quad(std::vector<Vertex> &vertices, std::vector<uint32_t> &indices, uint32_t baseVertex) {
+        const glm::vec3 up(0.f, 0.f, 1.f);
+        const float corners[6][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1}};
+        for (const auto &c: corners) {
+            indices.push_back(baseVertex + static_cast<uint32_t>(vertices.size()));
+            vertices.push_back(make_vertex(c[0], c[1], up));
+        }
+    }
+} // namespace
+
+TEST(VertexWeldTest, ExactDuplicatesMerge) {
+    constexpr uint32_t baseVertex = 40;
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    make_unindexed_quad(vertices, indices, baseVertex);
+    std::vector<float> handedness(vertices.size(), 1.f);
+    const std::vector<Vertex> original = vertices;
+
+    const size_t kept = vertexweld::weld(vertices, handedness, indices, baseVertex);
+    EXPECT_EQ(kept, 4u);
+    // every triangle still reads the positions it did before
+    for (size_t i = 0; i < indices.size(); i++) {
+        ASSERT_GE(indices[i], baseVertex);
+        ASSERT_LT(indices[i] - baseVertex, kept);
+        EXPECT_EQ(vertices[indices[i] - baseVertex].position, original[i].position);
+    }
+    // the first occurrences keep their order
+    EXPECT_EQ(vertices[0].position, original[0].position);
+    EXPECT_EQ(vertices[3].position, original[5].position);
+}
+
+TEST(VertexWeldTest, HardEdgesAndMirroredUVsStaySplit) {
+    std::vector<Vertex> vertices = {make_vertex(0, 0, {0.f, 0.f, 1.f}), make_vertex(0, 0, {1.f, 0.f, 0.f}),
+                                    make_vertex(0, 0, {0.f, 0.f, 1.f})};
+    std::vector<float> handedness = {1.f, 1.f, -1.f};
+    std::vector<uint32_t> indices = {0, 1, 2};
+
+    // same position, different normal or bitangent sign
+    EXPECT_EQ(vertexweld::weld(vertices, handedness, indices, 0), 3u);
+    EXPECT_EQ(indices, (std::vector<uint32_t>{0, 1, 2}));
+}
+
+TEST(VertexWeldTest, EpsilonMergesNearDuplicates) {
+    std::vector<Vertex> vertices = {make_vertex(0.5f, 0.5f, {0.f, 0.f, 1.f}),
+                                    make_vertex(0.5f + 1e-6f, 0.5f, {0.f, 0.f, 1.f}),
+                                    make_vertex(0.6f, 0.5f, {0.f, 0.f, 1.f})};
+    std::vector<float> handedness(vertices.size(), 1.f);
+    std::vector<uint32_t> indices = {0, 1, 2};
+
+    std::vector<Vertex> exact = vertices;
+    std::vector<float> exactHandedness = handedness;
+    std::vector<uint32_t> exactIndices = indices;
+    EXPECT_EQ(vertexweld::weld(exact, exactHandedness, exactIndices, 0), 3u);
+
+    EXPECT_EQ(vertexweld::weld(vertices, handedness, indices, 0, 1e-4f), 2u);
+    EXPECT_EQ(indices, (std::vector<uint32_t>{0, 0, 1}));
+}
+
+TEST(VertexWeldTest, SignedZeroIsOneValue) {
+    std::vector<Vertex> vertices = {make_vertex(0.f, 1.f, {0.f, 0.f, 1.f}), make_vertex(-0.f, 1.f, {-0.f, 0.f, 1.f})};
+    std::vector<float> handedness(vertices.size(), 1.f);
+    std::vector<uint32_t> indices = {0, 1, 1};
+
+    EXPECT_EQ(vertexweld::weld(vertices, handedness, indices, 0), 1u);
+    EXPECT_EQ(indices, (std::vector<uint32_t>{0, 0, 0}));
+}